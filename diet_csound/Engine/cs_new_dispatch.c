@@ -76,6 +76,10 @@
 #define INIT_SIZE (100)
 //static int task_max_size;
 
+static void dag_seed_deques(CSOUND *csound);
+static inline int dag_depends(CSOUND *csound, int j, int k);
+void dag_reinit(CSOUND *csound);
+
 static void dag_print_state(CSOUND *csound)
 {
     int i;
@@ -104,10 +108,9 @@ static void dag_print_state(CSOUND *csound)
         break;
       case WAITING:
         {
-          char *tt = csound->dag_task_dep[i];
           int j;
           printf("status=WAITING for tasks [");
-          for (j=0; j<i; j++) if (tt[j]) printf("%d ", j);
+          for (j=0; j<i; j++) if (dag_depends(csound, i, j)) printf("%d ", j);
           printf("]\n");
         }
         break;
@@ -117,6 +120,28 @@ static void dag_print_state(CSOUND *csound)
     }
 }
 
+/* One ready-task deque per performance thread, each large enough to
+   hold every task of a k-cycle */
+static void dag_alloc_deques(CSOUND *csound)
+{
+    int i, max = csound->dag_task_max_size;
+    if (csound->dag_deques == NULL) {
+      csound->dag_num_deques =
+        csound->oparms->numThreads > 1 ? csound->oparms->numThreads : 1;
+      csound->dag_deques =
+        csound->Calloc(csound, sizeof(taskDeque)*csound->dag_num_deques);
+      for (i=0; i<csound->dag_num_deques; i++)
+        csound->dag_deques[i].tasks =
+          csound->Calloc(csound, sizeof(taskID)*max);
+    }
+    else {
+      for (i=0; i<csound->dag_num_deques; i++)
+        csound->dag_deques[i].tasks =
+          csound->ReAlloc(csound, csound->dag_deques[i].tasks,
+                          sizeof(taskID)*max);
+    }
+}
+
 /* For now allocate a fixed maximum number of tasks; FIXME */
 static void create_dag(CSOUND *csound)
 {
@@ -125,8 +150,11 @@ static void create_dag(CSOUND *csound)
     csound->dag_task_status = csound->Calloc(csound, sizeof(stateWithPadding)*max);
     csound->dag_task_watch  = csound->Calloc(csound, sizeof(watchList*)*max);
     csound->dag_task_map    = csound->Calloc(csound, sizeof(INSDS*)*max);
-    csound->dag_task_dep    = (char **)csound->Calloc(csound, sizeof(char*)*max);
+    csound->dag_task_ins    = (int *)csound->Calloc(csound, sizeof(int)*max);
+    csound->dag_run_first   = (int *)csound->Calloc(csound, sizeof(int)*max);
     csound->dag_wlmm = (watchList *)csound->Calloc(csound, sizeof(watchList)*max);
+    if (csound->oparms->parallelScheduler == PAR_SCHED_STEAL)
+      dag_alloc_deques(csound);
 }
 
 static void recreate_dag(CSOUND *csound)
@@ -141,10 +169,14 @@ static void recreate_dag(CSOUND *csound)
                sizeof(watchList*)*max);
     csound->dag_task_map    =
       csound->ReAlloc(csound, (INSDS *)csound->dag_task_map, sizeof(INSDS*)*max);
-    csound->dag_task_dep    =
-      (char **)csound->ReAlloc(csound, csound->dag_task_dep, sizeof(char*)*max);
+    csound->dag_task_ins    =
+      (int *)csound->ReAlloc(csound, csound->dag_task_ins, sizeof(int)*max);
+    csound->dag_run_first   =
+      (int *)csound->ReAlloc(csound, csound->dag_run_first, sizeof(int)*max);
     csound->dag_wlmm        =
       (watchList *)csound->ReAlloc(csound, csound->dag_wlmm, sizeof(watchList)*max);
+    if (csound->oparms->parallelScheduler == PAR_SCHED_STEAL)
+      dag_alloc_deques(csound);
 }
 
 static INSTR_SEMANTICS *dag_get_info(CSOUND* csound, int insno)
@@ -183,11 +215,102 @@ static int dag_intersect(CSOUND *csound, struct set_t *current,
     return res;
 }
 
+/*
+ * Dependencies are a property of instrument templates, not of instances:
+ * a later instance must wait for an earlier one exactly when their
+ * instruments' read/write sets clash.  So rather than an instance by
+ * instance matrix, keep one bitset row per instrument number recording
+ * which other instruments it clashes with.  A bit is worked out (by set
+ * intersection) the first time the two instruments are active together,
+ * and forgotten only if either instrument is redefined.  Adding or
+ * removing instances then costs a linear walk of the active list.
+ */
+#define DAG_WORDS(n)         (((n)>>5)+1)
+#define DAG_BIT(row,n)       (((row)[(n)>>5] >> ((n)&31)) & 1)
+#define DAG_SET_BIT(row,n)   ((row)[(n)>>5] |= (1u << ((n)&31)))
+#define DAG_CLR_BIT(row,n)   ((row)[(n)>>5] &= ~(1u << ((n)&31)))
+
+/* does task j have to wait for (earlier) task k? */
+static inline int dag_depends(CSOUND *csound, int j, int k)
+{
+    return DAG_BIT(csound->dag_ins_conflict[csound->dag_task_ins[j]],
+                   csound->dag_task_ins[k]);
+}
+
+static void dag_check_templates(CSOUND *csound)
+{
+    int i, r, max = csound->engineState.maxinsno;
+    INSTRTXT **txt = csound->engineState.instrtxtp;
+    if (max > csound->dag_ins_max || csound->dag_ins_txt == NULL) {
+      /* instrument range grew; start again with wider rows */
+      for (i=0; csound->dag_ins_txt != NULL && i<=csound->dag_ins_max; i++) {
+        csound->Free(csound, csound->dag_ins_conflict[i]);
+        csound->Free(csound, csound->dag_ins_known[i]);
+      }
+      if (csound->dag_ins_txt != NULL) {
+        csound->Free(csound, csound->dag_ins_conflict);
+        csound->Free(csound, csound->dag_ins_known);
+        csound->Free(csound, csound->dag_ins_txt);
+      }
+      csound->dag_ins_max = max;
+      csound->dag_ins_conflict = csound->Calloc(csound, sizeof(uint32_t*)*(max+1));
+      csound->dag_ins_known = csound->Calloc(csound, sizeof(uint32_t*)*(max+1));
+      csound->dag_ins_txt = csound->Calloc(csound, sizeof(INSTRTXT*)*(max+1));
+      for (i=0; i<=max; i++) {
+        csound->dag_ins_conflict[i] =
+          csound->Calloc(csound, sizeof(uint32_t)*DAG_WORDS(max));
+        csound->dag_ins_known[i] =
+          csound->Calloc(csound, sizeof(uint32_t)*DAG_WORDS(max));
+      }
+    }
+    for (i=1; i<=max; i++) {
+      if (csound->dag_ins_txt[i] == txt[i]) continue;
+      /* (re)defined instrument: forget all it was known to clash with */
+      memset(csound->dag_ins_known[i], '\0',
+             sizeof(uint32_t)*DAG_WORDS(csound->dag_ins_max));
+      for (r=0; r<=csound->dag_ins_max; r++)
+        DAG_CLR_BIT(csound->dag_ins_known[r], i);
+      csound->dag_ins_txt[i] = txt[i];
+    }
+}
+
+static void dag_learn(CSOUND *csound, int a, int b)
+{
+    INSTR_SEMANTICS *current_instr, *later_instr;
+    int cnt = 0;
+    if (DAG_BIT(csound->dag_ins_known[a], b)) return;
+    current_instr = dag_get_info(csound, a);
+    later_instr = dag_get_info(csound, b);
+    /* the test is symmetric in the two instruments */
+    if (dag_intersect(csound, current_instr->write,
+                      later_instr->read, cnt++)       ||
+        dag_intersect(csound, current_instr->read_write,
+                      later_instr->read, cnt++)       ||
+        dag_intersect(csound, current_instr->read,
+                      later_instr->write, cnt++)      ||
+        dag_intersect(csound, current_instr->write,
+                      later_instr->write, cnt++)      ||
+        dag_intersect(csound, current_instr->read_write,
+                      later_instr->write, cnt++)      ||
+        dag_intersect(csound, current_instr->read,
+                      later_instr->read_write, cnt++) ||
+        dag_intersect(csound, current_instr->write,
+                      later_instr->read_write, cnt++)) {
+      DAG_SET_BIT(csound->dag_ins_conflict[a], b);
+      DAG_SET_BIT(csound->dag_ins_conflict[b], a);
+    }
+    else {
+      DAG_CLR_BIT(csound->dag_ins_conflict[a], b);
+      DAG_CLR_BIT(csound->dag_ins_conflict[b], a);
+    }
+    DAG_SET_BIT(csound->dag_ins_known[a], b);
+    DAG_SET_BIT(csound->dag_ins_known[b], a);
+}
+
 void dag_build(CSOUND *csound, INSDS *chain)
 {
     INSDS *save = chain;
-    INSDS **task_map;
-    int i;
+    int i, q;
 
     //printf("DAG BUILD***************************************\n");
     csound->dag_num_active = 0;
@@ -202,103 +325,66 @@ void dag_build(CSOUND *csound, INSDS *chain)
     }
     if (csound->dag_task_status == NULL)
       create_dag(csound); /* Should move elsewhere */
-    else {
-      memset((void*)csound->dag_task_watch, '\0',
-             sizeof(watchList*)*csound->dag_task_max_size);
-      for (i=0; i<csound->dag_task_max_size; i++) {
-        if (csound->dag_task_dep[i]) {
-          csound->dag_task_dep[i]= NULL;
-        }
-        csound->dag_wlmm[i].id = INVALID;
-      }
-    }
-    task_map = csound->dag_task_map;
-    for (i=0; i<csound->dag_num_active; i++) {
-      csound->dag_task_status[i].s = AVAILABLE;
-      csound->dag_wlmm[i].id=i;
-    }
-    csound->dag_changed = 0;
     if (UNLIKELY(csound->oparms->odebug))
       printf("dag_num_active = %d\n", csound->dag_num_active);
-    i = 0; chain = save;
-    while (chain != NULL) {     /* for each instance check against later */
-      int j = i+1;              /* count of instance */
-      if (UNLIKELY(csound->oparms->odebug))
-        printf("\nWho depends on %d (instr %d)?\n", i, chain->insno);
-      INSDS *next = chain->nxtact;
-      INSTR_SEMANTICS *current_instr = dag_get_info(csound, chain->insno);
-      //csp_set_print(csound, current_instr->read);
-      //csp_set_print(csound, current_instr->write);
-      while (next) {
-        INSTR_SEMANTICS *later_instr = dag_get_info(csound, next->insno);
-        int cnt = 0;
-        if (UNLIKELY(csound->oparms->odebug)) printf("%d ", j);
-        //csp_set_print(csound, later_instr->read);
-        //csp_set_print(csound, later_instr->write);
-        //csp_set_print(csound, later_instr->read_write);
-        if (dag_intersect(csound, current_instr->write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->read_write, cnt++) ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->read_write, cnt++)) {
-          char *tt = csound->dag_task_dep[j];
-          if (tt==NULL) {
-            /* get dep vector if missing and set watch first time */
-            tt = csound->dag_task_dep[j] =
-              (char*)csound->Calloc(csound, sizeof(char)*(j+1));
-            csound->dag_task_status[j].s = WAITING;
-            csound->dag_wlmm[j].next = csound->dag_task_watch[i];
-            csound->dag_wlmm[j].id = j;
-            csound->dag_task_watch[i] = &(csound->dag_wlmm[j]);
-            //printf("set watch %d to %d\n", j, i);
-          }
-          tt[i] = 1;
-          //printf("-yes ");
-        }
-        j++; next = next->nxtact;
+    for (i=0, chain = save; chain != NULL; i++, chain = chain->nxtact)
+      csound->dag_task_map[i] = chain;
+    dag_check_templates(csound);
+    /* split into runs of instances of one instrument, and make sure
+       every pair of instruments present has been compared */
+    csound->dag_num_runs = 0;
+    for (i=0; i<csound->dag_num_active; i++) {
+      int insno = csound->dag_task_map[i]->insno;
+      csound->dag_task_ins[i] = insno;
+      if (i == 0 || insno != csound->dag_task_ins[i-1]) {
+        csound->dag_run_first[csound->dag_num_runs++] = i;
+        for (q=0; q<csound->dag_num_runs; q++)
+          dag_learn(csound, insno,
+                    csound->dag_task_ins[csound->dag_run_first[q]]);
       }
-      task_map[i] = chain;
-      i++; chain = chain->nxtact;
     }
+    csound->dag_changed = 0;
+    /* If every task waits on its predecessor there is no parallelism
+       to exploit, and the main thread can run the cycle alone */
+    csound->dag_serial = 1;
+    for (i=1; i<csound->dag_num_active; i++)
+      if (!dag_depends(csound, i, i-1)) {
+        csound->dag_serial = 0;
+        break;
+      }
+    dag_reinit(csound);
     if (UNLIKELY(csound->oparms->odebug)) dag_print_state(csound);
 }
 
 void dag_reinit(CSOUND *csound)
 {
-    int i;
+    int i, r = 0;
     int max = csound->dag_task_max_size;
     volatile stateWithPadding *task_status = csound->dag_task_status;
     watchList * volatile *task_watch = csound->dag_task_watch;
     watchList *wlmm = csound->dag_wlmm;
+    int *run_first = csound->dag_run_first;
     if (UNLIKELY(csound->oparms->odebug))
       printf("DAG REINIT************************\n");
     for (i=csound->dag_num_active; i<max; i++)
       task_status[i].s = DONE;
-    task_status[0].s = AVAILABLE;
-    task_watch[0] = NULL;
-    for (i=1; i<csound->dag_num_active; i++) {
-      int j;
+    for (i=0; i<csound->dag_num_active; i++) {
+      int q;
+      if (r+1 < csound->dag_num_runs && run_first[r+1] == i) r++;
       task_status[i].s = AVAILABLE;
       task_watch[i] = NULL;
-      if (csound->dag_task_dep[i]==NULL) continue;
-      for (j=0; j<i; j++)
-        if (csound->dag_task_dep[i][j]) {
+      wlmm[i].id = i;
+      /* watch the earliest task depended on; in any run it is the
+         run's first instance */
+      for (q=0; q<=r; q++)
+        if (run_first[q] < i && dag_depends(csound, i, run_first[q])) {
           task_status[i].s = WAITING;
-          wlmm[i].id = i;
-          wlmm[i].next = task_watch[j];
-          task_watch[j] = &wlmm[i];
+          wlmm[i].next = task_watch[run_first[q]];
+          task_watch[run_first[q]] = &wlmm[i];
           break;
         }
     }
+    if (csound->dag_deques != NULL) dag_seed_deques(csound);
     //dag_print_state(csound);
 }
 
@@ -324,6 +410,89 @@ void dag_reinit(CSOUND *csound)
                               __ATOMIC_SEQ_CST)
 #endif
 
+#if defined(_MSC_VER)
+#define ATOMIC_LOAD_ACQ(x) (x)
+#define ATOMIC_STORE_REL(x,v) (x) = (v)
+#define ATOMIC_FENCE() MemoryBarrier()
+#define ATOMIC_DEC(x) InterlockedDecrement((volatile LONG *)(x))
+#else
+#define ATOMIC_LOAD_ACQ(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_REL(x,v) __atomic_store_n(&(x), v, __ATOMIC_RELEASE)
+#define ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define ATOMIC_DEC(x) __atomic_sub_fetch(x, 1, __ATOMIC_SEQ_CST)
+#endif
+
+/* Work-stealing deques (Chase and Lev, without the circular buffer).
+ * Only the owning thread calls deque_push and deque_pop; any thread
+ * may call deque_steal.
+ */
+static inline void deque_push(taskDeque *d, taskID t)
+{
+    int b = d->bottom;
+    d->tasks[b] = t;
+    ATOMIC_STORE_REL(d->bottom, b+1);
+}
+
+static inline taskID deque_pop(taskDeque *d)
+{
+    int b = d->bottom - 1, t;
+    taskID x = INVALID;
+    d->bottom = b;
+    ATOMIC_FENCE();
+    t = d->top;
+    if (t <= b) {
+      x = d->tasks[b];
+      if (t == b) {             /* last one; race against thieves */
+        if (!ATOMIC_CAS(&(d->top), t, t+1)) x = INVALID;
+        d->bottom = b+1;
+      }
+    }
+    else d->bottom = b+1;
+    return x;
+}
+
+static inline taskID deque_steal(taskDeque *d)
+{
+    int t = ATOMIC_LOAD_ACQ(d->top), b;
+    ATOMIC_FENCE();
+    b = ATOMIC_LOAD_ACQ(d->bottom);
+    if (t < b) {
+      taskID x = d->tasks[t];
+      if (ATOMIC_CAS(&(d->top), t, t+1)) return x;
+    }
+    return INVALID;
+}
+
+/* Called by the main thread before the workers are released: queue the
+   initially available tasks round-robin over the thread deques */
+static void dag_seed_deques(CSOUND *csound)
+{
+    int i, n = csound->dag_num_deques;
+    volatile stateWithPadding *task_status = csound->dag_task_status;
+    for (i=0; i<n; i++)
+      csound->dag_deques[i].top = csound->dag_deques[i].bottom = 0;
+    for (i=0; i<csound->dag_num_active; i++)
+      if (task_status[i].s == AVAILABLE)
+        deque_push(&csound->dag_deques[i%n], i);
+    csound->dag_tasks_left = csound->dag_num_active;
+}
+
+static taskID dag_steal_task(CSOUND *csound, int index)
+{
+    int i, n = csound->dag_num_deques;
+    taskID t;
+    index %= n;
+    t = deque_pop(&csound->dag_deques[index]);
+    for (i=1; t == INVALID && i<n; i++)
+      t = deque_steal(&csound->dag_deques[(index+i)%n]);
+    if (t != INVALID) {
+      ATOMIC_WRITE(csound->dag_task_status[t].s, INPROGRESS);
+      return t;
+    }
+    if (ATOMIC_LOAD_ACQ(csound->dag_tasks_left) == 0) return (taskID)INVALID;
+    return (taskID)WAIT;
+}
+
 taskID dag_get_task(CSOUND *csound, int index, int numThreads, taskID next_task)
 {
     int i;
@@ -339,6 +508,7 @@ taskID dag_get_task(CSOUND *csound, int index, int numThreads, taskID next_task)
       ATOMIC_WRITE(task_status[next_task].s,INPROGRESS);
       return next_task;
     }
+    if (csound->dag_deques != NULL) return dag_steal_task(csound, index);
 
     //printf("**GetTask from %d\n", csound->dag_num_active);
     i = start;
@@ -406,7 +576,7 @@ inline static int moveWatch(CSOUND *csound, watchList * volatile *w,
     return 1;
 }
 
-taskID dag_end_task(CSOUND *csound, taskID i)
+taskID dag_end_task(CSOUND *csound, int index, taskID i)
 {
     watchList *to_notify, *next;
     int canQueue;
@@ -436,7 +606,7 @@ taskID dag_end_task(CSOUND *csound, taskID i)
       wait_on_current_tasks = 0;
 
       for (k=0; k<j; k++) {     /* seek next watch */
-        if (csound->dag_task_dep[j][k]==0) continue;
+        if (!dag_depends(csound, j, k)) continue;
         current_task_status = ATOMIC_READ(csound->dag_task_status[k].s);
         //printf("investigating task %d (%d)\n", k, current_task_status);
 
@@ -466,7 +636,7 @@ taskID dag_end_task(CSOUND *csound, taskID i)
       // Try the same thing again but this time waiting on active or available task
       if (wait_on_current_tasks == 1) {
         for (k=0; k<j; k++) {     /* seek next watch */
-          if (csound->dag_task_dep[j][k]==0) continue;
+          if (!dag_depends(csound, j, k)) continue;
           current_task_status = ATOMIC_READ(csound->dag_task_status[k].s);
           //printf("investigating task %d (%d)\n", k, current_task_status);
 
@@ -494,10 +664,15 @@ taskID dag_end_task(CSOUND *csound, taskID i)
           next_task = j; // Forward directly to the thread to save re-dispatch
         } else {
           ATOMIC_WRITE(csound->dag_task_status[j].s, AVAILABLE);
+          if (csound->dag_deques != NULL)
+            deque_push(&csound->dag_deques[index%csound->dag_num_deques], j);
         }
       }
       to_notify = next;
     }
+    /* Only after any newly ready tasks are queued, so an idle thread
+       seeing empty deques and no tasks left can safely stop */
+    if (csound->dag_deques != NULL) ATOMIC_DEC(&csound->dag_tasks_left);
     //dag_print_state(csound);
     return next_task;
 }
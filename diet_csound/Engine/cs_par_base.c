@@ -23,6 +23,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#if !defined(WIN32)
+#include <unistd.h>
+#endif
 
 #include "csoundCore.h"
 
@@ -144,26 +147,85 @@ int barrier_wait(barrier_t *b)
 /***********************************************************************
  * parallel primitives
  */
+#if defined(_MSC_VER)
+#define BARRIER_LOAD(x) (x)
+#define BARRIER_STORE(x,v) (x) = (v)
+#define BARRIER_INC(x) InterlockedIncrement((volatile LONG *)(x))
+#define BARRIER_PAUSE() YieldProcessor()
+#else
+#define BARRIER_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define BARRIER_STORE(x,v) __atomic_store_n(&(x), v, __ATOMIC_RELEASE)
+#define BARRIER_INC(x) __atomic_add_fetch(x, 1, __ATOMIC_ACQ_REL)
+#if defined(__i386__) || defined(__x86_64__)
+#define BARRIER_PAUSE() __builtin_ia32_pause()
+#else
+#define BARRIER_PAUSE()
+#endif
+#endif
+
 void csp_barrier_alloc(CSOUND *csound, void **barrier,
                        int thread_count)
 {
+    csp_barrier_t *b;
     if (UNLIKELY(barrier == NULL))
       csound->Die(csound, Str("Invalid NULL Parameter barrier"));
     if (UNLIKELY(thread_count < 1))
       csound->Die(csound, Str("Invalid Parameter thread_count must be > 0"));
 
-    *barrier = csound->CreateBarrier(thread_count);
-    if (UNLIKELY(*barrier == NULL)) {
+    b = (csp_barrier_t *) csound->Calloc(csound, sizeof(csp_barrier_t));
+    b->max = thread_count;
+    b->spin = csound->oparms->barrierSpin;
+#if defined(_SC_NPROCESSORS_ONLN)
+    /* spinning only pays when every thread has a core to itself */
+    if (thread_count > sysconf(_SC_NPROCESSORS_ONLN)) b->spin = 0;
+#endif
+    b->mutex = csoundCreateMutex(0);
+    b->cond = csoundCreateCondVar();
+    if (UNLIKELY(b->mutex == NULL || b->cond == NULL)) {
         csound->Die(csound, Str("Failed to allocate barrier"));
     }
+    *barrier = (void *) b;
 }
 
 void csp_barrier_dealloc(CSOUND *csound, void **barrier)
 {
+    csp_barrier_t *b;
     if (UNLIKELY(barrier == NULL || *barrier == NULL))
       csound->Die(csound, Str("Invalid NULL Parameter barrier"));
+    b = (csp_barrier_t *) *barrier;
+    csoundDestroyCondVar(b->cond);
+    csoundDestroyMutex(b->mutex);
+    csound->Free(csound, b);
+    *barrier = NULL;
+}
 
-    csound->DestroyBarrier(*barrier);
+int csp_barrier_wait(void *barrier)
+{
+    csp_barrier_t *b = (csp_barrier_t *) barrier;
+    unsigned int epoch = BARRIER_LOAD(b->epoch);
+    int i;
+
+    if (BARRIER_INC(&b->arrived) == b->max) {
+      /* last to arrive: reset and open the next epoch */
+      int n;
+      b->arrived = 0;
+      csoundLockMutex(b->mutex);
+      BARRIER_STORE(b->epoch, epoch+1);
+      for (n = b->parked; n > 0; n--) csoundCondSignal(b->cond);
+      csoundUnlockMutex(b->mutex);
+      return 1;
+    }
+    for (i = 0; i < b->spin; i++) {
+      if (BARRIER_LOAD(b->epoch) != epoch) return 0;
+      BARRIER_PAUSE();
+    }
+    csoundLockMutex(b->mutex);
+    b->parked++;
+    while (BARRIER_LOAD(b->epoch) == epoch)
+      csoundCondWait(b->cond, b->mutex);
+    b->parked--;
+    csoundUnlockMutex(b->mutex);
+    return 0;
 }
 
 
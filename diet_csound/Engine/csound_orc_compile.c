@@ -58,6 +58,7 @@ int named_instr_alloc(CSOUND *csound, char *s, INSTRTXT *ip, int32 insno,
                       ENGINE_STATE *engineState, int merge);
 int check_instr_name(char *s);
 void free_instr_var_memory(CSOUND *, INSDS *);
+void free_instance_slabs(CSOUND *, INSTRTXT *);
 void mergeState_enqueue(CSOUND *csound, ENGINE_STATE *e, TYPE_TABLE *t,
                         OPDS *ids);
 
@@ -970,11 +971,9 @@ void free_instrtxt(CSOUND *csound, INSTRTXT *instrtxt) {
     if (active->auxchp != NULL)
       auxchfree(csound, active);
     free_instr_var_memory(csound, active);
-    if (active->opcod_iobufs != NULL)
-      csound->Free(csound, active->opcod_iobufs);
-    csound->Free(csound, active);
     active = nxt;
   }
+  free_instance_slabs(csound, ip);
   OPTXT *t = ip->nxtop;
   while (t) {
     OPTXT *s = t->nxtop;
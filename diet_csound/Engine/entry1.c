@@ -140,12 +140,12 @@ OENTRY opcodlst_1[] = {
   { "=.r",    S(ASSIGN),0,  1,      "r",    "i",    rassign, NULL, NULL, NULL },
   { "=.i",    S(ASSIGNM),0, 1,      "IIIIIIIIIIIIIIIIIIIIIIII", "m",
     minit, NULL, NULL, NULL  },
-  { "=.k",    S(ASSIGNM),0, 2,      "zzzzzzzzzzzzzzzzzzzzzzzz", "z",
+  { "=.k",    S(ASSIGNM),VB, 2,      "zzzzzzzzzzzzzzzzzzzzzzzz", "z",
     NULL, minit, NULL, NULL },
-  { "=.a",    S(ASSIGN),0,  2,      "a",    "a",    NULL, gaassign, NULL },
-  { "=.l",    S(ASSIGN),0,  2,      "a",    "a",    NULL,   laassign, NULL },
-  { "=.up",   S(UPSAMP),0,  2,      "a",    "k",  NULL, (SUBR)upsamp, NULL },
-  { "=.down",   S(DOWNSAMP),0,  3,  "k",    "ao",   (SUBR)downset,(SUBR)downsamp },
+  { "=.a",    S(ASSIGN),VB, 2,      "a",    "a",    NULL, gaassign, NULL },
+  { "=.l",    S(ASSIGN),VB, 2,      "a",    "a",    NULL,   laassign, NULL },
+  { "=.up",   S(UPSAMP),VB, 2,      "a",    "k",  NULL, (SUBR)upsamp, NULL },
+  { "=.down",   S(DOWNSAMP),VB, 3,  "k",   "ao",   (SUBR)downset,(SUBR)downsamp },
   //  { "=.t",    S(ASSIGNT),0, 2,      "t",    "kk",   NULL,   tassign, NULL   },
   { "init.S", S(STRCPY_OP),0, 1,      "S", "S", (SUBR) strcpy_opcode_S  },
   { "init.Si", S(STRCPY_OP),0, 1,      "S", "i", (SUBR) strcpy_opcode_p  },
@@ -180,34 +180,34 @@ OENTRY opcodlst_1[] = {
   { "##mul.ii",  S(AOP),0,    1,      "i",    "ii",   mulkk                   },
   { "##div.ii",  S(AOP),0,    1,      "i",    "ii",   divkk                   },
   { "##mod.ii",  S(AOP),0,    1,      "i",    "ii",   modkk                   },
-  { "##add.kk",  S(AOP),0,    2,      "k",    "kk",   NULL,   addkk           },
-  { "##sub.kk",  S(AOP),0,    2,      "k",    "kk",   NULL,   subkk           },
-  { "##mul.kk",  S(AOP),0,    2,      "k",    "kk",   NULL,   mulkk           },
-  { "##div.kk",  S(AOP),0,    2,      "k",    "kk",   NULL,   divkk           },
-  { "##mod.kk",  S(AOP),0,    2,      "k",    "kk",   NULL,   modkk           },
-  { "##add.ka",  S(AOP),0,    2,      "a",    "ka",   NULL,   addka   },
-  { "##sub.ka",  S(AOP),0,    2,      "a",    "ka",   NULL,   subka   },
-  { "##mul.ka",  S(AOP),0,    2,      "a",    "ka",   NULL,   mulka   },
-  { "##div.ka",  S(AOP),0,    2,      "a",    "ka",   NULL,   divka   },
-  { "##mod.ka",  S(AOP),0,    2,      "a",    "ka",   NULL,   modka   },
-  { "##add.ak",  S(AOP),0,    2,      "a",    "ak",   NULL,   addak   },
-  { "##sub.ak",  S(AOP),0,    2,      "a",    "ak",   NULL,   subak   },
-  { "##mul.ak",  S(AOP),0,    2,      "a",    "ak",   NULL,   mulak   },
-  { "##div.ak",  S(AOP),0,    2,      "a",    "ak",   NULL,   divak   },
-  { "##mod.ak",  S(AOP),0,    2,      "a",    "ak",   NULL,   modak   },
-  { "##add.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   addaa   },
-  { "##sub.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   subaa   },
-  { "##mul.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   mulaa   },
-  { "##div.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   divaa   },
-  { "##mod.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   modaa   },
+  { "##add.kk",  S(AOP),VB,   2,      "k",    "kk",   NULL,   addkk           },
+  { "##sub.kk",  S(AOP),VB,   2,      "k",    "kk",   NULL,   subkk           },
+  { "##mul.kk",  S(AOP),VB,   2,      "k",    "kk",   NULL,   mulkk           },
+  { "##div.kk",  S(AOP),VB,   2,      "k",    "kk",   NULL,   divkk           },
+  { "##mod.kk",  S(AOP),VB,   2,      "k",    "kk",   NULL,   modkk           },
+  { "##add.ka",  S(AOP),VB,   2,      "a",    "ka",   NULL,   addka   },
+  { "##sub.ka",  S(AOP),VB,   2,      "a",    "ka",   NULL,   subka   },
+  { "##mul.ka",  S(AOP),VB,   2,      "a",    "ka",   NULL,   mulka   },
+  { "##div.ka",  S(AOP),VB,   2,      "a",    "ka",   NULL,   divka   },
+  { "##mod.ka",  S(AOP),VB,   2,      "a",    "ka",   NULL,   modka   },
+  { "##add.ak",  S(AOP),VB,   2,      "a",    "ak",   NULL,   addak   },
+  { "##sub.ak",  S(AOP),VB,   2,      "a",    "ak",   NULL,   subak   },
+  { "##mul.ak",  S(AOP),VB,   2,      "a",    "ak",   NULL,   mulak   },
+  { "##div.ak",  S(AOP),VB,   2,      "a",    "ak",   NULL,   divak   },
+  { "##mod.ak",  S(AOP),VB,   2,      "a",    "ak",   NULL,   modak   },
+  { "##add.aa",  S(AOP),VB,   2,      "a",    "aa",   NULL,   addaa   },
+  { "##sub.aa",  S(AOP),VB,   2,      "a",    "aa",   NULL,   subaa   },
+  { "##mul.aa",  S(AOP),VB,   2,      "a",    "aa",   NULL,   mulaa   },
+  { "##div.aa",  S(AOP),VB,   2,      "a",    "aa",   NULL,   divaa   },
+  { "##mod.aa",  S(AOP),VB,   2,      "a",    "aa",   NULL,   modaa   },
   { "##addin.i", S(ASSIGN),0, 1,      "i",    "i",    addin,  NULL    },
-  { "##addin.k", S(ASSIGN),0, 2,      "k",    "k",    NULL,   addin   },
-  { "##addin.K", S(ASSIGN),0, 2,      "a",    "k",    NULL,   addinak },
-  { "##addin.a", S(ASSIGN),0, 2,      "a",    "a",    NULL,   addina  },
+  { "##addin.k", S(ASSIGN),VB, 2,      "k",    "k",    NULL,   addin   },
+  { "##addin.K", S(ASSIGN),VB, 2,      "a",    "k",    NULL,   addinak },
+  { "##addin.a", S(ASSIGN),VB, 2,      "a",    "a",    NULL,   addina  },
   { "##subin.i", S(ASSIGN),0, 1,      "i",    "i",    subin,  NULL    },
-  { "##subin.k", S(ASSIGN),0, 2,      "k",    "k",    NULL,   subin   },
-  { "##subin.K", S(ASSIGN),0, 2,      "a",    "k",    NULL,   subinak },
-  { "##subin.a", S(ASSIGN),0, 2,      "a",    "a",    NULL,   subina  },
+  { "##subin.k", S(ASSIGN),VB, 2,      "k",    "k",    NULL,   subin   },
+  { "##subin.K", S(ASSIGN),VB, 2,      "a",    "k",    NULL,   subinak },
+  { "##subin.a", S(ASSIGN),VB, 2,      "a",    "a",    NULL,   subina  },
   //{ "divz",   0xfffc                                                      },
   { "divz.ii", S(DIVZ),0,   1,      "i",    "iii",  divzkk, NULL,   NULL    },
   { "divz.kk", S(DIVZ),0,   2,      "k",    "kkk",  NULL,   divzkk, NULL    },
@@ -357,26 +357,26 @@ OENTRY opcodlst_1[] = {
   { "cossegb.a", S(COSSEG),0, 3,      "a",    "iim",  csgset_bkpt, cosseg  },
   { "cossegr", S(COSSEG),0,  3,     "k",    "iim",  csgrset, kcssegr, NULL  },
   { "cossegr.a", S(COSSEG),0,  3,     "a",    "iim",  csgrset, cossegr  },
-  { "linseg", S(LINSEG),0,  3,      "k",    "iim",  lsgset, klnseg, NULL },
-  { "linseg.a", S(LINSEG),0,  3,      "a",    "iim",  lsgset, linseg  },
+  { "linseg", S(LINSEG),VB, 3,      "k",    "iim",  lsgset, klnseg, NULL },
+  { "linseg.a", S(LINSEG),VB, 3,      "a",    "iim",  lsgset, linseg  },
   { "linsegb", S(LINSEG),0,  3,     "k",    "iim", lsgset_bkpt, klnseg, NULL  },
   { "linsegb.a", S(LINSEG),0,  3,     "a",    "iim", lsgset_bkpt, linseg  },
-  { "linsegr",S(LINSEG),0,  3,      "k",    "iim",  lsgrset,klnsegr,NULL },
-  { "linsegr.a",S(LINSEG),0,  3,      "a",    "iim",  lsgrset,linsegr },
-  { "expseg", S(EXXPSEG),0,  3,     "k",    "iim",  xsgset, kxpseg, NULL  },
-  { "expseg.a", S(EXXPSEG),0,  3,     "a",    "iim",  xsgset, expseg  },
+  { "linsegr",S(LINSEG),VB, 3,      "k",    "iim",  lsgrset,klnsegr,NULL },
+  { "linsegr.a",S(LINSEG),VB, 3,      "a",    "iim",  lsgrset,linsegr },
+  { "expseg", S(EXXPSEG),VB, 3,     "k",    "iim",  xsgset, kxpseg, NULL  },
+  { "expseg.a", S(EXXPSEG),VB, 3,     "a",    "iim",  xsgset, expseg  },
   { "expsegb", S(EXXPSEG),0,  3,     "k",    "iim",  xsgset_bkpt, kxpseg, NULL },
   { "expsegb.a", S(EXXPSEG),0, 3,     "a",    "iim",  xsgset_bkpt, expseg },
-  { "expsega",S(EXPSEG2),0,  3,     "a",    "iim",  xsgset2, expseg2  },
+  { "expsega",S(EXPSEG2),VB, 3,     "a",    "iim",  xsgset2, expseg2  },
   { "expsegba",S(EXPSEG2),0,  3,     "a",    "iim",  xsgset2b, expseg2 },
-  { "expsegr",S(EXPSEG),0,  3,      "k",    "iim",  xsgrset,kxpsegr,NULL },
-  { "expsegr.a",S(EXPSEG),0,  3,      "a",    "iim",  xsgrset,expsegr },
-  { "linen",  S(LINEN),0,   3,      "k",    "kiii", lnnset, klinen, NULL   },
-  { "linen.a",  S(LINEN),0,   3,      "a",    "aiii", alnnset, linen   },
-  { "linen.x",  S(LINEN),0,   3,      "a",    "kiii", alnnset, linen   },
-  { "linenr", S(LINENR),0,  3,      "k",    "kiii", lnrset, klinenr,NULL },
-  { "linenr.a", S(LINENR),0,  3,      "a",    "aiii", alnrset,linenr  },
-  { "linenr.x", S(LINENR),0,  3,      "a",    "kiii", alnrset,linenr  },
+  { "expsegr",S(EXPSEG),VB, 3,      "k",    "iim",  xsgrset,kxpsegr,NULL },
+  { "expsegr.a",S(EXPSEG),VB, 3,      "a",    "iim",  xsgrset,expsegr },
+  { "linen",  S(LINEN),VB,  3,      "k",    "kiii", lnnset, klinen, NULL   },
+  { "linen.a",  S(LINEN),VB,  3,      "a",    "aiii", alnnset, linen   },
+  { "linen.x",  S(LINEN),VB,  3,      "a",    "kiii", alnnset, linen   },
+  { "linenr", S(LINENR),VB, 3,      "k",    "kiii", lnrset, klinenr,NULL },
+  { "linenr.a", S(LINENR),VB, 3,      "a",    "aiii", alnrset,linenr  },
+  { "linenr.x", S(LINENR),VB, 3,      "a",    "kiii", alnrset,linenr  },
   { "envlpx", S(ENVLPX), TR, 3,     "k","kiiiiiio", evxset, knvlpx, NULL },
   { "envlpxr", S(ENVLPR),TR, 3,     "k","kiiiiioo", evrset, knvlpxr, NULL },
   { "envlpx.a", S(ENVLPX), TR, 3,     "a","aiiiiiio", aevxset,envlpx  },
@@ -422,12 +422,12 @@ OENTRY opcodlst_1[] = {
   { "oscil1", S(OSCIL1), TR, 3,     "k",    "ikij", ko1set, kosc1          },
   { "oscil1i",S(OSCIL1), TR, 3,     "k",    "ikij", ko1set, kosc1i         },
   { "osciln", S(OSCILN), TR, 3,     "a",    "kiii", oscnset,   osciln },
-  { "oscil.a",S(OSC),TR,    3,       "a",    "kkjo", oscset,   osckk  },
-  { "oscil.kkk",S(OSC),TR,   3,      "k",    "kkjo", oscset, koscil  },
-  { "oscil.kka",S(OSC),TR,   3,      "a",    "kkjo", oscset, osckk  },
-  { "oscil.ka",S(OSC),TR,    3,      "a",    "kajo", oscset,   oscka  },
-  { "oscil.ak",S(OSC),TR,    3,      "a",    "akjo", oscset,   oscak  },
-  { "oscil.aa",S(OSC),TR,    3,      "a",    "aajo", oscset,   oscaa  },
+  { "oscil.a",S(OSC),TR|VB, 3,       "a",    "kkjo", oscset,   osckk  },
+  { "oscil.kkk",S(OSC),TR|VB, 3,      "k",    "kkjo", oscset, koscil  },
+  { "oscil.kka",S(OSC),TR|VB, 3,      "a",    "kkjo", oscset, osckk  },
+  { "oscil.ka",S(OSC),TR|VB, 3,      "a",    "kajo", oscset,   oscka  },
+  { "oscil.ak",S(OSC),TR|VB, 3,      "a",    "akjo", oscset,   oscak  },
+  { "oscil.aa",S(OSC),TR|VB, 3,      "a",    "aajo", oscset,   oscaa  },
   { "oscil.kkA",S(OSC),0,   3,      "k",    "kki[]o", oscsetA, koscil       },
   { "oscil.kkA",S(OSC),0,   3,      "a",    "kki[]o", oscsetA, osckk },
   { "oscil.kaA",S(OSC),0,   3,      "a",    "kai[]o", oscsetA, oscka },
@@ -441,21 +441,21 @@ OENTRY opcodlst_1[] = {
      { "oscil.aa", S(POSC),TR, 3, "a", "aajo", posc_set,  poscaa },
      { "oscil3.kk",  S(POSC),TR,  7, "s", "kkjo", posc_set, kposc3, posc3 },
   */
-  { "oscili.a",S(OSC),TR,   3,      "a",    "kkjo", oscset, osckki  },
-  { "oscili.kk",S(OSC),TR,   3,      "k",   "kkjo", oscset, koscli, NULL  },
-  { "oscili.ka",S(OSC),TR,   3,      "a",   "kajo", oscset,   osckai  },
-  { "oscili.ak",S(OSC),TR,   3,      "a",   "akjo", oscset,   oscaki  },
-  { "oscili.aa",S(OSC),TR,   3,      "a",   "aajo", oscset,   oscaai  },
+  { "oscili.a",S(OSC),TR|VB, 3,      "a",    "kkjo", oscset, osckki  },
+  { "oscili.kk",S(OSC),TR|VB, 3,      "k",   "kkjo", oscset, koscli, NULL  },
+  { "oscili.ka",S(OSC),TR|VB, 3,      "a",   "kajo", oscset,   osckai  },
+  { "oscili.ak",S(OSC),TR|VB, 3,      "a",   "akjo", oscset,   oscaki  },
+  { "oscili.aa",S(OSC),TR|VB, 3,      "a",   "aajo", oscset,   oscaai  },
   { "oscili.aA",S(OSC),0,   3,      "a",   "kki[]o", oscsetA, osckki  },
   { "oscili.kkA",S(OSC),0,   3,      "k",  "kki[]o", oscsetA, koscli, NULL  },
   { "oscili.kaA",S(OSC),0,   3,      "a",  "kai[]o", oscsetA,   osckai  },
   { "oscili.akA",S(OSC),0,   3,      "a",  "aki[]o", oscsetA,   oscaki  },
   { "oscili.aaA",S(OSC),0,   3,      "a",  "aai[]o", oscsetA,   oscaai  },
-  { "oscil3.a",S(OSC),TR,   3,      "a",    "kkjo", oscset, osckk3  },
-  { "oscil3.kk",S(OSC),TR,   3,      "k",   "kkjo", oscset, koscl3, NULL  },
-  { "oscil3.ka",S(OSC),TR,   3,      "a",   "kajo", oscset,   oscka3  },
-  { "oscil3.ak",S(OSC),TR,   3,      "a",   "akjo", oscset,   oscak3  },
-  { "oscil3.aa",S(OSC),TR,   3,      "a",   "aajo", oscset,   oscaa3  },
+  { "oscil3.a",S(OSC),TR|VB, 3,      "a",    "kkjo", oscset, osckk3  },
+  { "oscil3.kk",S(OSC),TR|VB, 3,      "k",   "kkjo", oscset, koscl3, NULL  },
+  { "oscil3.ka",S(OSC),TR|VB, 3,      "a",   "kajo", oscset,   oscka3  },
+  { "oscil3.ak",S(OSC),TR|VB, 3,      "a",   "akjo", oscset,   oscak3  },
+  { "oscil3.aa",S(OSC),TR|VB, 3,      "a",   "aajo", oscset,   oscaa3  },
   { "oscil3.aA",S(OSC),0,   3,      "a",   "kki[]o", oscsetA, osckk3 },
   { "oscil3.kkA",S(OSC),0,   3,      "k",  "kki[]o", oscsetA, koscl3, NULL },
   { "oscil3.kaA",S(OSC),0,   3,      "a",  "kai[]o", oscsetA, oscka3 },
@@ -482,11 +482,13 @@ OENTRY opcodlst_1[] = {
   { "randc",  S(RANDC),0,   3,      "a",    "xxvoo", rcset, randc     },
   { "randc.k",  S(RANDC),0, 3,      "k",    "xxvoo", rcset, krandc    },
   { "port",   S(PORT),0,    3,      "k",    "kio",  porset, port            },
-  { "tone.k", S(TONE),0,    3,      "a",    "ako",  tonset,   tone    },
+  { "tone.k", S(TONE),VB,   3,      "a",    "ako",  tonset,   tone,
+    NULL, NULL, tone_batch },
   { "tonex.k",S(TONEX),0,   3,      "a",    "akoo", tonsetx,  tonex   },
-  { "atone.k",  S(TONE),0,  3,      "a",    "ako",  tonset,   atone   },
-  { "atonex.k", S(TONEX),0, 3,      "a",    "akoo", tonsetx,  atonex  },
-  { "reson", S(RESON),   0, 3,      "a",    "axxoo", rsnset,  reson   },
+  { "atone.k",  S(TONE),VB, 3,      "a",    "ako",  tonset,   atone,
+    NULL, NULL, atone_batch },
+  { "atonex.k", S(TONEX),0, 3,      "a",    "akoo", atonsetx, atonex  },
+  { "reson", S(RESON),   VB, 3,      "a",    "axxoo", rsnset,  reson   },
   { "resonx", S(RESONX),0,  3,      "a",    "axxooo", rsnsetx, resonx },
   { "areson.kk", S(RESON),0,3,      "a",    "akkoo",rsnset,   areson  },
   { "lpread", S(LPREAD),0,  3,      "kkkk", "kSoo", lprdset_S,lpread          },
@@ -572,8 +574,8 @@ OENTRY opcodlst_1[] = {
   { "pow.k",    S(POW),0,   2,      "k",    "kkp",  NULL,    ipow,  NULL    },
   { "pow.a",    S(POW),0,   2,      "a",    "akp",  NULL,  apow    },
   { "##pow.i",  S(POW),0,   1,      "i",    "iip",  ipow,    NULL,  NULL    },
-  { "##pow.k",  S(POW),0,   2,      "k",    "kkp",  NULL,    ipow,  NULL    },
-  { "##pow.a",  S(POW),0,   2,      "a",    "akp",  NULL,  apow    },
+  { "##pow.k",  S(POW),VB,  2,      "k",    "kkp",  NULL,    ipow,  NULL    },
+  { "##pow.a",  S(POW),VB,  2,      "a",    "akp",  NULL,  apow    },
   { "oscilx",   S(OSCILN), TR, 3,   "a",    "kiii", oscnset,   osciln  },
   { "linrand.i",S(PRAND),0, 1,      "i",    "k",    iklinear, NULL, NULL    },
   { "linrand.k",S(PRAND),0, 2,      "k",    "k",    NULL, iklinear, NULL    },
@@ -619,7 +621,7 @@ OENTRY opcodlst_1[] = {
     (SUBR) diskin_init_array_S,
     (SUBR) diskin2_perf_array                         },
   { "diskin2",S(DISKIN2_ARRAY),0, 3, "a[]",
-    "SPooooooo",
+    "SPoooooooo",
     (SUBR) diskin2_init_array_S,
     (SUBR) diskin2_perf_array                         },
   { "diskin.i",S(DISKIN2_ARRAY),0, 3,    "a[]",
@@ -627,7 +629,7 @@ OENTRY opcodlst_1[] = {
     (SUBR) diskin_init_array_I,
     (SUBR) diskin2_perf_array                         },
   { "diskin2.i",S(DISKIN2_ARRAY),0, 3, "a[]",
-    "iPooooooo",
+    "iPoooooooo",
     (SUBR) diskin2_init_array_I,
     (SUBR) diskin2_perf_array                         },
   { "diskin",S(DISKIN2),0, 3,    "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
@@ -635,7 +637,7 @@ OENTRY opcodlst_1[] = {
     (SUBR) diskin_init_S,
     (SUBR) diskin2_perf                         },
   { "diskin2",S(DISKIN2),0, 3, "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
-    "SPooooooo",
+    "SPoooooooo",
     (SUBR) diskin2_init_S,
     (SUBR) diskin2_perf                         },
   { "diskin.i",S(DISKIN2),0, 3,    "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
@@ -643,7 +645,7 @@ OENTRY opcodlst_1[] = {
     (SUBR) diskin_init,
     (SUBR) diskin2_perf                         },
   { "diskin2.i",S(DISKIN2),0, 3, "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
-    "iPooooooo",
+    "iPoooooooo",
     (SUBR) diskin2_init,
     (SUBR) diskin2_perf                         },
   { "noteon", S(OUT_ON),0,  1,      "",     "iii",  iout_on, NULL,   NULL    },
@@ -812,12 +814,12 @@ OENTRY opcodlst_1[] = {
   { "cpstmid", S(CPSTABLE),0, 1, "i", "i",    (SUBR)cpstmid                    },
   { "adsr", S(LINSEG),0,     3,     "k",    "iiiio",adsrset,klnseg, NULL },
   { "adsr.a", S(LINSEG),0,     3,     "a",    "iiiio",adsrset, linseg     },
-  { "madsr", S(LINSEG),0,    3,     "k",    "iiiioj", madsrset,klnsegr,NULL },
-  { "madsr.a", S(LINSEG),0,    3,     "a",    "iiiioj", madsrset, linsegr },
+  { "madsr", S(LINSEG),VB,   3,     "k",    "iiiioj", madsrset,klnsegr,NULL },
+  { "madsr.a", S(LINSEG),VB,   3,     "a",    "iiiioj", madsrset, linsegr },
   { "xadsr", S(EXXPSEG),0,   3,     "k",    "iiiio", xdsrset, kxpseg, NULL   },
   { "xadsr.a", S(EXXPSEG),0,   3,     "a",    "iiiio", xdsrset, expseg    },
-  { "mxadsr", S(EXPSEG),0,   3,     "k",    "iiiioj", mxdsrset, kxpsegr, NULL},
-  { "mxadsr.a", S(EXPSEG),0,   3,     "a",    "iiiioj", mxdsrset, expsegr},
+  { "mxadsr", S(EXPSEG),VB,  3,     "k",    "iiiioj", mxdsrset, kxpsegr, NULL},
+  { "mxadsr.a", S(EXPSEG),VB,  3,     "a",    "iiiioj", mxdsrset, expsegr},
   { "schedule", S(SCHED),0,  1,     "",     "iiim",
     schedule, NULL, NULL },
   { "schedule.N", S(SCHED),0,  1,     "",     "iiiN",
@@ -79,9 +79,53 @@ typedef struct CSFILE_ {
     int             pos;
     MYFLT           *buf;
     int             bufsize;
+    void            *lock;          /* held by the IO thread during IO  */
+    int             prefetch;       /* IO thread wakes at this fill     */
+    unsigned int    pass;           /* last IO thread pass serviced     */
     char            fullName[1];
 } CSFILE;
 
+/* The chain of open files is changed by whichever thread opens or
+   closes a file, which includes the ftable workers running GEN01, so it
+   is always guarded by open_files_lock.  Once the async IO thread runs
+   it also walks the chain, so files are then linked and unlinked
+   holding file_io_threadlock as well. */
+
+static void link_file(CSOUND *csound, CSFILE *p)
+{
+    int     io = csound->file_io_start;
+
+    if (io)
+      csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+    csoundSpinLock(&csound->open_files_lock);
+    p->nxt = (CSFILE*) csound->open_files;
+    p->prv = (CSFILE*) NULL;
+    if (csound->open_files != NULL)
+      ((CSFILE*) csound->open_files)->prv = p;
+    csound->open_files = (void*) p;
+    csoundSpinUnLock(&csound->open_files_lock);
+    if (io)
+      csound->NotifyThreadLock(csound->file_io_threadlock);
+}
+
+static void unlink_file(CSOUND *csound, CSFILE *p)
+{
+    int     io = csound->file_io_start;
+
+    if (io)
+      csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+    csoundSpinLock(&csound->open_files_lock);
+    if (p->prv == NULL)
+      csound->open_files = (void*) p->nxt;
+    else
+      p->prv->nxt = p->nxt;
+    if (p->nxt != NULL)
+      p->nxt->prv = p->prv;
+    csoundSpinUnLock(&csound->open_files_lock);
+    if (io)
+      csound->NotifyThreadLock(csound->file_io_threadlock);
+}
+
 #if defined(MSVC)
 #define RD_OPTS  _O_RDONLY | _O_BINARY
 #define WR_OPTS  _O_TRUNC | _O_CREAT | _O_WRONLY | _O_BINARY,_S_IWRITE
@@ -1094,6 +1138,10 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
     p->fd = tmp_fd;
     p->f = tmp_f;
     p->sf = (SNDFILE*) NULL;
+    p->cb = NULL;
+    p->async_flag = 0;
+    p->buf = NULL;
+    p->lock = NULL;
     strcpy(&(p->fullName[0]), fullName);
     if (env != NULL) {
       csound->Free(csound, fullName);
@@ -1172,9 +1220,7 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
       *((int*) fd) = tmp_fd;
     }
     /* link into chain of open files */
-    if (csound->open_files != NULL)
-      ((CSFILE*) csound->open_files)->prv = p;
-    csound->open_files = (void*) p;
+    link_file(csound, p);
     /* notify the host if it asked */
     if (csound->FileOpenCallback_ != NULL) {
       int writing = (type == CSFILE_SND_W || type == CSFILE_FD_W ||
@@ -1264,9 +1310,7 @@ void *csoundCreateFileHandle(CSOUND *csound,
       return NULL;
     }
     /* link into chain of open files */
-    if (csound->open_files != NULL)
-      ((CSFILE*) csound->open_files)->prv = p;
-    csound->open_files = (void*) p;
+    link_file(csound, p);
     /* return with opaque file handle */
     p->cb = NULL;
     return (void*) p;
@@ -1289,61 +1333,44 @@ int csoundFileClose(CSOUND *csound, void *fd)
 {
     CSFILE  *p = (CSFILE*) fd;
     int     retval = -1;
+
+    /* unlink from chain of open files */
+    unlink_file(csound, p);
     if (p->async_flag == ASYNC_GLOBAL) {
-      csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
-      /* close file */
-      switch (p->type) {
-      case CSFILE_FD_R:
-      case CSFILE_FD_W:
-        retval = close(p->fd);
-        break;
-      case CSFILE_STD:
-        retval = fclose(p->f);
-        break;
-      case CSFILE_SND_R:
-      case CSFILE_SND_W:
-        if (p->sf)
-          retval = sf_close(p->sf);
-        p->sf = NULL;
-        if (p->fd >= 0)
-          retval |= close(p->fd);
-        break;
+      /* wait for the IO thread to finish with this file */
+      csound->LockMutex(p->lock);
+      if (p->type == CSFILE_SND_W && p->sf != NULL) {
+        int n;
+        /* write out anything still queued */
+        while ((n = csound->ReadCircularBuffer(csound, p->cb,
+                                               p->buf, p->bufsize)) > 0)
+          sf_write_MYFLT(p->sf, p->buf, n);
       }
-      /* unlink from chain of open files */
-      if (p->prv == NULL)
-        csound->open_files = (void*) p->nxt;
-      else
-        p->prv->nxt = p->nxt;
-      if (p->nxt != NULL)
-        p->nxt->prv = p->prv;
+    }
+    /* close file */
+    switch (p->type) {
+    case CSFILE_FD_R:
+    case CSFILE_FD_W:
+      retval = close(p->fd);
+      break;
+    case CSFILE_STD:
+      retval = fclose(p->f);
+      break;
+    case CSFILE_SND_R:
+    case CSFILE_SND_W:
+      if (p->sf)
+        retval = sf_close(p->sf);
+      p->sf = NULL;
+      if (p->fd >= 0)
+        retval |= close(p->fd);
+      break;
+    }
+    if (p->async_flag == ASYNC_GLOBAL) {
+      csound->UnlockMutex(p->lock);
+      csound->DestroyMutex(p->lock);
       if (p->buf != NULL) csound->Free(csound, p->buf);
       p->bufsize = 0;
       csound->DestroyCircularBuffer(csound, p->cb);
-      csound->NotifyThreadLock(csound->file_io_threadlock);
-    } else {
-      /* close file */
-      switch (p->type) {
-      case CSFILE_FD_R:
-      case CSFILE_FD_W:
-        retval = close(p->fd);
-        break;
-      case CSFILE_STD:
-        retval = fclose(p->f);
-        break;
-      case CSFILE_SND_R:
-      case CSFILE_SND_W:
-        retval = sf_close(p->sf);
-        if (p->fd >= 0)
-          retval |= close(p->fd);
-        break;
-      }
-      /* unlink from chain of open files */
-      if (p->prv == NULL)
-        csound->open_files = (void*) p->nxt;
-      else
-        p->prv->nxt = p->nxt;
-      if (p->nxt != NULL)
-        p->nxt->prv = p->prv;
     }
     /* free allocated memory */
     csound->Free(csound, fd);
@@ -1359,11 +1386,17 @@ void close_all_files(CSOUND *csound)
     while (csound->open_files != NULL)
       csoundFileClose(csound, csound->open_files);
     if (csound->file_io_start) {
+      csound->file_io_start = 0;
 #ifndef __EMSCRIPTEN__
+      csound->NotifyThreadLock(csound->file_io_wake);
       csound->JoinThread(csound->file_io_thread);
 #endif
       if (csound->file_io_threadlock != NULL)
         csound->DestroyThreadLock(csound->file_io_threadlock);
+      if (csound->file_io_wake != NULL)
+        csound->DestroyThreadLock(csound->file_io_wake);
+      csound->file_io_threadlock = NULL;
+      csound->file_io_wake = NULL;
     }
 }
 
@@ -1401,6 +1434,14 @@ void *fopen_path(CSOUND *csound, FILE **fp, char *name, char *basename,
 
 uintptr_t file_iothread(void *p);
 
+/* Async files are served by one IO thread that sleeps on file_io_wake.
+   Readers wake it when a ring drops below the file's prefetch level,
+   writers when that much is queued, so the thread only runs when there
+   is work.  Each file has its own lock, taken by the IO thread for the
+   actual sf_read/sf_write and by seek and close, so a slow file only
+   blocks its own users; file_io_threadlock now just guards the chain
+   of open files. */
+
 void *csoundFileOpenWithType_Async(CSOUND *csound, void *fd, int type,
                                    const char *name, void *param, const char *env,
                                    int csFileType, int buffsize, int isTemporary)
@@ -1411,40 +1452,55 @@ void *csoundFileOpenWithType_Async(CSOUND *csound, void *fd, int type,
                                                csFileType,isTemporary)) == NULL)
       return NULL;
 
-    if (csound->file_io_start == 0) {
-      csound->file_io_start = 1;
-      csound->file_io_threadlock = csound->CreateThreadLock();
-      csound->NotifyThreadLock(csound->file_io_threadlock);
-      csound->file_io_thread =
-        csound->CreateThread(file_iothread, (void *) csound);
-    }
-    csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
-    p->async_flag = ASYNC_GLOBAL;
-
     p->cb = csound->CreateCircularBuffer(csound, buffsize*4, sizeof(MYFLT));
     p->items = 0;
     p->pos = 0;
     p->bufsize = buffsize;
     p->buf = (MYFLT *) csound->Calloc(csound, sizeof(MYFLT)*buffsize);
-    csound->NotifyThreadLock(csound->file_io_threadlock);
-
-    if (p->cb == NULL || p->buf == NULL) {
+    p->lock = csound->Create_Mutex(0);
+    p->prefetch = buffsize*2;           /* half the ring */
+    p->pass = 0;
+    if (p->cb == NULL || p->buf == NULL || p->lock == NULL) {
       /* close file immediately */
+      csound->DestroyCircularBuffer(csound, p->cb);
+      if (p->buf != NULL) csound->Free(csound, p->buf);
+      if (p->lock != NULL) csound->DestroyMutex(p->lock);
+      p->cb = NULL;
+      p->buf = NULL;
       csoundFileClose(csound, (void *) p);
       return NULL;
     }
+    if (csound->file_io_start == 0) {
+      csound->file_io_threadlock = csound->CreateThreadLock();
+      csound->file_io_wake = csound->CreateThreadLock();
+      csound->file_io_start = 1;
+      csound->file_io_thread =
+        csound->CreateThread(file_iothread, (void *) csound);
+    }
+    csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+    p->async_flag = ASYNC_GLOBAL;
+    csound->NotifyThreadLock(csound->file_io_threadlock);
+    /* start filling the ring */
+    csound->NotifyThreadLock(csound->file_io_wake);
     return (void *) p;
 #else
     return NULL;
 #endif
 }
 
+int checkspace(void *cb, int writeCheck);
+
 unsigned int csoundReadAsync(CSOUND *csound, void *handle,
                              MYFLT *buf, int items)
 {
     CSFILE *p = handle;
-    if (p != NULL &&  p->cb != NULL)
-      return csound->ReadCircularBuffer(csound, p->cb, buf, items);
+    unsigned int n;
+    if (p != NULL &&  p->cb != NULL) {
+      n = csound->ReadCircularBuffer(csound, p->cb, buf, items);
+      if (checkspace(p->cb, 0) < p->prefetch)
+        csound->NotifyThreadLock(csound->file_io_wake);
+      return n;
+    }
     else return 0;
 }
 
@@ -1452,15 +1508,20 @@ unsigned int csoundWriteAsync(CSOUND *csound, void *handle,
                               MYFLT *buf, int items)
 {
     CSFILE *p = handle;
-    if (p != NULL &&  p->cb != NULL)
-      return csound->WriteCircularBuffer(csound, p->cb, buf, items);
+    unsigned int n;
+    if (p != NULL &&  p->cb != NULL) {
+      n = csound->WriteCircularBuffer(csound, p->cb, buf, items);
+      if (n < (unsigned int) items || checkspace(p->cb, 1) < p->prefetch)
+        csound->NotifyThreadLock(csound->file_io_wake);
+      return n;
+    }
     else return 0;
 }
 
 int csoundFSeekAsync(CSOUND *csound, void *handle, int pos, int whence){
     CSFILE *p = handle;
     int ret = 0;
-    csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+    csound->LockMutex(p->lock);
     switch (p->type) {
     case CSFILE_FD_R:
       break;
@@ -1476,64 +1537,95 @@ int csoundFSeekAsync(CSOUND *csound, void *handle, int pos, int whence){
       p->items = 0;
       break;
     }
-    csound->NotifyThreadLock(csound->file_io_threadlock);
+    csound->UnlockMutex(p->lock);
+    csound->NotifyThreadLock(csound->file_io_wake);
     return ret;
 }
 
+/**
+ * Set how far ahead the IO thread keeps an async file: it is woken when
+ * fewer than 'items' samples are left to read, or when there is less
+ * than that much room left to write.  The default is half the ring.
+ */
 
-static int read_files(CSOUND *csound){
-    CSFILE *current = (CSFILE *) csound->open_files;
-    if (current == NULL) return 0;
-    while (current) {
-      if (current->async_flag == ASYNC_GLOBAL) {
-        int m = current->pos, l, n = current->items;
-        int items = current->bufsize;
-        MYFLT *buf = current->buf;
-        switch (current->type) {
-        case CSFILE_FD_R:
-          break;
-        case CSFILE_FD_W:
-          break;
-        case CSFILE_STD:
-          break;
-        case CSFILE_SND_R:
-          if (n == 0) {
-            n = sf_read_MYFLT(current->sf, buf, items);
-            m = 0;
-          }
-          l = csound->WriteCircularBuffer(csound,current->cb,&buf[m],n);
-          m += l;
-          n -= l;
-          current->items = n;
-          current->pos = m;
-          break;
-        case CSFILE_SND_W:
-          items = csound->ReadCircularBuffer(csound, current->cb, buf, items);
-          if (items == 0) { csoundSleep(10); break;}
-          sf_write_MYFLT(current->sf, buf, items);
-          break;
+void csoundPrefetchAsync(CSOUND *csound, void *handle, int items)
+{
+    CSFILE *p = handle;
+    IGN(csound);
+    if (p != NULL && p->cb != NULL)
+      p->prefetch = (items < 1 ? 1 : (items > p->bufsize*4 - 1 ?
+                                      p->bufsize*4 - 1 : items));
+}
+
+/* move data between one async file and its ring, with p->lock held */
+
+static void transfer_file(CSOUND *csound, CSFILE *p)
+{
+    int   l, n;
+
+    switch (p->type) {
+    case CSFILE_SND_R:
+      for (;;) {                        /* fill the ring */
+        if (p->items == 0) {
+          n = (int) sf_read_MYFLT(p->sf, p->buf, p->bufsize);
+          if (n <= 0)
+            break;
+          p->items = n;
+          p->pos = 0;
         }
+        l = csound->WriteCircularBuffer(csound, p->cb,
+                                        &(p->buf[p->pos]), p->items);
+        p->pos += l;
+        p->items -= l;
+        if (p->items > 0)
+          break;                        /* ring is full */
       }
-      current = current->nxt;
+      break;
+    case CSFILE_SND_W:                  /* drain the ring */
+      while ((n = csound->ReadCircularBuffer(csound, p->cb,
+                                             p->buf, p->bufsize)) > 0)
+        sf_write_MYFLT(p->sf, p->buf, n);
+      break;
+    default:
+      break;
     }
-    return 1;
 }
 
+/* serve every async file once; the chain lock is only held to find the
+   next file and is dropped before any IO is done */
 
+static void serve_files(CSOUND *csound, unsigned int pass)
+{
+    CSFILE  *p;
 
+    for (;;) {
+      csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+      csoundSpinLock(&csound->open_files_lock);
+      for (p = (CSFILE*) csound->open_files; p != NULL; p = p->nxt)
+        if (p->async_flag == ASYNC_GLOBAL && p->pass != pass)
+          break;
+      csoundSpinUnLock(&csound->open_files_lock);
+      if (p == NULL) {
+        csound->NotifyThreadLock(csound->file_io_threadlock);
+        return;
+      }
+      p->pass = pass;
+      csound->LockMutex(p->lock);
+      csound->NotifyThreadLock(csound->file_io_threadlock);
+      transfer_file(csound, p);
+      csound->UnlockMutex(p->lock);
+    }
+}
 
 uintptr_t file_iothread(void *p){
-    int res = 1;
     CSOUND *csound = p;
-    int wakeup = (int) (1000*csound->ksmps/csound->esr);
+    unsigned int pass = 0;
     _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    if (wakeup == 0) wakeup = 1;
-    while (res){
-      csoundSleep(wakeup);
-      csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
-      res = read_files(csound);
-      csound->NotifyThreadLock(csound->file_io_threadlock);
+    for (;;) {
+      csound->WaitThreadLockNoTimeout(csound->file_io_wake);
+      if (!csound->file_io_start)
+        break;
+      serve_files(csound, ++pass);
     }
-    csound->file_io_start = 0;
     return (uintptr_t)NULL;
 }
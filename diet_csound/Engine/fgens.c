@@ -33,6 +33,11 @@
 #include "pstream.h"
 #include "pvfileio.h"
 #include <stdlib.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 /* #undef ISSTRCOD */
 
 static inline int32_t byte_order(void)
@@ -110,6 +115,9 @@ typedef struct namedgen {
 
 CS_NOINLINE int  fterror(const FGDATA *, const char *, ...);
 static CS_NOINLINE void ftresdisp(const FGDATA *, FUNC *);
+static void ftrescale(const FGDATA *, FUNC *);
+static void ftdisplay(const FGDATA *, FUNC *);
+static void ftsaveargs(const FGDATA *, FUNC *);
 static CS_NOINLINE FUNC *ftalloc(const FGDATA *);
 
 static int GENUL(FGDATA *ff, FUNC *ftp)
@@ -122,6 +130,723 @@ static inline unsigned int isPowerOfTwo (unsigned int x) {
   return (x > 0) && !(x & (x - 1)) ? 1 : 0;
 }
 
+/* On-disk ftable cache (--ftable-cache=DIR).  A table made by a GEN
+ * that depends only on its arguments (and on the files it reads) is
+ * written to DIR, named after a hash of the GEN call; the next run
+ * maps the data instead of calling the GEN again.  The mapping is
+ * private, so opcodes writing to the table never touch the file.
+ * Files start with an FTCACHE_HDR and keep the table data at an
+ * FTCACHE_ALIGN boundary so it can be mapped where it lies.
+ */
+
+#define FTCACHE_VERSION 1
+#define FTCACHE_ALIGN   4096
+#define FTCACHE_MINLEN  4096    /* shorter computed tables are not cached */
+
+typedef struct {
+    char    magic[8];
+    int32_t version;
+    int32_t order;              /* 0x01020304 in the writer's byte order */
+    int32_t fltsize;            /* sizeof(MYFLT) */
+    int32_t hdrsize;            /* sizeof(FTCACHE_HDR) */
+    uint64_t key;
+    FUNC    func;               /* table header, ftable is not used */
+} FTCACHE_HDR;
+
+typedef struct ftmap_ {
+    struct ftmap_ *nxt;
+    void    *addr;
+    size_t  len;
+} FTMAP;
+
+static const char ftcache_magic[8] = { 'C', 'S', 'F', 'T', 'A', 'B', 0, 0 };
+
+static uint64_t ftcache_hash(uint64_t h, const void *p, size_t n)
+{
+    const unsigned char *c = (const unsigned char*) p;
+
+    while (n--) {               /* FNV-1a */
+      h ^= (uint64_t) *c++;
+      h *= (uint64_t) 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/* hash the GEN call in ff into *key; returns 0 if the table should not */
+/* be cached                                                            */
+
+static int ftcache_key(CSOUND *csound, const FGDATA *ff, int genum,
+                       uint64_t *key)
+{
+    uint64_t h = (uint64_t) 0xcbf29ce484222325ULL;
+    int32_t  n, file = 0;
+
+    if (csound->oparms->ftCacheDir == NULL)
+      return 0;
+    switch (genum) {
+    case 1:
+      if (csound->oparms->gen01defer)
+        return 0;
+      /* fall through */
+    case 23: case 28:
+      if (ff->e.strarg == NULL || !isstrcod(ff->e.p[5]))
+        return 0;
+      file = 1;
+      break;
+    case 2: case 3: case 5: case 6: case 7: case 8: case 9: case 10:
+    case 11: case 12: case 13: case 14: case 16: case 17: case 19: case 20:
+    case 25: case 27:
+      if (ff->flen < FTCACHE_MINLEN)
+        return 0;
+      break;
+    default:                    /* random, or reads other tables */
+      return 0;
+    }
+    n = FTCACHE_VERSION;
+    h = ftcache_hash(h, &n, sizeof(int32_t));
+    n = (int32_t) sizeof(FTCACHE_HDR);
+    h = ftcache_hash(h, &n, sizeof(int32_t));
+    h = ftcache_hash(h, &csound->esr, sizeof(MYFLT));
+    h = ftcache_hash(h, &csound->e0dbfs, sizeof(MYFLT));
+    n = genum;
+    h = ftcache_hash(h, &n, sizeof(int32_t));
+    n = ff->e.pcnt;
+    h = ftcache_hash(h, &n, sizeof(int32_t));
+    /* the arguments from the size on; p1 and p2 do not change the data */
+    if (n > PMAX) {
+      h = ftcache_hash(h, &(ff->e.p[3]), sizeof(MYFLT) * (PMAX - 2));
+      h = ftcache_hash(h, &(ff->e.c.extra[1]),
+                       sizeof(MYFLT) * (size_t) ff->e.c.extra[0]);
+    }
+    else if (n >= 3)
+      h = ftcache_hash(h, &(ff->e.p[3]), sizeof(MYFLT) * (n - 2));
+    if (ff->e.strarg != NULL)
+      h = ftcache_hash(h, ff->e.strarg, strlen(ff->e.strarg));
+    if (file) {
+      /* and the file the GEN reads, by path, size and time */
+      struct stat st;
+      char    *path;
+
+      path = csoundFindInputFile(csound, ff->e.strarg,
+                                 genum == 1 ? "SFDIR;SSDIR"
+                                            : "SFDIR;SSDIR;INCDIR");
+      if (path == NULL)
+        return 0;
+      if (stat(path, &st) != 0) {
+        csound->Free(csound, path);
+        return 0;
+      }
+      h = ftcache_hash(h, path, strlen(path));
+      h = ftcache_hash(h, &st.st_size, sizeof(st.st_size));
+      h = ftcache_hash(h, &st.st_mtime, sizeof(st.st_mtime));
+      csound->Free(csound, path);
+    }
+    *key = h;
+    return 1;
+}
+
+static char *ftcache_path(CSOUND *csound, uint64_t key, char *buf, int n)
+{
+    snprintf(buf, n, "%s%cft%016" PRIx64 ".cft",
+             csound->oparms->ftCacheDir, DIRSEP, key);
+    return buf;
+}
+
+/* free table data, which may be a cache file mapping */
+
+static void ftfreedata(CSOUND *csound, MYFLT *data)
+{
+    FTMAP   **pp, *m;
+
+    for (pp = (FTMAP**) &(csound->ftcache); (m = *pp) != NULL;
+         pp = &(m->nxt)) {
+      if (m->addr == (void*) data) {
+        *pp = m->nxt;
+#ifndef WIN32
+        munmap(m->addr, m->len);
+#endif
+        csound->Free(csound, m);
+        return;
+      }
+    }
+    csound->Free(csound, data);
+}
+
+/**
+ * Unmap the ftables loaded from the ftable cache.
+ */
+
+void ftcache_free(CSOUND *csound)
+{
+    FTMAP   *m;
+
+    while ((m = (FTMAP*) csound->ftcache) != NULL) {
+      csound->ftcache = (void*) m->nxt;
+#ifndef WIN32
+      munmap(m->addr, m->len);
+#endif
+      csound->Free(csound, m);
+    }
+}
+
+/* table for the GEN call with this key from the cache, or NULL */
+
+static FUNC *ftcache_load(CSOUND *csound, const FGDATA *ff, uint64_t key)
+{
+    FTCACHE_HDR hdr;
+    FUNC    *ftp;
+    FILE    *f;
+    char    path[1024];
+    void    *data = NULL;
+    size_t  len;
+#ifndef WIN32
+    FTMAP   *m;
+    struct stat st;
+#endif
+
+    if ((f = fopen(ftcache_path(csound, key, path, 1024), "rb")) == NULL)
+      return NULL;
+    if (fread(&hdr, sizeof(FTCACHE_HDR), 1, f) != 1 ||
+        memcmp(hdr.magic, ftcache_magic, 8) != 0 ||
+        hdr.version != FTCACHE_VERSION || hdr.order != 0x01020304 ||
+        hdr.fltsize != (int32_t) sizeof(MYFLT) ||
+        hdr.hdrsize != (int32_t) sizeof(FTCACHE_HDR) || hdr.key != key ||
+        hdr.func.flen <= 0 || hdr.func.flen > MAXLEN) {
+      fclose(f);
+      return NULL;
+    }
+    len = sizeof(MYFLT) * ((size_t) hdr.func.flen + 1);
+#ifndef WIN32
+    data = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                fileno(f), FTCACHE_ALIGN);
+    if (data == MAP_FAILED)
+      data = NULL;
+    else {
+      /* a short file would fault on access rather than fail here */
+      if (fstat(fileno(f), &st) != 0 ||
+          (size_t) st.st_size < FTCACHE_ALIGN + len) {
+        munmap(data, len);
+        fclose(f);
+        return NULL;
+      }
+      m = (FTMAP*) csound->Malloc(csound, sizeof(FTMAP));
+      m->addr = data;
+      m->len = len;
+      m->nxt = (FTMAP*) csound->ftcache;
+      csound->ftcache = (void*) m;
+    }
+#endif
+    if (data == NULL) {         /* no mapping: read it */
+      data = csound->Malloc(csound, len);
+      if (fseek(f, FTCACHE_ALIGN, SEEK_SET) != 0 ||
+          fread(data, 1, len, f) != len) {
+        csound->Free(csound, data);
+        fclose(f);
+        return NULL;
+      }
+    }
+    fclose(f);
+    ftp = (FUNC*) csound->Malloc(csound, sizeof(FUNC));
+    memcpy(ftp, &(hdr.func), sizeof(FUNC));
+    ftp->ftable = (MYFLT*) data;
+    ftp->fno = (int32) ff->fno;
+    return ftp;
+}
+
+/* write a table to the cache; it appears under its name only when complete */
+
+static void ftcache_store(CSOUND *csound, const FUNC *ftp, uint64_t key)
+{
+    FTCACHE_HDR hdr;
+    FILE    *f;
+    char    path[1024], tmp[1100];
+    size_t  len = sizeof(MYFLT) * ((size_t) ftp->flen + 1);
+    int     ok;
+
+    memset(&hdr, 0, sizeof(FTCACHE_HDR));
+    memcpy(hdr.magic, ftcache_magic, 8);
+    hdr.version = FTCACHE_VERSION;
+    hdr.order = 0x01020304;
+    hdr.fltsize = (int32_t) sizeof(MYFLT);
+    hdr.hdrsize = (int32_t) sizeof(FTCACHE_HDR);
+    hdr.key = key;
+    memcpy(&(hdr.func), ftp, sizeof(FUNC));
+    hdr.func.ftable = NULL;
+    ftcache_path(csound, key, path, 1024);
+    snprintf(tmp, 1100, "%s.%p.tmp", path, (void*) ftp);
+    if ((f = fopen(tmp, "wb")) == NULL) {
+      csound->Warning(csound, Str("ftable cache: cannot write %s"), tmp);
+      return;
+    }
+    ok = (fwrite(&hdr, sizeof(FTCACHE_HDR), 1, f) == 1 &&
+          fseek(f, FTCACHE_ALIGN, SEEK_SET) == 0 &&
+          fwrite(ftp->ftable, 1, len, f) == len);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp, path) != 0) {
+#ifdef WIN32
+      /* rename() does not replace an existing file here */
+      if (ok && remove(path) == 0 && rename(tmp, path) == 0)
+        return;
+#endif
+      remove(tmp);
+    }
+}
+
+/* A redrawn table is never written in place, whatever its size: the
+ * GEN fills a new FUNC, which replaces the old one in flist at a
+ * k-boundary (score and init time events run between k-cycles, and
+ * background jobs are published at the start of one).  Replaced and
+ * deleted tables are not freed at once: instruments that were
+ * initialised while they were current may still point into them, and
+ * keep using that version until their next init.
+ * Each one is retired with a new value of csound->ftepoch, and every
+ * instance records the epoch it was initialised in (INSDS.ftepoch).  A
+ * retired table is freed at a k-boundary once no active instance is
+ * older than its retirement; instances started later only ever saw the
+ * new version, and opcodes looking tables up at perf time do so again
+ * in the next cycle.
+ * Instances do not record which tables they use, so one long note keeps
+ * every table retired after it started.  Retired tables are therefore
+ * kept up to FTRETIRED_MAX bytes only; beyond that the oldest ones are
+ * freed with a warning, as replaced tables always used to be.
+ */
+
+#define FTRETIRED_MAX   ((size_t) 64 << 20)
+
+typedef struct ftretired_ {
+    struct ftretired_ *nxt;
+    FUNC    *ftp;
+    int64_t epoch;
+} FTRETIRED;
+
+static void ftretire(CSOUND *csound, FUNC *ftp)
+{
+    FTRETIRED *r = (FTRETIRED*) csound->Malloc(csound, sizeof(FTRETIRED));
+
+    r->ftp = ftp;
+    r->epoch = ++(csound->ftepoch);
+    r->nxt = (FTRETIRED*) csound->ftretired;
+    csound->ftretired = (void*) r;
+}
+
+/**
+ * Free the retired ftables no active instrument instance can still
+ * use, or all of them if 'all' is non-zero.
+ */
+
+void ftreclaim(CSOUND *csound, int all)
+{
+    FTRETIRED **pp, *r;
+    INSDS   *ip;
+    int64_t oldest = csound->ftepoch;
+    size_t  bytes = 0;
+    int     kept = 0;
+
+    if (!all) {
+      for (ip = csound->actanchor.nxtact; ip != NULL; ip = ip->nxtact)
+        if (ip->ftepoch < oldest)
+          oldest = ip->ftepoch;
+    }
+    /* the list is newest first */
+    for (pp = (FTRETIRED**) &(csound->ftretired); (r = *pp) != NULL; ) {
+      if (!all && r->epoch > oldest) {
+        bytes += sizeof(FUNC) + sizeof(MYFLT) * ((size_t) r->ftp->flen + 1);
+        if (!kept++ || bytes <= FTRETIRED_MAX) {
+          pp = &(r->nxt);
+          continue;
+        }
+        csound->Warning(csound, Str("ftable %d: freeing a replaced version "
+                                    "that active notes may still use"),
+                        (int) r->ftp->fno);
+      }
+      *pp = r->nxt;
+      ftfreedata(csound, r->ftp->ftable);
+      csound->Free(csound, r->ftp);
+      csound->Free(csound, r);
+    }
+}
+
+/* put ftp in flist as table ftp->fno, retiring the version it
+   replaces; called at a k-boundary */
+
+static FUNC *ftinstall(CSOUND *csound, FUNC *ftp)
+{
+    FUNC    *old;
+    int     fno = (int) ftp->fno;
+
+    if ((old = csound->flist[fno]) != NULL) {
+      csound->Warning(csound, Str("replacing previous ftable %d"), fno);
+      ftretire(csound, old);
+    }
+    csound->flist[fno] = ftp;
+    return ftp;
+}
+
+/* Background generation of ftables (--ftgen-threads=N).  GENs that only
+ * compute their table (and do not allocate it themselves) run on worker
+ * threads into a FUNC that is not in flist yet; the finished table is
+ * installed by ftjobs_publish() at the start of a k-cycle, so a
+ * performance pass never sees a half written table.
+ * Until then a table being replaced keeps its old contents.  Init time
+ * lookups of a table that does not exist yet wait for its job, running
+ * it on the calling thread if no worker has taken it; perf time lookups
+ * (csoundFTFindP) fail rather than block.  Anything that changes a table
+ * synchronously first waits for the jobs writing or reading it.  A job
+ * whose GEN fails deletes the table, as a failing inline GEN does.
+ */
+
+#define FTJOB_QUEUED    0
+#define FTJOB_RUNNING   1
+#define FTJOB_DONE      2
+#define FTJOB_MINLEN    4096    /* shorter tables are made inline */
+
+typedef struct ftjob_ {
+    struct ftjob_ *nxt;
+    FGDATA  ff;
+    FUNC    *ftp;               /* the new table, not in flist yet */
+    GEN     gen;
+    int     src;                /* table read by the GEN, or 0 */
+    int     err;
+    int     cache;              /* store the result under key */
+    uint64_t key;
+    volatile long state;
+} FTJOB;
+
+typedef struct {
+    FTJOB   *head, *tail;       /* jobs not yet published, in order */
+    FTJOB   *next;              /* first job a worker may take */
+    void    *lock;              /* protects next and the job states */
+    void    *wake;
+    void    *done;              /* signalled with lock held as jobs end */
+    void    **threads;
+    int     nthreads;
+    int     quit;
+} FTJOBS;
+
+static void ftjob_run(FTJOB *job)
+{
+    if (job->gen(&job->ff, job->ftp) != 0)
+      job->err = 1;
+    else {
+      ftrescale(&job->ff, job->ftp);
+      ftsaveargs(&job->ff, job->ftp);
+      if (job->cache)
+        ftcache_store(job->ff.csound, job->ftp, job->key);
+    }
+}
+
+static uintptr_t ftjob_thread(void *arg)
+{
+    CSOUND  *csound = (CSOUND*) arg;
+    FTJOBS  *q = (FTJOBS*) csound->ftjobs;
+    FTJOB   *job;
+    int     more;
+
+    while (1) {
+      csound->LockMutex(q->lock);
+      if (q->quit) {
+        csound->UnlockMutex(q->lock);
+        csound->NotifyThreadLock(q->wake);      /* pass it on */
+        break;
+      }
+      while (q->next != NULL && ATOMIC_GET(q->next->state) != FTJOB_QUEUED)
+        q->next = q->next->nxt;                 /* taken by a waiter */
+      if ((job = q->next) != NULL) {
+        ATOMIC_SET(job->state, FTJOB_RUNNING)
+        q->next = job->nxt;
+      }
+      more = (q->next != NULL);
+      csound->UnlockMutex(q->lock);
+      if (job == NULL) {
+        csound->WaitThreadLockNoTimeout(q->wake);
+        continue;
+      }
+      if (more)
+        csound->NotifyThreadLock(q->wake);      /* wake the next worker */
+      ftjob_run(job);
+      csound->LockMutex(q->lock);
+      ATOMIC_SET(job->state, FTJOB_DONE);
+      csoundCondSignal(q->done);
+      csound->UnlockMutex(q->lock);
+    }
+    return 0;
+}
+
+static void ftjob_free(CSOUND *csound, FTJOB *job)
+{
+    if (job->ff.e.strarg != NULL)
+      csound->Free(csound, job->ff.e.strarg);
+    if (job->ff.e.pcnt > PMAX)
+      csound->Free(csound, job->ff.e.c.extra);
+    csound->Free(csound, job);
+}
+
+/* 1 if a GEN job for table fno is waiting to be published */
+
+static int ftjob_pending(CSOUND *csound, int fno)
+{
+    FTJOBS  *q = (FTJOBS*) csound->ftjobs;
+    FTJOB   *job;
+
+    if (q == NULL)
+      return 0;
+    for (job = q->head; job != NULL; job = job->nxt)
+      if (job->ff.fno == fno)
+        return 1;
+    return 0;
+}
+
+/* a job must not be published while an earlier job for the same table */
+/* is pending, or while another GEN is still reading the table          */
+
+static int ftjob_blocked(FTJOBS *q, FTJOB *job)
+{
+    FTJOB   *j;
+    int     earlier = 1;
+
+    for (j = q->head; j != NULL; j = j->nxt) {
+      if (j == job) {
+        earlier = 0;
+        continue;
+      }
+      if (earlier && j->ff.fno == job->ff.fno)
+        return 1;
+      if (j->src == job->ff.fno && ATOMIC_GET(j->state) != FTJOB_DONE)
+        return 1;
+    }
+    return 0;
+}
+
+/* install a finished job in flist, called on the performance thread */
+
+static void ftjob_install(CSOUND *csound, FTJOB *job)
+{
+    FUNC    *ftp = job->ftp;
+
+    if (job->err) {
+      /* as when the GEN fails inline, the table no longer exists, so an
+         init pass waiting for it fails instead of using the old one */
+      csound->ErrorMsg(csound, Str("ftable %d: background generation failed"),
+                       job->ff.fno);
+      csound->Free(csound, ftp->ftable);
+      csound->Free(csound, ftp);
+      if ((ftp = csound->flist[job->ff.fno]) != NULL) {
+        csound->flist[job->ff.fno] = NULL;
+        ftretire(csound, ftp);
+      }
+      return;
+    }
+    ftp = ftinstall(csound, ftp);
+    ftdisplay(&job->ff, ftp);
+}
+
+/**
+ * Install the ftables generated in the background since the last call.
+ * Called at the start of each k-cycle.
+ */
+
+void ftjobs_publish(CSOUND *csound)
+{
+    FTJOBS  *q = (FTJOBS*) csound->ftjobs;
+    FTJOB   *job, *prv = NULL, *nxt;
+
+    if (q == NULL)
+      return;
+    for (job = q->head; job != NULL; job = nxt) {
+      nxt = job->nxt;
+      if (ATOMIC_GET(job->state) != FTJOB_DONE || ftjob_blocked(q, job)) {
+        prv = job;
+        continue;
+      }
+      csound->LockMutex(q->lock);
+      if (prv == NULL)
+        q->head = nxt;
+      else
+        prv->nxt = nxt;
+      if (q->tail == job)
+        q->tail = prv;
+      if (q->next == job)
+        q->next = nxt;
+      csound->UnlockMutex(q->lock);
+      ftjob_install(csound, job);
+      ftjob_free(csound, job);
+    }
+}
+
+/* finish and publish the jobs writing or reading table fno; fno == 0 */
+/* selects every job that reads another table                         */
+
+static void ftjob_wait(CSOUND *csound, int fno)
+{
+    FTJOBS  *q = (FTJOBS*) csound->ftjobs;
+    FTJOB   *job;
+    int     run;
+
+    if (q == NULL)
+      return;
+    for (job = q->head; job != NULL; job = job->nxt) {
+      if (fno ? (job->ff.fno != fno && job->src != fno) : !job->src)
+        continue;
+      csound->LockMutex(q->lock);
+      if ((run = (ATOMIC_GET(job->state) == FTJOB_QUEUED))) {
+        ATOMIC_SET(job->state, FTJOB_RUNNING)
+      }
+      csound->UnlockMutex(q->lock);
+      if (run) {
+        ftjob_run(job);
+        ATOMIC_SET(job->state, FTJOB_DONE);
+      }
+      else {
+        csound->LockMutex(q->lock);
+        while (ATOMIC_GET(job->state) != FTJOB_DONE)
+          csoundCondWait(q->done, q->lock);
+        csound->UnlockMutex(q->lock);
+      }
+    }
+    ftjobs_publish(csound);
+}
+
+/* table fno, after publishing a pending job for it */
+
+static FUNC *ftjob_table(CSOUND *csound, int fno)
+{
+    if (csound->ftjobs != NULL)
+      ftjob_wait(csound, fno);
+    return csound->flist[fno];
+}
+
+/**
+ * Stop the ftable worker threads and discard unpublished tables.
+ */
+
+void ftjobs_free(CSOUND *csound)
+{
+    FTJOBS  *q = (FTJOBS*) csound->ftjobs;
+    FTJOB   *job, *nxt;
+    int     i;
+
+    if (q == NULL)
+      return;
+    csound->LockMutex(q->lock);
+    q->quit = 1;
+    csound->UnlockMutex(q->lock);
+    csound->NotifyThreadLock(q->wake);
+    for (i = 0; i < q->nthreads; i++)
+      csound->JoinThread(q->threads[i]);
+    for (job = q->head; job != NULL; job = nxt) {
+      nxt = job->nxt;
+      csound->Free(csound, job->ftp->ftable);
+      csound->Free(csound, job->ftp);
+      ftjob_free(csound, job);
+    }
+    csound->DestroyThreadLock(q->wake);
+    csoundDestroyCondVar(q->done);
+    csound->DestroyMutex(q->lock);
+    csound->Free(csound, q->threads);
+    csound->Free(csound, q);
+    csound->ftjobs = NULL;
+}
+
+static void ftjobs_start(CSOUND *csound)
+{
+    FTJOBS  *q;
+    int     i, n = csound->oparms->ftgenThreads;
+
+    q = (FTJOBS*) csound->Calloc(csound, sizeof(FTJOBS));
+    q->lock = csound->Create_Mutex(0);
+    q->wake = csound->CreateThreadLock();
+    q->done = csoundCreateCondVar();
+    q->threads = (void**) csound->Calloc(csound, n * sizeof(void*));
+    csound->ftjobs = (void*) q;
+    for (i = 0; i < n; i++)
+      if ((q->threads[i] = csound->CreateThread(ftjob_thread, csound)) == NULL)
+        break;
+    q->nthreads = i;
+    if (UNLIKELY(i == 0)) {
+      csound->Warning(csound, Str("could not start ftable threads, "
+                                  "generating ftables inline"));
+      ftjobs_free(csound);
+      csound->oparms->ftgenThreads = 0;
+    }
+}
+
+/* decide whether GEN genum can make table ff in the background; sets */
+/* *src to the table the GEN reads, if any                            */
+
+static int ftjob_async(CSOUND *csound, const FGDATA *ff, int genum, int *src)
+{
+    *src = 0;
+    if (csound->oparms->ftgenThreads <= 0)
+      return 0;
+    switch (genum) {
+    case 1:
+      if (csound->oparms->gen01defer)
+        return 0;
+      break;                    /* file IO, worth it at any size */
+    case 30: case 31: case 33: case 34:
+      *src = (int) ff->e.p[5];
+      if (*src <= 0 || *src > csound->maxfnum || *src == ff->fno)
+        return 0;
+      ftjob_wait(csound, *src);
+      if (csound->flist[*src] == NULL || csound->flist[*src]->flen == 0)
+        return 0;               /* missing or deferred: report inline */
+      if (ff->flen < FTJOB_MINLEN)
+        return 0;
+      break;
+    case 2: case 3: case 5: case 6: case 7: case 8: case 9: case 10:
+    case 11: case 12: case 13: case 14: case 16: case 17: case 19: case 20:
+    case 25: case 27:
+      if (ff->flen < FTJOB_MINLEN)
+        return 0;
+      break;
+    default:
+      return 0;
+    }
+    if (csound->ftjobs == NULL)
+      ftjobs_start(csound);
+    return (csound->ftjobs != NULL);
+}
+
+static FUNC *ftjob_alloc(const FGDATA *ff)
+{
+    CSOUND  *csound = ff->csound;
+    FUNC    *ftp = (FUNC*) csound->Calloc(csound, sizeof(FUNC));
+
+    ftp->ftable = (MYFLT*) csound->Calloc(csound, (1+ff->flen) * sizeof(MYFLT));
+    ftp->fno = (int32) ff->fno;
+    ftp->flen = ff->flen;
+    return ftp;
+}
+
+static void ftjob_submit(CSOUND *csound, const FGDATA *ff, FUNC *ftp,
+                         GEN gen, int src, int cache, uint64_t key)
+{
+    FTJOBS  *q = (FTJOBS*) csound->ftjobs;
+    FTJOB   *job = (FTJOB*) csound->Calloc(csound, sizeof(FTJOB));
+
+    memcpy(&(job->ff), ff, sizeof(FGDATA));
+    if (ff->e.strarg != NULL) {
+      /* the caller's string does not outlive the event */
+      job->ff.e.strarg = csound->Malloc(csound, strlen(ff->e.strarg) + 1);
+      strcpy(job->ff.e.strarg, ff->e.strarg);
+    }
+    job->ftp = ftp;
+    job->gen = gen;
+    job->src = src;
+    job->cache = cache;
+    job->key = key;
+    csound->LockMutex(q->lock);
+    if (q->tail == NULL)
+      q->head = job;
+    else
+      q->tail->nxt = job;
+    q->tail = job;
+    if (q->next == NULL)
+      q->next = job;
+    csound->UnlockMutex(q->lock);
+    csound->NotifyThreadLock(q->wake);
+}
+
 /**
  * Create ftable using evtblk data, and store pointer to new table in *ftpp.
  * If mode is zero, a zero table number is ignored, otherwise a new table
@@ -132,7 +857,8 @@ static inline unsigned int isPowerOfTwo (unsigned int x) {
 int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
 {
     int32    genum, ltest;
-    int     lobits, msg_enabled, i;
+    int     lobits, msg_enabled, i, async, src, cache;
+    uint64_t key = 0;
     FUNC    *ftp;
     FGDATA  ff;
     int nonpowof2_flag=0; /* gab: fixed for non-powoftwo function tables*/
@@ -155,17 +881,19 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
       ff.fno = FTAB_SEARCH_BASE;
       do {                                      /*      or automatic number */
         ++ff.fno;
-      } while (ff.fno <= csound->maxfnum && csound->flist[ff.fno] != NULL);
+      } while (ff.fno <= csound->maxfnum &&
+               (csound->flist[ff.fno] != NULL ||
+                ftjob_pending(csound, ff.fno)));
       ff.e.p[1] = (MYFLT) (ff.fno);
     }
     else if (ff.fno < 0) {                      /*  fno < 0: remove         */
       ff.fno = -(ff.fno);
       if (UNLIKELY(ff.fno > csound->maxfnum ||
-                   (ftp = csound->flist[ff.fno]) == NULL)) {
+                   (ftp = ftjob_table(csound, ff.fno)) == NULL)) {
         return fterror(&ff, Str("ftable does not exist"));
       }
       csound->flist[ff.fno] = NULL;
-      csound->Free(csound, (void*) ftp);
+      ftretire(csound, ftp);
       if (UNLIKELY(msg_enabled))
         csoundMessage(csound, Str("ftable %d now deleted\n"), ff.fno);
       return 0;
@@ -175,6 +903,7 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
       int   size;
       for (size = csound->maxfnum; size < ff.fno; size += MAXFNUM)
         ;
+      ftjob_wait(csound, 0);                    /*  GENs reading flist      */
       nn = (FUNC**) csound->ReAlloc(csound,
                                     csound->flist, (size + 1) * sizeof(FUNC*));
       csound->flist = nn;
@@ -223,6 +952,17 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
       }
     }
     ff.flen = (int32) MYFLT2LRND(ff.e.p[3]);
+    if ((cache = ftcache_key(csound, &ff, genum, &key)) &&
+        (ftp = ftcache_load(csound, &ff, key)) != NULL) {
+      ftjob_wait(csound, ff.fno);
+      ftp = ftinstall(csound, ftp);
+      if (UNLIKELY(msg_enabled))
+        csoundMessage(csound, Str("ftable %d: loaded from cache\n"), ff.fno);
+      ff.flen = ftp->flen;
+      ftdisplay(&ff, ftp);
+      *ftpp = ftp;
+      return 0;
+    }
     if (!ff.flen) {
       /* defer alloc to gen01|gen23|gen28 */
       ff.guardreq = 1;
@@ -232,13 +972,17 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
       }
       if (UNLIKELY(msg_enabled))
         csoundMessage(csound, Str("ftable %d:\n"), ff.fno);
+      ftjob_wait(csound, ff.fno);
       i = (*csound->gensub[genum])(&ff, NULL);
       ftp = csound->flist[ff.fno];
       if (i != 0) {
         csound->flist[ff.fno] = NULL;
-        csound->Free(csound, ftp);
+        if (ftp != NULL)
+          ftretire(csound, ftp);
         return -1;
       }
+      if (cache)
+        ftcache_store(csound, ftp, key);
       *ftpp = ftp;
       return 0;
     }
@@ -271,7 +1015,12 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
         ff.guardreq = 1;
       }
     }
-    ftp = ftalloc(&ff);                 /*  alloc ftable space now  */
+    if ((async = ftjob_async(csound, &ff, genum, &src)))
+      ftp = ftjob_alloc(&ff);           /*  private until published */
+    else {
+      ftjob_wait(csound, ff.fno);
+      ftp = ftalloc(&ff);               /*  alloc ftable space now  */
+    }
     ftp->lenmask  = ((ff.flen & (ff.flen - 1L)) ?
                      0L : (ff.flen - 1L));      /*  init hdr w powof2 data  */
     ftp->lobits   = lobits;
@@ -286,26 +1035,40 @@ int hfgens(CSOUND *csound, FUNC **ftpp, const EVTBLK *evtblkp, int mode)
 
     if (UNLIKELY(msg_enabled))
       csoundMessage(csound, Str("ftable %d:\n"), ff.fno);
+    if (async) {
+      /* only ftp->fno may be used by the caller until it is published */
+      ftjob_submit(csound, &ff, ftp, csound->gensub[genum], src, cache, key);
+      *ftpp = ftp;
+      return 0;
+    }
     if ((*csound->gensub[genum])(&ff, ftp) != 0) {
       csound->flist[ff.fno] = NULL;
-      csound->Free(csound, ftp);
+      ftretire(csound, ftp);                    /*  as if deleted           */
       return -1;
     }
     /* VL 11.01.05 for deferred GEN01, it's called in gen01raw */
     ftresdisp(&ff, ftp);                        /* rescale and display      */
     *ftpp = ftp;
-    /* keep original arguments, from GEN number  */
-    ftp->argcnt = ff.e.pcnt - 3;
+    ftsaveargs(&ff, ftp);
+    if (cache)
+      ftcache_store(csound, ftp, key);
+    return 0;
+}
+
+/* keep original arguments, from GEN number  */
+
+static void ftsaveargs(const FGDATA *ff, FUNC *ftp)
+{
+    ftp->argcnt = ff->e.pcnt - 3;
     {  /* Note this does not handle extended args -- JPff */
       int size=ftp->argcnt;
       if (UNLIKELY(size>PMAX-4)) size=PMAX-4;
       /* printf("size = %d -> %d ftp->args = %p\n", */
       /*        size, sizeof(MYFLT)*size, ftp->args); */
-      memcpy(ftp->args, &(ff.e.p[4]), sizeof(MYFLT)*size); /* is this right? */
+      memcpy(ftp->args, &(ff->e.p[4]), sizeof(MYFLT)*size); /* is this right? */
       /*for (k=0; k < size; k++)
         csound->Message(csound, "%f\n", ftp->args[k]);*/
     }
-    return 0;
 }
 
 /**
@@ -324,6 +1087,7 @@ int csoundFTAlloc(CSOUND *csound, int tableNum, int len)
     if (UNLIKELY(tableNum > csound->maxfnum)) { /* extend list if necessary     */
       for (size = csound->maxfnum; size < tableNum; size += MAXFNUM)
         ;
+      ftjob_wait(csound, 0);
       nn = (FUNC**) csound->ReAlloc(csound,
                                     csound->flist, (size + 1) * sizeof(FUNC*));
       csound->flist = nn;
@@ -332,23 +1096,15 @@ int csoundFTAlloc(CSOUND *csound, int tableNum, int len)
       csound->maxfnum = size;
     }
     /* allocate space for table */
-    size = (int) (len * (int) sizeof(MYFLT));
-    ftp = csound->flist[tableNum];
+    ftp = ftjob_table(csound, tableNum);
     if (ftp == NULL) {
       csound->flist[tableNum] = (FUNC*) csound->Malloc(csound, sizeof(FUNC));
       csound->flist[tableNum]->ftable =
         (MYFLT*)csound->Malloc(csound, sizeof(MYFLT)*(len+1));
     }
     else if (len != (int) ftp->flen) {
-      if (UNLIKELY(csound->actanchor.nxtact != NULL)) { /*   & chk for danger    */
-        /* return */  /* VL: changed this into a Warning */
-          csound->Warning(csound, Str("ftable %d relocating due to size change"
-                                        "\n         currently active instruments "
-                                        "may find this disturbing"), tableNum);
-      }
-      csound->flist[tableNum] = NULL;
-      csound->Free(csound, ftp);
-      csound->flist[tableNum] = (FUNC*) csound->Malloc(csound, (size_t) size);
+      ftretire(csound, ftp);            /* active instruments keep it */
+      csound->flist[tableNum] = (FUNC*) csound->Calloc(csound, sizeof(FUNC));
       csound->flist[tableNum]->ftable =
         (MYFLT*)csound->Malloc(csound, sizeof(MYFLT)*(len+1));
     }
@@ -382,11 +1138,11 @@ int csoundFTDelete(CSOUND *csound, int tableNum)
 
     if (UNLIKELY((unsigned int) (tableNum - 1) >= (unsigned int) csound->maxfnum))
       return -1;
-    ftp = csound->flist[tableNum];
+    ftp = ftjob_table(csound, tableNum);
     if (UNLIKELY(ftp == NULL))
       return -1;
     csound->flist[tableNum] = NULL;
-    csound->Free(csound, ftp);
+    ftretire(csound, ftp);
 
     return 0;
 }
@@ -2302,11 +3058,14 @@ CS_NOINLINE int fterror(const FGDATA *ff, const char *s, ...)
 
 static CS_NOINLINE void ftresdisp(const FGDATA *ff, FUNC *ftp)
 {
-    CSOUND  *csound = ff->csound;
+    ftrescale(ff, ftp);
+    ftdisplay(ff, ftp);
+}
+
+static void ftrescale(const FGDATA *ff, FUNC *ftp)
+{
     MYFLT   *fp, *finp = &ftp->ftable[ff->flen];
     MYFLT   abs, maxval;
-    WINDAT  dwindow;
-    char    strmsg[64];
 
     if (!ff->guardreq)                      /* if no guardpt yet, do it */
       ftp->ftable[ff->flen] = ftp->ftable[0];
@@ -2321,6 +3080,14 @@ static CS_NOINLINE void ftresdisp(const FGDATA *ff, FUNC *ftp)
         for (fp=ftp->ftable; fp<=finp; fp++)
           *fp /= maxval;
     }
+}
+
+static void ftdisplay(const FGDATA *ff, FUNC *ftp)
+{
+    CSOUND  *csound = ff->csound;
+    WINDAT  dwindow;
+    char    strmsg[64];
+
     if (!csound->oparms->displays)
       return;
     memset(&dwindow, 0, sizeof(WINDAT));
@@ -2367,31 +3134,12 @@ static CS_NOINLINE FUNC *ftalloc(const FGDATA *ff)
     CSOUND  *csound = ff->csound;
     FUNC    *ftp = csound->flist[ff->fno];
 
- 
-    if (UNLIKELY(ftp != NULL)) {
+    if (UNLIKELY(ftp != NULL)) {            /* if redraw, playing notes */
       csound->Warning(csound, Str("replacing previous ftable %d"), ff->fno);
-      if (ff->flen != (int32)ftp->flen) {       /* if redraw & diff len, */
-        csound->Free(csound, ftp->ftable);
-        csound->Free(csound, (void*) ftp);             /*   release old space   */
-        csound->flist[ff->fno] = ftp = NULL;
-        if (UNLIKELY(csound->actanchor.nxtact != NULL)) { /*   & chk for danger */
-          csound->Warning(csound, Str("ftable %d relocating due to size change"
-                                      "\n         currently active instruments "
-                                      "may find this disturbing"), ff->fno);
-        }
-      }
-      else {
-                                    /* else clear it to zero */
-        MYFLT *tmp = ftp->ftable;
-        memset((void*) ftp->ftable, 0, sizeof(MYFLT)*(ff->flen+1));
-        memset((void*) ftp, 0, sizeof(FUNC));
-        ftp->ftable = tmp; /* restore table pointer */
-      }
-    }
-    if (ftp == NULL) {                      /*   alloc space as reqd */
-      csound->flist[ff->fno] = ftp = (FUNC*) csound->Calloc(csound, sizeof(FUNC));
-      ftp->ftable = (MYFLT*) csound->Calloc(csound, (1+ff->flen) * sizeof(MYFLT));
+      ftretire(csound, ftp);                /*   keep the old version   */
     }
+    csound->flist[ff->fno] = ftp = (FUNC*) csound->Calloc(csound, sizeof(FUNC));
+    ftp->ftable = (MYFLT*) csound->Calloc(csound, (1+ff->flen) * sizeof(MYFLT));
     ftp->fno = (int32) ff->fno;
     ftp->flen = ff->flen;
     return ftp;
@@ -2412,7 +3160,8 @@ FUNC *csoundFTFind(CSOUND *csound, MYFLT *argp)
     }
     if (UNLIKELY(fno <= 0                    ||
                  fno > csound->maxfnum       ||
-                 (ftp = csound->flist[fno]) == NULL)) {
+                 ((ftp = csound->flist[fno]) == NULL &&
+                  (ftp = ftjob_table(csound, fno)) == NULL))) {
       csoundInitError(csound, Str("Invalid ftable no. %f"), *argp);
       return NULL;
     }
@@ -2444,7 +3193,8 @@ FUNC *csoundFTFind2(CSOUND *csound, MYFLT *argp)
     }
     if (UNLIKELY(fno <= 0                    ||
                  fno > csound->maxfnum       ||
-                 (ftp = csound->flist[fno]) == NULL)) {
+                 ((ftp = csound->flist[fno]) == NULL &&
+                  (ftp = ftjob_table(csound, fno)) == NULL))) {
       return NULL;
     }
     else if (UNLIKELY(ftp->lenmask == -1)) {
@@ -2463,8 +3213,8 @@ PUBLIC int csoundGetTable(CSOUND *csound, MYFLT **tablePtr, int tableNum)
 
     if (UNLIKELY((unsigned int) (tableNum - 1) >= (unsigned int) csound->maxfnum))
       goto err_return;
-    ftp = csound->flist[tableNum];
-    if (UNLIKELY(ftp == NULL))
+    if (UNLIKELY((ftp = csound->flist[tableNum]) == NULL &&
+                 (ftp = ftjob_table(csound, tableNum)) == NULL))
       goto err_return;
     if (!ftp->flen) {
       ftp = gen01_defer_load(csound, tableNum);
@@ -2529,7 +3279,11 @@ FUNC *csoundFTFindP(CSOUND *csound, MYFLT *argp)
     if (UNLIKELY(fno <= 0                 ||
                  fno > csound->maxfnum    ||
                  (ftp = csound->flist[fno]) == NULL)) {
-      csound->ErrorMsg(csound, Str("Invalid ftable no. %f"), *argp);
+      if (fno > 0 && ftjob_pending(csound, fno))
+        csound->ErrorMsg(csound, Str("ftable %d is still being generated"),
+                         fno);
+      else
+        csound->ErrorMsg(csound, Str("Invalid ftable no. %f"), *argp);
       return NULL;
     }
     else if (UNLIKELY(!ftp->lenmask)) {
@@ -2556,7 +3310,8 @@ FUNC *csoundFTnp2Findint(CSOUND *csound, MYFLT *argp, int verbose)
     }
     if (UNLIKELY(fno <= 0 ||
                  fno > csound->maxfnum    ||
-                 (ftp = csound->flist[fno]) == NULL)) {
+                 ((ftp = csound->flist[fno]) == NULL &&
+                  (ftp = ftjob_table(csound, fno)) == NULL))) {
       if (verbose) csound->ErrorMsg(csound, Str("Invalid ftable no. %f"), *argp);
       return NULL;
     }
@@ -2622,6 +3377,18 @@ static const int gen01_format_table[10] = {
     AE_FLOAT,   AE_UNCH,    AE_24INT,   AE_DOUBLE
 };
 
+/* close the file and cache entry opened by sndgetset() for GEN01 */
+
+static void gen01_close(CSOUND *csound, SOUNDIN *p)
+{
+    if (p->sc != NULL)
+      sndcache_discard(csound, p->sc);
+    p->sc = NULL;
+    if (p->fd != NULL)
+      csound->FileClose(csound, p->fd);
+    p->fd = NULL;
+}
+
 /* read ftable values from a sound file */
 /* stops reading when table is full     */
 
@@ -2688,6 +3455,7 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     if (p->channel == 0)                      /* snd is chan 1,2,..8 or all */
       p->channel = ALLCHNLS;
     p->analonly = 0;
+    p->usecache = 1;
     if (UNLIKELY(ff->flen == 0 && (csound->oparms->msglevel & 7))) {
       csoundMessage(csound, Str("deferred alloc for %s\n"), p->sfname);
     }
@@ -2698,6 +3466,7 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     if (ff->flen == 0) {                      /* deferred ftalloc requestd: */
       if (UNLIKELY((ff->flen = p->framesrem + 1) <= 0)) {
         /*   get minsize from soundin */
+        gen01_close(csound, p);
         return fterror(ff, Str("deferred size, but filesize unknown"));
       }
       if (UNLIKELY(csound->oparms->msglevel & 7))
@@ -2788,7 +3557,9 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     }
     /* read sound with opt gain */
 
-    if (UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
+    inlocs = getsndin(csound, fd, ftp->ftable, table_length, p);
+    gen01_close(csound, p);
+    if (UNLIKELY(inlocs < 0)) {
       return fterror(ff, Str("GEN1 read error"));
     }
 
@@ -2800,7 +3571,6 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
       needsiz(csound, ff, p->framesrem);     /* ????????????  */
     }
     ftp->soundend = inlocs / ftp->nchanls;   /* record end of sound samps */
-    csound->FileClose(csound, p->fd);
     if (def) {
       MYFLT *tab = ftp->ftable;
       ftresdisp(ff, ftp);       /* VL: 11.01.05  for deferred alloc tables */
@@ -3297,9 +4067,13 @@ int resize_table(CSOUND *csound, RESIZE *p)
     }
     if (UNLIKELY((ftp = csound->FTFind(csound, p->fn)) == NULL))
       return NOTOK;
-    if (ftp->flen<fsize)
-      ftp->ftable = (MYFLT *) csound->ReAlloc(csound, ftp->ftable,
-                                              sizeof(MYFLT)*(fsize+1));
+    if (ftp->flen<fsize) {
+      /* not ReAlloc: the data may be mapped from the ftable cache */
+      MYFLT *tab = (MYFLT *) csound->Malloc(csound, sizeof(MYFLT)*(fsize+1));
+      memcpy(tab, ftp->ftable, sizeof(MYFLT)*(ftp->flen+1));
+      ftfreedata(csound, ftp->ftable);
+      ftp->ftable = tab;
+    }
     ftp->flen = fsize+1;
     csound->flist[fno] = ftp;
     return OK;
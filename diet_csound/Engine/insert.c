@@ -41,6 +41,7 @@ static  void    schedofftim(CSOUND *, INSDS *);
 void    beatexpire(CSOUND *, double);
 void    timexpire(CSOUND *, double);
 static  void    instance(CSOUND *, int);
+static  void    slab_release(INSTRTXT *, INSDS *);
 extern int argsRequired(char* argString);
 static int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn,
                        MEVENT *mep);
@@ -391,6 +392,7 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
     ip->ksmps = csound->ksmps;
     ip->ekr = csound->ekr;
     ip->kcounter = csound->kcounter;
+    ip->ftepoch = csound->ftepoch;
     ip->onedksmps = csound->onedksmps;
     ip->onedkr = csound->onedkr;
     ip->kicvt = csound->kicvt;
@@ -688,6 +690,7 @@ int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
   ip->ksmps        = csound->ksmps;
   ip->ekr          = csound->ekr;
   ip->kcounter     = csound->kcounter;
+  ip->ftepoch      = csound->ftepoch;
   ip->onedksmps    = csound->onedksmps;
   ip->onedkr       = csound->onedkr;
   ip->kicvt        = csound->kicvt;
@@ -831,7 +834,7 @@ static void showallocs(CSOUND *csound)      /* debugging aid */
   INSDS   *p;
 
   csound->Message(csound, "insno\tinstanc\tnxtinst\tprvinst\tnxtact\t"
-                  "prvact\tnxtoff\tactflg\tofftim\n");
+                  "prvact\toffidx\tactflg\tofftim\n");
   for (txtp = &(csound->engineState.instxtanchor);
        txtp != NULL;
        txtp = txtp->nxtinstxt)
@@ -842,23 +845,94 @@ static void showallocs(CSOUND *csound)      /* debugging aid */
        * and now on all platforms (JPff)
        */
       do {
-        csound->Message(csound, "%d\t%p\t%p\t%p\t%p\t%p\t%p\t%d\t%3.1f\n",
+        csound->Message(csound, "%d\t%p\t%p\t%p\t%p\t%p\t%d\t%d\t%3.1f\n",
                         (int) p->insno, (void*) p,
                         (void*) p->nxtinstance, (void*) p->prvinstance,
                         (void*) p->nxtact, (void*) p->prvact,
-                        (void*) p->nxtoff, p->actflg, p->offtim);
+                        p->offidx, p->actflg, p->offtim);
       } while ((p = p->nxtinstance) != NULL);
     }
 }
 
+/* The turnoff list is a binary min-heap on offtim; notes with equal
+   offtim keep the order in which they were scheduled (offseq).
+   ip->offidx is the heap position plus one, 0 if not scheduled, and
+   csound->frstoff always points at the top of the heap.             */
+
+#define OFF_BEFORE(a,b) ((a)->offtim < (b)->offtim ||                   \
+                         ((a)->offtim == (b)->offtim &&                 \
+                          (int32_t) ((a)->offseq - (b)->offseq) < 0))
+
+static void offheap_up(INSDS **h, int i)
+{
+  INSDS *ip = h[i];
+  while (i > 0) {
+    int parent = (i - 1) >> 1;
+    if (!OFF_BEFORE(ip, h[parent])) break;
+    h[i] = h[parent];
+    h[i]->offidx = i + 1;
+    i = parent;
+  }
+  h[i] = ip;
+  ip->offidx = i + 1;
+}
+
+static void offheap_down(INSDS **h, int n, int i)
+{
+  INSDS *ip = h[i];
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= n) break;
+    if (child + 1 < n && OFF_BEFORE(h[child + 1], h[child])) child++;
+    if (!OFF_BEFORE(h[child], ip)) break;
+    h[i] = h[child];
+    h[i]->offidx = i + 1;
+    i = child;
+  }
+  h[i] = ip;
+  ip->offidx = i + 1;
+}
+
+static void offheap_remove(CSOUND *csound, INSDS *ip)
+{
+  INSDS **h = csound->offheap;
+  INSDS *last;
+  int   i = ip->offidx - 1;
+
+  if (i < 0) return;                          /* not scheduled */
+  ip->offidx = 0;
+  last = h[--csound->offcnt];
+  if (last != ip) {
+    h[i] = last;
+    if (i > 0 && OFF_BEFORE(last, h[(i - 1) >> 1]))
+      offheap_up(h, i);
+    else
+      offheap_down(h, csound->offcnt, i);
+  }
+  csound->frstoff = (csound->offcnt > 0 ? h[0] : NULL);
+}
+
+static void offheap_insert(CSOUND *csound, INSDS *ip)
+{
+  if (UNLIKELY(ip->offidx))                   /* never listed twice */
+    offheap_remove(csound, ip);
+  if (UNLIKELY(csound->offcnt >= csound->offmax)) {
+    int n = (csound->offmax > 0 ? csound->offmax * 2 : 64);
+    csound->offheap = (INSDS**) csound->ReAlloc(csound, csound->offheap,
+                                                n * sizeof(INSDS*));
+    csound->offmax = n;
+  }
+  ip->offseq = csound->offseq++;
+  csound->offheap[csound->offcnt] = ip;
+  offheap_up(csound->offheap, csound->offcnt++);
+  csound->frstoff = csound->offheap[0];
+}
+
 static void schedofftim(CSOUND *csound, INSDS *ip)
 {                               /* put an active instr into offtime list  */
-  INSDS *prvp, *nxtp;         /* called by insert() & midioff + xtratim */
-
-  if ((nxtp = csound->frstoff) == NULL ||
-      nxtp->offtim > ip->offtim) {            /*   set into       */
-    csound->frstoff = ip;                     /*   firstoff chain */
-    ip->nxtoff = nxtp;
+                                /* called by insert() & midioff + xtratim */
+  offheap_insert(csound, ip);
+  if (csound->frstoff == ip) {                /* new first turnoff */
     /* IV - Feb 24 2006: check if this note already needs to be turned off */
     /* the following comparisons must match those in sensevents() */
 #ifdef BETA
@@ -884,13 +958,6 @@ static void schedofftim(CSOUND *csound, INSDS *ip)
                                     (0.505 * csound->ksmps))/csound->esr));
 #endif
   }
-  else {
-    while ((prvp = nxtp)
-           && (nxtp = nxtp->nxtoff) != NULL
-           && ip->offtim >= nxtp->offtim);
-    prvp->nxtoff = ip;
-    ip->nxtoff = nxtp;
-  }
 }
 
 /* csound.c */
@@ -983,18 +1050,7 @@ void xturnoff(CSOUND *csound, INSDS *ip)  /* turnoff a particular insalloc  */
     }
   }
   /* remove from schedoff chain first if finite duration */
-  if (csound->frstoff != NULL && ip->offtim >= 0.0) {
-    INSDS *prvip;
-    prvip = csound->frstoff;
-    if (prvip == ip)
-      csound->frstoff = ip->nxtoff;
-    else {
-      while (prvip != NULL && prvip->nxtoff != ip)
-        prvip = prvip->nxtoff;
-      if (prvip != NULL)
-        prvip->nxtoff = ip->nxtoff;
-    }
-  }
+  offheap_remove(csound, ip);
   /* if extra time needed: schedoff at new time */
   if (ip->xtratim > 0) {
     set_xtratim(csound, ip);
@@ -1052,8 +1108,6 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
       do {
         if (!ip->actflg) {
           cnt++;
-          if (ip->opcod_iobufs && ip->insno > csound->engineState.maxinsno)
-            csound->Free(csound, ip->opcod_iobufs);   /* IV - Nov 10 2002 */
           if (ip->fdchp != NULL)
             fdchclose(csound, ip);
           if (ip->auxchp != NULL)
@@ -1062,7 +1116,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
           if ((nxtip = ip->nxtinstance) != NULL)
             nxtip->prvinstance = prvip;
           *prvnxtloc = nxtip;
-          csound->Free(csound, (char *)ip);
+          slab_release(txtp, ip);
         }
         else {
           prvip = ip;
@@ -1745,30 +1799,27 @@ int nstrstr(CSOUND *csound, NSTRSTR *p)
 void beatexpire(CSOUND *csound, double beat)
 {
   INSDS  *ip;
- strt:
-  if ((ip = csound->frstoff) != NULL && ip->offbet <= beat) {
-    do {
-      if (!ip->relesing && ip->xtratim) {
-        /* IV - Nov 30 2002: */
-        /*   allow extra time for finite length (p3 > 0) score notes */
-        set_xtratim(csound, ip);      /* enter release stage */
-        csound->frstoff = ip->nxtoff; /* update turnoff list */
+  int    cnt = 0;
+
+  while ((ip = csound->frstoff) != NULL && ip->offbet <= beat) {
+    offheap_remove(csound, ip);       /* update turnoff list */
+    if (!ip->relesing && ip->xtratim) {
+      /* IV - Nov 30 2002: */
+      /*   allow extra time for finite length (p3 > 0) score notes */
+      set_xtratim(csound, ip);        /* enter release stage */
 #ifdef BETA
-        if (UNLIKELY(csound->oparms->odebug))
-          csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
+      if (UNLIKELY(csound->oparms->odebug))
+        csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
 #endif
-        schedofftim(csound, ip);
-        goto strt;                    /* and start again */
-      }
-      else
-        deact(csound, ip);    /* IV - Sep 5 2002: use deact() as it also */
-    }                         /* deactivates subinstrument instances */
-    while ((ip = ip->nxtoff) != NULL && ip->offbet <= beat);
-    csound->frstoff = ip;
-    if (UNLIKELY(csound->oparms->odebug)) {
-      csound->Message(csound, "deactivated all notes to beat %7.3f\n", beat);
-      csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
+      schedofftim(csound, ip);
     }
+    else
+      deact(csound, ip);      /* IV - Sep 5 2002: use deact() as it also */
+    cnt++;                    /* deactivates subinstrument instances */
+  }
+  if (UNLIKELY(cnt && csound->oparms->odebug)) {
+    csound->Message(csound, "deactivated all notes to beat %7.3f\n", beat);
+    csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
   }
 }
 
@@ -1781,33 +1832,27 @@ void beatexpire(CSOUND *csound, double beat)
 void timexpire(CSOUND *csound, double time)
 {
   INSDS  *ip;
-
- strt:
-  if ((ip = csound->frstoff) != NULL && ip->offtim <= time) {
-    do {
-      if (!ip->relesing && ip->xtratim) {
-        /* IV - Nov 30 2002: */
-        /*   allow extra time for finite length (p3 > 0) score notes */
-        set_xtratim(csound, ip);      /* enter release stage */
-        csound->frstoff = ip->nxtoff; /* update turnoff list */
+  int    cnt = 0;
+
+  while ((ip = csound->frstoff) != NULL && ip->offtim <= time) {
+    offheap_remove(csound, ip);       /* update turnoff list */
+    if (!ip->relesing && ip->xtratim) {
+      /* IV - Nov 30 2002: */
+      /*   allow extra time for finite length (p3 > 0) score notes */
+      set_xtratim(csound, ip);        /* enter release stage */
 #ifdef BETA
-        if (UNLIKELY(csound->oparms->odebug))
-          csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
+      if (UNLIKELY(csound->oparms->odebug))
+        csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
 #endif
-        schedofftim(csound, ip);
-
-        goto strt;                    /* and start again */
-      }
-      else {
-        deact(csound, ip);    /* IV - Sep 5 2002: use deact() as it also */
-      }
-    }                         /* deactivates subinstrument instances */
-    while ((ip = ip->nxtoff) != NULL && ip->offtim <= time);
-    csound->frstoff = ip;
-    if (UNLIKELY(csound->oparms->odebug)) {
-      csound->Message(csound, "deactivated all notes to time %7.3f\n", time);
-      csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
+      schedofftim(csound, ip);
     }
+    else
+      deact(csound, ip);      /* IV - Sep 5 2002: use deact() as it also */
+    cnt++;                    /* deactivates subinstrument instances */
+  }
+  if (UNLIKELY(cnt && csound->oparms->odebug)) {
+    csound->Message(csound, "deactivated all notes to time %7.3f\n", time);
+    csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
   }
 }
 
@@ -2351,6 +2396,76 @@ int findLabelMemOffset(CSOUND* csound, INSTRTXT* ip, char* labelName) {
   return offset;
 }
 
+/* Instance memory is carved out of per-template slabs.  A block is
+   never given back to the allocator while its template lives: orcompact
+   and delete_instr put it on the template's slab_free chain, so once a
+   template has warmed up (or been sized by prealloc) a note-on does not
+   have to malloc.  All blocks of a template have the same size.        */
+
+typedef struct instr_slab {
+    struct instr_slab *nxt;
+} INSTR_SLAB;
+
+#define SLAB_HDRSIZ     CS_FLOAT_ALIGN(sizeof(INSTR_SLAB))
+#define SLAB_MINBLKS    4
+#define SLAB_MAXBLKS    64
+
+static void *slab_alloc(CSOUND *csound, INSTRTXT *tp, size_t size)
+{
+    void  *blk;
+
+    if (UNLIKELY(tp->slab_blksiz == 0))
+      tp->slab_blksiz = CS_FLOAT_ALIGN(size);
+    else if (UNLIKELY(size > tp->slab_blksiz))
+      csoundDie(csound, Str("inconsistent instance size"));
+    if (UNLIKELY(tp->slab_free == NULL)) {
+      INSTR_SLAB *sp;
+      char  *bp;
+      int   n = tp->slab_hint;
+      if (n <= 0) {             /* grow with the number of instances */
+        n = tp->instcnt;
+        if (n < SLAB_MINBLKS) n = SLAB_MINBLKS;
+        if (n > SLAB_MAXBLKS) n = SLAB_MAXBLKS;
+      }
+      sp = (INSTR_SLAB*) csound->Malloc(csound, SLAB_HDRSIZ +
+                                        (size_t) n * tp->slab_blksiz);
+      sp->nxt = (INSTR_SLAB*) tp->slabs;
+      tp->slabs = (void*) sp;
+      bp = (char*) sp + SLAB_HDRSIZ;
+      while (n--) {
+        *(void**) bp = tp->slab_free;
+        tp->slab_free = (void*) bp;
+        bp += tp->slab_blksiz;
+      }
+    }
+    blk = tp->slab_free;
+    tp->slab_free = *(void**) blk;
+    memset(blk, 0, tp->slab_blksiz);
+    return blk;
+}
+
+/* return the block of a torn down instance to its template */
+
+static void slab_release(INSTRTXT *tp, INSDS *ip)
+{
+    *(void**) ip = tp->slab_free;
+    tp->slab_free = (void*) ip;
+}
+
+/* called when the template itself goes away */
+
+void free_instance_slabs(CSOUND *csound, INSTRTXT *tp)
+{
+    INSTR_SLAB *sp = (INSTR_SLAB*) tp->slabs;
+    while (sp != NULL) {
+      INSTR_SLAB *nxt = sp->nxt;
+      csound->Free(csound, sp);
+      sp = nxt;
+    }
+    tp->slabs = tp->slab_free = NULL;
+    tp->slab_blksiz = 0;
+}
+
 /* create instance of an instr template */
 /*   allocates and sets up all pntrs    */
 
@@ -2366,6 +2481,7 @@ static void instance(CSOUND *csound, int insno)
   MYFLT     **argpp, *lclbas;
   CS_VAR_MEM *lcloffbas; // start of pfields
   char*     opMemStart;
+  size_t    opdsend, iobufsiz;
 
   OPARMS    *O = csound->oparms;
   int       odebug = O->odebug;
@@ -2385,13 +2501,17 @@ static void instance(CSOUND *csound, int insno)
   pextrab = ((i = tp->pmax - 3L) > 0 ? (int) i * sizeof(CS_VAR_MEM) : 0);
   /* alloc new space,  */
   pextent = sizeof(INSDS) + pextrab + pextra*sizeof(CS_VAR_MEM);
-  ip =
-    (INSDS*) csound->Calloc(csound,
-                            (size_t) pextent + tp->varPool->poolSize +
-                            (tp->varPool->varCount *
-                             CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
-                            (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
-                            tp->opdstot);
+  opdsend = (size_t) pextent + tp->varPool->poolSize +
+    (tp->varPool->varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
+    (tp->varPool->varCount * sizeof(CS_VARIABLE*)) + tp->opdstot;
+  opdsend = CS_FLOAT_ALIGN(opdsend);
+  iobufsiz = 0;
+  if (tp->opcode_info != NULL) {        /* UDO I/O buffers go at the end */
+    OPCODINFO* info = tp->opcode_info;
+    iobufsiz = sizeof(OPCOD_IOBUFS) +
+      sizeof(MYFLT*) * (info->inchns + info->outchns);
+  }
+  ip = (INSDS*) slab_alloc(csound, tp, opdsend + iobufsiz);
   ip->csound = csound;
   ip->m_chnbp = (MCHNBLK*) NULL;
   ip->instr = tp;
@@ -2410,14 +2530,8 @@ static void instance(CSOUND *csound, int insno)
                   tp->act_instance);
 
 
-  if (insno > csound->engineState.maxinsno) {
-    //      size_t pcnt = (size_t) tp->opcode_info->perf_incnt;
-    //      pcnt += (size_t) tp->opcode_info->perf_outcnt;
-    OPCODINFO* info = tp->opcode_info;
-    size_t pcnt = sizeof(OPCOD_IOBUFS) +
-      sizeof(MYFLT*) * (info->inchns + info->outchns);
-    ip->opcod_iobufs = (void*) csound->Malloc(csound, pcnt);
-  }
+  if (insno > csound->engineState.maxinsno)
+    ip->opcod_iobufs = (void*) ((char*) ip + opdsend);
 
   /* gbloffbas = csound->globalVarPool; */
   lcloffbas = (CS_VAR_MEM*)&ip->p0;
@@ -2585,6 +2699,7 @@ static void instance(CSOUND *csound, int insno)
 
 int prealloc_(CSOUND *csound, AOP *p, int instname)
 {
+    INSTRTXT *tp;
     int     n, a;
 
     if (instname)
@@ -2600,7 +2715,10 @@ int prealloc_(CSOUND *csound, AOP *p, int instname)
     if (UNLIKELY(n == NOT_AN_INSTRUMENT)) return NOTOK;
     if (csound->oparms->realtime)
       csoundSpinLock(&csound->alloc_spinlock);
-    a = (int) *p->a - csound->engineState.instrtxtp[n]->active;
+    tp = csound->engineState.instrtxtp[n];
+    if ((int) *p->a > tp->slab_hint)    /* size later slabs as well */
+      tp->slab_hint = (int) *p->a;
+    a = (int) *p->a - tp->active;
     for ( ; a > 0; a--)
       instance(csound, n);
     if (csound->oparms->realtime)
@@ -2645,18 +2763,15 @@ int delete_instr(CSOUND *csound, DELETEIN *p)
         return csound->InitError(csound,
                                  Str("Instrument %d is still active"), n);
     }
-#if 0
-    if (active->opcod_iobufs && active->insno > csound->engineState.maxinsno)
-      csound->Free(csound, active->opcod_iobufs);        /* IV - Nov 10 2002 */
-#endif
     if (active->fdchp != NULL)
       fdchclose(csound, active);
     if (active->auxchp != NULL)
       auxchfree(csound, active);
     free_instr_var_memory(csound, active);
-    csound->Free(csound, active);
     active = nxt;
   }
+  free_instance_slabs(csound, ip);
+  ip->instance = ip->lst_instance = ip->act_instance = NULL;
   csound->engineState.instrtxtp[n] = NULL;
   /* Now patch it out */
   for (txtp = &(csound->engineState.instxtanchor);
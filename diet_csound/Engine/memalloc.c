@@ -53,6 +53,82 @@ typedef struct memAllocBlock_s {
 
 #define MEMALLOC_DB (csound->memalloc_db)
 
+/* Optional arena backend, chosen when the instance is created
+   (csoundCreateWithAllocator).  Small requests come from power-of-two
+   size classes carved out of large chunks.  Every thread keeps its own
+   free lists, so an alloc/free pair normally touches neither libc nor
+   memlock; the lock is only taken when a thread cache runs dry or grows
+   too long.  Large requests still go through malloc and the memalloc_db
+   chain.  memRESET() drops the chunks wholesale.
+*/
+
+#define ARENA_MIN_SHIFT   4
+#define ARENA_CLASSES     12                /* 16 bytes .. 32 kbytes    */
+#define ARENA_MAX_SIZE    ((size_t) 1 << (ARENA_MIN_SHIFT+ARENA_CLASSES-1))
+#define ARENA_CHUNK_SIZE  ((size_t) 1 << 18)
+#define ARENA_BATCH_BYTES ((size_t) 1 << 14) /* refill/flush quantum    */
+#define ARENA_BATCH_MAX   32
+#define ARENA_ALIGN(n)    (((n) + 15) & ~((size_t) 15))
+#define CLASS_BYTES(c)    ((size_t) 1 << ((c) + ARENA_MIN_SHIFT))
+
+typedef struct arenaBlock_s {           /* same size as memAllocBlock_t */
+#ifdef MEMDEBUG
+    int                     magic;
+    void                    *ptr;
+#endif
+    size_t                  size;       /* class, or bytes if large     */
+    struct arenaBlock_s     *nxt;       /* free list link               */
+} arenaBlock_t;
+
+typedef char arena_hdr_check[sizeof(arenaBlock_t) ==
+                             sizeof(memAllocBlock_t) ? 1 : -1];
+
+#define ARENA_HDR(p)  ((arenaBlock_t*) ((unsigned char*) (p) - (int) HDR_SIZE))
+
+typedef struct arenaCache_s {
+    struct arenaCache_s     *nxt;
+    void                    *owner;     /* identifies the thread        */
+    arenaBlock_t            *free[ARENA_CLASSES];
+    int                     nfree[ARENA_CLASSES];
+    int64_t                 allocs, frees, bytes;
+} arenaCache_t;
+
+typedef struct memArena_s {
+    int                     mode;       /* CSOUND_ALLOC_SYSTEM/_ARENA   */
+    unsigned int            gen;        /* changes on every memRESET    */
+    arenaCache_t * volatile caches;     /* per thread caches            */
+    arenaBlock_t            *free[ARENA_CLASSES];   /* shared lists     */
+    char                    *chunks;    /* chain, link in first word    */
+    char                    *cur, *end; /* free space in newest chunk   */
+    int64_t                 reserved;   /* bytes held in chunks         */
+    int64_t                 allocs, frees;      /* retired caches and   */
+    int64_t                 bigbytes;           /*   malloc'ed blocks   */
+} memArena_t;
+
+#if defined(_MSC_VER)
+#define ARENA_TLS __declspec(thread)
+#define ARENA_LOAD_ACQ(x) (x)
+#define ARENA_STORE_REL(x,v) (x) = (v)
+#define ARENA_NEXT_GEN(x) InterlockedIncrement((volatile LONG *)(x))
+#elif defined(__GNUC__)
+#define ARENA_TLS __thread
+#define ARENA_LOAD_ACQ(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define ARENA_STORE_REL(x,v) __atomic_store_n(&(x), v, __ATOMIC_RELEASE)
+#define ARENA_NEXT_GEN(x) __atomic_add_fetch(x, 1, __ATOMIC_SEQ_CST)
+#endif
+
+#define MEMARENA    ((memArena_t*) csound->memarena)
+#ifdef ARENA_TLS
+#define ARENA_ON    (MEMARENA != NULL && MEMARENA->mode == CSOUND_ALLOC_ARENA)
+/* the thread's most recent cache; the address of arena_tls_cache also
+   serves as the thread's identity in arenaCache_t.owner */
+static ARENA_TLS arenaCache_t *arena_tls_cache = NULL;
+static ARENA_TLS unsigned int arena_tls_gen = 0;
+static unsigned int arena_generation = 0;
+#else
+#define ARENA_ON    0
+#endif
+
 static void memdie(CSOUND *csound, size_t nbytes)
 {
     csound->ErrorMsg(csound, Str("memory allocate failure for %zd"),
@@ -60,7 +136,7 @@ static void memdie(CSOUND *csound, size_t nbytes)
     csound->LongJmp(csound, CSOUND_MEMORY);
 }
 
-void *mmalloc(CSOUND *csound, size_t size)
+static void *sys_malloc(CSOUND *csound, size_t size)
 {
     void  *p;
 
@@ -86,6 +162,7 @@ void *mmalloc(CSOUND *csound, size_t size)
     if (MEMALLOC_DB != NULL)
       ((memAllocBlock_t*) MEMALLOC_DB)->prv = (memAllocBlock_t*) p;
     MEMALLOC_DB = (void*) p;
+    if (MEMARENA != NULL) MEMARENA->allocs++;
     CSOUND_MEM_SPINUNLOCK
     /* return with data pointer */
     return DATA_PTR(p);
@@ -98,7 +175,7 @@ void *mmallocDebug(CSOUND *csound, size_t size, char *file, int line)
     return ans;
 }
 
-void *mcalloc(CSOUND *csound, size_t size)
+static void *sys_calloc(CSOUND *csound, size_t size)
 {
     void  *p;
 
@@ -124,6 +201,7 @@ void *mcalloc(CSOUND *csound, size_t size)
     if (MEMALLOC_DB != NULL)
       ((memAllocBlock_t*) MEMALLOC_DB)->prv = (memAllocBlock_t*) p;
     MEMALLOC_DB = (void*) p;
+    if (MEMARENA != NULL) MEMARENA->allocs++;
     CSOUND_MEM_SPINUNLOCK
     /* return with data pointer */
     return DATA_PTR(p);
@@ -137,7 +215,7 @@ void *mcallocDebug(CSOUND *csound, size_t size, char *file, int line)
 }
 
 
-void mfree(CSOUND *csound, void *p)
+static void sys_free(CSOUND *csound, void *p)
 {
     memAllocBlock_t *pp;
 
@@ -168,6 +246,7 @@ void mfree(CSOUND *csound, void *p)
       else
         MEMALLOC_DB = (void*)nxt;
     }
+    if (MEMARENA != NULL) MEMARENA->frees++;
     //csound->Message(csound, "free\n");
     /* free memory */
     free((void*) pp);
@@ -180,17 +259,11 @@ void mfreeDebug(CSOUND *csound, void *ans, char *file, int line)
     mfree(csound,ans);
 }
 
-void *mrealloc(CSOUND *csound, void *oldp, size_t size)
+static void *sys_realloc(CSOUND *csound, void *oldp, size_t size)
 {
     memAllocBlock_t *pp;
     void            *p;
 
-    if (UNLIKELY(oldp == NULL))
-      return mmalloc(csound, size);
-    if (UNLIKELY(size == (size_t) 0)) {
-      mfree(csound, oldp);
-      return NULL;
-    }
     pp = HDR_PTR(oldp);
 #ifdef MEMDEBUG
     if (UNLIKELY(pp->magic != MEMALLOC_MAGIC || pp->ptr != oldp)) {
@@ -245,10 +318,325 @@ void *mreallocDebug(CSOUND *csound, void *oldp, size_t size, char *file, int lin
     return p;
 }
 
+#ifdef ARENA_TLS
+
+/* take bytes from the newest chunk; called with memlock held, returns
+   NULL (without dying, the lock is still held) if malloc fails */
+
+static void *arena_carve(memArena_t *a, size_t bytes)
+{
+    void  *p;
+
+    if (UNLIKELY(a->cur + bytes > a->end)) {
+      char  *chunk = (char*) malloc(ARENA_CHUNK_SIZE);
+      if (UNLIKELY(chunk == NULL))
+        return NULL;
+      *(char**) chunk = a->chunks;
+      a->chunks = chunk;
+      a->cur = chunk + ARENA_ALIGN(sizeof(char*));
+      a->end = chunk + ARENA_CHUNK_SIZE;
+      a->reserved += ARENA_CHUNK_SIZE;
+    }
+    p = (void*) a->cur;
+    a->cur += bytes;
+    return p;
+}
+
+static arenaCache_t *arena_cache(CSOUND *csound, memArena_t *a)
+{
+    arenaCache_t  *c = arena_tls_cache;
+
+    if (LIKELY(c != NULL && arena_tls_gen == a->gen))
+      return c;
+    /* another instance, or the arena was reset: look for our cache */
+    for (c = ARENA_LOAD_ACQ(a->caches); c != NULL; c = c->nxt)
+      if (c->owner == (void*) &arena_tls_cache)
+        break;
+    if (c == NULL) {
+      CSOUND_MEM_SPINLOCK
+      c = (arenaCache_t*) arena_carve(a, ARENA_ALIGN(sizeof(arenaCache_t)));
+      if (c != NULL) {
+        memset(c, 0, sizeof(arenaCache_t));
+        c->owner = (void*) &arena_tls_cache;
+        c->nxt = a->caches;
+        ARENA_STORE_REL(a->caches, c);
+      }
+      CSOUND_MEM_SPINUNLOCK
+      if (UNLIKELY(c == NULL))
+        memdie(csound, sizeof(arenaCache_t));
+    }
+    arena_tls_cache = c;
+    arena_tls_gen = a->gen;
+    return c;
+}
+
+static inline int arena_batch(int cls)
+{
+    size_t  n = ARENA_BATCH_BYTES / CLASS_BYTES(cls);
+    return (n < 1 ? 1 : (n > ARENA_BATCH_MAX ? ARENA_BATCH_MAX : (int) n));
+}
+
+/* move a batch of blocks into an empty thread cache */
+
+static void arena_refill(CSOUND *csound, memArena_t *a,
+                         arenaCache_t *c, int cls)
+{
+    size_t  stride = ARENA_ALIGN(HDR_SIZE + CLASS_BYTES(cls));
+    int     n = arena_batch(cls);
+
+    CSOUND_MEM_SPINLOCK
+    while (n > 0 && a->free[cls] != NULL) {
+      arenaBlock_t *b = a->free[cls];
+      a->free[cls] = b->nxt;
+      b->nxt = c->free[cls];
+      c->free[cls] = b;
+      c->nfree[cls]++;
+      n--;
+    }
+    while (n > 0) {
+      arenaBlock_t *b = (arenaBlock_t*) arena_carve(a, stride);
+      if (UNLIKELY(b == NULL))
+        break;
+      b->nxt = c->free[cls];
+      c->free[cls] = b;
+      c->nfree[cls]++;
+      n--;
+    }
+    CSOUND_MEM_SPINUNLOCK
+    if (UNLIKELY(c->free[cls] == NULL))
+      memdie(csound, CLASS_BYTES(cls));
+}
+
+/* hand the surplus of an overlong thread cache back to the shared lists */
+
+static void arena_flush(CSOUND *csound, memArena_t *a,
+                        arenaCache_t *c, int cls)
+{
+    int     n = c->nfree[cls] - arena_batch(cls);
+
+    CSOUND_MEM_SPINLOCK
+    while (n-- > 0) {
+      arenaBlock_t *b = c->free[cls];
+      c->free[cls] = b->nxt;
+      c->nfree[cls]--;
+      b->nxt = a->free[cls];
+      a->free[cls] = b;
+    }
+    CSOUND_MEM_SPINUNLOCK
+}
+
+static void *arena_alloc(CSOUND *csound, size_t size, int zero)
+{
+    memArena_t    *a = MEMARENA;
+    arenaCache_t  *c;
+    arenaBlock_t  *b;
+    int           cls = 0;
+
+    if (UNLIKELY(size > ARENA_MAX_SIZE)) {  /* large: plain malloc */
+      b = (arenaBlock_t*) (zero ? sys_calloc(csound, HDR_SIZE + size)
+                                : sys_malloc(csound, HDR_SIZE + size));
+      b->size = size;
+      b->nxt = NULL;
+      CSOUND_MEM_SPINLOCK
+      a->bigbytes += size;
+      CSOUND_MEM_SPINUNLOCK
+    }
+    else {
+      while (CLASS_BYTES(cls) < size)
+        cls++;
+      c = arena_cache(csound, a);
+      if (UNLIKELY(c->free[cls] == NULL))
+        arena_refill(csound, a, c, cls);
+      b = c->free[cls];
+      c->free[cls] = b->nxt;
+      c->nfree[cls]--;
+      b->size = (size_t) cls;
+      c->allocs++;
+      c->bytes += CLASS_BYTES(cls);
+      if (zero)
+        memset(DATA_PTR(b), 0, size);
+    }
+#ifdef MEMDEBUG
+    b->magic = MEMALLOC_MAGIC;
+    b->ptr = DATA_PTR(b);
+#endif
+    return DATA_PTR(b);
+}
+
+static void arena_free(CSOUND *csound, void *p)
+{
+    memArena_t    *a = MEMARENA;
+    arenaBlock_t  *b = ARENA_HDR(p);
+    arenaCache_t  *c;
+    int           cls;
+
+    if (UNLIKELY(b->size >= (size_t) ARENA_CLASSES)) {
+      CSOUND_MEM_SPINLOCK
+      a->bigbytes -= b->size;
+      CSOUND_MEM_SPINUNLOCK
+      sys_free(csound, (void*) b);
+      return;
+    }
+    cls = (int) b->size;
+    c = arena_cache(csound, a);
+    b->nxt = c->free[cls];
+    c->free[cls] = b;
+    c->frees++;
+    c->bytes -= CLASS_BYTES(cls);
+    if (UNLIKELY(++c->nfree[cls] > 2 * arena_batch(cls)))
+      arena_flush(csound, a, c, cls);
+}
+
+static void *arena_realloc(CSOUND *csound, void *oldp, size_t size)
+{
+    arenaBlock_t  *b = ARENA_HDR(oldp);
+    size_t        oldsize;
+    void          *p;
+
+    if (b->size < (size_t) ARENA_CLASSES) {
+      oldsize = CLASS_BYTES(b->size);
+      if (size <= oldsize)              /* still fits its class */
+        return oldp;
+    }
+    else
+      oldsize = b->size;
+    p = arena_alloc(csound, size, 0);
+    memcpy(p, oldp, (size < oldsize ? size : oldsize));
+    arena_free(csound, oldp);
+    return p;
+}
+
+#endif  /* ARENA_TLS */
+
+void *mmalloc(CSOUND *csound, size_t size)
+{
+#ifdef ARENA_TLS
+    if (ARENA_ON)
+      return arena_alloc(csound, size, 0);
+#endif
+    return sys_malloc(csound, size);
+}
+
+void *mcalloc(CSOUND *csound, size_t size)
+{
+#ifdef ARENA_TLS
+    if (ARENA_ON)
+      return arena_alloc(csound, size, 1);
+#endif
+    return sys_calloc(csound, size);
+}
+
+void mfree(CSOUND *csound, void *p)
+{
+#ifdef ARENA_TLS
+    if (ARENA_ON) {
+      if (UNLIKELY(p == NULL))
+        return;
+ #ifdef MEMDEBUG
+      if (UNLIKELY(ARENA_HDR(p)->magic != MEMALLOC_MAGIC ||
+                   ARENA_HDR(p)->ptr != p)) {
+        csound->Warning(csound, "csound->Free() called with invalid "
+                        "pointer (%p)", p);
+        return;
+      }
+      ARENA_HDR(p)->magic = 0;
+ #endif
+      arena_free(csound, p);
+      return;
+    }
+#endif
+    sys_free(csound, p);
+}
+
+void *mrealloc(CSOUND *csound, void *oldp, size_t size)
+{
+    if (UNLIKELY(oldp == NULL))
+      return mmalloc(csound, size);
+    if (UNLIKELY(size == (size_t) 0)) {
+      mfree(csound, oldp);
+      return NULL;
+    }
+#ifdef ARENA_TLS
+    if (ARENA_ON)
+      return arena_realloc(csound, oldp, size);
+#endif
+    return sys_realloc(csound, oldp, size);
+}
+
+/* called by csoundCreateWithAllocator() before the first allocation */
+
+void memINIT(CSOUND *csound, int allocator)
+{
+    memArena_t  *a = (memArena_t*) calloc(1, sizeof(memArena_t));
+
+    if (a == NULL)
+      return;                   /* no counters, system allocator */
+#ifdef ARENA_TLS
+    if (allocator == CSOUND_ALLOC_ARENA) {
+      a->mode = CSOUND_ALLOC_ARENA;
+      a->gen = ARENA_NEXT_GEN(&arena_generation);
+    }
+#else
+    (void) allocator;
+#endif
+    csound->memarena = (void*) a;
+}
+
+void memDESTROY(CSOUND *csound)
+{
+    free(csound->memarena);
+    csound->memarena = NULL;
+}
+
+PUBLIC int csoundGetMemoryStats(CSOUND *csound, CSOUND_MEMSTATS *stats)
+{
+    memArena_t    *a = MEMARENA;
+    arenaCache_t  *c;
+
+    memset(stats, 0, sizeof(CSOUND_MEMSTATS));
+    if (a == NULL)
+      return CSOUND_ERROR;
+    CSOUND_MEM_SPINLOCK
+    stats->allocator = a->mode;
+    stats->allocs = a->allocs;
+    stats->frees = a->frees;
+    stats->bytesInUse = a->bigbytes;
+    stats->bytesReserved = a->reserved;
+    /* per thread counters are read without stopping their owners */
+    for (c = a->caches; c != NULL; c = c->nxt) {
+      stats->allocs += c->allocs;
+      stats->frees += c->frees;
+      stats->bytesInUse += c->bytes;
+    }
+    CSOUND_MEM_SPINUNLOCK
+    return CSOUND_SUCCESS;
+}
+
 void memRESET(CSOUND *csound)
 {
     memAllocBlock_t *pp, *nxtp;
 
+#ifdef ARENA_TLS
+    if (ARENA_ON) {             /* drop the chunks wholesale */
+      memArena_t    *a = MEMARENA;
+      arenaCache_t  *c;
+      char          *chunk = a->chunks;
+      for (c = a->caches; c != NULL; c = c->nxt) {
+        a->allocs += c->allocs;
+        a->frees += c->frees;
+      }
+      while (chunk != NULL) {
+        char *nxt = *(char**) chunk;
+        free(chunk);
+        chunk = nxt;
+      }
+      a->chunks = a->cur = a->end = NULL;
+      a->caches = NULL;
+      memset(a->free, 0, sizeof(a->free));
+      a->reserved = a->bigbytes = 0;
+      a->gen = ARENA_NEXT_GEN(&arena_generation);  /* stale thread hints */
+    }
+#endif
     pp = (memAllocBlock_t*) MEMALLOC_DB;
     MEMALLOC_DB = NULL;
     while (pp != NULL) {
@@ -32,6 +32,7 @@
 #include <sndfile.h>
 #include <string.h>
 #include <inttypes.h>
+#include <sys/stat.h>
 
 static int Load_Het_File_(CSOUND *csound, const char *filnam,
                           char **allocp, int32 *len)
@@ -689,3 +690,360 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
     /* return with pointer to file structure */
     return p;
 }
+
+ /* ------------------------------------------------------------------------ */
+
+/* Decoded sample cache shared by diskin2 and GEN01.  Entries are keyed by
+   the full path, modification time, size and the sample rate, channel
+   count and format the file was opened with, so an edited file or a raw
+   file read with different parameters is never confused with a cached
+   one.  Files of up to SNDCACHE_PRELOAD_MAX samples are decoded whole
+   when first opened, longer ones in pages of SNDCACHE_PAGE_FRAMES frames
+   as they are read.  Pages are not pinned: readers copy out of them with
+   the cache locked, so any page may be dropped when the memory budget
+   (--sample-cache=MB) is exceeded, least recently used first.  The cache
+   keeps one file handle per entry, closed when the last user goes.  A
+   page is decoded with the cache unlocked and published when it is
+   done; meanwhile its entry is marked as loading, and other readers of
+   the same file wait for it, as the file handle serves one at a time.
+   GEN01 releases its entry with sndcache_discard(), so a file that only
+   a table was built from is not kept in memory twice. */
+
+#define SNDCACHE_PAGE_FRAMES    16384
+#define SNDCACHE_PRELOAD_MAX    (1L << 20)
+
+typedef struct sndcache_page_ {
+    struct sndcache_entry_ *owner;
+    struct sndcache_page_ *prv, *nxt;   /* LRU list, newest first   */
+    int32         index;
+    int32         nframes;              /* frames actually decoded  */
+    MYFLT         data[1];
+} SNDCACHE_PAGE;
+
+typedef struct sndcache_entry_ {
+    char          *key;
+    char          *fullName;
+    void          *fd;                  /* NULL while unused        */
+    SNDFILE       *sf;
+    SF_INFO       sfinfo;
+    int64_t       nFrames;
+    int32         pageFrames;
+    int32         nPages, nLoaded;
+    int           refCount;
+    int           loading;              /* a page is being decoded  */
+    SNDCACHE_PAGE **pages;
+} SNDCACHE_ENTRY;
+
+typedef struct {
+    CS_HASH_TABLE *entries;
+    void          *mutex;
+    void          *loaded;              /* a page was published     */
+    int           waiting;              /* readers waiting for one  */
+    SNDCACHE_PAGE lru;                  /* list head, not a page    */
+    size_t        bytes, budget;
+    long          hits, misses, evictions;
+} SNDCACHE;
+
+/* sub-second part of a file's mtime, so that a file rewritten twice
+   within the same second is still seen as changed */
+
+static long sndcache_mtime_nsec(const struct stat *st)
+{
+#if defined(__APPLE__)
+    return (long) st->st_mtimespec.tv_nsec;
+#elif defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) \
+      || defined(__OpenBSD__)
+    return (long) st->st_mtim.tv_nsec;
+#else
+    (void) st;
+    return 0L;
+#endif
+}
+
+static void sndcache_free_entry(CSOUND *csound, SNDCACHE *c,
+                                SNDCACHE_ENTRY *e)
+{
+    char    *key = cs_hash_table_get_key(csound, c->entries, e->key);
+
+    cs_hash_table_remove(csound, c->entries, e->key);
+    csound->Free(csound, key);          /* the table's copy */
+    csound->Free(csound, e->pages);
+    csound->Free(csound, e->fullName);
+    csound->Free(csound, e->key);
+    csound->Free(csound, e);
+}
+
+static void sndcache_drop_page(CSOUND *csound, SNDCACHE *c, SNDCACHE_PAGE *pg)
+{
+    SNDCACHE_ENTRY  *e = pg->owner;
+
+    pg->prv->nxt = pg->nxt;
+    pg->nxt->prv = pg->prv;
+    e->pages[pg->index] = NULL;
+    e->nLoaded--;
+    c->bytes -= sizeof(SNDCACHE_PAGE)
+                + (size_t) e->pageFrames * e->sfinfo.channels * sizeof(MYFLT);
+    csound->Free(csound, pg);
+    if (e->nLoaded == 0 && e->refCount == 0)
+      sndcache_free_entry(csound, c, e);
+}
+
+/* decode page 'n' of an entry, evicting old pages to stay in budget;
+   called with the cache locked, which is dropped while the file is read */
+
+static SNDCACHE_PAGE *sndcache_load_page(CSOUND *csound, SNDCACHE *c,
+                                         SNDCACHE_ENTRY *e, int32 n)
+{
+    SNDCACHE_PAGE *pg = NULL;
+    size_t  nbytes;
+    int64_t start = (int64_t) n * e->pageFrames;
+    int32   nframes, got = 0;
+    int     i;
+
+    nbytes = sizeof(SNDCACHE_PAGE)
+             + (size_t) e->pageFrames * e->sfinfo.channels * sizeof(MYFLT);
+    while (c->bytes + nbytes > c->budget && c->lru.prv != &c->lru) {
+      sndcache_drop_page(csound, c, c->lru.prv);
+      c->evictions++;
+    }
+    c->bytes += nbytes;                 /* counted while it is decoded */
+    e->loading = 1;
+    csound->UnlockMutex(c->mutex);
+    /* the caller's reference keeps the entry and its handle open */
+    if (e->fd == NULL) {
+      SF_INFO tmp = e->sfinfo;
+      e->fd = csound->FileOpen2(csound, &(e->sf), CSFILE_SND_R, e->fullName,
+                                &tmp, "SFDIR;SSDIR", CSFTYPE_UNKNOWN_AUDIO, 0);
+    }
+    if (LIKELY(e->fd != NULL)) {
+      nframes = (int32) (e->nFrames - start < e->pageFrames ?
+                         e->nFrames - start : e->pageFrames);
+      pg = (SNDCACHE_PAGE*) csound->Malloc(csound, nbytes);
+      if (sf_seek(e->sf, (sf_count_t) start, SEEK_SET) >= 0) {
+        got = (int32) sf_read_MYFLT(e->sf, pg->data,
+                                    (sf_count_t) nframes * e->sfinfo.channels);
+        got = (got < 0 ? 0 : got / e->sfinfo.channels);
+      }
+    }
+    csound->LockMutex(c->mutex);
+    e->loading = 0;
+    for (i = c->waiting; i > 0; i--)
+      csoundCondSignal(c->loaded);
+    if (UNLIKELY(pg == NULL)) {
+      c->bytes -= nbytes;
+      return NULL;
+    }
+    pg->owner = e;
+    pg->index = n;
+    pg->nframes = got;
+    pg->prv = &c->lru;
+    pg->nxt = c->lru.nxt;
+    c->lru.nxt->prv = pg;
+    c->lru.nxt = pg;
+    e->pages[n] = pg;
+    e->nLoaded++;
+    return pg;
+}
+
+/**
+ * Attach to the cache entry for a sound file that the caller has just
+ * opened with csound->FileOpen2(); 'fd' is the handle it returned and
+ * 'sfi' the SF_INFO it filled in.  The caller keeps ownership of fd.
+ * Returns NULL if the cache is disabled or the file length is unknown,
+ * in which case the file should be read directly as before.
+ * Every successful call must be paired with sndcache_close().
+ */
+
+void *sndcache_open(CSOUND *csound, void *fd, const void *sfi)
+{
+    const SF_INFO   *sfinfo = (const SF_INFO*) sfi;
+    SNDCACHE        *c = (SNDCACHE*) csound->sndcache;
+    SNDCACHE_ENTRY  *e;
+    const char      *name;
+    struct stat     st;
+    char            key[1024];
+
+    if (csound->oparms->sampleCache <= 0 || fd == NULL ||
+        sfinfo->frames <= (sf_count_t) 0 || sfinfo->channels < 1 ||
+        (name = csound->GetFileName(fd)) == NULL ||
+        stat(name, &st) != 0 || !S_ISREG(st.st_mode))
+      return NULL;
+    if (c == NULL) {
+      c = (SNDCACHE*) csound->Calloc(csound, sizeof(SNDCACHE));
+      c->entries = cs_hash_table_create(csound);
+      c->mutex = csound->Create_Mutex(0);
+      c->loaded = csoundCreateCondVar();
+      c->lru.prv = c->lru.nxt = &c->lru;
+      c->budget = (size_t) csound->oparms->sampleCache << 20;
+      csound->sndcache = c;
+    }
+    snprintf(key, 1024, "%s|%ld.%09ld|%" PRId64 "|%d|%d|%x", name,
+             (long) st.st_mtime, sndcache_mtime_nsec(&st),
+             (int64_t) st.st_size,
+             sfinfo->samplerate, sfinfo->channels, sfinfo->format);
+    csound->LockMutex(c->mutex);
+    e = (SNDCACHE_ENTRY*) cs_hash_table_get(csound, c->entries, key);
+    if (e != NULL) {
+      e->refCount++;
+      c->hits++;
+      csound->UnlockMutex(c->mutex);
+      return e;
+    }
+    c->misses++;
+    e = (SNDCACHE_ENTRY*) csound->Calloc(csound, sizeof(SNDCACHE_ENTRY));
+    e->key = cs_strdup(csound, key);
+    e->fullName = cs_strdup(csound, (char*) name);
+    e->sfinfo = *sfinfo;
+    e->nFrames = (int64_t) sfinfo->frames;
+    if (e->nFrames * sfinfo->channels <= SNDCACHE_PRELOAD_MAX)
+      e->pageFrames = (int32) e->nFrames;
+    else
+      e->pageFrames = SNDCACHE_PAGE_FRAMES;
+    e->nPages = (int32) ((e->nFrames + e->pageFrames - 1) / e->pageFrames);
+    e->pages = (SNDCACHE_PAGE**)
+      csound->Calloc(csound, e->nPages * sizeof(SNDCACHE_PAGE*));
+    e->refCount = 1;
+    cs_hash_table_put(csound, c->entries, e->key, e);
+    if (e->nPages == 1)                 /* small file: decode it now */
+      sndcache_load_page(csound, c, e, 0);
+    csound->UnlockMutex(c->mutex);
+    return e;
+}
+
+/**
+ * Copy up to 'nframes' interleaved sample frames starting at frame
+ * 'start' of a cached file to 'buf'.  Returns the number of frames
+ * copied, which is less than nframes at the end of the file (or zero
+ * on a read error).
+ */
+
+int32 sndcache_read(CSOUND *csound, void *sc, MYFLT *buf,
+                    int64_t start, int32 nframes)
+{
+    SNDCACHE        *c = (SNDCACHE*) csound->sndcache;
+    SNDCACHE_ENTRY  *e = (SNDCACHE_ENTRY*) sc;
+    SNDCACHE_PAGE   *pg;
+    int32           n, ofs, cnt, done = 0;
+    int             nchnls = e->sfinfo.channels;
+
+    if (UNLIKELY(start < 0))
+      return 0;
+    csound->LockMutex(c->mutex);
+    while (done < nframes && start < e->nFrames) {
+      n = (int32) (start / e->pageFrames);
+      ofs = (int32) (start - (int64_t) n * e->pageFrames);
+      if ((pg = e->pages[n]) == NULL) {
+        if (e->loading) {               /* another reader has the file */
+          c->waiting++;
+          csoundCondWait(c->loaded, c->mutex);
+          c->waiting--;
+          continue;
+        }
+        if (UNLIKELY((pg = sndcache_load_page(csound, c, e, n)) == NULL))
+          break;
+      }
+      else if (pg != c->lru.nxt) {      /* move to the front */
+        pg->prv->nxt = pg->nxt;
+        pg->nxt->prv = pg->prv;
+        pg->prv = &c->lru;
+        pg->nxt = c->lru.nxt;
+        c->lru.nxt->prv = pg;
+        c->lru.nxt = pg;
+      }
+      if ((cnt = pg->nframes - ofs) <= 0)
+        break;                          /* short read from the file */
+      if (cnt > nframes - done)
+        cnt = nframes - done;
+      memcpy(buf + (size_t) done * nchnls, pg->data + (size_t) ofs * nchnls,
+             (size_t) cnt * nchnls * sizeof(MYFLT));
+      done += cnt;
+      start += cnt;
+    }
+    csound->UnlockMutex(c->mutex);
+    return done;
+}
+
+static SNDCACHE_PAGE *sndcache_any_page(SNDCACHE_ENTRY *e)
+{
+    int32   n = 0;
+
+    while (e->pages[n] == NULL)
+      n++;
+    return e->pages[n];
+}
+
+static void sndcache_release(CSOUND *csound, SNDCACHE_ENTRY *e, int keep)
+{
+    SNDCACHE        *c = (SNDCACHE*) csound->sndcache;
+
+    csound->LockMutex(c->mutex);
+    if (--e->refCount == 0) {
+      if (e->fd != NULL) {
+        csound->FileClose(csound, e->fd);
+        e->fd = NULL;
+        e->sf = NULL;
+      }
+      if (!keep && e->nLoaded > 0) {
+        while (e->nLoaded > 1)
+          sndcache_drop_page(csound, c, sndcache_any_page(e));
+        /* dropping the last page frees the entry as well */
+        sndcache_drop_page(csound, c, sndcache_any_page(e));
+      }
+      else if (e->nLoaded == 0)
+        sndcache_free_entry(csound, c, e);
+    }
+    csound->UnlockMutex(c->mutex);
+}
+
+/* release an entry returned by sndcache_open() */
+
+void sndcache_close(CSOUND *csound, void *sc)
+{
+    sndcache_release(csound, (SNDCACHE_ENTRY*) sc, 1);
+}
+
+/* release an entry and, if nobody else is reading the file, drop its
+   pages as well; for readers such as GEN01 that keep their own copy */
+
+void sndcache_discard(CSOUND *csound, void *sc)
+{
+    sndcache_release(csound, (SNDCACHE_ENTRY*) sc, 0);
+}
+
+/* free all cached data, called on reset before open files are closed */
+
+void sndcache_free(CSOUND *csound)
+{
+    SNDCACHE        *c = (SNDCACHE*) csound->sndcache;
+    CONS_CELL       *head, *cell;
+    SNDCACHE_ENTRY  *e;
+
+    if (c == NULL)
+      return;
+    if (c->hits + c->misses > 0 && (csound->oparms->msglevel & 7))
+      csound->Message(csound, Str("sample cache: %ld hits, %ld misses, "
+                                  "%ld pages evicted\n"),
+                      c->hits, c->misses, c->evictions);
+    while (c->lru.nxt != &c->lru) {
+      SNDCACHE_PAGE *pg = c->lru.nxt;
+      pg->prv->nxt = pg->nxt;
+      pg->nxt->prv = pg->prv;
+      csound->Free(csound, pg);
+    }
+    head = cs_hash_table_values(csound, c->entries);
+    for (cell = head; cell != NULL; cell = cell->next) {
+      e = (SNDCACHE_ENTRY*) cell->value;
+      if (e->fd != NULL)
+        csound->FileClose(csound, e->fd);
+      csound->Free(csound, e->pages);
+      csound->Free(csound, e->fullName);
+      csound->Free(csound, e->key);
+      csound->Free(csound, e);
+    }
+    cs_cons_free(csound, head);
+    cs_hash_table_free(csound, c->entries);
+    csound->DestroyMutex(c->mutex);
+    csoundDestroyCondVar(c->loaded);
+    csound->Free(csound, c);
+    csound->sndcache = NULL;
+}
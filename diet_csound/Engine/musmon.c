@@ -425,12 +425,77 @@ static void deactivate_all_notes(CSOUND *csound)
     }
 }
 
+/* Pending realtime events are kept in a binary min-heap on start_kcnt
+   (OrcTrigHeap), so that schedule/event calls cost O(log n) however
+   many events are waiting.  Events due in the same k-period still start
+   in the order they were inserted (seqno).  OrcTrigEvts always points
+   at the top of the heap, or is NULL when nothing is pending.        */
+
+#define EVT_BEFORE(a,b) ((a)->start_kcnt < (b)->start_kcnt ||             \
+                         ((a)->start_kcnt == (b)->start_kcnt &&           \
+                          (int32_t) ((a)->seqno - (b)->seqno) < 0))
+
+static void evtheap_up(EVTNODE **h, int i)
+{
+  EVTNODE *e = h[i];
+  while (i > 0) {
+    int parent = (i - 1) >> 1;
+    if (!EVT_BEFORE(e, h[parent])) break;
+    h[i] = h[parent];
+    i = parent;
+  }
+  h[i] = e;
+}
+
+static void evtheap_down(EVTNODE **h, int n, int i)
+{
+  EVTNODE *e = h[i];
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= n) break;
+    if (child + 1 < n && EVT_BEFORE(h[child + 1], h[child])) child++;
+    if (!EVT_BEFORE(h[child], e)) break;
+    h[i] = h[child];
+    i = child;
+  }
+  h[i] = e;
+}
+
+static void evtheap_push(CSOUND *csound, EVTNODE *e)
+{
+  if (UNLIKELY(csound->OrcTrigCnt >= csound->OrcTrigMax)) {
+    int n = (csound->OrcTrigMax > 0 ? csound->OrcTrigMax * 2 : 64);
+    csound->OrcTrigHeap =
+      (EVTNODE**) csound->ReAlloc(csound, csound->OrcTrigHeap,
+                                  n * sizeof(EVTNODE*));
+    csound->OrcTrigMax = n;
+  }
+  e->seqno = csound->OrcTrigSeq++;
+  csound->OrcTrigHeap[csound->OrcTrigCnt] = e;
+  evtheap_up(csound->OrcTrigHeap, csound->OrcTrigCnt++);
+  csound->OrcTrigEvts = csound->OrcTrigHeap[0];
+}
+
+static EVTNODE *evtheap_pop(CSOUND *csound)
+{
+  EVTNODE **h = csound->OrcTrigHeap;
+  EVTNODE *e = h[0];
+  if (--csound->OrcTrigCnt > 0) {
+    h[0] = h[csound->OrcTrigCnt];
+    evtheap_down(h, csound->OrcTrigCnt, 0);
+    csound->OrcTrigEvts = h[0];
+  }
+  else
+    csound->OrcTrigEvts = NULL;
+  return e;
+}
+
 static void delete_pending_rt_events(CSOUND *csound)
 {
-  EVTNODE *ep = csound->OrcTrigEvts;
+  int i;
 
-  while (ep != NULL) {
-    EVTNODE *nxt = ep->nxt;
+  for (i = 0; i < csound->OrcTrigCnt; i++) {
+    EVTNODE *ep = csound->OrcTrigHeap[i];
     if (ep->evt.strarg != NULL) {
       csound->Free(csound,ep->evt.strarg);
       ep->evt.strarg = NULL;
@@ -438,17 +503,18 @@ static void delete_pending_rt_events(CSOUND *csound)
     /* push to stack of free event nodes */
     ep->nxt = csound->freeEvtNodes;
     csound->freeEvtNodes = ep;
-    ep = nxt;
   }
+  csound->OrcTrigCnt = 0;
   csound->OrcTrigEvts = NULL;
 }
 
 void delete_selected_rt_events(CSOUND *csound, MYFLT instr)
 {
-  EVTNODE *ep = csound->OrcTrigEvts;
-  EVTNODE *last = NULL;
-  while (ep != NULL) {
-    EVTNODE *nxt = ep->nxt;
+  EVTNODE **h = csound->OrcTrigHeap;
+  int i, n = 0;
+
+  for (i = 0; i < csound->OrcTrigCnt; i++) {
+    EVTNODE *ep = h[i];
     //printf("*** delete_selected_rt_events: instr = %f, p[1] = %f\n",
     //instr, ep->evt.p[1]);
     if (ep->evt.opcod=='i' &&
@@ -460,15 +526,18 @@ void delete_selected_rt_events(CSOUND *csound, MYFLT instr)
         csound->Free(csound,ep->evt.strarg);
         ep->evt.strarg = NULL;
       }
-      if (last) last->nxt = nxt; else csound->OrcTrigEvts = nxt;
       /* push to stack of free event nodes */
       ep->nxt = csound->freeEvtNodes;
       csound->freeEvtNodes = ep;
     }
-    else last = ep;
-    ep = nxt;
+    else h[n++] = ep;
+  }
+  if (n < csound->OrcTrigCnt) {         /* rebuild what is left */
+    csound->OrcTrigCnt = n;
+    for (i = n / 2 - 1; i >= 0; i--)
+      evtheap_down(h, n, i);
+    csound->OrcTrigEvts = (n > 0 ? h[0] : NULL);
   }
-  //csound->OrcTrigEvts = NULL;
 }
 
 static inline void cs_beep(CSOUND *csound)
@@ -762,11 +831,8 @@ static int process_score_event(CSOUND *csound, EVTBLK *evt, int rtEvt)
     /* fall through */
   case 'l':
   case 's':
-    while (csound->frstoff != NULL) {
-      INSDS *nxt = csound->frstoff->nxtoff;
+    while (csound->frstoff != NULL)     /* also unlinks the note */
       xturnoff_now(csound, csound->frstoff);
-      csound->frstoff = nxt;
-    }
     csound->currevent = saved_currevent;
     return (evt->opcod == 'l' ? 3 : (evt->opcod == 's' ? 1 : 2));
   case 'q':
@@ -941,7 +1007,7 @@ static int process_rt_event(CSOUND *csound, int sensType)
   }
   if (sensType == 4) {                  /* RM: Realtime orc event   */
     EVTNODE *e = csound->OrcTrigEvts;
-    /* RM: Events are sorted on insertion, so just check the first */
+    /* RM: Events are kept in time order, so just check the first */
     evt = &(e->evt);
     insno = MYFLT2LONG(evt->p[1]);
     if ((rfd = getRemoteInsRfd(csound, insno))) {
@@ -951,8 +1017,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
         insSendevt(csound, evt, rfd);  /* RM: or send to single remote Csound */
       return 0;
     }
-    /* pop from the list */
-    csound->OrcTrigEvts = e->nxt;
+    /* pop from the heap */
+    evtheap_pop(csound);
     retval = process_score_event(csound, evt, 1);
     if (evt->strarg != NULL) {
       csound->Free(csound, evt->strarg);
@@ -1287,7 +1353,7 @@ static inline uint64_t time2kcnt(CSOUND *csound, double tval)
 int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
 {
   double        start_time;
-  EVTNODE       *e, *prv;
+  EVTNODE       *e;
   CSOUND        *st = csound;
   MYFLT         *p;
   uint32        start_kcnt;
@@ -1422,18 +1488,7 @@ int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
   }
   /* queue new event */
   e->start_kcnt = start_kcnt;
-  prv = csound->OrcTrigEvts;
-  /* if list is empty, or at beginning of list: */
-  if (prv == NULL || start_kcnt < prv->start_kcnt) {
-    e->nxt = prv;
-    csound->OrcTrigEvts = e;
-  }
-  else {                                      /* otherwise sort by time */
-    while (prv->nxt != NULL && start_kcnt >= prv->nxt->start_kcnt)
-      prv = prv->nxt;
-    e->nxt = prv->nxt;
-    prv->nxt = e;
-  }
+  evtheap_push(csound, e);
   /* Make sure sensevents() looks for RT events */
   csound->oparms->RTevents = 1;
   return 0;
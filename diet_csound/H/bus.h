@@ -41,8 +41,22 @@ extern "C" {
 typedef struct {
     OPDS    h;
     MYFLT   *r, *a;
+    MYFLT   *fp;            /* cached channel data for index idx */
+    int32_t idx;
+    uint32_t gen;
 } CHNVAL;
 
+/* Numbered channels used by chani/chano, indexed directly by channel
+   number so that an index change does not need a name lookup.  There
+   is one table per channel type and direction; gen is bumped whenever
+   a channel's data pointer is replaced, invalidating cached pointers. */
+
+typedef struct {
+    MYFLT   **ptr[4];
+    int32_t size[4];
+    uint32_t gen;
+} CHNNUMTAB;
+
 typedef struct {
     OPDS    h;
     PVSDAT   *r;
@@ -57,11 +71,26 @@ typedef struct {
     int32_t evtbuf;
 } KSENSE;
 
+/* One way of an audio channel between the engine and a host: a triple
+   buffer (see bus.c) */
+
+typedef struct {
+    MYFLT         *buf[3];
+    volatile long mid;              /* the block in between, | 4 if new */
+    int32_t       wr, rd;           /* the writer's and the reader's */
+} CHNXBUF;
+
+typedef struct {
+    CHNXBUF     in, out;            /* host to engine, engine to host */
+    spin_lock_t lock;               /* between host threads only */
+} CHNHOST;
+
 typedef struct channelEntry_s {
-    struct channelEntry_s *nxt;
+    struct channelEntry_s *nxt;     /* next audio channel (chn_audio) */
     controlChannelHints_t hints;
     MYFLT       *data;
     spin_lock_t lock;               /* Multi-thread protection */
+    CHNHOST     *host;              /* audio channels: the host's side */
     int32_t     type;
     int32_t     datasize;  /* size of allocated chn data */
     char        name[1];
@@ -74,6 +103,7 @@ typedef struct {
     MYFLT       *fp;
     spin_lock_t *lock;
     int32_t     pos;
+    int32_t     constname;  /* name is a literal, never re-resolved */
     char        chname[MAX_CHAN_NAME+1];
 } CHNGET;
 
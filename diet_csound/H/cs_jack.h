@@ -64,4 +64,17 @@ typedef struct RtJackGlobals_ {
     int     xrunFlag;                   /* non-zero if an xrun has occured  */
     jack_client_t   *listclient;
     int outDevNum, inDevNum;            /* select devs by number */
+    int     *xrunCount;                 /* "rtjack_xruns" global variable   */
+    /* callback mode (-+jack_callback=1): the engine runs in processCallback */
+    int     cbMode;                     /* non-zero if callback mode is on  */
+    volatile int cbActive;              /* callback is driving the engine   */
+    int     cbInCallback;               /* set while processCallback runs   */
+    int     cbPlayPos;                  /* frames written in this period    */
+    int     cbRecPos;                   /* frames read in this period       */
+#ifdef LINUX
+    pthread_mutex_t cbLock;             /* parks the Csound thread          */
+#else
+    void    *cbLock;
+#endif
+    int     cbLockInit;
 } RtJackGlobals;
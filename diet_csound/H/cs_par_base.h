@@ -83,6 +83,30 @@
 /* return thread index of caller */
 int csp_thread_index_get(CSOUND *csound);
 
+/*
+ * hybrid barrier used between the performance threads
+ *
+ * waiting threads spin on the epoch for a number of iterations
+ * (--barrier-spin=N) before parking on a condition variable, so that
+ * short k-periods do not pay for a futex wake-up on every cycle
+ */
+typedef struct csp_barrier_t {
+    volatile unsigned int arrived;
+    uint8_t  padding1[CONCURRENTPADDING - sizeof(unsigned int)];
+    volatile unsigned int epoch;
+    uint8_t  padding2[CONCURRENTPADDING - sizeof(unsigned int)];
+    unsigned int max;
+    int      spin;
+    int      parked;        /* threads asleep on cond, under mutex */
+    void     *mutex;
+    void     *cond;
+} csp_barrier_t;
+
+void csp_barrier_alloc(CSOUND *csound, void **barrier, int thread_count);
+void csp_barrier_dealloc(CSOUND *csound, void **barrier);
+/* returns 1 in the thread that completed the barrier, 0 in the others */
+int csp_barrier_wait(void *barrier);
+
 /* structure headers */
 #define HDR_LEN                 4
 //#define INSTR_WEIGHT_INFO_HDR   "IWI"
@@ -43,11 +43,13 @@ typedef struct {
     MYFLT   *iBufSize;
     MYFLT   *iSkipInit;
     MYFLT   *forceSync;
+    MYFLT   *iPrefetch;
  /* ------------------------------------- */
     MYFLT   WinSize;
     MYFLT   BufSize;
     MYFLT   SkipInit;
     MYFLT   fforceSync;
+    MYFLT   Prefetch;           /* in sample frames, 0 for half the ring */
 
     int     initDone;
     int     nChannels;
@@ -72,7 +74,10 @@ typedef struct {
     MYFLT   aOut_bufsize;
     void    *cb;
     int     async;
+    void    *io;                /* reader thread filling cb */
+    int     prefetch;           /* wake the reader below this fill level */
   MYFLT     transpose;
+    void    *sc;                /* shared sample cache entry, or NULL */
 } DISKIN2;
 
 typedef struct {
@@ -87,11 +92,13 @@ typedef struct {
     MYFLT   *iBufSize;
     MYFLT   *iSkipInit;
     MYFLT   *forceSync;
+    MYFLT   *iPrefetch;
  /* ------------------------------------- */
     MYFLT   WinSize;
     MYFLT   BufSize;
     MYFLT   SkipInit;
     MYFLT   fforceSync;
+    MYFLT   Prefetch;           /* in sample frames, 0 for half the ring */
     int     initDone;
     int     nChannels;
     int     bufSize;            /* in sample frames, power of two */
@@ -115,6 +122,9 @@ typedef struct {
   MYFLT aOut_bufsize;
   void *cb;
   int  async;
+  void *io;                     /* reader thread filling cb */
+  int  prefetch;                /* wake the reader below this fill level */
+    void    *sc;                /* shared sample cache entry, or NULL */
 } DISKIN2_ARRAY;
 
 int diskin2_init(CSOUND *csound, DISKIN2 *p);
@@ -208,10 +208,13 @@ int32_t krandi2(CSOUND *, void *), randi2(CSOUND *, void *);
 int32_t porset(CSOUND *, void *), port(CSOUND *, void *);
 int32_t tonset(CSOUND *, void *), tone(CSOUND *, void *);
 int32_t atone(CSOUND *, void *), rsnset(CSOUND *, void *);
+int32_t tone_batch(CSOUND *, void **, int);
+int32_t atone_batch(CSOUND *, void **, int);
 int32_t reson(CSOUND *, void *), areson(CSOUND *, void *);
 int32_t resonx(CSOUND *, void *), aresonx(CSOUND *, void *);
 int32_t rsnsetx(CSOUND *, void *), tonex(CSOUND *, void *);
 int32_t atonex(CSOUND *, void *), tonsetx(CSOUND *, void *);
+int32_t atonsetx(CSOUND *, void *);
 int32_t lprdset(CSOUND *, void *), lpread(CSOUND *, void *);
 int32_t lpformantset(CSOUND *, void *), lpformant(CSOUND *, void*);
 int32_t lprsnset(CSOUND *, void *), lpreson(CSOUND *, void *);
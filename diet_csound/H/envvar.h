@@ -241,6 +241,8 @@ extern "C" {
 
   int csoundFSeekAsync(CSOUND *csound, void *handle, int pos, int whence);
 
+  void csoundPrefetchAsync(CSOUND *csound, void *handle, int items);
+
 
 #ifdef __cplusplus
 }
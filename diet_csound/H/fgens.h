@@ -48,5 +48,27 @@ int csoundFTAlloc(CSOUND *csound, int tableNum, int len);
  */
 int csoundFTDelete(CSOUND *csound, int tableNum);
 
+/**
+ * Installs the ftables generated in the background (--ftgen-threads)
+ * that have finished since the last call.  Called at each k-cycle.
+ */
+void ftjobs_publish(CSOUND *csound);
+
+/**
+ * Stops the background ftable threads and discards unpublished tables.
+ */
+void ftjobs_free(CSOUND *csound);
+
+/**
+ * Frees the replaced ftables that no active instrument instance can
+ * still be using, or all of them if 'all' is non-zero.
+ */
+void ftreclaim(CSOUND *csound, int all);
+
+/**
+ * Unmaps the ftables loaded from the ftable cache (--ftable-cache).
+ */
+void ftcache_free(CSOUND *csound);
+
 #endif  /* CSOUND_FGENS_H */
 
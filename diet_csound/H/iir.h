@@ -0,0 +1,97 @@
+/*
+    iir.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/*                                                      IIR.H           */
+
+/* Filter core of the first and second order filters (tone, atone,
+ * butter*, biquad, pareq, rbjeq).  An opcode keeps its section's
+ * coefficients, normalised so that a0 is 1, in an IIR_COEFS that it
+ * works out again only when its k-rate arguments change, and hands the
+ * samples to one of the kernels below: a block of one voice at a time,
+ * or through iir_batch() the same section of VBATCH_LANES voices at
+ * once (see vbatch.h) on a CPU where that pays (see iir.c).  Each form
+ * does the sums of the opcodes that were written in it, so that they
+ * give the same samples as before:
+ *
+ *   onepole  y = b0 x - a1 y1                          tone
+ *   hp1      y = b0 (x - x1 + y1), b1 = a1 = -b0       atone
+ *   df1      y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2  biquad, pareq, rbjeq
+ *   df2      w = x - a1 w1 - a2 w2
+ *            y = b0 w + b1 w1 + b2 w2                  butter*
+ *
+ * keeping { y1 }, { y1 - x1 }, { x1, x2, y1, y2 } and { w1, w2 } as
+ * state.  The filters of arbitrary order (tonex, atonex, resonx) are
+ * cascades of sections in transposed direct form II,
+ *
+ *   tdf2     y = b0 x + s1
+ *            s1 = b1 x - a1 y + s2,  s2 = b2 x - a2 y
+ *
+ * with { s1, s2 } for each section; iir_tdf2() runs the sections over
+ * the block one after the other.
+ */
+
+#ifndef CSOUND_IIR_H
+#define CSOUND_IIR_H
+
+#include "vbatch.h"
+
+#define IIR_NZ          4       /* most state a section keeps */
+
+typedef struct {
+    double  b0, b1, b2, a1, a2;
+} IIR_COEFS;
+
+/* the forms iir_batch() has lane kernels for */
+
+enum { IIR_ONEPOLE, IIR_HP1, IIR_DF1, IIR_DF2 };
+
+/* What iir_batch() needs to know of an opcode.  voice() brings the
+   coefficients of voice p up to date, copies them to *c and points
+   *z, *in and *out at its state and signals; it returns 0 if the voice
+   has to go through perf() on its own instead. */
+
+typedef struct {
+    SUBR        perf;
+    int         (*voice)(CSOUND *, void *p, IIR_COEFS *c, double **z,
+                         MYFLT **in, MYFLT **out);
+    int         form;           /* IIR_ONEPOLE ... */
+} IIR_BATCH;
+
+/* one section (or for iir_tdf2 nsect of them) over in[from..to-1] */
+
+void iir_onepole(const IIR_COEFS *, double *z, MYFLT *in, MYFLT *out,
+                 uint32_t from, uint32_t to);
+void iir_hp1(const IIR_COEFS *, double *z, MYFLT *in, MYFLT *out,
+             uint32_t from, uint32_t to);
+void iir_df1(const IIR_COEFS *, double *z, MYFLT *in, MYFLT *out,
+             uint32_t from, uint32_t to);
+void iir_df2(const IIR_COEFS *, double *z, MYFLT *in, MYFLT *out,
+             uint32_t from, uint32_t to);
+void iir_tdf2(const IIR_COEFS *, int nsect, double *z, MYFLT *in,
+              MYFLT *out, uint32_t from, uint32_t to);
+
+/* batch perf (OENTRY.bopadr) of n voices of the filter described by f */
+
+int32_t iir_batch(CSOUND *, void **p, int n, const IIR_BATCH *f);
+
+#endif  /* CSOUND_IIR_H */
@@ -77,6 +77,9 @@ char    *type2string(int type);
 int     type2csfiletype(int type, int encoding);
 int     sftype2csfiletype(int type);
 void    rewriteheader(void *ofd);
+void    interleave_frames(MYFLT *, const MYFLT *, uint32_t nchnls,
+                          uint32_t nframes, uint32_t stride, MYFLT scale);
+void    chn_bus_begin(CSOUND *), chn_bus_end(CSOUND *);
 #if 0
 int     readOptions_file(CSOUND *, FILE *, int);
 #else
@@ -101,6 +104,12 @@ void    *sndgetset(CSOUND *, void *);
 void    dbfs_init(CSOUND *, MYFLT dbfs);
 int     csoundLoadExternals(CSOUND *);
 SNDMEMFILE  *csoundLoadSoundFile(CSOUND *, const char *name, void *sfinfo);
+void    *sndcache_open(CSOUND *, void *fd, const void *sfinfo);
+int32   sndcache_read(CSOUND *, void *sc, MYFLT *buf,
+                      int64_t start, int32 nframes);
+void    sndcache_close(CSOUND *, void *sc);
+void    sndcache_discard(CSOUND *, void *sc);
+void    sndcache_free(CSOUND *);
 int     PVOCEX_LoadFile(CSOUND *, const char *fname, PVOCEX_MEMFILE *p);
 void    print_opcodedir_warning(CSOUND *);
 int     check_rtaudio_name(char *fName, char **devName, int isOutput);
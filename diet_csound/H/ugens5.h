@@ -22,6 +22,7 @@
 */
 
 #include "lpc.h"        /*                               UGENS5.H        */
+#include "iir.h"
 
 typedef struct {
         OPDS    h;
@@ -49,6 +50,7 @@ typedef struct {
         MYFLT   *ar, *asig, *khp, *ord, *istor;
         double  c1, c2, *yt1, prvhp;
         int loop;
+        IIR_COEFS *c;           /* the sections tonex and atonex run */
         AUXCH   aux;
 } TONEX;
 
@@ -57,6 +59,7 @@ typedef struct {
         MYFLT   *ar, *asig, *kcf, *kbw, *ord, *iscl, *istor;
         int     scale, loop;
         double  c1, c2, c3, *yt1, *yt2, cosf, prvcf, prvbw;
+        IIR_COEFS *c;           /* the sections, with k-rate kcf and kbw */
         AUXCH   aux;
 } RESONX;
 
@@ -0,0 +1,80 @@
+/*
+    vbatch.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/*                                                      VBATCH.H        */
+
+/* Voice batching (--voice-batch): instances of one instrument whose
+ * opcodes are all flagged VB run op by op instead of voice by voice,
+ * and an opcode with a batch entry (OENTRY.bopadr) gets all the voices
+ * in one call; it returns how many are left, having dropped any voice
+ * whose perf failed, as the one voice at a time loop does.  Batch
+ * kernels work on VBATCH_LANES voices at a time, with the signals
+ * transposed into [sample][voice] blocks so that the per-sample
+ * recursion of each voice becomes one vector operation.
+ * From the first opcode that reads spin or adds into spout (IB) on,
+ * each voice runs the rest of its chain alone, in list order, so that
+ * the output is summed exactly as without batching.
+ */
+
+#ifndef CSOUND_VBATCH_H
+#define CSOUND_VBATCH_H
+
+#define VBATCH_MAX      64      /* voices run in one group */
+#define VBATCH_LANES    8       /* voices per kernel pass */
+#define VBATCH_BLOCK    64      /* samples per transposed block */
+
+typedef double VBATCH_BUF[VBATCH_BLOCK][VBATCH_LANES];
+
+/* copy samples i0..i0+nb-1 of m signals into x, zeroing unused lanes;
+   a signal at a time, so that the reads at least are in order */
+
+static inline void vbatch_load(VBATCH_BUF x, MYFLT **in, int m,
+                               uint32_t i0, uint32_t nb)
+{
+    MYFLT    *s;
+    uint32_t i;
+    int      v;
+
+    for (v = 0; v < m; v++)
+      for (i = 0, s = in[v] + i0; i < nb; i++)
+        x[i][v] = (double) s[i];
+    for (; v < VBATCH_LANES; v++)
+      for (i = 0; i < nb; i++)
+        x[i][v] = 0.0;
+}
+
+/* copy the first m lanes of x back to samples i0..i0+nb-1 of out */
+
+static inline void vbatch_store(VBATCH_BUF x, MYFLT **out, int m,
+                                uint32_t i0, uint32_t nb)
+{
+    MYFLT    *d;
+    uint32_t i;
+    int      v;
+
+    for (v = 0; v < m; v++)
+      for (i = 0, d = out[v] + i0; i < nb; i++)
+        d[i] = (MYFLT) x[i][v];
+}
+
+#endif  /* CSOUND_VBATCH_H */
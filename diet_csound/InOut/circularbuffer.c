@@ -23,43 +23,77 @@
 
 #include <csoundCore.h>
 
+/* The read and write counters run freely and are masked into a
+   power-of-two sized buffer, so a transfer is at most two memcpy()
+   calls.  The usable capacity is still numelem - 1, as it always was.
+   Each counter is written by one side only and sits on its own cache
+   line; the other side picks it up with an acquire load. */
+
+#define CB_PADDING 64
+
 typedef struct _circular_buffer {
   char *buffer;
-  int  wp;
-  int rp;
-  int numelem;
+  unsigned int mask;      /* buffer size in elements - 1 */
+  unsigned int capacity;  /* numelem - 1 */
   int elemsize; /* in number of bytes */
+  char pad0[CB_PADDING];
+  volatile unsigned int wp;
+  char pad1[CB_PADDING - sizeof(unsigned int)];
+  volatile unsigned int rp;
+  char pad2[CB_PADDING - sizeof(unsigned int)];
 } circular_buffer;
 
+#if defined(MSVC)
+#  define CB_LOAD(var)        (var)
+#  define CB_STORE(var, val)  InterlockedExchange((volatile long *) &(var), \
+                                                  (long) (val))
+#elif defined(HAVE_ATOMIC_BUILTIN)
+#  define CB_LOAD(var)        __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#  define CB_STORE(var, val)  __atomic_store_n(&(var), (val), __ATOMIC_RELEASE)
+#else
+#  define CB_LOAD(var)        (var)
+#  define CB_STORE(var, val)  ((var) = (val))
+#endif
+
 void *csoundCreateCircularBuffer(CSOUND *csound, int numelem, int elemsize){
     circular_buffer *p;
+    unsigned int size = 1;
     if ((p = (circular_buffer *)
          csound->Malloc(csound, sizeof(circular_buffer))) == NULL) {
       return NULL;
     }
-    p->numelem = numelem;
+    while (size < (unsigned int) numelem)
+      size <<= 1;
+    p->mask = size - 1;
+    p->capacity = numelem > 0 ? numelem - 1 : 0;
     p->wp = p->rp = 0;
     p->elemsize = elemsize;
 
-    if ((p->buffer = (char *) csound->Malloc(csound, numelem*elemsize)) == NULL) {
+    if ((p->buffer = (char *) csound->Malloc(csound, size*elemsize)) == NULL) {
       return NULL;
     }
-    memset(p->buffer, 0, numelem*elemsize);
+    memset(p->buffer, 0, size*elemsize);
     return (void *)p;
 }
 
-int checkspace(circular_buffer *p, int writeCheck){
-    int wp = p->wp, rp = p->rp, numelem = p->numelem;
-    if(writeCheck){
-      if (wp > rp) return rp - wp + numelem - 1;
-      else if (wp < rp) return rp - wp - 1;
-      else return numelem - 1;
-    }
-    else {
-      if (wp > rp) return wp - rp;
-      else if (wp < rp) return wp - rp + numelem;
-      else return 0;
-    }
+int checkspace(void *cb, int writeCheck){
+    circular_buffer *p = (circular_buffer *) cb;
+    if(writeCheck)
+      return (int) (p->capacity - (p->wp - CB_LOAD(p->rp)));
+    else
+      return (int) (CB_LOAD(p->wp) - p->rp);
+}
+
+/* copy items elements out of the buffer starting at counter rp */
+static inline void cb_copy_out(circular_buffer *p, char *out,
+                               unsigned int rp, unsigned int items)
+{
+    unsigned int elemsize = p->elemsize, start = rp & p->mask;
+    unsigned int first = p->mask + 1 - start;
+    if (first > items) first = items;
+    memcpy(out, p->buffer + start * elemsize, first * elemsize);
+    if (items > first)
+      memcpy(out + first * elemsize, p->buffer, (items - first) * elemsize);
 }
 
 int csoundReadCircularBuffer(CSOUND *csound, void *p, void *out, int items)
@@ -67,29 +101,15 @@ int csoundReadCircularBuffer(CSOUND *csound, void *p, void *out, int items)
     IGN(csound);
     if (p == NULL) return 0;
     {
-      int remaining;
-      int itemsread, numelem = ((circular_buffer *)p)->numelem;
-      int elemsize = ((circular_buffer *)p)->elemsize;
-      int i=0, rp = ((circular_buffer *)p)->rp;
-      char *buffer = ((circular_buffer *)p)->buffer;
-      if ((remaining = checkspace(p, 0)) == 0) {
+      circular_buffer *cb = (circular_buffer *) p;
+      unsigned int rp = cb->rp;
+      int remaining, itemsread;
+      if ((remaining = (int) (CB_LOAD(cb->wp) - rp)) == 0 || items <= 0) {
         return 0;
       }
       itemsread = items > remaining ? remaining : items;
-      for (i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-          rp = 0;
-        }
-      }
-#if defined(MSVC)
-      InterlockedExchange(&((circular_buffer *)p)->rp, rp);
-#elif defined(HAVE_ATOMIC_BUILTIN)
-      __atomic_exchange_n(&((circular_buffer *)p)->rp,rp, __ATOMIC_SEQ_CST);
-#else
-      ((circular_buffer *)p)->rp = rp;
-#endif
+      cb_copy_out(cb, (char *) out, rp, itemsread);
+      CB_STORE(cb->rp, rp + itemsread);
       return itemsread;
     }
 }
@@ -98,22 +118,14 @@ int csoundPeekCircularBuffer(CSOUND *csound, void *p, void *out, int items)
 {
     IGN(csound);
     if (p == NULL) return 0;
-    int remaining;
-    int itemsread, numelem = ((circular_buffer *)p)->numelem;
-    int elemsize = ((circular_buffer *)p)->elemsize;
-    int i=0, rp = ((circular_buffer *)p)->rp;
-    char *buffer = ((circular_buffer *)p)->buffer;
-    if ((remaining = checkspace(p, 0)) == 0) {
+    circular_buffer *cb = (circular_buffer *) p;
+    unsigned int rp = cb->rp;
+    int remaining, itemsread;
+    if ((remaining = (int) (CB_LOAD(cb->wp) - rp)) == 0 || items <= 0) {
         return 0;
     }
     itemsread = items > remaining ? remaining : items;
-    for(i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-            rp = 0;
-        }
-    }
+    cb_copy_out(cb, (char *) out, rp, itemsread);
     return itemsread;
 }
 
@@ -121,25 +133,8 @@ void csoundFlushCircularBuffer(CSOUND *csound, void *p)
 {
     IGN(csound);
     if (p == NULL) return;
-    int remaining;
-    int itemsread, numelem = ((circular_buffer *)p)->numelem;
-    int i=0, rp = ((circular_buffer *)p)->rp;
-    //MYFLT *buffer = ((circular_buffer *)p)->buffer;
-    if ((remaining = checkspace(p, 0)) == 0) {
-        return;
-    }
-    itemsread = numelem > remaining ? remaining: numelem;
-    for (i=0; i < itemsread; i++){
-        rp++;
-        if(rp == numelem) rp = 0;
-    }
-#if defined(MSVC)
-      InterlockedExchange(&((circular_buffer *)p)->rp, rp);
-#elif defined(HAVE_ATOMIC_BUILTIN)
-      __atomic_store_n(&((circular_buffer *)p)->rp,rp, __ATOMIC_SEQ_CST);
-#else
-      ((circular_buffer *)p)->rp = rp;
-#endif
+    circular_buffer *cb = (circular_buffer *) p;
+    CB_STORE(cb->rp, CB_LOAD(cb->wp));
 }
 
 
@@ -147,27 +142,22 @@ int csoundWriteCircularBuffer(CSOUND *csound, void *p, const void *in, int items
 {
     IGN(csound);
     if (p == NULL) return 0;
-    int remaining;
-    int itemswrite, numelem = ((circular_buffer *)p)->numelem;
-    int elemsize = ((circular_buffer *)p)->elemsize;
-    int i=0, wp = ((circular_buffer *)p)->wp;
-    char *buffer = ((circular_buffer *)p)->buffer;
-    if ((remaining = checkspace(p, 1)) == 0) {
+    circular_buffer *cb = (circular_buffer *) p;
+    unsigned int wp = cb->wp, elemsize = cb->elemsize, start, first;
+    int remaining, itemswrite;
+    if ((remaining = (int) (cb->capacity - (wp - CB_LOAD(cb->rp)))) <= 0 ||
+        items <= 0) {
         return 0;
     }
     itemswrite = items > remaining ? remaining : items;
-    for(i=0; i < itemswrite; i++){
-        memcpy(&(buffer[elemsize * wp++]),
-                ((char *) in) + (i * elemsize),  elemsize);
-        if(wp == numelem) wp = 0;
-    }
-#if defined(MSVC)
-      InterlockedExchange(&((circular_buffer *)p)->wp, wp);
-#elif defined(HAVE_ATOMIC_BUILTIN)
-      __atomic_store_n(&((circular_buffer *)p)->wp,wp, __ATOMIC_SEQ_CST);
-#else
-      ((circular_buffer *)p)->wp = wp;
-#endif
+    start = wp & cb->mask;
+    first = cb->mask + 1 - start;
+    if (first > (unsigned int) itemswrite) first = itemswrite;
+    memcpy(cb->buffer + start * elemsize, in, first * elemsize);
+    if ((unsigned int) itemswrite > first)
+      memcpy(cb->buffer, (const char *) in + first * elemsize,
+             (itemswrite - first) * elemsize);
+    CB_STORE(cb->wp, wp + itemswrite);
     return itemswrite;
 }
 
@@ -60,18 +60,250 @@ static inline void alloc_globals(CSOUND *csound)
    audtran to flush when this happens.
 */
 
+/* Output post-processing.  The orchestra leaves a cycle's output in
+   spraw as nchnls blocks of ksmps samples, so each channel's samples are
+   contiguous: the peaks and the limiter run over each channel in turn,
+   and the output buffer is then filled with a blocked transpose that
+   also applies the 0dbfs scaling.  Both use SSE2 where it is available;
+   the per-sample maxpos and rngcnt bookkeeping is only revisited for
+   channels whose block peak actually needs it. */
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#ifndef USE_DOUBLE
+typedef __m128 spvec;
+#define SPV_N           4
+#define spv_load        _mm_loadu_ps
+#define spv_store       _mm_storeu_ps
+#define spv_set1        _mm_set1_ps
+#define spv_add         _mm_add_ps
+#define spv_mul         _mm_mul_ps
+#define spv_div         _mm_div_ps
+#define spv_max         _mm_max_ps
+#define spv_cmpge       _mm_cmpge_ps
+#define spv_cmple       _mm_cmple_ps
+#define spv_abs(x)      _mm_andnot_ps(_mm_set1_ps(-0.0f), (x))
+#define spv_sel(m,a,b)  _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+#else
+typedef __m128d spvec;
+#define SPV_N           2
+#define spv_load        _mm_loadu_pd
+#define spv_store       _mm_storeu_pd
+#define spv_set1        _mm_set1_pd
+#define spv_add         _mm_add_pd
+#define spv_mul         _mm_mul_pd
+#define spv_div         _mm_div_pd
+#define spv_max         _mm_max_pd
+#define spv_cmpge       _mm_cmpge_pd
+#define spv_cmple       _mm_cmple_pd
+#define spv_abs(x)      _mm_andnot_pd(_mm_set1_pd(-0.0), (x))
+#define spv_sel(m,a,b)  _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b))
+#endif
+#endif
+
+/* Interleave nframes frames from nchnls planar blocks that start stride
+   samples apart, multiplying by scale on the way.  The SSE2 version
+   transposes tiles of SPV_N channels by SPV_N frames in registers. */
+
+void interleave_frames(MYFLT *dst, const MYFLT *src, uint32_t nchnls,
+                       uint32_t nframes, uint32_t stride, MYFLT scale)
+{
+    uint32_t  c = 0, f = 0, k;
+    const MYFLT *s;
+
+    if (nchnls == 1) {
+#if defined(__SSE2__)
+      spvec vs = spv_set1(scale);
+      for (; f + SPV_N <= nframes; f += SPV_N)
+        spv_store(&dst[f], spv_mul(spv_load(&src[f]), vs));
+#endif
+      for (; f < nframes; f++)
+        dst[f] = src[f] * scale;
+      return;
+    }
+#if defined(__SSE2__)
+    {
+      spvec vs = spv_set1(scale);
+      for (; c + SPV_N <= nchnls; c += SPV_N) {
+        s = &src[c * stride];
+        for (f = 0; f + SPV_N <= nframes; f += SPV_N) {
+          MYFLT *d = &dst[f * nchnls + c];
+#ifndef USE_DOUBLE
+          __m128 r0 = _mm_mul_ps(_mm_loadu_ps(&s[f]), vs);
+          __m128 r1 = _mm_mul_ps(_mm_loadu_ps(&s[stride + f]), vs);
+          __m128 r2 = _mm_mul_ps(_mm_loadu_ps(&s[2 * stride + f]), vs);
+          __m128 r3 = _mm_mul_ps(_mm_loadu_ps(&s[3 * stride + f]), vs);
+          _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+          _mm_storeu_ps(d, r0);
+          _mm_storeu_ps(d + nchnls, r1);
+          _mm_storeu_ps(d + 2 * nchnls, r2);
+          _mm_storeu_ps(d + 3 * nchnls, r3);
+#else
+          __m128d r0 = _mm_mul_pd(_mm_loadu_pd(&s[f]), vs);
+          __m128d r1 = _mm_mul_pd(_mm_loadu_pd(&s[stride + f]), vs);
+          _mm_storeu_pd(d, _mm_unpacklo_pd(r0, r1));
+          _mm_storeu_pd(d + nchnls, _mm_unpackhi_pd(r0, r1));
+#endif
+        }
+        for (; f < nframes; f++)
+          for (k = 0; k < SPV_N; k++)
+            dst[f * nchnls + c + k] = s[k * stride + f] * scale;
+      }
+#ifndef USE_DOUBLE
+      /* a remaining pair of channels, e.g. plain stereo */
+      if (c + 2 <= nchnls) {
+        s = &src[c * stride];
+        for (f = 0; f + 4 <= nframes; f += 4) {
+          MYFLT  *d = &dst[f * nchnls + c];
+          __m128 r0 = _mm_mul_ps(_mm_loadu_ps(&s[f]), vs);
+          __m128 r1 = _mm_mul_ps(_mm_loadu_ps(&s[stride + f]), vs);
+          __m128 lo = _mm_unpacklo_ps(r0, r1), hi = _mm_unpackhi_ps(r0, r1);
+          _mm_storel_pi((__m64*) d, lo);
+          _mm_storeh_pi((__m64*) (d + nchnls), lo);
+          _mm_storel_pi((__m64*) (d + 2 * nchnls), hi);
+          _mm_storeh_pi((__m64*) (d + 3 * nchnls), hi);
+        }
+        for (; f < nframes; f++) {
+          dst[f * nchnls + c] = s[f] * scale;
+          dst[f * nchnls + c + 1] = s[stride + f] * scale;
+        }
+        c += 2;
+      }
+#endif
+    }
+#endif
+    for (; c < nchnls; c++) {
+      s = &src[c * stride];
+      for (f = 0; f < nframes; f++)
+        dst[f * nchnls + c] = s[f] * scale;
+    }
+}
+
+/* [7/6] Pade approximant of tanh, error below 2e-12 on [-1,1] */
+
+#define SPOUT_TANH_P(x2) \
+    (FL(135135.0) + x2 * (FL(17325.0) + x2 * (FL(378.0) + x2)))
+#define SPOUT_TANH_Q(x2) \
+    (FL(135135.0) + x2 * (FL(62370.0) + x2 * (FL(3150.0) + x2 * FL(28.0))))
+
+static inline MYFLT spout_tanh(MYFLT x)
+{
+    MYFLT x2 = x * x;
+    return x * SPOUT_TANH_P(x2) / SPOUT_TANH_Q(x2);
+}
+
+/* largest absolute value of n samples */
+
+static MYFLT spout_peak(const MYFLT *p, uint32_t n)
+{
+    uint32_t  i = 0;
+    MYFLT     a, peak = FL(0.0);
+#if defined(__SSE2__)
+    if (n >= SPV_N) {
+      spvec     pk = spv_set1(FL(0.0));
+      MYFLT     lanes[SPV_N];
+      uint32_t  l;
+      for (; i + SPV_N <= n; i += SPV_N)
+        pk = spv_max(spv_abs(spv_load(&p[i])), pk);
+      spv_store(lanes, pk);                 /* reduce across the lanes */
+      for (l = 0; l < SPV_N; l++)
+        if (lanes[l] > peak)
+          peak = lanes[l];
+    }
+#endif
+    for (; i < n; i++) {
+      a = FABS(p[i]);
+      if (a > peak)
+        peak = a;
+    }
+    return peak;
+}
+
+/* apply the soft limiter to n samples in place */
+
+static void spout_limit(MYFLT *sp, uint32_t n, MYFLT lim)
+{
+    uint32_t  i = 0;
+    MYFLT     x, rlim = FL(1.0) / lim;
+    MYFLT     lk1 = lim * (FL(1.0) / TANH(FL(1.0)));   /* lim * 1.31304 */
+#if defined(__SSE2__)
+    spvec vlim = spv_set1(lim), vnlim = spv_set1(-lim);
+    spvec vrlim = spv_set1(rlim), vlk1 = spv_set1(lk1);
+    for (; i + SPV_N <= n; i += SPV_N) {
+      spvec v = spv_load(&sp[i]);
+      spvec t = spv_mul(v, vrlim), t2 = spv_mul(t, t), y, q;
+      /* same Pade approximant as spout_tanh() */
+      y = spv_add(t2, spv_set1(FL(378.0)));
+      y = spv_add(spv_mul(t2, y), spv_set1(FL(17325.0)));
+      y = spv_add(spv_mul(t2, y), spv_set1(FL(135135.0)));
+      q = spv_add(spv_mul(t2, spv_set1(FL(28.0))), spv_set1(FL(3150.0)));
+      q = spv_add(spv_mul(t2, q), spv_set1(FL(62370.0)));
+      q = spv_add(spv_mul(t2, q), spv_set1(FL(135135.0)));
+      y = spv_mul(vlk1, spv_div(spv_mul(t, y), q));
+      y = spv_sel(spv_cmpge(v, vlim), vlim, y);
+      y = spv_sel(spv_cmple(v, vnlim), vnlim, y);
+      spv_store(&sp[i], y);
+    }
+#endif
+    for (; i < n; i++) {
+      x = sp[i];
+      if (UNLIKELY(x >= lim))
+        x = lim;
+      else if (UNLIKELY(x <= -lim))
+        x = -lim;
+      else
+        x = lk1 * spout_tanh(x * rlim);
+      sp[i] = x;
+    }
+}
+
+/* Track the peaks of nf frames of spraw starting at frame f0, which is
+   frame number 'frame' of the performance, limit them if lim is non-zero
+   and write them scaled and interleaved to out, unless that is NULL. */
+
+static void spout_frames(CSOUND *csound, uint32_t f0, uint32_t nf,
+                         uint32 frame, MYFLT *out, MYFLT lim, MYFLT scale,
+                         int rngchk)
+{
+    uint32_t  nch = csound->nchnls, stride = csound->ksmps, c, f;
+    MYFLT     *p, peak;
+
+    for (c = 0; c < nch; c++) {
+      p = &csound->spraw[c * stride + f0];
+      peak = spout_peak(p, nf);
+      if (peak > csound->maxamp[c]) {       /*  maxamp this seg  */
+        /* the first occurrence is what a per-sample scan finds */
+        for (f = 0; FABS(p[f]) != peak; f++)
+          ;
+        csound->maxamp[c] = peak;
+        csound->maxpos[c] = frame + f;
+      }
+      if (rngchk && peak > csound->e0dbfs) { /* out of range?     */
+        for (f = 0; f < nf; f++)
+          if (FABS(p[f]) > csound->e0dbfs)
+            csound->rngcnt[c]++;            /*  report it        */
+        csound->rngflg = 1;
+      }
+      // Out of range is reported on the samples before the built-in
+      // limiter, while the limited values are passed to the output.
+      if (lim != FL(0.0))
+        spout_limit(p, nf, lim);
+    }
+    if (out != NULL)
+      interleave_frames(out, &csound->spraw[f0], nch, nf, stride, scale);
+}
+
+/* outbufsamps and nspout are both whole numbers of frames, so the
+   output buffer always fills up at a frame boundary */
+
 static void spoutsf(CSOUND *csound)
 {
     OPARMS  *O = csound->oparms;
-    uint32_t   chn = 0;
+    uint32_t f0 = 0, nf;
     int     n;
     int spoutrem = csound->nspout;
-    MYFLT   *sp = csound->spout;
-    MYFLT   absamp = FL(0.0);
     uint32  nframes = csound->libsndStatics.nframes;
-    MYFLT lim = O->limiter*csound->e0dbfs;
-    MYFLT rlim = lim==0 ? 0 : FL(1.0)/lim;
-    MYFLT k1 = FL(1.0)/TANH(FL(1.0)); /*  1.31304 */
+    MYFLT lim = (O->limiter ? O->limiter*csound->e0dbfs : FL(0.0));
  nchk:
     /* if nspout remaining > buf rem, prepare to send in parts */
     if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem) {
@@ -79,53 +311,15 @@ static void spoutsf(CSOUND *csound)
     }
     spoutrem -= n;
     csound->libsndStatics.outbufrem -= n;
-    do {
-      // built inlimiter start ****
-      // There is a rather awkward problem in reporting out of range not being
-      // confused by the limited value but passing the clipped values to the
-      // output.  Current solution is nasty and should be easier
-      if (O->limiter) {
-        MYFLT x = *sp;
-        absamp = x;
-        if (UNLIKELY(x>=lim))
-          x = lim;
-        else if (UNLIKELY(x<= -lim))
-          x = -lim;
-        else
-          x = lim*k1*TANH(x*rlim);
-        //printf("*** %g -> %g\n", *(sp-1), x);
-        *sp++ = x;
-        if (csound->libsndStatics.osfopen) {
-          *csound->libsndStatics.outbufp++ = (x * csound->dbfs_to_float);
-        }
-      }
-      // limiter end ****
-      else {
-        absamp = *sp++;
-        if (csound->libsndStatics.osfopen) {
-          *csound->libsndStatics.outbufp++ = (absamp * csound->dbfs_to_float);
-        }
-      }
-      if (absamp < FL(0.0)) {
-        absamp = -absamp;
-      }
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-         csound->maxpos[chn] = nframes;
-      }
-      if (absamp > csound->e0dbfs) {        /* out of range?     */
-        csound->rngcnt[chn]++;              /*  report it        */
-        csound->rngflg = 1;
-      }
-      if (csound->multichan) {
-        if (++chn >= csound->nchnls) {
-            chn = 0;
-            nframes++;
-        }
-      } else {
-        nframes++;
-      }
-    } while (--n);
+    nf = (uint32_t) n / csound->nchnls;
+    spout_frames(csound, f0, nf, nframes,
+                 (csound->libsndStatics.osfopen ?
+                  csound->libsndStatics.outbufp : NULL),
+                 lim, csound->dbfs_to_float, 1);
+    f0 += nf;
+    nframes += nf;
+    if (csound->libsndStatics.osfopen)
+      csound->libsndStatics.outbufp += n;
     if (!csound->libsndStatics.outbufrem) {
       if (csound->libsndStatics.osfopen) {
         csound->nrecs++;
@@ -145,10 +339,8 @@ static void spoutsf(CSOUND *csound)
 
 static void spoutsf_noscale(CSOUND *csound)
 {
-    uint32_t chn = 0;
+    uint32_t f0 = 0, nf;
     int      n, spoutrem = csound->nspout;
-    MYFLT    *sp = csound->spout;
-    MYFLT    absamp = FL(0.0);
     uint32   nframes = csound->libsndStatics.nframes;
 
  nchk:
@@ -157,19 +349,15 @@ static void spoutsf_noscale(CSOUND *csound)
       n = (int)csound->libsndStatics.outbufrem;
     spoutrem -= n;
     csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen)
-        *csound->libsndStatics.outbufp++ = absamp;
-      if (absamp < FL(0.0))
-        absamp = -absamp;
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (++chn >= csound->nchnls)
-        chn = 0, nframes++;
-    } while (--n);
+    nf = (uint32_t) n / csound->nchnls;
+    spout_frames(csound, f0, nf, nframes,
+                 (csound->libsndStatics.osfopen ?
+                  csound->libsndStatics.outbufp : NULL),
+                 FL(0.0), FL(1.0), 0);
+    f0 += nf;
+    nframes += nf;
+    if (csound->libsndStatics.osfopen)
+      csound->libsndStatics.outbufp += n;
 
     if (!csound->libsndStatics.outbufrem) {
       if (csound->libsndStatics.osfopen) {
@@ -184,59 +372,14 @@ static void spoutsf_noscale(CSOUND *csound)
     csound->libsndStatics.nframes = nframes;
 }
 
-/* diskfile write option for audtran's */
-/*      assigned during sfopenout()    */
+/* triangular or rectangular dither noise added before writing integer */
+/* formats; the generator state is kept in STA(dither)                  */
 
-static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
-{
-    OPARMS  *O = csound->oparms;
-    int     n;
+typedef void (*SF_DITHER)(CSOUND *, MYFLT *, int);
 
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader((void *)STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", "\a");
-        break;
-    }
-}
-
-static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void dither_tri(CSOUND *csound, MYFLT *buf, int m, MYFLT scale)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int    dith;
-
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    dith = STA(dither);
+    int   n, dith = STA(dither);
     for (n=0; n<m; n++) {
       int   tmp = ((dith * 15625) + 1) & 0xFFFF;
       int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
@@ -244,123 +387,205 @@ static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
       dith = rnd;
       rnd = (rnd+tmp)>>1;           /* triangular distribution */
       result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
+      result /= scale;
       buf[n] += result;
     }
     STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
 }
 
-static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void dither_rect(CSOUND *csound, MYFLT *buf, int m, MYFLT scale)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
-
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    dith = STA(dither);
+    int   n, dith = STA(dither);
     for (n=0; n<m; n++) {
-      int   tmp = ((dith * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
+      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
       MYFLT result;
-      dith = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
+      dith =  rnd;
       result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
+      result /= scale;
       buf[n] += result;
     }
     STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
+}
+
+static void dither_16(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_tri(csound, buf, m, (MYFLT) 0x7fff);
+}
+
+static void dither_8(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_tri(csound, buf, m, (MYFLT) 0x7f);
+}
+
+static void dither_u16(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_rect(csound, buf, m, (MYFLT) 0x7fff);
+}
+
+static void dither_u8(CSOUND *csound, MYFLT *buf, int m)
+{
+    dither_rect(csound, buf, m, (MYFLT) 0x7f);
+}
+
+/* dither and write one buffer, returns the number of bytes written */
+
+static int sf_write_block(CSOUND *csound, MYFLT *buf, int nbytes,
+                          SF_DITHER dither)
+{
+    int     n;
+
+    if (dither != NULL)
+      dither(csound, buf, nbytes / (int) sizeof(MYFLT));
+    n = (int) sf_write_MYFLT(STA(outfile), buf,
                              nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
+    if (UNLIKELY(csound->oparms->rewrt_hdr))
+      rewriteheader((void *)STA(outfile));
+    return n;
+}
+
+/* Background writer for sound files (--sfwrite-queue=N).  The engine
+   fills one of N buffers while the writer thread dithers and writes the
+   ones queued before it.  wp and rp are free running buffer counts: the
+   buffers rp .. wp-1 are queued, and buffer wp is being filled, so the
+   engine has to wait for room when wp - rp reaches N - 1.  Write errors
+   are only recorded by the writer and reported on the engine thread. */
+
+typedef struct {
+    void          *thread;
+    void          *wake;            /* notified when a buffer is queued */
+    void          *room;            /* notified when a buffer is free   */
+    MYFLT         **bufs;
+    int           *nbytes;
+    SF_DITHER     *dither;
+    long          depth;
+    volatile long wp, rp;
+    volatile long quit;
+    volatile long nret, nput;       /* first failed write, if any       */
+    long          stalls;           /* times the engine had to wait     */
+} SFWRITER;
+
+static uintptr_t sfwriter_thread(void *userData)
+{
+    CSOUND    *csound = (CSOUND*) userData;
+    SFWRITER  *w = (SFWRITER*) STA(sfwriter);
+    long      rp = w->rp, i;
+    int       n;
+
+    for (;;) {
+      if (rp == ATOMIC_GET(w->wp)) {
+        if (ATOMIC_GET(w->quit) && rp == ATOMIC_GET(w->wp))
+          break;
+        csound->WaitThreadLockNoTimeout(w->wake);
+        continue;
+      }
+      i = rp % w->depth;
+      if (LIKELY(w->nput == 0)) {     /* after an error just drain */
+        n = sf_write_block(csound, w->bufs[i], w->nbytes[i], w->dither[i]);
+        if (UNLIKELY(n < w->nbytes[i])) {
+          w->nret = n;
+          ATOMIC_SET(w->nput, w->nbytes[i]);
         }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
+      }
+      rp++;
+      ATOMIC_SET(w->rp, rp);
+      csound->NotifyThreadLock(w->room);
     }
+    return 0;
 }
 
-static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void sfwriter_start(CSOUND *csound, int depth)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
+    SFWRITER  *w;
+    long      i;
+
+    w = (SFWRITER*) csound->Calloc(csound, sizeof(SFWRITER));
+    w->depth = depth;
+    w->bufs = (MYFLT**) csound->Calloc(csound, depth*sizeof(MYFLT*));
+    w->nbytes = (int*) csound->Calloc(csound, depth*sizeof(int));
+    w->dither = (SF_DITHER*) csound->Calloc(csound, depth*sizeof(SF_DITHER));
+    w->bufs[0] = STA(outbuf);
+    for (i = 1; i < depth; i++)
+      w->bufs[i] = (MYFLT*) csound->Malloc(csound, STA(outbufsiz));
+    w->wake = csound->CreateThreadLock();
+    w->room = csound->CreateThreadLock();
+    STA(sfwriter) = w;
+    if (w->wake != NULL && w->room != NULL)
+      w->thread = csound->CreateThread(sfwriter_thread, (void*) csound);
+    if (UNLIKELY(w->wake == NULL || w->room == NULL || w->thread == NULL)) {
+      csound->Warning(csound, Str("could not start sound file writer thread, "
+                                  "writing on the performance thread"));
+      STA(sfwriter) = NULL;
+      csound->DestroyThreadLock(w->wake);
+      csound->DestroyThreadLock(w->room);
+      for (i = 1; i < depth; i++)
+        csound->Free(csound, w->bufs[i]);
+      csound->Free(csound, w->bufs);
+      csound->Free(csound, w->nbytes);
+      csound->Free(csound, w->dither);
+      csound->Free(csound, w);
+    }
+}
 
-    if (UNLIKELY(STA(outfile) == NULL))
+/* wait for the queue to drain and stop the writer thread */
+
+static void sfwriter_stop(CSOUND *csound)
+{
+    SFWRITER  *w = (SFWRITER*) STA(sfwriter);
+    long      i;
+    int       nret, nput;
+
+    ATOMIC_SET(w->quit, 1);
+    csound->NotifyThreadLock(w->wake);
+    csound->JoinThread(w->thread);
+    nret = (int) w->nret;
+    nput = (int) w->nput;
+    STA(sfwriter) = NULL;
+    csound->Message(csound, Str("sound file writer: %ld buffers queued, "
+                                "%ld stalls waiting for the disk\n"),
+                    w->wp, w->stalls);
+    csound->DestroyThreadLock(w->wake);
+    csound->DestroyThreadLock(w->room);
+    for (i = 0; i < w->depth; i++)
+      if (w->bufs[i] != STA(outbuf))
+        csound->Free(csound, w->bufs[i]);
+    csound->Free(csound, w->bufs);
+    csound->Free(csound, w->nbytes);
+    csound->Free(csound, w->dither);
+    csound->Free(csound, w);
+    if (UNLIKELY(nput != 0))
+      sndwrterr(csound, nret, nput);
+}
+
+/* queue the buffer being filled and move on to the next free one */
+
+static void sfwriter_push(CSOUND *csound, int nbytes, SF_DITHER dither)
+{
+    SFWRITER  *w = (SFWRITER*) STA(sfwriter);
+    long      wp = w->wp;
+
+    if (UNLIKELY(ATOMIC_GET(w->nput) != 0)) {
+      sfwriter_stop(csound);        /* reports the error and dies */
       return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      dith =  rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
-      buf[n] += result;
     }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
+    w->nbytes[wp % w->depth] = nbytes;
+    w->dither[wp % w->depth] = dither;
+    wp++;
+    ATOMIC_SET(w->wp, wp);
+    csound->NotifyThreadLock(w->wake);
+    if (UNLIKELY(wp - ATOMIC_GET(w->rp) >= w->depth)) {
+      w->stalls++;
+      do {
+        csound->WaitThreadLockNoTimeout(w->room);
+      } while (wp - ATOMIC_GET(w->rp) >= w->depth);
+    }
+    STA(outbuf) = w->bufs[wp % w->depth];
+}
+
+static void sf_heartbeat(CSOUND *csound)
+{
+    int     n;
+
+    switch (csound->oparms->heartbeat) {
       case 1:
         csound->MessageS(csound, CSOUNDMSG_REALTIME,
                                  "%c\010", "|/-\\"[csound->nrecs & 3]);
@@ -381,61 +606,54 @@ static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
         }
         break;
       case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  "\a");
+        csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", "\a");
         break;
     }
 }
 
-static void writesf_dither_u8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static inline void writesf_(CSOUND *csound, const MYFLT *outbuf, int nbytes,
+                            SF_DITHER dither)
 {
-    OPARMS  *O = csound->oparms;
     int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
+    if (STA(sfwriter) != NULL)
+      sfwriter_push(csound, nbytes, dither);
+    else {
+      n = sf_write_block(csound, (MYFLT*) outbuf, nbytes, dither);
+      if (UNLIKELY(n < nbytes))
+        sndwrterr(csound, n, nbytes);
     }
+    sf_heartbeat(csound);
+}
+
+/* diskfile write option for audtran's */
+/*      assigned during sfopenout()    */
+
+static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    writesf_(csound, outbuf, nbytes, NULL);
+}
+
+static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    writesf_(csound, outbuf, nbytes, dither_16);
+}
+
+static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    writesf_(csound, outbuf, nbytes, dither_8);
+}
+
+static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    writesf_(csound, outbuf, nbytes, dither_u16);
+}
+
+static void writesf_dither_u8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    writesf_(csound, outbuf, nbytes, dither_u8);
 }
 
 static int readsf(CSOUND *csound, MYFLT *inbuf, int inbufsize)
@@ -931,6 +1149,8 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
     }
     STA(osfopen)   = 1;
     STA(outbufrem) = O->outbufsamps;
+    if (O->sfWriteQueue >= 2 && STA(pipdevout) != 2 && STA(outfile) != NULL)
+      sfwriter_start(csound, O->sfWriteQueue);
 }
 
 void sfclosein(CSOUND *csound)
@@ -969,6 +1189,8 @@ void sfcloseout(CSOUND *csound)
       csound->nrecs++;
       csound->audtran(csound, STA(outbuf), nb);
     }
+    if (STA(sfwriter) != NULL)
+      sfwriter_stop(csound);
     if (STA(pipdevout) == 2 && (!STA(isfopen) || STA(pipdevin) != 2)) {
       /* close only if not open for input too */
       csound->rtclose_callback(csound);
@@ -95,7 +95,13 @@ static int sreadin(CSOUND *csound, SNDFILE *infd, MYFLT *inbuf,
 {
     /* return the number of samples read */
     int   n, ntot = 0;
-    do {
+    if (p->sc != NULL) {
+      ntot = sndcache_read(csound, p->sc, inbuf, p->cachepos,
+                           nsamples / p->nchanls);
+      p->cachepos += ntot;
+      ntot *= p->nchanls;
+    }
+    else do {
       n = sf_read_MYFLT(infd, inbuf + ntot, nsamples - ntot);
       if (UNLIKELY(n < 0))
         csound->Die(csound, Str("soundfile read error"));
@@ -194,6 +200,9 @@ void *sndgetset(CSOUND *csound, void *p_)
     }
     p->audrem = (int64_t) sfinfo.frames * (int64_t) sfinfo.channels;
     p->framesrem = (int64_t) sfinfo.frames;         /*   find frames rem */
+    /* GEN01 shares decoded data with diskin2 through the sample cache */
+    p->sc = (p->usecache ? sndcache_open(csound, p->fd, &sfinfo) : NULL);
+    p->cachepos = 0;
     skipframes = (int) ((double) p->skiptime * (double) p->sr
                         + (p->skiptime >= FL(0.0) ? 0.5 : -0.5));
     if (skipframes < 0) {
@@ -231,7 +240,10 @@ void *sndgetset(CSOUND *csound, void *p_)
     }
     else {                                      /* for greater skiptime: */
       /* else seek to bndry */
-      if (UNLIKELY(sf_seek(p->sinfd, (sf_count_t) skipframes, SEEK_SET) < 0)) {
+      if (p->sc != NULL)
+        p->cachepos = skipframes;
+      else if (UNLIKELY(sf_seek(p->sinfd, (sf_count_t) skipframes,
+                                SEEK_SET) < 0)) {
         csound->ErrorMsg(csound, Str("soundin seek error"));
         goto err_return;
       }
@@ -247,6 +259,9 @@ void *sndgetset(CSOUND *csound, void *p_)
     return p->sinfd;                            /* return the active fd  */
 
  err_return:
+    if (p->sc != NULL)
+      sndcache_close(csound, p->sc);
+    p->sc = NULL;
     if (p->fd != NULL)
       csound->FileClose(csound, p->fd);
     p->sinfd = NULL;
@@ -54,6 +54,9 @@
 #include <signal.h>
 #include <sys/mman.h>
 #include <sys/resource.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
 #include "soundio.h"
@@ -116,6 +119,8 @@ typedef struct devparams_ {
     /* record sample conversion function */
     void            (*rec_conv)(int, void *, MYFLT *);
     int             seed;           /* random seed for dithering        */
+    int             mmap;           /* non-zero if using mmap access    */
+    int             frameSize;      /* device sample frame size (bytes) */
 } DEVPARAMS;
 
 #ifdef BUF_SIZE
@@ -191,17 +196,60 @@ int set_scheduler_priority(CSOUND *csound, int priority)
 
 /* sample conversion routines for playback */
 
-static void MYFLT_to_short(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
+/* The integer converters work on whole blocks: the dither generator is
+   inherently serial, so it is run ahead into a block of noise values,
+   and the scaling, clamping and rounding is then done four or eight
+   samples at a time with SSE2 where available.  The SSE2 conversions
+   round to nearest like lrint() does, so both paths give the same
+   result. */
+
+#define DITHER_BLOCK    (256)
+
+static void short_block(int nSmps, const MYFLT *inBuf, int16_t *outBuf,
+                        const MYFLT *noise)
 {
     MYFLT tmp_f;
     int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = (((rnd) * 15625) + 1) & 0xFFFF;
-      rnd += *seed;           /* triangular distribution */
-      tmp_f = (MYFLT) ((rnd>>1) - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
+    int   n = 0;
+#if defined(__SSE2__)
+#ifndef USE_DOUBLE
+    const __m128 scl = _mm_set1_ps(32768.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f), hi = _mm_set1_ps(32767.0f);
+    for (; n+8<=nSmps; n+=8) {
+      __m128 x0 = _mm_mul_ps(_mm_loadu_ps(&inBuf[n]), scl);
+      __m128 x1 = _mm_mul_ps(_mm_loadu_ps(&inBuf[n+4]), scl);
+      if (noise != NULL) {
+        x0 = _mm_add_ps(x0, _mm_loadu_ps(&noise[n]));
+        x1 = _mm_add_ps(x1, _mm_loadu_ps(&noise[n+4]));
+      }
+      x0 = _mm_min_ps(_mm_max_ps(x0, lo), hi);
+      x1 = _mm_min_ps(_mm_max_ps(x1, lo), hi);
+      _mm_storeu_si128((__m128i*) &outBuf[n],
+                       _mm_packs_epi32(_mm_cvtps_epi32(x0),
+                                       _mm_cvtps_epi32(x1)));
+    }
+#else
+    const __m128d scl = _mm_set1_pd(32768.0);
+    const __m128d lo = _mm_set1_pd(-32768.0), hi = _mm_set1_pd(32767.0);
+    for (; n+4<=nSmps; n+=4) {
+      __m128d x0 = _mm_mul_pd(_mm_loadu_pd(&inBuf[n]), scl);
+      __m128d x1 = _mm_mul_pd(_mm_loadu_pd(&inBuf[n+2]), scl);
+      __m128i i0;
+      if (noise != NULL) {
+        x0 = _mm_add_pd(x0, _mm_loadu_pd(&noise[n]));
+        x1 = _mm_add_pd(x1, _mm_loadu_pd(&noise[n+2]));
+      }
+      x0 = _mm_min_pd(_mm_max_pd(x0, lo), hi);
+      x1 = _mm_min_pd(_mm_max_pd(x1, lo), hi);
+      i0 = _mm_unpacklo_epi64(_mm_cvtpd_epi32(x0), _mm_cvtpd_epi32(x1));
+      _mm_storel_epi64((__m128i*) &outBuf[n], _mm_packs_epi32(i0, i0));
+    }
+#endif
+#endif
+    for (; n<nSmps; n++) {
+      tmp_f = inBuf[n] * (MYFLT) 0x8000;
+      if (noise != NULL)
+        tmp_f += noise[n];
 #ifndef USE_DOUBLE
       tmp_i = (int) lrintf(tmp_f);
 #else
@@ -213,54 +261,75 @@ static void MYFLT_to_short(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
     }
 }
 
+static void MYFLT_to_short(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
+{
+    MYFLT noise[DITHER_BLOCK];
+    int   n, m, cnt, s = *seed;
+    for (m=0; m<nSmps; m+=cnt) {
+      cnt = (nSmps - m < DITHER_BLOCK ? nSmps - m : DITHER_BLOCK);
+      for (n=0; n<cnt; n++) {
+        int rnd = ((s * 15625) + 1) & 0xFFFF;
+        s = ((rnd * 15625) + 1) & 0xFFFF;
+        rnd += s;             /* triangular distribution */
+        noise[n] = (MYFLT) ((rnd>>1) - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
+      }
+      short_block(cnt, &inBuf[m], &outBuf[m], noise);
+    }
+    *seed = s;
+}
+
 static void MYFLT_to_short_u(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
 {
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
-      *seed = rnd;
-      tmp_f = (MYFLT) (rnd - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
-      tmp_f += inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
+    MYFLT noise[DITHER_BLOCK];
+    int   n, m, cnt, s = *seed;
+    for (m=0; m<nSmps; m+=cnt) {
+      cnt = (nSmps - m < DITHER_BLOCK ? nSmps - m : DITHER_BLOCK);
+      for (n=0; n<cnt; n++) {
+        s = ((s * 15625) + 1) & 0xFFFF;
+        noise[n] = (MYFLT) (s - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
+      }
+      short_block(cnt, &inBuf[m], &outBuf[m], noise);
     }
+    *seed = s;
 }
 
 static void MYFLT_to_short_no_dither(int nSmps, MYFLT *inBuf,
                                      int16_t *outBuf, int *seed)
 {
-  IGN(seed);
-    MYFLT tmp_f;
-    int   tmp_i;
-    int n;
-    for (n=0; n<nSmps; n++) {
-      tmp_f = inBuf[n] * (MYFLT) 0x8000;
-#ifndef USE_DOUBLE
-      tmp_i = (int) lrintf(tmp_f);
-#else
-      tmp_i = (int) lrint(tmp_f);
-#endif
-      if (tmp_i < -0x8000) tmp_i = -0x8000;
-      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
-      outBuf[n] = (int16_t) tmp_i;
-    }
+    IGN(seed);
+    short_block(nSmps, inBuf, outBuf, NULL);
 }
 
 static void MYFLT_to_long(int nSmps, MYFLT *inBuf, int32_t *outBuf, int *seed)
 {
     MYFLT   tmp_f;
     int64_t tmp_i;
+    int     n = 0;
     (void) seed;
-    int n;
-    for (n=0; n<nSmps; n++) {
+#if defined(__SSE2__)
+#ifndef USE_DOUBLE
+    /* 2^31 is not representable as int32_t and converts to 0x80000000, */
+    /* so positive overflows are flipped to 0x7FFFFFFF afterwards        */
+    const __m128 scl = _mm_set1_ps(2147483648.0f);
+    const __m128 lo = _mm_set1_ps(-2147483648.0f);
+    for (; n+4<=nSmps; n+=4) {
+      __m128  x = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(&inBuf[n]), scl), lo);
+      __m128i ovf = _mm_castps_si128(_mm_cmpge_ps(x, scl));
+      _mm_storeu_si128((__m128i*) &outBuf[n],
+                       _mm_xor_si128(_mm_cvtps_epi32(x), ovf));
+    }
+#else
+    const __m128d scl = _mm_set1_pd(2147483648.0);
+    const __m128d lo = _mm_set1_pd(-2147483648.0);
+    const __m128d hi = _mm_set1_pd(2147483647.0);
+    for (; n+2<=nSmps; n+=2) {
+      __m128d x = _mm_mul_pd(_mm_loadu_pd(&inBuf[n]), scl);
+      x = _mm_min_pd(_mm_max_pd(x, lo), hi);
+      _mm_storel_epi64((__m128i*) &outBuf[n], _mm_cvtpd_epi32(x));
+    }
+#endif
+#endif
+    for (; n<nSmps; n++) {
       tmp_f = inBuf[n] * (MYFLT) 0x80000000UL;
 #ifndef USE_DOUBLE
       tmp_i = (int64_t) llrintf(tmp_f);
@@ -432,11 +501,18 @@ static int set_device_params(CSOUND *csound, DEVPARAMS *dev, int play)
     /*=========================*/
 
     /* now set the various hardware parameters: */
-    /* access method, */
-    if (UNLIKELY(snd_pcm_hw_params_set_access(dev->handle, hw_params,
-                                              SND_PCM_ACCESS_RW_INTERLEAVED) < 0)) {
-      strNcpy(msg, Str("Error setting access type for soundcard"), MSGLEN);
-      goto err_return_msg;
+    /* access method: prefer mmap, so that samples can be converted */
+    /* straight into the DMA area, and fall back to read/write       */
+    dev->mmap = 1;
+    if (snd_pcm_hw_params_set_access(dev->handle, hw_params,
+                                     SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0) {
+      dev->mmap = 0;
+      if (UNLIKELY(snd_pcm_hw_params_set_access(dev->handle, hw_params,
+                                                SND_PCM_ACCESS_RW_INTERLEAVED)
+                   < 0)) {
+        strNcpy(msg, Str("Error setting access type for soundcard"), MSGLEN);
+        goto err_return_msg;
+      }
     }
     /* sample format, */
     alsaFmt = SND_PCM_FORMAT_UNKNOWN;
@@ -544,9 +620,10 @@ static int set_device_params(CSOUND *csound, DEVPARAMS *dev, int play)
     /* print settings */
 
     if (p->GetMessageLevel(p) != 0)
-      p->Message(p, Str("ALSA %s: total buffer size: %d, period size: %d\n"),
+      p->Message(p, Str("ALSA %s: total buffer size: %d, period size: %d%s\n"),
                  (play ? "output" : "input"),
-                 dev->buffer_smps, dev->period_smps /*, dev->srate*/);
+                 dev->buffer_smps, dev->period_smps /*, dev->srate*/,
+                 (dev->mmap ? " (mmap)" : ""));
     /* now set software parameters */
     n = (play ? dev->buffer_smps : 1);
     if (UNLIKELY(snd_pcm_sw_params_current(dev->handle, sw_params) < 0 ||
@@ -560,8 +637,12 @@ static int set_device_params(CSOUND *csound, DEVPARAMS *dev, int play)
               Str("Error setting software parameters for real-time audio"),MSGLEN);
       goto err_return_msg;
     }
+    dev->frameSize = (dev->format == AE_SHORT ? 2 : 4) * dev->nchns;
+    /* no conversion buffer is needed with mmap access */
+    if (dev->mmap)
+      return 0;
     /* allocate memory for sample conversion buffer */
-    n = (dev->format == AE_SHORT ? 2 : 4) * dev->nchns * alloc_smps;
+    n = dev->frameSize * alloc_smps;
     dev->buf = (void*) csound->Malloc(csound, (size_t) n);
     if (UNLIKELY(dev->buf == NULL)) {
       strNcpy(msg, Str("Memory allocation failure"),MSGLEN);
@@ -750,6 +831,104 @@ static int playopen_(CSOUND *csound, const csRtAudioParams *parm)
         csound->Warning(csound, Str(x));                  \
   }
 
+/* try to recover from an I/O error, returns zero on success */
+
+static int xrun_recover(CSOUND *csound, DEVPARAMS *dev, int err, int play)
+{
+    if (err == -EPIPE) {
+      /* buffer underrun / overrun */
+      if (play) {
+        warning(Str("Buffer underrun in real-time audio output"));
+      }
+      else {
+        warning(Str("Buffer overrun in real-time audio input"));
+      }
+      if (snd_pcm_prepare(dev->handle) >= 0) return 0;
+    }
+    else if (err == -ESTRPIPE) {
+      /* suspend */
+      if (play) {
+        warning(Str("Real-time audio output suspended"));
+      }
+      else {
+        warning(Str("Real-time audio input suspended"));
+      }
+      while (snd_pcm_resume(dev->handle) == -EAGAIN) sleep(1);
+      if (snd_pcm_prepare(dev->handle) >= 0) return 0;
+    }
+    /* could not recover from error */
+    if (play)
+      csound->ErrorMsg(csound,
+                       Str("Error writing data to audio output device"));
+    else
+      csound->ErrorMsg(csound,
+                       Str("Error reading data from audio input device"));
+    snd_pcm_close(dev->handle);
+    dev->handle = NULL;
+    return -1;
+}
+
+/* transfer n sample frames through the mmap area, converting directly */
+/* between 'buf' and the device; returns the number of frames done     */
+
+static int mmap_transfer(CSOUND *csound, DEVPARAMS *dev, MYFLT *buf,
+                         int n, int play)
+{
+    const snd_pcm_channel_area_t  *areas;
+    snd_pcm_uframes_t             offset, frames;
+    snd_pcm_sframes_t             avail, done;
+    int                           err, m = 0;
+
+    while (n) {
+      /* with mmap access capture has to be started explicitly */
+      if (!play && snd_pcm_state(dev->handle) == SND_PCM_STATE_PREPARED) {
+        if (UNLIKELY((err = snd_pcm_start(dev->handle)) < 0))
+          goto xrun;
+      }
+      avail = snd_pcm_avail_update(dev->handle);
+      if (UNLIKELY(avail < 0)) {
+        err = (int) avail;
+        goto xrun;
+      }
+      if (avail < (snd_pcm_sframes_t) n &&
+          avail < (snd_pcm_sframes_t) dev->period_smps) {
+        if (play && snd_pcm_state(dev->handle) == SND_PCM_STATE_PREPARED) {
+          /* the buffer is as full as it gets, so start playing */
+          if (UNLIKELY((err = snd_pcm_start(dev->handle)) < 0))
+            goto xrun;
+        }
+        else if (UNLIKELY((err = snd_pcm_wait(dev->handle, 1000)) < 0))
+          goto xrun;
+        continue;
+      }
+      frames = (snd_pcm_uframes_t) (avail < n ? avail : n);
+      if (UNLIKELY((err = snd_pcm_mmap_begin(dev->handle, &areas,
+                                             &offset, &frames)) < 0))
+        goto xrun;
+      {
+        /* interleaved access: one area describes all channels */
+        void  *addr = (char*) areas[0].addr + (areas[0].first >> 3)
+                      + offset * (size_t) dev->frameSize;
+        if (play)
+          dev->playconv((int) frames * dev->nchns, buf, addr, &(dev->seed));
+        else
+          dev->rec_conv((int) frames * dev->nchns, addr, buf);
+      }
+      done = snd_pcm_mmap_commit(dev->handle, offset, frames);
+      if (UNLIKELY(done < 0 || (snd_pcm_uframes_t) done != frames)) {
+        err = (done < 0 ? (int) done : -EPIPE);
+        goto xrun;
+      }
+      buf += (int) frames * dev->nchns;
+      n -= (int) frames; m += (int) frames;
+      continue;
+ xrun:
+      if (xrun_recover(csound, dev, err, play) != 0)
+        break;
+    }
+    return m;
+}
+
 static int rtrecord_(CSOUND *csound, MYFLT *inbuf, int nbytes)
 {
     DEVPARAMS *dev;
@@ -764,30 +943,21 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf, int nbytes)
     /* calculate the number of samples to record */
     n = nbytes / dev->sampleSize;
 
+    if (dev->mmap) {
+      m = mmap_transfer(csound, dev, inbuf, n, 0);
+      return (m * dev->sampleSize);
+    }
     m = 0;
     while (n) {
-      err = (int) snd_pcm_readi(dev->handle, dev->buf, (snd_pcm_uframes_t) n);
+      err = (int) snd_pcm_readi(dev->handle,
+                                (char*) dev->buf + m * dev->frameSize,
+                                (snd_pcm_uframes_t) n);
       if (err >= 0) {
         n -= err; m += err; continue;
       }
       /* handle I/O errors */
-      if (UNLIKELY(err == -EPIPE)) {
-        /* buffer underrun */
-        warning(Str("Buffer overrun in real-time audio input"));     /* complain */
-        if (snd_pcm_prepare(dev->handle) >= 0) continue;
-      }
-      else if (err == -ESTRPIPE) {
-        /* suspend */
-        warning(Str("Real-time audio input suspended"));
-        while (snd_pcm_resume(dev->handle) == -EAGAIN) sleep(1);
-        if (snd_pcm_prepare(dev->handle) >= 0) continue;
-      }
-      /* could not recover from error */
-      csound->ErrorMsg(csound,
-                       Str("Error reading data from audio input device"));
-      snd_pcm_close(dev->handle);
-      dev->handle = NULL;
-      break;
+      if (xrun_recover(csound, dev, err, 0) != 0)
+        break;
     }
     /* convert samples to MYFLT */
     dev->rec_conv(m * dev->nchns, dev->buf, inbuf);
@@ -799,7 +969,7 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf, int nbytes)
 static void rtplay_(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
     DEVPARAMS *dev;
-    int     n, err;
+    int     n, m, err;
 
     dev = (DEVPARAMS*) *(csound->GetRtPlayUserData(csound));
     if (dev->handle == NULL)
@@ -807,32 +977,24 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     /* calculate the number of samples to play */
     n = nbytes / dev->sampleSize;
 
+    if (dev->mmap) {
+      mmap_transfer(csound, dev, (MYFLT*) outbuf, n, 1);
+      return;
+    }
     /* convert samples from MYFLT */
     dev->playconv(n * dev->nchns, (MYFLT*) outbuf, dev->buf, &(dev->seed));
 
+    m = 0;
     while (n) {
-      err = (int) snd_pcm_writei(dev->handle, dev->buf, (snd_pcm_uframes_t) n);
+      err = (int) snd_pcm_writei(dev->handle,
+                                 (char*) dev->buf + m * dev->frameSize,
+                                 (snd_pcm_uframes_t) n);
       if (err >= 0) {
-        n -= err; continue;
+        n -= err; m += err; continue;
       }
       /* handle I/O errors */
-      if (err == -EPIPE) {
-        /* buffer underrun */
-        warning(Str("Buffer underrun in real-time audio output"));   /* complain */
-        if (snd_pcm_prepare(dev->handle) >= 0) continue;
-      }
-      else if (err == -ESTRPIPE) {
-        /* suspend */
-        warning(Str("Real-time audio output suspended"));
-        while (snd_pcm_resume(dev->handle) == -EAGAIN) sleep(1);
-        if (snd_pcm_prepare(dev->handle) >= 0) continue;
-      }
-      /* could not recover from error */
-      csound->ErrorMsg(csound,
-                       Str("Error writing data to audio output device"));
-      snd_pcm_close(dev->handle);
-      dev->handle = NULL;
-      break;
+      if (xrun_recover(csound, dev, err, 1) != 0)
+        break;
     }
 }
 
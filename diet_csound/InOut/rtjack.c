@@ -179,6 +179,8 @@ static inline void rtJack_DestroyLock(CSOUND *csound, void **p)
 static CS_NORETURN void rtJack_Error(CSOUND *, int errCode, const char *msg);
 
 static int processCallback(jack_nframes_t nframes, void *arg);
+static int rtJack_Drive(CSOUND *csound, void *userData);
+static CS_NOINLINE void rtJack_Restart(RtJackGlobals *p);
 
 /* callback functions */
 
@@ -222,11 +224,18 @@ static void freeWheelCallback(int starting, void *arg)
 }
 #endif
 
+static inline void rtJack_CountXrun(RtJackGlobals *p)
+{
+    p->xrunFlag = 1;
+    if (p->xrunCount != NULL)
+      ATOMIC_INCR(*(p->xrunCount));
+}
+
 static int xrunCallback(void *arg)
 {
     RtJackGlobals *p = (RtJackGlobals*) arg;
 
-    p->xrunFlag = 1;
+    rtJack_CountXrun(p);
     return 0;
 }
 
@@ -235,6 +244,11 @@ static void shutDownCallback(void *arg)
     RtJackGlobals *p = (RtJackGlobals*) arg;
 
     p->jackState = 2;
+    if (p->cbMode && p->cbActive) {
+      /* let the Csound thread reconnect */
+      p->cbActive = 0;
+      rtJack_Unlock(p->csound, &(p->cbLock));
+    }
     if (p->bufs != NULL) {
       int   i;
       for (i = 0; i < p->nBuffers; i++) {
@@ -322,6 +336,34 @@ static void rtJack_AllocateBuffers(RtJackGlobals *p)
     }
 }
 
+/* empty the ring buffers and hand them all to the Csound thread */
+
+static void rtJack_ResetBuffers(RtJackGlobals *p)
+{
+    int     i, j, k;
+
+    p->csndBufCnt = 0;
+    p->csndBufPos = 0;
+    p->jackBufCnt = 0;
+    p->jackBufPos = 0;
+    for (i = 0; p->bufs != NULL && i < p->nBuffers; i++) {
+      rtJack_TryLock(p->csound, &(p->bufs[i]->csndLock));
+      rtJack_Unlock(p->csound, &(p->bufs[i]->jackLock));
+      if (p->inputEnabled) {
+        for (j = 0; j < p->nChannels_i; j++) {
+          for (k = 0; k < p->bufSize; k++)
+            p->bufs[i]->inBufs[j][k] = (jack_default_audio_sample_t) 0;
+        }
+      }
+      if (p->outputEnabled) {
+        for (j = 0; j < p->nChannels; j++) {
+          for (k = 0; k < p->bufSize; k++)
+            p->bufs[i]->outBufs[j][k] = (jack_default_audio_sample_t) 0;
+        }
+      }
+    }
+}
+
 static void listPorts(CSOUND *csound, int isOutput){
     int i, n = listDevices(csound, NULL, isOutput);
     CS_AUDIODEVICE *devs = csound->Malloc(csound, (size_t)n*sizeof(CS_AUDIODEVICE));
@@ -384,7 +426,7 @@ static int strcmp_natural (const void *s1, const void *s2)
 static void openJackStreams(RtJackGlobals *p)
 {
     char    buf[256];
-    int     i, j, k;
+    int     i;
     CSOUND *csound = p->csound;
     OPARMS oparms;
     csound->GetOParms(csound, &oparms);
@@ -423,40 +465,44 @@ static void openJackStreams(RtJackGlobals *p)
       rtJack_Error(csound, -1, Str("invalid period size (-b)"));
     if (p->nBuffers < 2)
       p->nBuffers = 2;
+    if (p->cbMode) {
+      /* the engine can only run in the process callback if each period
+         is exactly one -b buffer */
+      if (UNLIKELY(p->bufSize != (int) jack_get_buffer_size(p->client))) {
+        csound->Warning(csound, Str("rtjack: callback mode needs -b %d "
+                                    "(the JACK period size), using "
+                                    "ring buffers\n"),
+                        (int) jack_get_buffer_size(p->client));
+        p->cbMode = 0;
+        csound->SetPerformDriver(csound, NULL, NULL);
+      }
+    }
     if (UNLIKELY((unsigned int) (p->nBuffers * p->bufSize) > (unsigned int) 65536))
       rtJack_Error(csound, -1, Str("invalid buffer size (-B)"));
-    if (UNLIKELY(((p->nBuffers - 1) * p->bufSize)
+    if (UNLIKELY(!p->cbMode &&
+                 ((p->nBuffers - 1) * p->bufSize)
                  < (int) jack_get_buffer_size(p->client)))
       rtJack_Error(csound, -1, Str("buffer size (-B) is too small"));
 
     /* register ports */
     rtJack_RegisterPorts(p);
 
-    /* allocate ring buffers if not done yet */
-    if (p->bufs == NULL)
-      rtJack_AllocateBuffers(p);
-
-    /* initialise ring buffers */
-    p->csndBufCnt = 0;
-    p->csndBufPos = 0;
-    p->jackBufCnt = 0;
-    p->jackBufPos = 0;
-    for (i = 0; i < p->nBuffers; i++) {
-      rtJack_TryLock(p->csound, &(p->bufs[i]->csndLock));
-      rtJack_Unlock(p->csound, &(p->bufs[i]->jackLock));
-      if (p->inputEnabled) {
-        for (j = 0; j < p->nChannels_i; j++) {
-          for (k = 0; k < p->bufSize; k++)
-            p->bufs[i]->inBufs[j][k] = (jack_default_audio_sample_t) 0;
-        }
-      }
-      if (p->outputEnabled) {
-        for (j = 0; j < p->nChannels; j++) {
-          for (k = 0; k < p->bufSize; k++)
-            p->bufs[i]->outBufs[j][k] = (jack_default_audio_sample_t) 0;
-        }
+    if (p->cbMode) {
+      if (!p->cbLockInit) {
+        if (UNLIKELY(rtJack_CreateLock(csound, &(p->cbLock)) != 0))
+          rtJack_Error(csound, CSOUND_MEMORY, Str("memory allocation failure"));
+        p->cbLockInit = 1;
       }
+      rtJack_TryLock(csound, &(p->cbLock));
+      p->cbActive = 0;
+      p->cbInCallback = 0;
+      /* csoundPerform() hands its k-loop to rtJack_Drive() */
+      csound->SetPerformDriver(csound, rtJack_Drive, (void*) p);
     }
+    /* allocate ring buffers if not done yet */
+    else if (p->bufs == NULL)
+      rtJack_AllocateBuffers(p);
+    rtJack_ResetBuffers(p);
 
     /* output port buffer pointer cache is invalid initially */
     if (p->outputEnabled)
@@ -783,12 +829,94 @@ static int playopen_(CSOUND *csound, const csRtAudioParams *parm)
 /* the process callback is called by the JACK client thread, */
 /* and copies data to the input and from the output ring buffers */
 
+/* In callback mode the process callback runs the k-cycles for one period
+   itself, through PerformKsmpsDriven().  csoundPerform() hands its k-loop
+   over to rtJack_Drive(), where the Csound thread waits, outside kperf,
+   until the performance ends or the server goes away; rtplay_() and
+   rtrecord_() are then only called from inside this callback, and copy
+   straight between the engine and the JACK port buffers.  A host that
+   runs the k-loop itself (csoundPerformKsmps()) gets the ring buffers. */
+
+static int rtJack_ProcessDirect(RtJackGlobals *p, jack_nframes_t nframes)
+{
+    CSOUND  *csound = p->csound;
+    int     i, n, ksmps = csound->GetKsmps(csound);
+
+    for (i = 0; i < p->nChannels_i && p->inputEnabled; i++)
+      p->inPortBufs[i] = (jack_default_audio_sample_t*)
+        jack_port_get_buffer(p->inPorts[i], nframes);
+    for (i = 0; i < p->nChannels && p->outputEnabled; i++)
+      p->outPortBufs[i] = (jack_default_audio_sample_t*)
+        jack_port_get_buffer(p->outPorts[i], nframes);
+    p->cbPlayPos = p->cbRecPos = 0;
+    if (ATOMIC_GET(p->cbActive)) {
+      if (UNLIKELY((int) nframes != p->bufSize))
+        rtJack_CountXrun(p);      /* period changed: skip it */
+      else {
+        p->cbInCallback = 1;
+        for (n = 0; n < (int) nframes; n += ksmps) {
+          if (csound->PerformKsmpsDriven(csound) != 0) {
+            /* end of performance: release the Csound thread */
+            p->cbActive = 0;
+            rtJack_Unlock(csound, &(p->cbLock));
+            break;
+          }
+        }
+        p->cbInCallback = 0;
+      }
+    }
+    /* silence whatever the engine did not write */
+    if (p->outputEnabled && p->cbPlayPos < (int) nframes) {
+      for (i = 0; i < p->nChannels; i++)
+        memset(&(p->outPortBufs[i][p->cbPlayPos]), 0,
+               ((int) nframes - p->cbPlayPos)
+               * sizeof(jack_default_audio_sample_t));
+    }
+    return 0;
+}
+
+/* the performance driver: csoundPerform() waits here */
+
+static int rtJack_Drive(CSOUND *csound, void *userData)
+{
+    RtJackGlobals *p = (RtJackGlobals*) userData;
+
+    if (p->jackState == 2)
+      rtJack_Restart(p);
+    if (!p->cbMode)
+      return 0;                 /* back to ring buffers after all */
+    ATOMIC_SET(p->cbActive, 1)
+    rtJack_Lock(csound, &(p->cbLock));
+    return 0;
+}
+
+/* rtplay_() or rtrecord_() from a thread of the host's: callback mode
+   cannot work, so use the ring buffers for the rest of the run */
+
+static CS_NOINLINE void rtJack_NoCallback(RtJackGlobals *p)
+{
+    CSOUND  *csound = p->csound;
+
+    csound->Warning(csound, "%s", Str("rtjack: callback mode needs the "
+                                      "host to call csoundPerform(), "
+                                      "using ring buffers\n"));
+    csound->SetPerformDriver(csound, NULL, NULL);
+    if (p->bufs == NULL)
+      rtJack_AllocateBuffers(p);
+    rtJack_ResetBuffers(p);
+    if (p->outputEnabled)
+      p->outPortBufs[0] = (jack_default_audio_sample_t*) NULL;
+    ATOMIC_SET(p->cbMode, 0)
+}
+
 static int processCallback(jack_nframes_t nframes, void *arg)
 {
     RtJackGlobals *p;
     int           i, j, k, l;
 
     p = (RtJackGlobals*) arg;
+    if (p->cbMode)
+      return rtJack_ProcessDirect(p, nframes);
     /* get pointers to port buffers */
     if (p->inputEnabled) {
       for (i = 0; i < p->nChannels_i; i++)
@@ -807,7 +935,7 @@ static int processCallback(jack_nframes_t nframes, void *arg)
         /* check for xrun: */
         if (rtJack_TryLock(p->csound, &(p->bufs[p->jackBufCnt]->jackLock))
             != 0) {
-          p->xrunFlag = 1;
+          rtJack_CountXrun(p);
           /* yes, discard input and fill output with zero samples */
           if (p->outputEnabled) {
             for (j = 0; j < p->nChannels; j++)
@@ -884,14 +1012,35 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
     p = (RtJackGlobals*) *(csound->GetRtPlayUserData(csound));
     if (UNLIKELY(p==NULL)) rtJack_Abort(csound, 0);
     if (p->jackState != 0) {
-      if (p->jackState < 0)
+      if (p->jackState < 0) {
         openJackStreams(p);     /* open audio input */
+        if (p->cbMode) {
+          /* csoundPerform() hands over at the next k-cycle */
+          memset(inbuf_, 0, bytes_);
+          return bytes_;
+        }
+      }
       else if (p->jackState == 2)
         rtJack_Restart(p);
       else
         rtJack_Abort(csound, p->jackState);
     }
     nframes = bytes_ / (p->nChannels_i * (int) sizeof(MYFLT));
+    if (p->cbMode && !p->cbInCallback)
+      rtJack_NoCallback(p);
+    if (p->cbMode) {
+      if (nframes > p->bufSize - p->cbRecPos) {
+        memset(inbuf_, 0, bytes_);
+        nframes = p->bufSize - p->cbRecPos;
+      }
+      for (k = 0; k < p->nChannels_i; k++) {
+        jack_default_audio_sample_t *srcp = &(p->inPortBufs[k][p->cbRecPos]);
+        for (i = 0, j = k; i < nframes; i++, j += p->nChannels_i)
+          inbuf_[j] = (MYFLT) srcp[i];
+      }
+      p->cbRecPos += nframes;
+      return bytes_;
+    }
     bufpos = p->csndBufPos;
     bufcnt = p->csndBufCnt;
     for (i = j = 0; i < nframes; i++) {
@@ -927,13 +1076,8 @@ static int rtrecord_(CSOUND *csound, MYFLT *inbuf_, int bytes_)
       p->csndBufPos = bufpos;
       p->csndBufCnt = bufcnt;
     }
-    if (p->xrunFlag) {
-      p->xrunFlag = 0;
-      OPARMS oparms;
-      csound->GetOParms(csound, &oparms);
-      if (UNLIKELY(oparms.msglevel & 4))
-        csound->Warning(csound, "%s", Str("rtjack: xrun in real time audio"));
-    }
+    /* xruns are counted in the "rtjack_xruns" global variable */
+    p->xrunFlag = 0;
 
     return bytes_;
 }
@@ -956,6 +1100,19 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
       return;
     }
     nframes = bytes_ / (p->nChannels * (int) sizeof(MYFLT));
+    if (p->cbMode && !p->cbInCallback)
+      rtJack_NoCallback(p);
+    if (p->cbMode) {
+      if (nframes > p->bufSize - p->cbPlayPos)
+        nframes = p->bufSize - p->cbPlayPos;
+      for (k = 0; k < p->nChannels; k++) {
+        jack_default_audio_sample_t *dstp = &(p->outPortBufs[k][p->cbPlayPos]);
+        for (i = 0, j = k; i < nframes; i++, j += p->nChannels)
+          dstp[i] = (jack_default_audio_sample_t) outbuf_[j];
+      }
+      p->cbPlayPos += nframes;
+      return;
+    }
     for (i = j = 0; i < nframes; i++) {
       if (p->csndBufPos == 0) {
         /* wait until there is enough free space in ring buffer */
@@ -976,10 +1133,8 @@ static void rtplay_(CSOUND *csound, const MYFLT *outbuf_, int bytes_)
           p->csndBufCnt = 0;
       }
     }
-    if (p->xrunFlag) {
-      p->xrunFlag = 0;
-      csound->Warning(csound, "%s", Str("rtjack: xrun in real time audio"));
-    }
+    /* xruns are counted in the "rtjack_xruns" global variable */
+    p->xrunFlag = 0;
 }
 
 /* release ring buffers */
@@ -1064,6 +1219,17 @@ static CS_NOINLINE void rtclose_(CSOUND *csound)
       csound->Free(csound,p.outPortBufs);
     /* free ring buffers */
     rtJack_DeleteBuffers(&p);
+    if (p.cbLockInit)
+      rtJack_DestroyLock(csound, &(pp->cbLock));
+    if (p.cbMode)
+      csound->SetPerformDriver(csound, NULL, NULL);
+    if (p.xrunCount != NULL && *(p.xrunCount) > 0) {
+      OPARMS oparms;
+      csound->GetOParms(csound, &oparms);
+      if (UNLIKELY(oparms.msglevel & 4))
+        csound->Warning(csound, Str("rtjack: %d xruns in real time audio"),
+                        *(p.xrunCount));
+    }
     csound->DestroyGlobalVariable(csound, "_rtjackGlobals");
 }
 
@@ -1199,6 +1365,24 @@ PUBLIC int csoundModuleCreate(CSOUND *csound)
                                         (void*) &(p->sleepTime),
                                         CSOUNDCFG_INTEGER, 0, &i, &j,
                                         Str("Deprecated"), NULL);
+    /* callback mode */
+    csound->CreateConfigurationVariable(csound, "jack_callback",
+                                        (void*) &(p->cbMode),
+                                        CSOUNDCFG_BOOLEAN, 0, NULL, NULL,
+                                        Str("Run the engine in the JACK process "
+                                            "callback (needs -b equal to the "
+                                            "JACK period)"),
+                                        NULL);
+    /* xrun counter, readable by hosts */
+    if (csound->QueryGlobalVariable(csound, "rtjack_xruns") == NULL &&
+        UNLIKELY(csound->CreateGlobalVariable(csound, "rtjack_xruns",
+                                              sizeof(int)) != 0)) {
+      csound->ErrorMsg(csound, "%s", Str(" *** rtjack: error allocating globals"));
+      return -1;
+    }
+    p->xrunCount = (int*) csound->QueryGlobalVariableNoCheck(csound,
+                                                             "rtjack_xruns");
+    *(p->xrunCount) = 0;
     /* done */
     p->listclient = NULL;
 
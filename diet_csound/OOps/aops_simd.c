@@ -0,0 +1,1031 @@
+/*
+    aops_simd.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"         /*                      AOPS_SIMD.C     */
+#include "entry1.h"
+
+/* Vector versions of the audio rate arithmetic of aops.c, one set per
+ * instruction set.  aops_dispatch() asks the CPU what it has when the
+ * opcode list is built and points the opcode entries at the widest set,
+ * so that one binary runs on every machine of a family.  Each lane does
+ * just what the scalar code does (no fused multiply-add, no reciprocal
+ * estimates), so every set gives the same samples as aops.c.
+ *
+ * The audio rate sin, cos, exp, log, tanh, ampdb, ampdbfs and powoftwo
+ * cannot call the C library a lane at a time, so they use the Cephes
+ * range reductions and polynomials written with the same vector macros.
+ * They are within 1 ulp of the exact result for exp, exp2 and log and
+ * 2 ulp for sin, cos and tanh in double (1.5 and 2.5 ulp in float), keep
+ * the special values (NaN, infinities, zeros, denormals) and send sin
+ * and cos arguments too large for the reduction to the library.  All
+ * the x86 sets give the same samples as each other, but not always the
+ * same as the library functions aops.c calls, which a CPU with only
+ * SSE2 keeps for sin, cos, exp, log and tanh.
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define AOPS_X86
+#  include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__ARM_NEON) \
+      && defined(USE_NEON_AOPS)
+/* not yet built and run on aarch64: cmake -DUSE_NEON_AOPS=ON */
+#  define AOPS_NEON
+#  include <arm_neon.h>
+#endif
+
+#if defined(AOPS_X86) || defined(AOPS_NEON)
+
+/* Every set has to round just as aops.c does, so neither file may be
+   built with -ffast-math (the default) or let the compiler fuse a
+   multiply and an add where the target has FMA (AVX-512, NEON). */
+#if defined(__clang__)
+#  pragma float_control(precise, on)
+#  pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#  pragma GCC optimize ("no-fast-math", "fp-contract=off")
+#endif
+
+/* The scalar versions, in the order of the tables below */
+
+static const SUBR aops_generic[] = {
+    addaa, subaa, mulaa, divaa,
+    addka, subka, mulka, divka,
+    addak, subak, mulak, divak,
+    divzaa, divzka, divzak, absa,
+    sina, cosa, expa, loga,
+    tanha, aampdb, aampdbfs, powoftwoa
+};
+
+#define AOPS_NFUNCS (sizeof(aops_generic) / sizeof(SUBR))
+#define AOPS_SINA   16                  /* sina to tanha, see aops_dispatch */
+#define AOPS_TANHA  20
+
+#define AOPS_RANGE                                              \
+    uint32_t offset = p->h.insdshead->ksmps_offset;             \
+    uint32_t early  = p->h.insdshead->ksmps_no_end;             \
+    uint32_t n, nsmps = CS_KSMPS;                               \
+    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
+    if (UNLIKELY(early)) {                                      \
+      nsmps -= early;                                           \
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));             \
+    }
+
+/* The templates use the vector macros of the instruction set being
+   instantiated:
+     VT, VW             vector type and width
+     VLD, VST, VDUP     unaligned load and store, broadcast
+     VADD ... VDIV      lane by lane arithmetic
+     VABS(x)            |x|
+     VDIVZ(a,b,d)       a/b, or d where b is zero
+     MT, MZERO          accumulator of zero divisors, and its start
+     MACC(m,b), MANY(m) add the zeros of b to m, any zero seen
+*/
+
+#define AOPS_AA(NAME,SFX,ATTR,VOP,OP)                           \
+  static ATTR int32_t NAME##_##SFX(CSOUND *csound, AOP *p)      \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a, *b = p->b;                    \
+    AOPS_RANGE                                                  \
+    IGN(csound);                                                \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VOP(VLD(&a[n]), VLD(&b[n])));                  \
+    for (; n < nsmps; n++)                                      \
+      r[n] = a[n] OP b[n];                                      \
+    return OK;                                                  \
+  }
+
+#define AOPS_KA(NAME,SFX,ATTR,VOP,OP)                           \
+  static ATTR int32_t NAME##_##SFX(CSOUND *csound, AOP *p)      \
+  {                                                             \
+    MYFLT   *r = p->r, a = *p->a, *b = p->b;                    \
+    AOPS_RANGE                                                  \
+    VT      va = VDUP(a);                                       \
+    IGN(csound);                                                \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VOP(va, VLD(&b[n])));                          \
+    for (; n < nsmps; n++)                                      \
+      r[n] = a OP b[n];                                         \
+    return OK;                                                  \
+  }
+
+#define AOPS_AK(NAME,SFX,ATTR,VOP,OP)                           \
+  static ATTR int32_t NAME##_##SFX(CSOUND *csound, AOP *p)      \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a, b = *p->b;                    \
+    AOPS_RANGE                                                  \
+    VT      vb = VDUP(b);                                       \
+    IGN(csound);                                                \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VOP(VLD(&a[n]), vb));                          \
+    for (; n < nsmps; n++)                                      \
+      r[n] = a[n] OP b;                                         \
+    return OK;                                                  \
+  }
+
+/* the whole set for one instruction set */
+
+#define AOPS_FUNCS(SFX,ATTR)                                    \
+  AOPS_AA(addaa,SFX,ATTR,VADD,+)                                \
+  AOPS_AA(subaa,SFX,ATTR,VSUB,-)                                \
+  AOPS_AA(mulaa,SFX,ATTR,VMUL,*)                                \
+  AOPS_KA(addka,SFX,ATTR,VADD,+)                                \
+  AOPS_KA(subka,SFX,ATTR,VSUB,-)                                \
+  AOPS_KA(mulka,SFX,ATTR,VMUL,*)                                \
+  AOPS_KA(divka,SFX,ATTR,VDIV,/)                                \
+  AOPS_AK(addak,SFX,ATTR,VADD,+)                                \
+  AOPS_AK(subak,SFX,ATTR,VSUB,-)                                \
+  AOPS_AK(mulak,SFX,ATTR,VMUL,*)                                \
+                                                                \
+  static ATTR int32_t divak_##SFX(CSOUND *csound, AOP *p)       \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a, b = *p->b;                    \
+    AOPS_RANGE                                                  \
+    VT      vb = VDUP(b);                                       \
+    if (UNLIKELY(b == FL(0.0)))                                 \
+      csound->Warning(csound, Str("Division by zero"));         \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VDIV(VLD(&a[n]), vb));                         \
+    for (; n < nsmps; n++)                                      \
+      r[n] = a[n] / b;                                          \
+    return OK;                                                  \
+  }                                                             \
+                                                                \
+  static ATTR int32_t divaa_##SFX(CSOUND *csound, AOP *p)       \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a, *b = p->b;                    \
+    AOPS_RANGE                                                  \
+    MT      zero = MZERO;                                       \
+    int     err = 0;                                            \
+    for (n = offset; n + VW <= nsmps; n += VW) {                \
+      VT vb = VLD(&b[n]);                                       \
+      MACC(zero, vb);                                           \
+      VST(&r[n], VDIV(VLD(&a[n]), vb));                         \
+    }                                                           \
+    for (; n < nsmps; n++) {                                    \
+      if (b[n] == FL(0.0)) err = 1;                             \
+      r[n] = a[n] / b[n];                                       \
+    }                                                           \
+    if (UNLIKELY(err || MANY(zero)))                            \
+      csound->Warning(csound, Str("Division by zero"));         \
+    return OK;                                                  \
+  }                                                             \
+                                                                \
+  static ATTR int32_t divzaa_##SFX(CSOUND *csound, DIVZ *p)     \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a, *b = p->b, def = *p->def;     \
+    AOPS_RANGE                                                  \
+    VT      vd = VDUP(def);                                     \
+    IGN(csound);                                                \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VDIVZ(VLD(&a[n]), VLD(&b[n]), vd));            \
+    for (; n < nsmps; n++)                                      \
+      r[n] = (b[n] == FL(0.0) ? def : a[n] / b[n]);             \
+    return OK;                                                  \
+  }                                                             \
+                                                                \
+  static ATTR int32_t divzka_##SFX(CSOUND *csound, DIVZ *p)     \
+  {                                                             \
+    MYFLT   *r = p->r, a = *p->a, *b = p->b, def = *p->def;     \
+    AOPS_RANGE                                                  \
+    VT      va = VDUP(a), vd = VDUP(def);                       \
+    IGN(csound);                                                \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VDIVZ(va, VLD(&b[n]), vd));                    \
+    for (; n < nsmps; n++)                                      \
+      r[n] = (b[n] == FL(0.0) ? def : a / b[n]);                \
+    return OK;                                                  \
+  }                                                             \
+                                                                \
+  static ATTR int32_t divzak_##SFX(CSOUND *csound, DIVZ *p)     \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a, b = *p->b, def = *p->def;     \
+    AOPS_RANGE                                                  \
+    VT      vb = VDUP(b);                                       \
+    IGN(csound);                                                \
+    if (UNLIKELY(b == FL(0.0))) {                               \
+      for (n = offset; n < nsmps; n++) r[n] = def;              \
+      return OK;                                                \
+    }                                                           \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VDIV(VLD(&a[n]), vb));                         \
+    for (; n < nsmps; n++)                                      \
+      r[n] = a[n] / b;                                          \
+    return OK;                                                  \
+  }                                                             \
+                                                                \
+  static ATTR int32_t absa_##SFX(CSOUND *csound, EVAL *p)       \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a;                               \
+    AOPS_RANGE                                                  \
+    IGN(csound);                                                \
+    for (n = offset; n + VW <= nsmps; n += VW)                  \
+      VST(&r[n], VABS(VLD(&a[n])));                             \
+    for (; n < nsmps; n++)                                      \
+      r[n] = FABS(a[n]);                                        \
+    return OK;                                                  \
+  }                                                             \
+                                                                \
+  AOPS_VMATH(SFX,ATTR)                                          \
+                                                                \
+  static const SUBR aops_##SFX[] = {                            \
+    (SUBR) addaa_##SFX, (SUBR) subaa_##SFX,                     \
+    (SUBR) mulaa_##SFX, (SUBR) divaa_##SFX,                     \
+    (SUBR) addka_##SFX, (SUBR) subka_##SFX,                     \
+    (SUBR) mulka_##SFX, (SUBR) divka_##SFX,                     \
+    (SUBR) addak_##SFX, (SUBR) subak_##SFX,                     \
+    (SUBR) mulak_##SFX, (SUBR) divak_##SFX,                     \
+    (SUBR) divzaa_##SFX, (SUBR) divzka_##SFX,                   \
+    (SUBR) divzak_##SFX, (SUBR) absa_##SFX,                     \
+    (SUBR) sina_##SFX, (SUBR) cosa_##SFX,                       \
+    (SUBR) expa_##SFX, (SUBR) loga_##SFX,                       \
+    (SUBR) tanha_##SFX, (SUBR) aampdb_##SFX,                    \
+    (SUBR) aampdbfs_##SFX, (SUBR) powoftwoa_##SFX               \
+  };
+
+/* Constants of the vector math for the precision of MYFLT.  VM_MAGIC
+   added and taken away rounds to an integer, and leaves that integer in
+   the low bits of the sum; VM_MAGICI is its bit pattern.  The double
+   exp is that of fdlibm, the rest are from Cephes. */
+
+#ifdef USE_DOUBLE
+#  define VM_MAGIC      6755399441055744.0      /* 1.5 * 2^52 */
+#  define VM_MAGICI     INT64_C(0x4338000000000000)
+#  define VM_SHIFT      52
+#  define VM_BIAS       1023
+#  define VM_MANT       INT64_C(0x000fffffffffffff)
+#  define VM_HALFI      INT64_C(0x3fe0000000000000)
+#  define VM_TINY       2.2250738585072014e-308 /* smallest normal */
+#  define VM_TINYSC     18014398509481984.0     /* 2^54 */
+#  define VM_TINYEX     54
+#  define VM_FLIPSH     61
+#  define VM_EXP_LO     (-746.0)
+#  define VM_EXP_HI     710.0
+#  define VM_EXP2_LO    (-1076.0)
+#  define VM_EXP2_HI    1025.0
+#  define VM_LN2HI      6.93147180369123816490e-1
+#  define VM_LN2LO      1.90821492927058770002e-10
+#  define VM_SIN_LOSS   1.073741824e9
+/* e^(hi - lo), |hi - lo| <= ln2/2, into y */
+#  define VM_EXP_POLY(y,lo)                                     \
+  do {                                                          \
+    VT r_ = VSUB(y, lo), c_ = VMUL(r_, r_);                     \
+    c_ = VSUB(r_, VMUL(c_, VP4(c_, 4.13813679705723846039e-8,   \
+                               -1.65339022054652515390e-6,      \
+                               6.61375632143793436117e-5,       \
+                               -2.77777777770155933842e-3,      \
+                               1.66666666666666019037e-1)));    \
+    y = VSUB(VDUP(1.0),                                         \
+             VSUB(VSUB(lo, VDIV(VMUL(r_, c_),                   \
+                                VSUB(VDUP(2.0), c_))), y));     \
+  } while (0)
+/* 2^y for |y| <= 1/2: y ln2 split so that the high part is exact */
+#  define VM_EXP2_POLY(y)                                       \
+  do {                                                          \
+    VT h_ = VSUB(VADD(y, VDUP(6442450944.0)), VDUP(6442450944.0)); \
+    VT l_ = VSUB(VMUL(h_, VDUP(-VM_LN2LO)),                     \
+                 VMUL(VSUB(y, h_), VDUP(0.69314718055994530942))); \
+    y = VMUL(h_, VDUP(VM_LN2HI));                               \
+    VM_EXP_POLY(y, l_);                                         \
+  } while (0)
+/* log(1 + x) + e log(2), sqrt(1/2) - 1 <= x <= sqrt(2) - 1, into x */
+#  define VM_LOG_POLY(x,e)                                      \
+  do {                                                          \
+    VT z_ = VMUL(x, x), y_;                                     \
+    y_ = VMUL(x, VDIV(VMUL(z_, VP5(x, 1.01875663804580931796e-4, \
+                                   4.97494994976747001425e-1,   \
+                                   4.70579119878881725854e0,    \
+                                   1.44989225341610930846e1,    \
+                                   1.79368678507819816313e1,    \
+                                   7.70838733755885391666e0)),  \
+                      VP5(x, 1.0, 1.12873587189167450590e1,     \
+                          4.52279145837532221105e1,             \
+                          8.29875266912776603211e1,             \
+                          7.11544750618563894466e1,             \
+                          2.31251620126765340583e1)));          \
+    y_ = VSUB(y_, VMUL(e, VDUP(2.121944400546905827679e-4)));   \
+    y_ = VSUB(y_, VMUL(VDUP(0.5), z_));                         \
+    x = VADD(x, y_);                                            \
+    x = VADD(x, VMUL(e, VDUP(0.693359375)));                    \
+  } while (0)
+/* |x| less y pi/4, in three parts */
+#  define VM_SIN_REDUCE(x,y)                                    \
+    VSUB(VSUB(VSUB(x, VMUL(y, VDUP(7.85398125648498535156e-1))), \
+              VMUL(y, VDUP(3.77489470793079817668e-8))),        \
+         VMUL(y, VDUP(2.69515142907905952645e-15)))
+/* sin z and cos z for |z| <= pi/4, zz = z^2 */
+#  define VM_SIN_POLY(z,zz)                                     \
+    VADD(z, VMUL(z, VMUL(zz, VP5(zz, 1.58962301576546568060e-10, \
+                                 -2.50507477628578072866e-8,    \
+                                 2.75573136213857245213e-6,     \
+                                 -1.98412698295895385996e-4,    \
+                                 8.33333333332211858878e-3,     \
+                                 -1.66666666666666307295e-1))))
+#  define VM_COS_POLY(zz)                                       \
+    VADD(VSUB(VDUP(1.0), VMUL(VDUP(0.5), zz)),                  \
+         VMUL(VMUL(zz, zz), VP5(zz, -1.13585365213876817300e-11, \
+                                2.08757008419747316778e-9,      \
+                                -2.75573141792967388112e-7,     \
+                                2.48015872888517045348e-5,      \
+                                -1.38888888888730564116e-3,     \
+                                4.16666666666665929218e-2)))
+/* tanh x for |x| <= 0.625, z = x^2 */
+#  define VM_TANH_POLY(x,z)                                     \
+    VADD(x, VMUL(VMUL(x, z),                                    \
+                 VDIV(VP2(z, -9.64399179425052238628e-1,        \
+                          -9.92877231001918586564e1,            \
+                          -1.61468768441708447952e3),           \
+                      VP3(z, 1.0, 1.12811678491632931402e2,     \
+                          2.23548839060100448583e3,             \
+                          4.84406305325125486048e3))))
+#else
+#  define VM_MAGIC      12582912.0f             /* 1.5 * 2^23 */
+#  define VM_MAGICI     0x4b400000
+#  define VM_SHIFT      23
+#  define VM_BIAS       127
+#  define VM_MANT       0x007fffff
+#  define VM_HALFI      0x3f000000
+#  define VM_TINY       1.17549435e-38f         /* smallest normal */
+#  define VM_TINYSC     33554432.0f             /* 2^25 */
+#  define VM_TINYEX     25
+#  define VM_FLIPSH     29
+#  define VM_EXP_LO     (-104.0f)
+#  define VM_EXP_HI     89.0f
+#  define VM_EXP2_LO    (-151.0f)
+#  define VM_EXP2_HI    129.0f
+#  define VM_LN2HI      0.693359375f
+#  define VM_LN2LO      (-2.12194440e-4f)
+#  define VM_SIN_LOSS   4096.0f
+#  define VM_EXP_POLY(y,lo)                                     \
+  do {                                                          \
+    VT r_;                                                      \
+    y = VSUB(y, lo);                                            \
+    r_ = VP5(y, 1.9875691500e-4f, 1.3981999507e-3f,             \
+             8.3334519073e-3f, 4.1665795894e-2f,                \
+             1.6666665459e-1f, 5.0000001201e-1f);               \
+    y = VADD(VADD(VMUL(r_, VMUL(y, y)), y), VDUP(1.0f));        \
+  } while (0)
+#  define VM_EXP2_POLY(y)                                       \
+    y = VADD(VMUL(VP5(y, 1.535336188319500e-4f,                 \
+                      1.339887440266574e-3f,                    \
+                      9.618437357674640e-3f,                    \
+                      5.550332471162809e-2f,                    \
+                      2.402264791363012e-1f,                    \
+                      6.931472028550421e-1f), y), VDUP(1.0f))
+#  define VM_LOG_POLY(x,e)                                      \
+  do {                                                          \
+    VT z_ = VMUL(x, x), y_;                                     \
+    y_ = VMUL(VMUL(VP8(x, 7.0376836292e-2f, -1.1514610310e-1f,  \
+                       1.1676998740e-1f, -1.2420140846e-1f,     \
+                       1.4249322787e-1f, -1.6668057665e-1f,     \
+                       2.0000714765e-1f, -2.4999993993e-1f,     \
+                       3.3333331174e-1f), x), z_);              \
+    y_ = VADD(y_, VMUL(VDUP(-2.12194440e-4f), e));              \
+    y_ = VADD(y_, VMUL(VDUP(-0.5f), z_));                       \
+    x = VADD(x, y_);                                            \
+    x = VADD(x, VMUL(VDUP(0.693359375f), e));                   \
+  } while (0)
+/* four parts of at most 11 bits but the last, exact for |x| < 4096 */
+#  define VM_SIN_REDUCE(x,y)                                    \
+    VSUB(VSUB(VSUB(VSUB(x, VMUL(y, VDUP(0.78515625f))),         \
+                   VMUL(y, VDUP(2.4187564849853515625e-4f))),   \
+              VMUL(y, VDUP(3.7747668102383614e-8f))),           \
+         VMUL(y, VDUP(1.2816720341285448e-12f)))
+#  define VM_SIN_POLY(z,zz)                                     \
+    VADD(VMUL(VMUL(VP2(zz, -1.9515295891e-4f, 8.3321608736e-3f, \
+                       -1.6666654611e-1f), zz), z), z)
+#  define VM_COS_POLY(zz)                                       \
+    VADD(VSUB(VMUL(VMUL(VP2(zz, 2.443315711809948e-5f,          \
+                            -1.388731625493765e-3f,             \
+                            4.166664568298827e-2f), zz), zz),   \
+              VMUL(VDUP(0.5f), zz)), VDUP(1.0f))
+#  define VM_TANH_POLY(x,z)                                     \
+    VADD(VMUL(VMUL(VP4(z, -5.70498872745e-3f, 2.06390887954e-2f, \
+                       -5.37397155531e-2f, 1.33314422036e-1f,   \
+                       -3.33332819422e-1f), z), x), x)
+#endif
+#define VM_LOG2E        1.4426950408889634073599
+#define VM_FOPI         1.27323954473516268615  /* 4/pi */
+#define VM_SQRTH        0.70710678118654752440  /* sqrt(1/2) */
+
+/* polynomials by Horner's rule, highest power first */
+
+#define VP1(x,a,b)              VADD(VMUL(VDUP(a), x), VDUP(b))
+#define VP2(x,a,b,c)            VADD(VMUL(VP1(x,a,b), x), VDUP(c))
+#define VP3(x,a,b,c,d)          VADD(VMUL(VP2(x,a,b,c), x), VDUP(d))
+#define VP4(x,a,b,c,d,e)        VADD(VMUL(VP3(x,a,b,c,d), x), VDUP(e))
+#define VP5(x,a,b,c,d,e,f)      VADD(VMUL(VP4(x,a,b,c,d,e), x), VDUP(f))
+#define VP6(x,a,b,c,d,e,f,g)    VADD(VMUL(VP5(x,a,b,c,d,e,f), x), VDUP(g))
+#define VP7(x,a,b,c,d,e,f,g,h)                                  \
+    VADD(VMUL(VP6(x,a,b,c,d,e,f,g), x), VDUP(h))
+#define VP8(x,a,b,c,d,e,f,g,h,i)                                \
+    VADD(VMUL(VP7(x,a,b,c,d,e,f,g,h), x), VDUP(i))
+
+/* The math templates also use
+     VI, VTOI, VTOF     integer vector of the same width, bit casts
+     VDUPI, VADDI       integer broadcast and add
+     VANDI, VORI        integer and, or
+     VSLLI, VSRLI       integer shifts left and right (logical)
+     VMIN, VMAX, VXOR   lane by lane minimum, maximum, xor of the bits
+     VMASK, VLT, VEQ    compare result, a < b, a == b
+     VSEL(m,t,f)        t where m is set, otherwise f
+     VANYM(m)           any lane of m set
+*/
+
+#define AOPS_VMATHA(NAME,SFX,ATTR,EXPR)                         \
+  static ATTR int32_t NAME##_##SFX(CSOUND *csound, EVAL *p)     \
+  {                                                             \
+    MYFLT   *r = p->r, *a = p->a, t[VW];                        \
+    AOPS_RANGE                                                  \
+    VT      x;                                                  \
+    IGN(csound);                                                \
+    for (n = offset; n + VW <= nsmps; n += VW) {                \
+      x = VLD(&a[n]);                                           \
+      VST(&r[n], EXPR);                                         \
+    }                                                           \
+    if (n < nsmps) {                                            \
+      memset(t, '\0', sizeof(t));                               \
+      memcpy(t, &a[n], (nsmps - n)*sizeof(MYFLT));              \
+      x = VLD(t);                                               \
+      VST(t, EXPR);                                             \
+      memcpy(&r[n], t, (nsmps - n)*sizeof(MYFLT));              \
+    }                                                           \
+    return OK;                                                  \
+  }
+
+#define AOPS_VMATH(SFX,ATTR)                                    \
+  /* round to an integer */                                     \
+  static inline ATTR VT vround_##SFX(VT x)                      \
+  {                                                             \
+    return VSUB(VADD(x, VDUP(VM_MAGIC)), VDUP(VM_MAGIC));       \
+  }                                                             \
+                                                                \
+  /* 2^n, n an integer in the normal exponent range */          \
+  static inline ATTR VT vpow2i_##SFX(VT n)                      \
+  {                                                             \
+    VI      i = VADDI(VTOI(VADD(n, VDUP(VM_MAGIC))),            \
+                      VDUPI(VM_BIAS - VM_MAGICI));              \
+    return VTOF(VSLLI(i, VM_SHIFT));                            \
+  }                                                             \
+                                                                \
+  /* x 2^n in two steps, so that n may overflow or go denormal */ \
+  static inline ATTR VT vscale_##SFX(VT x, VT n)                \
+  {                                                             \
+    VT      h = vround_##SFX(VSUB(VMUL(n, VDUP(0.5)), VDUP(0.25))); \
+    return VMUL(VMUL(x, vpow2i_##SFX(h)),                       \
+                vpow2i_##SFX(VSUB(n, h)));                      \
+  }                                                             \
+                                                                \
+  static inline ATTR VT vexp_##SFX(VT x)                        \
+  {                                                             \
+    VT      y, n, lo;                                           \
+    y = VMIN(VMAX(x, VDUP(VM_EXP_LO)), VDUP(VM_EXP_HI));        \
+    n = vround_##SFX(VMUL(y, VDUP(VM_LOG2E)));                  \
+    y = VSUB(y, VMUL(n, VDUP(VM_LN2HI)));                       \
+    lo = VMUL(n, VDUP(VM_LN2LO));                               \
+    VM_EXP_POLY(y, lo);                                         \
+    return VSEL(VEQ(x, x), vscale_##SFX(y, n), x);              \
+  }                                                             \
+                                                                \
+  static inline ATTR VT vexp2_##SFX(VT x)                       \
+  {                                                             \
+    VT      y, n;                                               \
+    y = VMIN(VMAX(x, VDUP(VM_EXP2_LO)), VDUP(VM_EXP2_HI));      \
+    n = vround_##SFX(y);                                        \
+    y = VSUB(y, n);                                             \
+    VM_EXP2_POLY(y);                                            \
+    return VSEL(VEQ(x, x), vscale_##SFX(y, n), x);              \
+  }                                                             \
+                                                                \
+  static inline ATTR VT vlog_##SFX(VT x)                        \
+  {                                                             \
+    VMASK   tiny = VLT(x, VDUP(VM_TINY)), lo;                   \
+    VI      b = VTOI(VSEL(tiny, VMUL(x, VDUP(VM_TINYSC)), x));  \
+    VT      e, m;                                               \
+    /* x = m 2^e, 1/2 <= m < 1 */                               \
+    e = VSUB(VTOF(VADDI(VSRLI(b, VM_SHIFT), VDUPI(VM_MAGICI))), \
+             VDUP(VM_MAGIC));                                   \
+    e = VSUB(e, VSEL(tiny, VDUP(VM_BIAS - 1 + VM_TINYEX),       \
+                     VDUP(VM_BIAS - 1)));                       \
+    m = VTOF(VORI(VANDI(b, VDUPI(VM_MANT)), VDUPI(VM_HALFI)));  \
+    lo = VLT(m, VDUP(VM_SQRTH));                                \
+    e = VSEL(lo, VSUB(e, VDUP(1.0)), e);                        \
+    m = VSUB(VSEL(lo, VADD(m, m), m), VDUP(1.0));               \
+    VM_LOG_POLY(m, e);                                          \
+    m = VSEL(VEQ(x, VDUP(0.0)), VDUP(-INFINITY), m);            \
+    m = VSEL(VLT(x, VDUP(0.0)), VDUP(NAN), m);                  \
+    m = VSEL(VEQ(x, VDUP(INFINITY)), x, m);                     \
+    return VSEL(VEQ(x, x), m, x);                               \
+  }                                                             \
+                                                                \
+  static inline ATTR VT vsincos_##SFX(VT x, int cosine)         \
+  {                                                             \
+    VT      ax = VABS(x), y, z, zz, ps, pc, q;                  \
+    VI      j;                                                  \
+    /* octant, rounded up to even, of |x| */                    \
+    y = VMUL(ax, VDUP(VM_FOPI));                                \
+    z = vround_##SFX(y);                                        \
+    y = VSEL(VLT(y, z), VSUB(z, VDUP(1.0)), z);                 \
+    j = VTOI(VADD(y, VDUP(VM_MAGIC)));                          \
+    y = VADD(y, VSUB(VTOF(VORI(VANDI(j, VDUPI(1)),              \
+                               VDUPI(VM_MAGICI))),              \
+                     VDUP(VM_MAGIC)));                          \
+    j = VTOI(VADD(y, VDUP(VM_MAGIC)));                          \
+    q = VSUB(VTOF(VORI(VANDI(j, VDUPI(2)), VDUPI(VM_MAGICI))),  \
+             VDUP(VM_MAGIC));                                   \
+    z = VM_SIN_REDUCE(ax, y);                                   \
+    zz = VMUL(z, z);                                            \
+    ps = VM_SIN_POLY(z, zz);                                    \
+    pc = VM_COS_POLY(zz);                                       \
+    if (cosine) {                                               \
+      y = VSEL(VEQ(q, VDUP(2.0)), ps, pc);                      \
+      j = VADDI(j, VDUPI(2));                                   \
+    }                                                           \
+    else                                                        \
+      y = VXOR(VSEL(VEQ(q, VDUP(2.0)), pc, ps), VXOR(x, ax));   \
+    y = VXOR(y, VTOF(VSLLI(VANDI(j, VDUPI(4)), VM_FLIPSH)));    \
+    if (UNLIKELY(VANYM(VLT(VDUP(VM_SIN_LOSS), ax)))) {          \
+      MYFLT xs[VW], ys[VW];                                     \
+      int   i;                                                  \
+      VST(xs, x);                                               \
+      VST(ys, y);                                               \
+      for (i = 0; i < VW; i++)                                  \
+        if (FABS(xs[i]) > VM_SIN_LOSS)                          \
+          ys[i] = (cosine ? COS(xs[i]) : SIN(xs[i]));           \
+      y = VLD(ys);                                              \
+    }                                                           \
+    return y;                                                   \
+  }                                                             \
+                                                                \
+  static inline ATTR VT vtanh_##SFX(VT x)                       \
+  {                                                             \
+    VT      ax = VABS(x), z, y;                                 \
+    VMASK   big = VLT(VDUP(0.625), ax);                         \
+    z = VMUL(x, x);                                             \
+    y = VM_TANH_POLY(x, z);                                     \
+    if (VANYM(big)) {                                           \
+      z = vexp_##SFX(VADD(ax, ax));                             \
+      z = VSUB(VDUP(1.0), VDIV(VDUP(2.0), VADD(z, VDUP(1.0)))); \
+      y = VSEL(big, VXOR(z, VXOR(x, ax)), y);                   \
+    }                                                           \
+    return y;                                                   \
+  }                                                             \
+                                                                \
+  AOPS_VMATHA(sina,SFX,ATTR,vsincos_##SFX(x, 0))                \
+  AOPS_VMATHA(cosa,SFX,ATTR,vsincos_##SFX(x, 1))                \
+  AOPS_VMATHA(expa,SFX,ATTR,vexp_##SFX(x))                      \
+  AOPS_VMATHA(loga,SFX,ATTR,vlog_##SFX(x))                      \
+  AOPS_VMATHA(tanha,SFX,ATTR,vtanh_##SFX(x))                    \
+  AOPS_VMATHA(aampdb,SFX,ATTR,                                  \
+              vexp_##SFX(VMUL(x, VDUP(LOG10D20))))              \
+  AOPS_VMATHA(aampdbfs,SFX,ATTR,                                \
+              VMUL(VDUP(csound->e0dbfs),                        \
+                   vexp_##SFX(VMUL(x, VDUP(LOG10D20)))))        \
+  AOPS_VMATHA(powoftwoa,SFX,ATTR,vexp2_##SFX(x))
+
+#endif  /* AOPS_X86 || AOPS_NEON */
+
+#ifdef AOPS_X86
+
+#define AOPS_SSE2       __attribute__((target("sse2")))
+#define AOPS_AVX2       __attribute__((target("avx2")))
+#define AOPS_AVX512     __attribute__((target("avx512f")))
+
+/* SSE2 */
+
+#ifdef USE_DOUBLE
+#  define VT            __m128d
+#  define VW            2
+#  define VLD           _mm_loadu_pd
+#  define VST           _mm_storeu_pd
+#  define VDUP          _mm_set1_pd
+#  define VADD          _mm_add_pd
+#  define VSUB          _mm_sub_pd
+#  define VMUL          _mm_mul_pd
+#  define VDIV          _mm_div_pd
+#  define VCMPZ(x)      _mm_cmpeq_pd(x, _mm_setzero_pd())
+#  define VABS(x)       _mm_andnot_pd(_mm_set1_pd(-0.0), x)
+#  define VDIVZ(a,b,d)  sse2_divz(a, b, d)
+#  define MT            __m128d
+#  define MZERO         _mm_setzero_pd()
+#  define MACC(m,b)     (m = _mm_or_pd(m, VCMPZ(b)))
+#  define MANY(m)       _mm_movemask_pd(m)
+#  define VI            __m128i
+#  define VTOI          _mm_castpd_si128
+#  define VTOF          _mm_castsi128_pd
+#  define VDUPI         _mm_set1_epi64x
+#  define VADDI         _mm_add_epi64
+#  define VANDI         _mm_and_si128
+#  define VORI          _mm_or_si128
+#  define VSLLI         _mm_slli_epi64
+#  define VSRLI         _mm_srli_epi64
+#  define VMIN          _mm_min_pd
+#  define VMAX          _mm_max_pd
+#  define VXOR          _mm_xor_pd
+#  define VMASK         __m128d
+#  define VLT           _mm_cmplt_pd
+#  define VEQ           _mm_cmpeq_pd
+#  define VSEL(m,t,f)   _mm_or_pd(_mm_and_pd(m, t), _mm_andnot_pd(m, f))
+#  define VANYM(m)      _mm_movemask_pd(m)
+static inline AOPS_SSE2 __m128d sse2_divz(__m128d a, __m128d b, __m128d d)
+{
+    __m128d z = VCMPZ(b);
+    return _mm_or_pd(_mm_and_pd(z, d), _mm_andnot_pd(z, _mm_div_pd(a, b)));
+}
+#else
+#  define VT            __m128
+#  define VW            4
+#  define VLD           _mm_loadu_ps
+#  define VST           _mm_storeu_ps
+#  define VDUP          _mm_set1_ps
+#  define VADD          _mm_add_ps
+#  define VSUB          _mm_sub_ps
+#  define VMUL          _mm_mul_ps
+#  define VDIV          _mm_div_ps
+#  define VCMPZ(x)      _mm_cmpeq_ps(x, _mm_setzero_ps())
+#  define VABS(x)       _mm_andnot_ps(_mm_set1_ps(-0.0f), x)
+#  define VDIVZ(a,b,d)  sse2_divz(a, b, d)
+#  define MT            __m128
+#  define MZERO         _mm_setzero_ps()
+#  define MACC(m,b)     (m = _mm_or_ps(m, VCMPZ(b)))
+#  define MANY(m)       _mm_movemask_ps(m)
+#  define VI            __m128i
+#  define VTOI          _mm_castps_si128
+#  define VTOF          _mm_castsi128_ps
+#  define VDUPI         _mm_set1_epi32
+#  define VADDI         _mm_add_epi32
+#  define VANDI         _mm_and_si128
+#  define VORI          _mm_or_si128
+#  define VSLLI         _mm_slli_epi32
+#  define VSRLI         _mm_srli_epi32
+#  define VMIN          _mm_min_ps
+#  define VMAX          _mm_max_ps
+#  define VXOR          _mm_xor_ps
+#  define VMASK         __m128
+#  define VLT           _mm_cmplt_ps
+#  define VEQ           _mm_cmpeq_ps
+#  define VSEL(m,t,f)   _mm_or_ps(_mm_and_ps(m, t), _mm_andnot_ps(m, f))
+#  define VANYM(m)      _mm_movemask_ps(m)
+static inline AOPS_SSE2 __m128 sse2_divz(__m128 a, __m128 b, __m128 d)
+{
+    __m128 z = VCMPZ(b);
+    return _mm_or_ps(_mm_and_ps(z, d), _mm_andnot_ps(z, _mm_div_ps(a, b)));
+}
+#endif
+
+AOPS_FUNCS(sse2,AOPS_SSE2)
+
+#undef VT
+#undef VW
+#undef VLD
+#undef VST
+#undef VDUP
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VCMPZ
+#undef VABS
+#undef VDIVZ
+#undef MT
+#undef MZERO
+#undef MACC
+#undef MANY
+#undef VI
+#undef VTOI
+#undef VTOF
+#undef VDUPI
+#undef VADDI
+#undef VANDI
+#undef VORI
+#undef VSLLI
+#undef VSRLI
+#undef VMIN
+#undef VMAX
+#undef VXOR
+#undef VMASK
+#undef VLT
+#undef VEQ
+#undef VSEL
+#undef VANYM
+
+/* AVX2 */
+
+#ifdef USE_DOUBLE
+#  define VT            __m256d
+#  define VW            4
+#  define VLD           _mm256_loadu_pd
+#  define VST           _mm256_storeu_pd
+#  define VDUP          _mm256_set1_pd
+#  define VADD          _mm256_add_pd
+#  define VSUB          _mm256_sub_pd
+#  define VMUL          _mm256_mul_pd
+#  define VDIV          _mm256_div_pd
+#  define VCMPZ(x)      _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ)
+#  define VABS(x)       _mm256_andnot_pd(_mm256_set1_pd(-0.0), x)
+#  define VDIVZ(a,b,d)  _mm256_blendv_pd(_mm256_div_pd(a, b), d, VCMPZ(b))
+#  define MT            __m256d
+#  define MZERO         _mm256_setzero_pd()
+#  define MACC(m,b)     (m = _mm256_or_pd(m, VCMPZ(b)))
+#  define MANY(m)       _mm256_movemask_pd(m)
+#  define VI            __m256i
+#  define VTOI          _mm256_castpd_si256
+#  define VTOF          _mm256_castsi256_pd
+#  define VDUPI         _mm256_set1_epi64x
+#  define VADDI         _mm256_add_epi64
+#  define VANDI         _mm256_and_si256
+#  define VORI          _mm256_or_si256
+#  define VSLLI         _mm256_slli_epi64
+#  define VSRLI         _mm256_srli_epi64
+#  define VMIN          _mm256_min_pd
+#  define VMAX          _mm256_max_pd
+#  define VXOR          _mm256_xor_pd
+#  define VMASK         __m256d
+#  define VLT(a,b)      _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#  define VEQ(a,b)      _mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+#  define VSEL(m,t,f)   _mm256_blendv_pd(f, t, m)
+#  define VANYM(m)      _mm256_movemask_pd(m)
+#else
+#  define VT            __m256
+#  define VW            8
+#  define VLD           _mm256_loadu_ps
+#  define VST           _mm256_storeu_ps
+#  define VDUP          _mm256_set1_ps
+#  define VADD          _mm256_add_ps
+#  define VSUB          _mm256_sub_ps
+#  define VMUL          _mm256_mul_ps
+#  define VDIV          _mm256_div_ps
+#  define VCMPZ(x)      _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ)
+#  define VABS(x)       _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x)
+#  define VDIVZ(a,b,d)  _mm256_blendv_ps(_mm256_div_ps(a, b), d, VCMPZ(b))
+#  define MT            __m256
+#  define MZERO         _mm256_setzero_ps()
+#  define MACC(m,b)     (m = _mm256_or_ps(m, VCMPZ(b)))
+#  define MANY(m)       _mm256_movemask_ps(m)
+#  define VI            __m256i
+#  define VTOI          _mm256_castps_si256
+#  define VTOF          _mm256_castsi256_ps
+#  define VDUPI         _mm256_set1_epi32
+#  define VADDI         _mm256_add_epi32
+#  define VANDI         _mm256_and_si256
+#  define VORI          _mm256_or_si256
+#  define VSLLI         _mm256_slli_epi32
+#  define VSRLI         _mm256_srli_epi32
+#  define VMIN          _mm256_min_ps
+#  define VMAX          _mm256_max_ps
+#  define VXOR          _mm256_xor_ps
+#  define VMASK         __m256
+#  define VLT(a,b)      _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#  define VEQ(a,b)      _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+#  define VSEL(m,t,f)   _mm256_blendv_ps(f, t, m)
+#  define VANYM(m)      _mm256_movemask_ps(m)
+#endif
+
+AOPS_FUNCS(avx2,AOPS_AVX2)
+
+#undef VT
+#undef VW
+#undef VLD
+#undef VST
+#undef VDUP
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VCMPZ
+#undef VABS
+#undef VDIVZ
+#undef MT
+#undef MZERO
+#undef MACC
+#undef MANY
+#undef VI
+#undef VTOI
+#undef VTOF
+#undef VDUPI
+#undef VADDI
+#undef VANDI
+#undef VORI
+#undef VSLLI
+#undef VSRLI
+#undef VMIN
+#undef VMAX
+#undef VXOR
+#undef VMASK
+#undef VLT
+#undef VEQ
+#undef VSEL
+#undef VANYM
+
+/* AVX-512 */
+
+#ifdef USE_DOUBLE
+#  define VT            __m512d
+#  define VW            8
+#  define VLD           _mm512_loadu_pd
+#  define VST           _mm512_storeu_pd
+#  define VDUP          _mm512_set1_pd
+#  define VADD          _mm512_add_pd
+#  define VSUB          _mm512_sub_pd
+#  define VMUL          _mm512_mul_pd
+#  define VDIV          _mm512_div_pd
+#  define VCMPZ(x)      _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_EQ_OQ)
+#  define VABS(x)       _mm512_abs_pd(x)
+#  define VDIVZ(a,b,d)  _mm512_mask_blend_pd(VCMPZ(b), _mm512_div_pd(a, b), d)
+#  define VI            __m512i
+#  define VTOI          _mm512_castpd_si512
+#  define VTOF          _mm512_castsi512_pd
+#  define VDUPI         _mm512_set1_epi64
+#  define VADDI         _mm512_add_epi64
+#  define VSLLI         _mm512_slli_epi64
+#  define VSRLI         _mm512_srli_epi64
+#  define VMIN          _mm512_min_pd
+#  define VMAX          _mm512_max_pd
+#  define VMASK         __mmask8
+#  define VLT(a,b)      _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+#  define VEQ(a,b)      _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)
+#  define VSEL(m,t,f)   _mm512_mask_blend_pd(m, f, t)
+#else
+#  define VT            __m512
+#  define VW            16
+#  define VLD           _mm512_loadu_ps
+#  define VST           _mm512_storeu_ps
+#  define VDUP          _mm512_set1_ps
+#  define VADD          _mm512_add_ps
+#  define VSUB          _mm512_sub_ps
+#  define VMUL          _mm512_mul_ps
+#  define VDIV          _mm512_div_ps
+#  define VCMPZ(x)      _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_EQ_OQ)
+#  define VABS(x)       _mm512_abs_ps(x)
+#  define VDIVZ(a,b,d)  _mm512_mask_blend_ps(VCMPZ(b), _mm512_div_ps(a, b), d)
+#  define VI            __m512i
+#  define VTOI          _mm512_castps_si512
+#  define VTOF          _mm512_castsi512_ps
+#  define VDUPI         _mm512_set1_epi32
+#  define VADDI         _mm512_add_epi32
+#  define VSLLI         _mm512_slli_epi32
+#  define VSRLI         _mm512_srli_epi32
+#  define VMIN          _mm512_min_ps
+#  define VMAX          _mm512_max_ps
+#  define VMASK         __mmask16
+#  define VLT(a,b)      _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+#  define VEQ(a,b)      _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)
+#  define VSEL(m,t,f)   _mm512_mask_blend_ps(m, f, t)
+#endif
+#define MT              uint32_t
+#define MZERO           0
+#define MACC(m,b)       (m |= VCMPZ(b))
+#define MANY(m)         (m)
+/* AVX-512F has no floating point logic, so xor goes through integers */
+#define VANDI           _mm512_and_si512
+#define VORI            _mm512_or_si512
+#define VXOR(a,b)       VTOF(_mm512_xor_si512(VTOI(a), VTOI(b)))
+#define VANYM(m)        ((m) != 0)
+
+AOPS_FUNCS(avx512,AOPS_AVX512)
+
+#endif  /* AOPS_X86 */
+
+#ifdef AOPS_NEON
+
+#ifdef USE_DOUBLE
+#  define VT            float64x2_t
+#  define VW            2
+#  define VLD           vld1q_f64
+#  define VST           vst1q_f64
+#  define VDUP          vdupq_n_f64
+#  define VADD          vaddq_f64
+#  define VSUB          vsubq_f64
+#  define VMUL          vmulq_f64
+#  define VDIV          vdivq_f64
+#  define VABS          vabsq_f64
+#  define VDIVZ(a,b,d)  vbslq_f64(vceqzq_f64(b), d, vdivq_f64(a, b))
+#  define MT            uint64x2_t
+#  define MZERO         vdupq_n_u64(0)
+#  define MACC(m,b)     (m = vorrq_u64(m, vceqzq_f64(b)))
+#  define MANY(m)       vmaxvq_u32(vreinterpretq_u32_u64(m))
+#  define VI            int64x2_t
+#  define VTOI          vreinterpretq_s64_f64
+#  define VTOF          vreinterpretq_f64_s64
+#  define VDUPI         vdupq_n_s64
+#  define VADDI         vaddq_s64
+#  define VANDI         vandq_s64
+#  define VORI          vorrq_s64
+#  define VSLLI         vshlq_n_s64
+#  define VSRLI(x,k)    vreinterpretq_s64_u64(                  \
+                            vshrq_n_u64(vreinterpretq_u64_s64(x), k))
+#  define VMIN          vminq_f64
+#  define VMAX          vmaxq_f64
+#  define VXOR(a,b)     VTOF(veorq_s64(VTOI(a), VTOI(b)))
+#  define VMASK         uint64x2_t
+#  define VLT           vcltq_f64
+#  define VEQ           vceqq_f64
+#  define VSEL          vbslq_f64
+#  define VANYM(m)      vmaxvq_u32(vreinterpretq_u32_u64(m))
+#else
+#  define VT            float32x4_t
+#  define VW            4
+#  define VLD           vld1q_f32
+#  define VST           vst1q_f32
+#  define VDUP          vdupq_n_f32
+#  define VADD          vaddq_f32
+#  define VSUB          vsubq_f32
+#  define VMUL          vmulq_f32
+#  define VDIV          vdivq_f32
+#  define VABS          vabsq_f32
+#  define VDIVZ(a,b,d)  vbslq_f32(vceqzq_f32(b), d, vdivq_f32(a, b))
+#  define MT            uint32x4_t
+#  define MZERO         vdupq_n_u32(0)
+#  define MACC(m,b)     (m = vorrq_u32(m, vceqzq_f32(b)))
+#  define MANY(m)       vmaxvq_u32(m)
+#  define VI            int32x4_t
+#  define VTOI          vreinterpretq_s32_f32
+#  define VTOF          vreinterpretq_f32_s32
+#  define VDUPI         vdupq_n_s32
+#  define VADDI         vaddq_s32
+#  define VANDI         vandq_s32
+#  define VORI          vorrq_s32
+#  define VSLLI         vshlq_n_s32
+#  define VSRLI(x,k)    vreinterpretq_s32_u32(                  \
+                            vshrq_n_u32(vreinterpretq_u32_s32(x), k))
+#  define VMIN          vminq_f32
+#  define VMAX          vmaxq_f32
+#  define VXOR(a,b)     VTOF(veorq_s32(VTOI(a), VTOI(b)))
+#  define VMASK         uint32x4_t
+#  define VLT           vcltq_f32
+#  define VEQ           vceqq_f32
+#  define VSEL          vbslq_f32
+#  define VANYM(m)      vmaxvq_u32(m)
+#endif
+
+AOPS_FUNCS(neon,)
+
+#endif  /* AOPS_NEON */
+
+/**
+ * Points the opcode entries of the audio rate arithmetic at the
+ * versions for the widest instruction set this CPU has.
+ */
+
+void aops_dispatch(CSOUND *csound)
+{
+#if defined(AOPS_X86) || defined(AOPS_NEON)
+    const SUBR  *best;
+    const char  *name;
+    CONS_CELL   *top, *head, *items;
+    OENTRY      *ep;
+    size_t      i;
+    int         libm = 0;
+
+#  ifdef AOPS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+      best = aops_avx512, name = "AVX-512";
+    else if (__builtin_cpu_supports("avx2"))
+      best = aops_avx2, name = "AVX2";
+    else if (__builtin_cpu_supports("sse2"))
+      /* two lanes of sin, cos, exp, log and tanh polynomials are
+         slower than the library (tests/aops_math_bench), so keep it */
+      best = aops_sse2, name = "SSE2", libm = 1;
+    else
+      return;
+#  else
+    best = aops_neon, name = "NEON";
+#  endif
+    top = head = cs_hash_table_values(csound, csound->opcodes);
+    for ( ; head != NULL; head = head->next) {
+      for (items = head->value; items != NULL; items = items->next) {
+        ep = items->value;
+        for (i = 0; i < AOPS_NFUNCS; i++)
+          if (ep->kopadr == aops_generic[i]) {
+            if (!(libm && i >= AOPS_SINA && i <= AOPS_TANHA))
+              ep->kopadr = best[i];
+            break;
+          }
+      }
+    }
+    cs_cons_free(csound, top);
+    csound->DebugMsg(csound, "audio arithmetic: %s\n", name);
+#else
+    IGN(csound);
+#endif
+}
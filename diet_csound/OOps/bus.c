@@ -72,47 +72,91 @@
 
 
 
+/* Resolve numbered channel n for chani/chano and cache the data pointer
+   in the opcode.  The per-instance cache is only refreshed when the index
+   changes or a channel's data pointer is replaced, so the common case
+   costs a compare per k-cycle. */
+
+static CS_NOINLINE int32_t chn_num_resolve(CSOUND *csound, CHNVAL *p,
+                                           int32_t n, int32_t type)
+{
+    CHNNUMTAB *tab = (CHNNUMTAB*) csound->chn_numtab;
+    int32_t   k = ((type & CSOUND_CHANNEL_TYPE_MASK) == CSOUND_AUDIO_CHANNEL ?
+                   2 : 0) + ((type & CSOUND_OUTPUT_CHANNEL) ? 1 : 0);
+    MYFLT     *val;
+
+    if (tab == NULL) {
+      tab = (CHNNUMTAB*) csound->Calloc(csound, sizeof(CHNNUMTAB));
+      tab->gen = 1;
+      csound->chn_numtab = (void*) tab;
+    }
+    if (n >= tab->size[k]) {
+      int32_t size = tab->size[k] ? tab->size[k] : 16;
+      while (size <= n) size <<= 1;
+      tab->ptr[k] = (MYFLT**) csound->ReAlloc(csound, tab->ptr[k],
+                                              size * sizeof(MYFLT*));
+      memset(&tab->ptr[k][tab->size[k]], 0,
+             (size - tab->size[k]) * sizeof(MYFLT*));
+      tab->size[k] = size;
+    }
+    if ((val = tab->ptr[k][n]) == NULL) {
+      char    chan_name[16];
+      int32_t err;
+      snprintf(chan_name, 16, "%i", n);
+      err = csoundGetChannelPtr(csound, &val, chan_name, type);
+      if (UNLIKELY(err))
+        return err;
+      tab->ptr[k][n] = val;
+    }
+    p->fp = val;
+    p->idx = n;
+    p->gen = tab->gen;
+    return OK;
+}
+
+static inline int32_t chn_num_changed(CSOUND *csound, CHNVAL *p, int32_t n)
+{
+    return (n != p->idx || p->fp == NULL ||
+            p->gen != ((CHNNUMTAB*) csound->chn_numtab)->gen);
+}
+
 int32_t chani_opcode_perf_k(CSOUND *csound, CHNVAL *p)
 {
     int32_t     n = (int32_t)MYFLT2LRND(*(p->a));
-    char chan_name[16];
     int32_t   err;
-    MYFLT *val;
 
     if (UNLIKELY(n < 0))
         return csound->PerfError(csound, &(p->h),Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
-
-    if (UNLIKELY(err))
+    if (UNLIKELY(chn_num_changed(csound, p, n))) {
+      err = chn_num_resolve(csound, p, n,
+                            CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
+      if (UNLIKELY(err))
         return csound->PerfError(csound, &(p->h),
                                  Str("chani error %d:"
                                      "channel not found or not right type"), err);
-    *(p->r) = *val;
+    }
+    *(p->r) = *(p->fp);
     return OK;
 }
 
 int32_t chano_opcode_perf_k(CSOUND *csound, CHNVAL *p)
 {
     int32_t     n = (int32_t)MYFLT2LRND(*(p->a));
-    char chan_name[16];
     int32_t   err;
-    MYFLT *val;
 
     if (UNLIKELY(n < 0))
         return csound->PerfError(csound,&(p->h),Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
-
-    if (UNLIKELY(err))
+    if (UNLIKELY(chn_num_changed(csound, p, n))) {
+      err = chn_num_resolve(csound, p, n,
+                            CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
+      if (UNLIKELY(err))
         return csound->PerfError(csound, &(p->h),
                                  Str("chano error %d:"
                                      "channel not found or not right type"), err);
-    *val = *(p->r);
+    }
+    *(p->fp) = *(p->r);
     return OK;
 }
 
@@ -122,20 +166,21 @@ int32_t chani_opcode_perf_a(CSOUND *csound, CHNVAL *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
 
-    char chan_name[16];
     int32_t   err;
     MYFLT *val;
 
     if (UNLIKELY(n < 0))
         return csound->PerfError(csound, &(p->h),Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
-    if (UNLIKELY(err))
+    if (UNLIKELY(chn_num_changed(csound, p, n))) {
+      err = chn_num_resolve(csound, p, n,
+                            CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
+      if (UNLIKELY(err))
         return csound->PerfError(csound, &(p->h),
                                  Str("chani error %d:"
                                      "channel not found or not right type"), err);
+    }
+    val = p->fp;
     if (UNLIKELY(offset)) memset(p->r, '\0', offset * sizeof(MYFLT));
     memcpy(&p->r[offset], &val[offset],
            sizeof(MYFLT) * (CS_KSMPS-offset-early));
@@ -150,22 +195,22 @@ int32_t chano_opcode_perf_a(CSOUND *csound, CHNVAL *p)
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
 
-    char chan_name[16];
     int32_t   err;
     MYFLT *val;
 
     if (UNLIKELY(n < 0))
         return csound->PerfError(csound, &(p->h),Str("chani: invalid index"));
 
-    snprintf(chan_name, 16, "%i", n);
-    err = csoundGetChannelPtr(csound, &val, chan_name,
-                              CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
-    if (UNLIKELY(err))
+    if (UNLIKELY(chn_num_changed(csound, p, n))) {
+      err = chn_num_resolve(csound, p, n,
+                            CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL);
+      if (UNLIKELY(err))
         return csound->PerfError(csound, &(p->h),
                                  Str("chano error %d:"
                                      "channel not found or not right type"), err);
-
-    if (UNLIKELY(offset)) memset(&val, '\0', offset * sizeof(MYFLT));
+    }
+    val = p->fp;
+    if (UNLIKELY(offset)) memset(val, '\0', offset * sizeof(MYFLT));
     memcpy(&val[offset], &p->r[offset],
            sizeof(MYFLT) * (CS_KSMPS-offset-early));
 
@@ -303,10 +348,24 @@ int32_t pvsout_perf(CSOUND *csound, FCHAN *p)
 
 /* "chn" opcodes and bus interface by Istvan Varga */
 
+static void delete_channel_numtab(CSOUND *csound)
+{
+    CHNNUMTAB *tab = (CHNNUMTAB*) csound->chn_numtab;
+    int32_t   k;
+
+    if (tab == NULL)
+      return;
+    for (k = 0; k < 4; k++)
+      csound->Free(csound, tab->ptr[k]);
+    csound->Free(csound, tab);
+    csound->chn_numtab = NULL;
+}
+
 static int32_t delete_channel_db(CSOUND *csound, void *p)
 {
     CONS_CELL *head, *values;
     IGN(p);
+    delete_channel_numtab(csound);
     if (csound->chn_db == NULL) {
         return 0;
     }
@@ -333,6 +392,7 @@ static int32_t delete_channel_db(CSOUND *csound, void *p)
 
     cs_hash_table_mfree_complete(csound, csound->chn_db);
     csound->chn_db = NULL;
+    csound->chn_audio = NULL;
     return 0;
 }
 
@@ -347,8 +407,119 @@ static inline CHNENTRY *find_channel(CSOUND *csound, const char *name)
 void set_channel_data_ptr(CSOUND *csound,
                           const char *name, void *ptr, int32_t newSize)
 {
+    CHNNUMTAB *tab = (CHNNUMTAB*) csound->chn_numtab;
     find_channel(csound, name)->data = (MYFLT *) ptr;
     find_channel(csound, name)->datasize = newSize;
+    /* drop cached numbered channel pointers */
+    if (tab != NULL) {
+      int32_t k;
+      for (k = 0; k < 4; k++)
+        if (tab->size[k])
+          memset(tab->ptr[k], 0, tab->size[k] * sizeof(MYFLT*));
+      tab->gen++;
+    }
+}
+
+/* The host reads and writes audio channels (csoundGetAudioChannel(),
+   csoundSetAudioChannel() and csoundGetChannelSnapshot()) through two
+   triple buffers per channel, one each way.  Of the three blocks of
+   one, the writer owns one and the reader another; the third is handed
+   over with a single atomic exchange of its index, which has CHN_FRESH
+   set while the reader has not taken it.  Neither side ever waits for
+   the other.  The engine takes what a host has set at the start of a
+   k-cycle and hands out the channel data at the end of it; chnget,
+   chnset and the rest only lock a channel against each other, when the
+   instruments run on several threads. */
+
+#define CHN_FRESH       4
+
+#if defined(MSVC)
+#  define CHN_FENCE()           MemoryBarrier()
+#  define CHN_XCHG(var, val)    InterlockedExchange(&(var), val)
+#elif defined(HAVE_ATOMIC_BUILTIN)
+#  define CHN_FENCE()           __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#  define CHN_XCHG(var, val)    __atomic_exchange_n(&(var), val, \
+                                                    __ATOMIC_SEQ_CST)
+#else
+#  define CHN_FENCE()
+#  define CHN_XCHG(var, val)    chn_xchg(&(var), val)
+
+static inline long chn_xchg(volatile long *var, long val)
+{
+    long  old = *var;
+    *var = val;
+    return old;
+}
+#endif
+
+/* hand the block just written to the reader */
+
+static inline void chn_give(CHNXBUF *x)
+{
+    x->wr = (int32_t) (CHN_XCHG(x->mid, (long) (x->wr | CHN_FRESH)) & 3);
+}
+
+/* take the newest block handed over, or NULL if there is none since the
+   last call */
+
+static inline MYFLT *chn_take(CHNXBUF *x)
+{
+    if (!(ATOMIC_GET(x->mid) & CHN_FRESH))
+      return NULL;
+    x->rd = (int32_t) (CHN_XCHG(x->mid, (long) x->rd) & 3);
+    return x->buf[x->rd];
+}
+
+static inline MYFLT *chn_newest(CHNXBUF *x)
+{
+    MYFLT *p = chn_take(x);
+    return (p != NULL ? p : x->buf[x->rd]);
+}
+
+static CHNHOST *chn_host_alloc(CSOUND *csound, int32_t dsize)
+{
+    CHNHOST *h = (CHNHOST*) csound->Calloc(csound,
+                                           sizeof(CHNHOST) + 6 * dsize);
+    MYFLT   *b = (MYFLT*) (h + 1);
+    int32_t i;
+
+    for (i = 0; i < 3; i++) {
+      h->in.buf[i] = (MYFLT*) ((char*) b + i * dsize);
+      h->out.buf[i] = (MYFLT*) ((char*) b + (i + 3) * dsize);
+    }
+    h->in.wr = h->out.wr = 0;
+    h->in.rd = h->out.rd = 1;
+    h->in.mid = h->out.mid = 2;
+    csoundSpinLockInit(&h->lock);
+    return h;
+}
+
+/* Start of a k-cycle: audio channels get what a host has set since the
+   last one.  Also makes chn_bus_seq odd (see csoundGetChannelSnapshot) */
+
+void chn_bus_begin(CSOUND *csound)
+{
+    CHNENTRY  *pp;
+    MYFLT     *src;
+
+    ATOMIC_INCR(csound->chn_bus_seq);
+    for (pp = (CHNENTRY*) csound->chn_audio; pp != NULL; pp = pp->nxt)
+      if ((src = chn_take(&pp->host->in)) != NULL)
+        memcpy(pp->data, src, csound->ksmps * sizeof(MYFLT));
+}
+
+/* End of a k-cycle: hand the audio channels to the host */
+
+void chn_bus_end(CSOUND *csound)
+{
+    CHNENTRY  *pp;
+
+    for (pp = (CHNENTRY*) csound->chn_audio; pp != NULL; pp = pp->nxt) {
+      memcpy(pp->host->out.buf[pp->host->out.wr], pp->data,
+             csound->ksmps * sizeof(MYFLT));
+      chn_give(&pp->host->out);
+    }
+    ATOMIC_INCR(csound->chn_bus_seq);
 }
 
 #define INIT_STRING_CHANNEL_DATASIZE 256
@@ -384,6 +555,8 @@ static CS_NOINLINE CHNENTRY *alloc_channel(CSOUND *csound,
 
     csoundSpinLockInit(&pp->lock);
     pp->datasize = dsize;
+    if ((type & CSOUND_CHANNEL_TYPE_MASK) == CSOUND_AUDIO_CHANNEL)
+        pp->host = chn_host_alloc(csound, dsize);
 
     return (CHNENTRY*) pp;
 }
@@ -414,6 +587,11 @@ static CS_NOINLINE int32_t create_new_channel(CSOUND *csound, const char *name,
     strcpy(&(pp->name[0]), name);
 
     cs_hash_table_put(csound, csound->chn_db, (char*)name, pp);
+    if (pp->host != NULL) {
+        pp->nxt = (CHNENTRY*) csound->chn_audio;
+        CHN_FENCE();
+        csound->chn_audio = pp;
+    }
 
     return CSOUND_SUCCESS;
 }
@@ -473,6 +651,129 @@ PUBLIC int32_t *csoundGetChannelLock(CSOUND *csound,
     else return NULL;
 }
 
+/* copy an audio channel for csoundGetAudioChannel(), as the engine
+   left it at the end of the last k-cycle */
+
+void read_audio_channel(CSOUND *csound, const char *name, MYFLT *samples)
+{
+    CHNENTRY  *pp = find_channel(csound, name);
+
+    if (UNLIKELY(pp == NULL || pp->host == NULL))
+      return;
+    csoundSpinLock(&pp->host->lock);
+    memcpy(samples, chn_newest(&pp->host->out),
+           csound->ksmps * sizeof(MYFLT));
+    csoundSpinUnLock(&pp->host->lock);
+}
+
+/* write an audio channel for csoundSetAudioChannel(), for the engine to
+   take at the start of the next k-cycle */
+
+void write_audio_channel(CSOUND *csound, const char *name,
+                         const MYFLT *samples)
+{
+    CHNENTRY  *pp = find_channel(csound, name);
+
+    if (UNLIKELY(pp == NULL || pp->host == NULL))
+      return;
+    csoundSpinLock(&pp->host->lock);
+    memcpy(pp->host->in.buf[pp->host->in.wr], samples,
+           csound->ksmps * sizeof(MYFLT));
+    chn_give(&pp->host->in);
+    csoundSpinUnLock(&pp->host->lock);
+}
+
+/* bounds for csoundGetChannelSnapshot() waiting on the engine */
+#define CHN_SNAPSHOT_TRIES  8
+#define CHN_SNAPSHOT_SPIN   100000
+
+static int32_t chn_snapshot_copy(CSOUND *csound, CHNENTRY **chn,
+                                 MYFLT **values, int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i++) {
+      CHNENTRY *pp = chn[i];
+      if ((pp->type & CSOUND_CHANNEL_TYPE_MASK) == CSOUND_CONTROL_CHANNEL) {
+#if defined(MSVC)
+        union {
+          MYFLT d;
+          MYFLT_INT_TYPE i;
+        } x;
+        x.i = InterlockedExchangeAdd64((MYFLT_INT_TYPE *) pp->data, 0);
+        *(values[i]) = x.d;
+#elif defined(HAVE_ATOMIC_BUILTIN)
+        union {
+          MYFLT d;
+          MYFLT_INT_TYPE i;
+        } x;
+        x.i = __atomic_load_n((MYFLT_INT_TYPE *) pp->data, __ATOMIC_SEQ_CST);
+        *(values[i]) = x.d;
+#else
+        *(values[i]) = *(pp->data);
+#endif
+      }
+      else {
+        csoundSpinLock(&pp->host->lock);
+        memcpy(values[i], chn_newest(&pp->host->out),
+               csound->ksmps * sizeof(MYFLT));
+        csoundSpinUnLock(&pp->host->lock);
+      }
+    }
+    return CSOUND_SUCCESS;
+}
+
+/* Copy a set of control and audio channels in one call.  The copy is
+   taken between two performance passes, so all values belong to the same
+   k-cycle; if the engine stays busy for longer than the retry budget the
+   channels are still copied one by one and 1 is returned instead. */
+
+PUBLIC int32_t csoundGetChannelSnapshot(CSOUND *csound, const char **names,
+                                        MYFLT **values, int32_t count)
+{
+    CHNENTRY  *chnbuf[16], **chn = chnbuf;
+    int32_t   i, tries, ret = 1;
+
+    if (UNLIKELY(count <= 0))
+      return CSOUND_SUCCESS;
+    if (count > 16)
+      chn = (CHNENTRY**) csound->Malloc(csound, count * sizeof(CHNENTRY*));
+    for (i = 0; i < count; i++) {
+      int32_t type;
+      chn[i] = (names[i] != NULL ? find_channel(csound, names[i]) : NULL);
+      if (UNLIKELY(chn[i] == NULL))
+        break;
+      type = chn[i]->type & CSOUND_CHANNEL_TYPE_MASK;
+      if (UNLIKELY(type != CSOUND_CONTROL_CHANNEL &&
+                   type != CSOUND_AUDIO_CHANNEL))
+        break;
+    }
+    if (UNLIKELY(i < count)) {
+      if (chn != chnbuf)
+        csound->Free(csound, chn);
+      return CSOUND_ERROR;
+    }
+    for (tries = 0; tries < CHN_SNAPSHOT_TRIES; tries++) {
+      long  s;
+      int32_t spin = CHN_SNAPSHOT_SPIN;
+      while (((s = ATOMIC_GET(csound->chn_bus_seq)) & 1) && --spin)
+        ;
+      if (s & 1)
+        continue;
+      CHN_FENCE();
+      chn_snapshot_copy(csound, chn, values, count);
+      CHN_FENCE();
+      if (ATOMIC_GET(csound->chn_bus_seq) == s) {
+        ret = CSOUND_SUCCESS;
+        break;
+      }
+    }
+    if (ret != CSOUND_SUCCESS)
+      chn_snapshot_copy(csound, chn, values, count);
+    if (chn != chnbuf)
+      csound->Free(csound, chn);
+    return ret;
+}
+
 static int32_t cmp_func(const void *p1, const void *p2)
 {
     return strcmp(((controlChannelInfo_t*) p1)->name,
@@ -646,10 +947,24 @@ static CS_NOINLINE int32_t print_chn_err(void *p, int32_t err)
 }
 
 
+/* true if input argument n of the opcode is a string literal; such
+   channel names cannot change after init, so the perf-time routines
+   skip comparing them against the cached name */
+
+static int32_t chn_name_is_literal(OPDS *h, int32_t n)
+{
+    ARG *arg = h->optext->t.inArgs;
+    while (n-- > 0 && arg != NULL)
+      arg = arg->next;
+    return (arg != NULL && arg->type == ARG_STRING);
+}
+
 /* receive control value from bus at performance time */
 static int32_t chnget_opcode_perf_k(CSOUND* csound, CHNGET* p)
 {
-    if (strncmp(p->chname, p->iname->data, MAX_CHAN_NAME) || !strcmp(p->iname->data, ""))
+    if (UNLIKELY(p->fp == NULL ||
+                 (!p->constname &&
+                  strncmp(p->chname, p->iname->data, MAX_CHAN_NAME))))
     {
         int32_t err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
                                           CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
@@ -688,8 +1003,11 @@ static int32_t chnget_opcode_perf_a(CSOUND* csound, CHNGET* p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early = p->h.insdshead->ksmps_no_end;
+    MYFLT    *src;
 
-    if (strncmp(p->chname, p->iname->data, MAX_CHAN_NAME)  || !strcmp(p->iname->data, ""))
+    if (UNLIKELY(p->fp == NULL ||
+                 (!p->constname &&
+                  strncmp(p->chname, p->iname->data, MAX_CHAN_NAME))))
     {
         int32_t err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
                                           CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL);
@@ -701,28 +1019,19 @@ static int32_t chnget_opcode_perf_a(CSOUND* csound, CHNGET* p)
             print_chn_err_perf(p, err);
             return OK;
         }
-    } 
-      
-    
-
-    if (CS_KSMPS==(uint32_t) csound->ksmps){
-        csoundSpinLock(p->lock);
-        if (UNLIKELY(offset)) memset(p->arg, '\0', offset);
-        memcpy(&p->arg[offset], p->fp, sizeof(MYFLT)*(CS_KSMPS-offset-early));
-        if (UNLIKELY(early))
-            memset(&p->arg[CS_KSMPS-early], '\0', sizeof(MYFLT)*early);
-        csoundSpinUnLock(p->lock);
     }
-    else {
-        csoundSpinLock(p->lock);
-        if (UNLIKELY(offset)) memset(p->arg, '\0', offset);
-        memcpy(&p->arg[offset], &(p->fp[offset+p->pos]),
-               sizeof(MYFLT)*(CS_KSMPS-offset-early));
-        if (UNLIKELY(early))
-            memset(&p->arg[CS_KSMPS-early], '\0', sizeof(MYFLT)*early);
+
+    src = (CS_KSMPS==(uint32_t) csound->ksmps) ? p->fp : &(p->fp[p->pos]);
+    if (UNLIKELY(offset)) memset(p->arg, '\0', offset*sizeof(MYFLT));
+    csoundSpinLock(p->lock);
+    memcpy(&p->arg[offset], &src[offset],
+           sizeof(MYFLT)*(CS_KSMPS-offset-early));
+    csoundSpinUnLock(p->lock);
+    if (UNLIKELY(early))
+        memset(&p->arg[CS_KSMPS-early], '\0', sizeof(MYFLT)*early);
+    if (CS_KSMPS!=(uint32_t) csound->ksmps) {
         p->pos += CS_KSMPS;
         p->pos %= (csound->ksmps-offset);
-        csoundSpinUnLock(p->lock);
     }
 
     return OK;
@@ -1159,6 +1468,7 @@ int32_t chnget_opcode_init_k(CSOUND *csound, CHNGET *p)
         p->lock =   (spin_lock_t *)csoundGetChannelLock(csound, (char*) p->iname->data);
         strNcpy(p->chname, p->iname->data, MAX_CHAN_NAME);
     }
+    p->constname = chn_name_is_literal(&(p->h), 0);
 
     p->h.opadr = (SUBR) chnget_opcode_perf_k;
     return OK;
@@ -1178,6 +1488,7 @@ int32_t chnget_opcode_init_a(CSOUND* csound, CHNGET* p)
         p->lock = (spin_lock_t*) csoundGetChannelLock(csound, (char*) p->iname->data);
         strNcpy(p->chname, p->iname->data, MAX_CHAN_NAME);
     }
+    p->constname = chn_name_is_literal(&(p->h), 0);
 
     p->h.opadr = (SUBR) chnget_opcode_perf_a;
     return OK;
@@ -1250,15 +1561,19 @@ int32_t chnget_opcode_perf_S(CSOUND* csound, CHNGET* p)
 
 static int32_t chnset_opcode_perf_k(CSOUND *csound, CHNGET *p)
 {
-    if(strncmp(p->chname, p->iname->data, MAX_CHAN_NAME)){
+    if (UNLIKELY(p->fp == NULL ||
+                 (!p->constname &&
+                  strncmp(p->chname, p->iname->data, MAX_CHAN_NAME)))) {
         int32_t err = csoundGetChannelPtr(csound, &(p->fp), (char*) p->iname->data,
                                           CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL);
         if(err == 0) {
             p->lock = (spin_lock_t *) csoundGetChannelLock(csound, (char*) p->iname->data);
             strNcpy(p->chname, p->iname->data, MAX_CHAN_NAME);
         }
-        else
+        else {
             print_chn_err_perf(p, err);
+            return OK;
+        }
     } // else return csound->PerfError(csound, &p->h, "invalid channel name");
 
 #if defined(MSVC)
@@ -1396,7 +1711,9 @@ int32_t chnset_opcode_init_k(CSOUND* csound, CHNGET* p)
                               CSOUND_CONTROL_CHANNEL | CSOUND_OUTPUT_CHANNEL);
     if (LIKELY(!err)) {
         p->lock = (spin_lock_t*) csoundGetChannelLock(csound, (char*) p->iname->data);
+        strNcpy(p->chname, p->iname->data, MAX_CHAN_NAME);
     } else return print_chn_err(p, err);
+    p->constname = chn_name_is_literal(&(p->h), 1);
 
     p->h.opadr = (SUBR) chnset_opcode_perf_k;
     return OK;
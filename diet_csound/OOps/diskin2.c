@@ -29,10 +29,144 @@
 
 typedef struct DISKIN_INST_ {
   CSOUND *csound;
-  DISKIN2 *diskin;
+  void   *diskin;
   struct DISKIN_INST_ *nxt;
 } DISKIN_INST;
 
+/* reader thread refilling the circular buffers of the asynchronous   */
+/* instances; it sleeps until an instance drains below its prefetch   */
+/* level, and the instance list is only changed under 'lock'          */
+
+typedef struct {
+  CSOUND  *csound;
+  DISKIN_INST *top;
+  void    *thread;
+  void    *wake;
+  void    *lock;
+  int32_t (*fill)(CSOUND *, void *);
+  volatile long run;
+} DISKIN_IO;
+
+static uintptr_t diskin_io_thread(void *arg)
+{
+    DISKIN_IO   *io = (DISKIN_IO *) arg;
+    CSOUND      *csound = io->csound;
+    DISKIN_INST *current;
+
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    while (1) {
+      csound->WaitThreadLockNoTimeout(io->wake);
+      if (!ATOMIC_GET(io->run))
+        break;
+      csound->LockMutex(io->lock);
+      for (current = io->top; current != NULL; current = current->nxt)
+        io->fill(current->csound, current->diskin);
+      csound->UnlockMutex(io->lock);
+    }
+    return 0;
+}
+
+/* add instance 'p' to the reader named 'name', starting the thread */
+/* for the first one                                                */
+
+static DISKIN_IO *diskin_io_add(CSOUND *csound, const char *name, void *p,
+                                int32_t (*fill)(CSOUND *, void *))
+{
+    DISKIN_IO   *io = (DISKIN_IO *) csound->QueryGlobalVariable(csound, name);
+    DISKIN_INST *current;
+
+    if (io == NULL) {
+      if (UNLIKELY(csound->CreateGlobalVariable(csound, name,
+                                                sizeof(DISKIN_IO)) != 0))
+        return NULL;
+      io = (DISKIN_IO *) csound->QueryGlobalVariable(csound, name);
+      io->csound = csound;
+      io->fill = fill;
+      io->lock = csound->Create_Mutex(0);
+      io->wake = csound->CreateThreadLock();
+#ifndef __EMSCRIPTEN__
+      io->run = 1;
+      io->thread = csound->CreateThread(diskin_io_thread, io);
+#endif
+    }
+    current = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
+    current->csound = csound;
+    current->diskin = p;
+    csound->LockMutex(io->lock);
+    current->nxt = io->top;
+    io->top = current;
+    csound->UnlockMutex(io->lock);
+    /* have the ring filled before the first performance pass */
+    csound->NotifyThreadLock(io->wake);
+    return io;
+}
+
+/* remove instance 'p', stopping the thread when it was the last one */
+
+static void diskin_io_remove(CSOUND *csound, const char *name, void *p)
+{
+    DISKIN_IO   *io = (DISKIN_IO *) csound->QueryGlobalVariable(csound, name);
+    DISKIN_INST **pp, *current = NULL;
+
+    if (io == NULL)
+      return;
+    csound->LockMutex(io->lock);
+    for (pp = &(io->top); *pp != NULL; pp = &((*pp)->nxt)) {
+      if ((*pp)->diskin == p) {
+        current = *pp;
+        *pp = current->nxt;
+        break;
+      }
+    }
+    csound->UnlockMutex(io->lock);
+    if (current != NULL)
+      csound->Free(csound, current);
+    if (io->top == NULL) {
+#ifndef __EMSCRIPTEN__
+      ATOMIC_SET(io->run, 0);
+      csound->NotifyThreadLock(io->wake);
+      csound->JoinThread(io->thread);
+#endif
+      csound->DestroyThreadLock(io->wake);
+      csound->DestroyMutex(io->lock);
+      csound->DestroyGlobalVariable(csound, name);
+    }
+}
+
+/* the fill level, in samples, below which an instance wakes the reader: */
+/* 'frames' ahead of playback (the iprefetch argument), clamped to the   */
+/* ring of 2 * bufSize frames, or half the ring when it is not given     */
+
+static int32_t diskin_prefetch(MYFLT frames, int32_t bufSize,
+                               int32_t nChannels)
+{
+    int32_t n = (int32_t) frames;
+
+    if (n <= 0)
+      n = bufSize;
+    else if (n > 2 * bufSize - 1)
+      n = 2 * bufSize - 1;
+    return n * nChannels;
+}
+
+
+/* read 'nframes' sample frames from frame 'pos' of the file, from the */
+/* shared sample cache if the file is in it; returns the number of mono */
+/* samples read, or zero on error                                       */
+
+static inline int32_t diskin2_read_frames(CSOUND *csound, SNDFILE *sf,
+                                          void *sc, MYFLT *buf, int32_t pos,
+                                          int32_t nframes, int32_t nChannels)
+{
+    int32_t i;
+
+    if (sc != NULL)
+      return sndcache_read(csound, sc, buf, pos, nframes) * nChannels;
+    sf_seek(sf, (sf_count_t) pos, SEEK_SET);
+    /* convert sample count to mono samples and read file */
+    i = (int32_t) sf_read_MYFLT(sf, buf, (sf_count_t) nframes * nChannels);
+    return (i < 0 ? 0 : i);
+}
 
 static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
                                             DISKIN2 *p, int32_t bufReadPos)
@@ -40,7 +174,6 @@ static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
     MYFLT *tmp;
     int32_t nsmps;
     int32_t i;
-    IGN(csound);
     /* swap buffer pointers */
     tmp = p->buf;
     p->buf = p->prvBuf;
@@ -67,12 +200,8 @@ static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
       if (nsmps > 0L) {         /* if there is anything to read: */
         if (nsmps > (int32_t) p->bufSize)
           nsmps = (int32_t) p->bufSize;
-        nsmps *= (int32_t) p->nChannels;
-        sf_seek(p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
-        /* convert sample count to mono samples and read file */
-        i = (int32_t)sf_read_MYFLT(p->sf, p->buf, (sf_count_t) nsmps);
-        if (UNLIKELY(i < 0))  /* error ? */
-          i = 0;    /* clear entire buffer to zero */
+        i = diskin2_read_frames(csound, p->sf, p->sc, p->buf,
+                                p->bufStartPos, nsmps, p->nChannels);
       }
     }
     /* fill rest of buffer with zero samples */
@@ -229,6 +358,7 @@ int32_t diskin2_init(CSOUND *csound, DISKIN2 *p) {
     p->WinSize = *p->iWinSize;
     p->BufSize =  *p->iBufSize;
     p->fforceSync = *p->forceSync;
+    p->Prefetch = *p->iPrefetch;
     return diskin2_init_(csound,p,0);
 }
 
@@ -237,6 +367,7 @@ int32_t diskin2_init_S(CSOUND *csound, DISKIN2 *p) {
     p->WinSize = *p->iWinSize;
     p->BufSize =  *p->iBufSize;
     p->fforceSync = *p->forceSync;
+    p->Prefetch = *p->iPrefetch;
     return diskin2_init_(csound,p,1);
 }
 
@@ -247,6 +378,7 @@ int32_t diskin_init(CSOUND *csound, DISKIN2 *p){
     p->WinSize = 2;
     p->BufSize = 0;
     p->fforceSync = 0;
+    p->Prefetch = 0;
     return diskin2_init_(csound,p,0);
 }
 
@@ -255,6 +387,7 @@ int32_t diskin_init_S(CSOUND *csound, DISKIN2 *p){
     p->WinSize = 2;
     p->BufSize = 0;
     p->fforceSync = 0;
+    p->Prefetch = 0;
     return diskin2_init_(csound,p,1);
 }
 
@@ -269,6 +402,7 @@ int32_t sndinset(CSOUND *csound, DISKIN2 *p) {
     p->WinSize = 2;
     p->BufSize = 0;
     p->fforceSync = 0;
+    p->Prefetch = 0;
     ret = diskin2_init_(csound,p,0);
     return ret;
 }
@@ -281,6 +415,7 @@ int32_t sndinset_S(CSOUND *csound, DISKIN2 *p){
     p->WinSize = 2;
     p->BufSize = 0;
     p->fforceSync = 0;
+    p->Prefetch = 0;
     ret = diskin2_init_(csound,p,1);
     return ret;
 }
@@ -296,6 +431,17 @@ int32_t soundin(CSOUND *csound, DISKIN2 *p){
 
 int32_t diskin2_async_deinit(CSOUND *csound, void *p);
 
+static int32_t diskin2_cache_deinit(CSOUND *csound, void *p)
+{
+    DISKIN2 *pp = (DISKIN2*) p;
+
+    if (pp->sc != NULL) {
+      sndcache_close(csound, pp->sc);
+      pp->sc = NULL;
+    }
+    return OK;
+}
+
 static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
 {
     double  pos;
@@ -311,11 +457,16 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
                                Str("diskin2: invalid number of channels"));
     }
     /* if already open, close old file first */
-    if (p->fdch.fd != NULL) {
+    if (p->fdch.fd != NULL || p->sc != NULL) {
       /* skip initialisation if requested */
       if (p->SkipInit != FL(0.0))
         return OK;
-      csound_fd_close(csound, &(p->fdch));
+      if (p->fdch.fd != NULL)
+        csound_fd_close(csound, &(p->fdch));
+      if (p->sc != NULL) {
+        sndcache_close(csound, p->sc);
+        p->sc = NULL;
+      }
     }
     /* set default format parameters */
     memset(&sfinfo, 0, sizeof(SF_INFO));
@@ -417,16 +568,15 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
     p->prvBuf = (MYFLT*) p->buf + (int32_t)n;
 
     memset(p->buf, 0, n*sizeof(MYFLT));
+    /* share decoded data with other instances reading the same file */
+    p->sc = sndcache_open(csound, fd, &sfinfo);
 
     // create circular buffer, on fail set mode to synchronous
     if (csound->oparms->realtime==1 && p->fforceSync==0 &&
         (p->cb = csound->CreateCircularBuffer(csound,
                                               p->bufSize*p->nChannels*2,
                                               sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-#ifndef __EMSCRIPTEN__
-      int32_t *start;
-#endif
+      int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p);
       // allocate buffer
       p->aOut_bufsize =  ((unsigned int)p->bufSize) < CS_KSMPS ?
         ((MYFLT)CS_KSMPS) : ((MYFLT)p->bufSize);
@@ -435,41 +585,9 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
         csound->AuxAlloc(csound, (int32_t) n, &(p->auxData2));
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
-      top = (DISKIN_INST **)csound->QueryGlobalVariable(csound, "DISKIN_INST");
-#ifndef __EMSCRIPTEN__
-      if (top == NULL){
-        csound->CreateGlobalVariable(csound, "DISKIN_INST", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound, "DISKIN_INST");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound, "DISKIN_PTHREAD", sizeof(void**));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START", sizeof(int32_t));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt = (DISKIN_INST *) csound->Calloc(csound,
-                                                        sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin = p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if ( *(start = csound->QueryGlobalVariable(csound,
-                                                 "DISKIN_THREAD_START")) == 0) {
-        uintptr_t diskin_io_thread(void *p);
-        void **thread = csound->QueryGlobalVariable(csound, "DISKIN_PTHREAD");
-        *thread = csound->CreateThread(diskin_io_thread, *top);
-        *start = 1;
-      }
-#endif
+      p->prefetch = diskin_prefetch(p->Prefetch, p->bufSize, p->nChannels);
+      p->io = diskin_io_add(csound, "DISKIN_IO", p,
+                            (int32_t (*)(CSOUND *, void *)) diskin_file_read);
       csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
       p->async = 1;
 
@@ -501,6 +619,13 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
                         Str("sample frames\n"));
       }
     }
+    if (p->sc != NULL) {
+      /* the cache reads the file through its own handle */
+      csound_fd_close(csound, &(p->fdch));
+      p->sf = NULL;
+      if (!p->async)
+        csound->RegisterDeinitCallback(csound, p, diskin2_cache_deinit);
+    }
 
     /* done initialisation */
     p->initDone = 1;
@@ -509,35 +634,9 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
 
 int32_t diskin2_async_deinit(CSOUND *csound,  void *p){
 
-    DISKIN_INST **top, *current, *prv;
-
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST")) == NULL) return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
-    }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int32_t *start; void **pt;
-
-      start = (int32_t *) csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      *start = 0;
-      pt = csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      csound->JoinThread(*pt);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST");
-    }
-#endif
-    csound->Free(csound, current);
+    diskin_io_remove(csound, "DISKIN_IO", p);
     csound->DestroyCircularBuffer(csound, ((DISKIN2 *)p)->cb);
+    diskin2_cache_deinit(csound, p);
 
     return OK;
 }
@@ -571,7 +670,7 @@ int32_t diskin2_perf_synchronous(CSOUND *csound, DISKIN2 *p)
     int32_t  wsized2, warp;
 
 
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
+    if (UNLIKELY(p->fdch.fd == NULL && p->sc == NULL)) goto file_error;
     if (!p->initDone && !p->SkipInit){
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
@@ -748,9 +847,8 @@ int checkspace(void *p, int writeCheck);
 
 int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p)
 {
-    /* nsmps is bufsize in frames */
-  int32_t nsmps = checkspace(p->cb,1); // suggest in issue #1535 (no patch supplied though, but seems to work)
-   //p->aOut_bufsize;// - p->h.insdshead->ksmps_offset;
+    /* nsmps is the free space of the ring in frames, at most bufsize */
+    int32_t nsmps = checkspace(p->cb,1) / p->nChannels;
     int32_t i, nn;
     int32_t chn, chans = p->nChannels;
     double  d, frac_d, x, c, v, pidwarp_d;
@@ -760,7 +858,11 @@ int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p)
     MYFLT   *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
     MYFLT transpose = p->transpose;
 
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
+    if (UNLIKELY(p->fdch.fd == NULL && p->sc == NULL)) goto file_error;
+    if (nsmps > (int32_t)p->aOut_bufsize)
+      nsmps = (int32_t)p->aOut_bufsize;
+    if (nsmps <= 0)
+      return OK;
     if (!p->initDone && !p->SkipInit) {
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
@@ -924,13 +1026,9 @@ int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p)
     }
     {
       /* write to circular buffer */
-      int32_t lc, mc=0, nc=nsmps*p->nChannels;
-      int32_t *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc =  csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
+      int32_t nc=nsmps*p->nChannels;
+      /* there is room for all of it, only this thread writes */
+      csound->WriteCircularBuffer(csound, p->cb, aOut, nc);
     }
     return OK;
  file_error:
@@ -957,7 +1055,7 @@ int32_t diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
       if (UNLIKELY(early)) nsmps -= early;
     }
 
-    if (UNLIKELY(p->fdch.fd == NULL)) return NOTOK;
+    if (UNLIKELY(p->fdch.fd == NULL && p->sc == NULL)) return NOTOK;
     if (!p->initDone && !p->SkipInit){
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
@@ -965,36 +1063,19 @@ int32_t diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
     for (nn = offset; nn < nsmps; nn++){
 
       for (chn = 0; chn < chans; chn++) {
-        //int32_t i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
+        /* play silence rather than stale data if the reader is late */
+        if (UNLIKELY(csound->ReadCircularBuffer(csound, cb, &samp, 1) == 0))
+          samp = FL(0.0);
         p->aOut[chn][nn] = csound->e0dbfs*samp;
       }
     }
+    /* wake the reader once the ring has drained below the prefetch level */
+    if (checkspace(cb, 0) < p->prefetch)
+      csound->NotifyThreadLock(((DISKIN_IO *) p->io)->wake);
     return OK;
 }
 
 
-uintptr_t diskin_io_thread(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int32_t wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int32_t *start =
-      current->csound->QueryGlobalVariable(current->csound,"DISKIN_THREAD_START");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read(current->csound, current->diskin);
-        current = current->nxt;
-      }
-    }
-    return 0;
-}
-
-
 int32_t diskin2_perf(CSOUND *csound, DISKIN2 *p) {
     if (!p->async) return diskin2_perf_synchronous(csound, p);
     else return diskin2_perf_asynchronous(csound, p);
@@ -1168,7 +1249,6 @@ static CS_NOINLINE void diskin2_read_buffer_array(CSOUND *csound,
     MYFLT   *tmp;
     int32_t nsmps;
     int32_t i;
-    IGN(csound);
     /* swap buffer pointers */
     tmp = p->buf;
     p->buf = p->prvBuf;
@@ -1195,12 +1275,8 @@ static CS_NOINLINE void diskin2_read_buffer_array(CSOUND *csound,
       if (nsmps > 0L) {         /* if there is anything to read: */
         if (nsmps > (int32_t) p->bufSize)
           nsmps = (int32_t) p->bufSize;
-        nsmps *= (int32_t) p->nChannels;
-        sf_seek(p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
-        /* convert sample count to mono samples and read file */
-        i = (int32_t)sf_read_MYFLT(p->sf, p->buf, (sf_count_t) nsmps);
-        if (UNLIKELY(i < 0))  /* error ? */
-          i = 0;    /* clear entire buffer to zero */
+        i = diskin2_read_frames(csound, p->sf, p->sc, p->buf,
+                                p->bufStartPos, nsmps, p->nChannels);
       }
     }
     /* fill rest of buffer with zero samples */
@@ -1313,39 +1389,22 @@ static inline void diskin2_get_sample_array(CSOUND *csound,
     }
 }
 
-int32_t diskin2_async_deinit_array(CSOUND *csound,  void *p){
-
-    DISKIN_INST **top, *current, *prv;
+static int32_t diskin2_cache_deinit_array(CSOUND *csound, void *p)
+{
+    DISKIN2_ARRAY *pp = (DISKIN2_ARRAY*) p;
 
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY")) == NULL)
-      return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
+    if (pp->sc != NULL) {
+      sndcache_close(csound, pp->sc);
+      pp->sc = NULL;
     }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
+    return OK;
+}
 
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int32_t *start; void **pt;
-      start = (int32_t *) csound->QueryGlobalVariable(csound,
-                                                  "DISKIN_THREAD_START_ARRAY");
-      *start = 0;
-      pt = csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD_ARRAY");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      csound->JoinThread(*pt);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST_ARRAY");
-    }
-#endif
+int32_t diskin2_async_deinit_array(CSOUND *csound,  void *p){
 
-    csound->Free(csound, current);
+    diskin_io_remove(csound, "DISKIN_IO_ARRAY", p);
     csound->DestroyCircularBuffer(csound, ((DISKIN2_ARRAY *)p)->cb);
+    diskin2_cache_deinit_array(csound, p);
 
     return OK;
 }
@@ -1353,8 +1412,8 @@ int32_t diskin2_async_deinit_array(CSOUND *csound,  void *p){
 
 int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
 {
-    /* nsmps is bufsize in frames */
-  int32_t nsmps = p->aOut_bufsize;// - p->h.insdshead->ksmps_offset;
+    /* nsmps is the free space of the ring in frames, at most bufsize */
+    int32_t nsmps = checkspace(p->cb,1) / p->nChannels;
     int32_t i, nn;
     int32_t chn, chans = p->nChannels;
     double  d, frac_d, x, c, v, pidwarp_d;
@@ -1363,7 +1422,11 @@ int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
     int32_t     wsized2, warp;
     MYFLT  *aOut = (MYFLT *)p->aOut_buf; /* needs to be allocated */
 
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
+    if (UNLIKELY(p->fdch.fd == NULL && p->sc == NULL)) goto file_error;
+    if (nsmps > (int32_t)p->aOut_bufsize)
+      nsmps = (int32_t)p->aOut_bufsize;
+    if (nsmps <= 0)
+      return OK;
     if (!p->initDone && !p->SkipInit) {
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
@@ -1527,13 +1590,9 @@ int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
     }
     {
       /* write to circular buffer */
-      int32_t lc, mc=0, nc=nsmps*p->nChannels;
-      int32_t *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
+      int32_t nc=nsmps*p->nChannels;
+      /* there is room for all of it, only this thread writes */
+      csound->WriteCircularBuffer(csound, p->cb, aOut, nc);
     }
     return OK;
  file_error:
@@ -1541,25 +1600,6 @@ int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
     return NOTOK;
 }
 
-uintptr_t diskin_io_thread_array(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int32_t wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int32_t *start =
-      current->csound->QueryGlobalVariable(current->csound,
-                                           "DISKIN_THREAD_START_ARRAY");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read_array(current->csound, (DISKIN2_ARRAY *)current->diskin);
-        current = current->nxt;
-      }
-    }
-    return 0;
-}
-
-
 static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
                                   int32_t stringname)
 {
@@ -1571,11 +1611,16 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
     ARRAYDAT *t = p->aOut;
 
     /* if already open, close old file first */
-    if (p->fdch.fd != NULL) {
+    if (p->fdch.fd != NULL || p->sc != NULL) {
       /* skip initialisation if requested */
       if (p->SkipInit != FL(0.0))
         return OK;
-      csound_fd_close(csound, &(p->fdch));
+      if (p->fdch.fd != NULL)
+        csound_fd_close(csound, &(p->fdch));
+      if (p->sc != NULL) {
+        sndcache_close(csound, p->sc);
+        p->sc = NULL;
+      }
     }
     // to handle raw files number of channels
     if (t->data) p->nChannels = t->sizes[0];
@@ -1697,16 +1742,15 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
     p->prvBuf = (MYFLT*) p->buf + (int32_t)n;
 
     memset(p->buf, 0, n*sizeof(MYFLT));
+    /* share decoded data with other instances reading the same file */
+    p->sc = sndcache_open(csound, fd, &sfinfo);
 
     // create circular buffer, on fail set mode to synchronous
     if (csound->oparms->realtime==1 && p->fforceSync==0 &&
         (p->cb = csound->CreateCircularBuffer(csound,
                                               p->bufSize*p->nChannels*2,
                                               sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-#ifndef __EMSCRIPTEN__
-      int32_t *start;
-#endif
+      int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p);
       // allocate buffer
       p->aOut_bufsize =
         ((unsigned int)p->bufSize) < CS_KSMPS ?
@@ -1716,50 +1760,10 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
         csound->AuxAlloc(csound, (int32_t) n, &(p->auxData2));
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
-      top =
-        (DISKIN_INST **)csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY");
-#ifndef __EMSCRIPTEN__
-      if (top == NULL){
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_INST_ARRAY", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound,
-                                                           "DISKIN_INST_ARRAY");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_PTHREAD_ARRAY", sizeof(void**));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START_ARRAY", sizeof(int32_t));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt =
-            (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin =  (DISKIN2 *) p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if (*(start =
-            csound->QueryGlobalVariable(csound,
-                                        "DISKIN_THREAD_START_ARRAY")) == 0) {
-        uintptr_t diskin_io_thread_array(void *p);
-        // TOFIX: this variable (thread) is not referenced
-        #if 0
-        void **thread = csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_PTHREAD_ARRAY");
-        #endif
-        *start = 1;
-        csound->CreateThread(diskin_io_thread_array, *top);
-      }
-#endif
+      p->prefetch = diskin_prefetch(p->Prefetch, p->bufSize, p->nChannels);
+      p->io = diskin_io_add(csound, "DISKIN_IO_ARRAY", p,
+                            (int32_t (*)(CSOUND *, void *))
+                            diskin_file_read_array);
       csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
                                      diskin2_async_deinit_array);
       p->async = 1;
@@ -1792,6 +1796,13 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
                         Str("sample frames\n"));
       }
     }
+    if (p->sc != NULL) {
+      /* the cache reads the file through its own handle */
+      csound_fd_close(csound, &(p->fdch));
+      p->sf = NULL;
+      if (!p->async)
+        csound->RegisterDeinitCallback(csound, p, diskin2_cache_deinit_array);
+    }
 
     /* done initialisation */
     p->initDone = 1;
@@ -1813,7 +1824,7 @@ int32_t diskin2_perf_synchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
     MYFLT *aOut = (MYFLT *) p->aOut->data;
 
 
-    if (UNLIKELY(p->fdch.fd == NULL) ) goto file_error;
+    if (UNLIKELY(p->fdch.fd == NULL && p->sc == NULL)) goto file_error;
     if (!p->initDone && !p->SkipInit){
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
@@ -2006,7 +2017,7 @@ int32_t diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
       if (UNLIKELY(early)) nsmps -= early;
     }
 
-    if (UNLIKELY(p->fdch.fd == NULL)) return NOTOK;
+    if (UNLIKELY(p->fdch.fd == NULL && p->sc == NULL)) return NOTOK;
     if (!p->initDone && !p->SkipInit){
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
@@ -2014,14 +2025,15 @@ int32_t diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
     for (nn = offset; nn < nsmps; nn++){
 
       for (chn = 0; chn < chans; chn++) {
-        //int32_t i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
+        /* play silence rather than stale data if the reader is late */
+        if (UNLIKELY(csound->ReadCircularBuffer(csound, cb, &samp, 1) == 0))
+          samp = FL(0.0);
         aOut[chn*ksmps+nn] = csound->e0dbfs*samp;
       }
     }
+    /* wake the reader once the ring has drained below the prefetch level */
+    if (checkspace(cb, 0) < p->prefetch)
+      csound->NotifyThreadLock(((DISKIN_IO *) p->io)->wake);
     return OK;
 }
 
@@ -2030,6 +2042,7 @@ int32_t diskin2_init_array_I(CSOUND *csound, DISKIN2_ARRAY *p) {
     p->WinSize = *p->iWinSize;
     p->BufSize =  *p->iBufSize;
     p->fforceSync = *p->forceSync;
+    p->Prefetch = *p->iPrefetch;
     return diskin2_init_array(csound,p,0);
 }
 
@@ -2038,6 +2051,7 @@ int32_t diskin2_init_array_S(CSOUND *csound, DISKIN2_ARRAY *p) {
     p->WinSize = *p->iWinSize;
     p->BufSize =  *p->iBufSize;
     p->fforceSync = *p->forceSync;
+    p->Prefetch = *p->iPrefetch;
     return diskin2_init_array(csound,p,1);
 }
 
@@ -2048,6 +2062,7 @@ int32_t diskin_init_array_I(CSOUND *csound, DISKIN2_ARRAY *p){
     p->WinSize = 2;
     p->BufSize = 0;
     p->fforceSync = 0;
+    p->Prefetch = 0;
     return diskin2_init_array(csound,p,0);
 }
 
@@ -2056,6 +2071,7 @@ int32_t diskin_init_array_S(CSOUND *csound, DISKIN2_ARRAY *p){
     p->WinSize = 2;
     p->BufSize = 0;
     p->fforceSync = 0;
+    p->Prefetch = 0;
     return diskin2_init_array(csound,p,1);
 }
 
@@ -0,0 +1,321 @@
+/*
+    iir.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#include "csoundCore.h"         /*                      IIR.C           */
+#include "iir.h"
+
+/* The kernels copy coefficients and state to locals: out may be the
+   same memory as anything else, and the compiler would otherwise
+   reload them every sample. */
+
+void iir_onepole(const IIR_COEFS *c, double *z, MYFLT *in, MYFLT *out,
+                 uint32_t from, uint32_t to)
+{
+    double      b0 = c->b0, a1 = c->a1, y1 = z[0];
+    uint32_t    n;
+
+    for (n = from; n < to; n++) {
+      y1 = b0 * (double) in[n] - a1 * y1;
+      out[n] = (MYFLT) y1;
+    }
+    z[0] = y1;
+}
+
+void iir_hp1(const IIR_COEFS *c, double *z, MYFLT *in, MYFLT *out,
+             uint32_t from, uint32_t to)
+{
+    double      b0 = c->b0, s = z[0];
+    uint32_t    n;
+
+    for (n = from; n < to; n++) {
+      double x = (double) in[n];
+      double y = s = b0 * (s + x);
+      out[n] = (MYFLT) y;
+      s -= x;                           /* s is y1 - x1 */
+    }
+    z[0] = s;
+}
+
+void iir_df1(const IIR_COEFS *c, double *z, MYFLT *in, MYFLT *out,
+             uint32_t from, uint32_t to)
+{
+    double      b0 = c->b0, b1 = c->b1, b2 = c->b2, a1 = c->a1, a2 = c->a2;
+    double      x1 = z[0], x2 = z[1], y1 = z[2], y2 = z[3], x, y;
+    uint32_t    n;
+
+    for (n = from; n < to; n++) {
+      x = (double) in[n];
+      y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+      x2 = x1; x1 = x;
+      y2 = y1; y1 = y;
+      out[n] = (MYFLT) y;
+    }
+    z[0] = x1; z[1] = x2; z[2] = y1; z[3] = y2;
+}
+
+void iir_df2(const IIR_COEFS *c, double *z, MYFLT *in, MYFLT *out,
+             uint32_t from, uint32_t to)
+{
+    double      b0 = c->b0, b1 = c->b1, b2 = c->b2, a1 = c->a1, a2 = c->a2;
+    double      w1 = z[0], w2 = z[1], w;
+    uint32_t    n;
+
+    for (n = from; n < to; n++) {
+      w = (double) in[n] - a1 * w1 - a2 * w2;
+      w = csoundUndenormalizeDouble(w); /* Not needed on AMD */
+      out[n] = (MYFLT) (w * b0 + b1 * w1 + b2 * w2);
+      w2 = w1; w1 = w;
+    }
+    z[0] = w1; z[1] = w2;
+}
+
+/* Section j (state z[2j], z[2j+1]) takes the output of section j-1, a
+   whole block at a time, so only one section's numbers are live in the
+   inner loop whatever the order. */
+
+void iir_tdf2(const IIR_COEFS *c, int nsect, double *z, MYFLT *in,
+              MYFLT *out, uint32_t from, uint32_t to)
+{
+    double      b0, b1, b2, a1, a2, s1, s2, x, y;
+    uint32_t    n;
+    int         j;
+
+    for (j = 0; j < nsect; j++, c++, z += 2, in = out) {
+      b0 = c->b0; b1 = c->b1; b2 = c->b2; a1 = c->a1; a2 = c->a2;
+      s1 = z[0]; s2 = z[1];
+      for (n = from; n < to; n++) {
+        x = (double) in[n];
+        y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        out[n] = (MYFLT) y;
+      }
+      z[0] = s1; z[1] = s2;
+    }
+}
+
+/* Lane kernels.  One voice's recursion waits on the latency of its
+   multiplies and adds; VBATCH_LANES voices side by side fill that time,
+   but only with the lanes kept in registers a whole vector at a time.
+   Loops over the lanes do not get there (with -O3 they come out slower
+   than one voice at a time), and with the two doubles of SSE2 or NEON
+   the transposes in and out of the lanes cost more than the lanes save
+   (tests/biquad_bench).  So the kernels are written for AVX2, the lanes
+   as two vectors of four doubles, and built for x86-64 only; there
+   iir_batch() uses them when the CPU has AVX2, and otherwise, as on
+   every other target, hands each voice to perf().  The vectors do the
+   sums of the one voice kernels in the same order, with no fused
+   multiply-add, so they give the same samples. */
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#  define IIR_HAVE_LANES
+#endif
+
+#ifdef IIR_HAVE_LANES
+
+#if VBATCH_LANES != 8
+#  error "the lane kernels take VBATCH_LANES as two vectors of four"
+#endif
+
+#define LANES_TARGET    __attribute__((target("avx2")))
+
+typedef double LANES_V __attribute__((vector_size(32)));
+
+#define L       VBATCH_LANES
+
+/* L sections side by side */
+
+typedef struct {
+    double  b0[L], b1[L], b2[L], a1[L], a2[L];
+    double  z[IIR_NZ][L];
+} IIR_LANES;
+
+static inline LANES_TARGET LANES_V lanes_load(const double *p)
+{
+    LANES_V v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline LANES_TARGET void lanes_store(double *p, LANES_V v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+/* lanes 0-3 in v##a and 4-7 in v##b */
+
+#define LOAD2(v, from)  LANES_V v##a = lanes_load(from),                \
+                                v##b = lanes_load((from) + 4)
+#define STORE2(v, to)   lanes_store(to, v##a); lanes_store((to) + 4, v##b)
+
+static LANES_TARGET void onepole_lanes(IIR_LANES *l, VBATCH_BUF x,
+                                       uint32_t nb)
+{
+    LOAD2(b0, l->b0); LOAD2(a1, l->a1); LOAD2(y1, l->z[0]);
+    uint32_t    i;
+
+    for (i = 0; i < nb; i++) {
+      y1a = b0a * lanes_load(x[i]) - a1a * y1a;
+      y1b = b0b * lanes_load(x[i] + 4) - a1b * y1b;
+      STORE2(y1, x[i]);
+    }
+    STORE2(y1, l->z[0]);
+}
+
+static LANES_TARGET void hp1_lanes(IIR_LANES *l, VBATCH_BUF x,
+                                   uint32_t nb)
+{
+    LOAD2(b0, l->b0); LOAD2(s, l->z[0]);
+    LANES_V     xa, xb;
+    uint32_t    i;
+
+    for (i = 0; i < nb; i++) {
+      xa = lanes_load(x[i]); xb = lanes_load(x[i] + 4);
+      sa = b0a * (sa + xa); sb = b0b * (sb + xb);
+      STORE2(s, x[i]);
+      sa -= xa; sb -= xb;
+    }
+    STORE2(s, l->z[0]);
+}
+
+static LANES_TARGET void df1_lanes(IIR_LANES *l, VBATCH_BUF x,
+                                   uint32_t nb)
+{
+    LOAD2(b0, l->b0); LOAD2(b1, l->b1); LOAD2(b2, l->b2);
+    LOAD2(a1, l->a1); LOAD2(a2, l->a2);
+    LOAD2(x1, l->z[0]); LOAD2(x2, l->z[1]);
+    LOAD2(y1, l->z[2]); LOAD2(y2, l->z[3]);
+    LANES_V     xa, xb, ya, yb;
+    uint32_t    i;
+
+    for (i = 0; i < nb; i++) {
+      xa = lanes_load(x[i]); xb = lanes_load(x[i] + 4);
+      ya = b0a * xa + b1a * x1a + b2a * x2a - a1a * y1a - a2a * y2a;
+      yb = b0b * xb + b1b * x1b + b2b * x2b - a1b * y1b - a2b * y2b;
+      x2a = x1a; x1a = xa; y2a = y1a; y1a = ya;
+      x2b = x1b; x1b = xb; y2b = y1b; y1b = yb;
+      STORE2(y, x[i]);
+    }
+    STORE2(x1, l->z[0]); STORE2(x2, l->z[1]);
+    STORE2(y1, l->z[2]); STORE2(y2, l->z[3]);
+}
+
+/* csoundUndenormalizeDouble() does nothing on x86-64 */
+
+static LANES_TARGET void df2_lanes(IIR_LANES *l, VBATCH_BUF x,
+                                   uint32_t nb)
+{
+    LOAD2(b0, l->b0); LOAD2(b1, l->b1); LOAD2(b2, l->b2);
+    LOAD2(a1, l->a1); LOAD2(a2, l->a2);
+    LOAD2(w1, l->z[0]); LOAD2(w2, l->z[1]);
+    LANES_V     wa, wb, ya, yb;
+    uint32_t    i;
+
+    for (i = 0; i < nb; i++) {
+      wa = lanes_load(x[i]) - a1a * w1a - a2a * w2a;
+      wb = lanes_load(x[i] + 4) - a1b * w1b - a2b * w2b;
+      ya = wa * b0a + b1a * w1a + b2a * w2a;
+      yb = wb * b0b + b1b * w1b + b2b * w2b;
+      w2a = w1a; w1a = wa;
+      w2b = w1b; w1b = wb;
+      STORE2(y, x[i]);
+    }
+    STORE2(w1, l->z[0]); STORE2(w2, l->z[1]);
+}
+
+static const struct {
+    void    (*kernel)(IIR_LANES *, VBATCH_BUF, uint32_t);
+    int     nz;                 /* doubles of state */
+} lanes[] = {
+    { onepole_lanes, 1 }, { hp1_lanes, 1 }, { df1_lanes, 4 }, { df2_lanes, 2 }
+};
+
+/* Voices with a sample-accurate start or end, or that voice() turns
+   away, go through the single voice perf, and are dropped from p[] if
+   it fails.  Unused lanes run with zero coefficients and state.
+   Returns the number of voices left in p[]. */
+
+static int32_t lanes_batch(CSOUND *csound, void **p, int n,
+                           const IIR_BATCH *f)
+{
+    IIR_LANES   l;
+    IIR_COEFS   c;
+    OPDS        *q;
+    MYFLT       *in[L], *out[L];
+    double      *z[L];
+    VBATCH_BUF  x;
+    uint32_t    i0, nb, nsmps = csound->ksmps;
+    int         nz = lanes[f->form].nz;
+    int         j, k, m, v, w = 0;
+
+    for (j = 0; j < n; ) {
+      for (m = 0; m < L && j < n; j++) {
+        q = (OPDS *) p[j];
+        if (UNLIKELY(q->insdshead->ksmps_offset ||
+                     q->insdshead->ksmps_no_end ||
+                     !f->voice(csound, q, &c, &z[m], &in[m], &out[m]))) {
+          if (LIKELY(f->perf(csound, q) == OK))
+            p[w++] = q;
+          continue;
+        }
+        p[w++] = q;
+        l.b0[m] = c.b0; l.b1[m] = c.b1; l.b2[m] = c.b2;
+        l.a1[m] = c.a1; l.a2[m] = c.a2;
+        for (k = 0; k < nz; k++)
+          l.z[k][m] = z[m][k];
+        m++;
+      }
+      if (m == 0) break;
+      for (v = m; v < L; v++) {
+        l.b0[v] = l.b1[v] = l.b2[v] = l.a1[v] = l.a2[v] = 0.0;
+        for (k = 0; k < nz; k++)
+          l.z[k][v] = 0.0;
+      }
+      for (i0 = 0; i0 < nsmps; i0 += nb) {
+        nb = (nsmps - i0 < VBATCH_BLOCK ? nsmps - i0 : VBATCH_BLOCK);
+        vbatch_load(x, in, m, i0, nb);
+        lanes[f->form].kernel(&l, x, nb);
+        vbatch_store(x, out, m, i0, nb);
+      }
+      for (v = 0; v < m; v++)
+        for (k = 0; k < nz; k++)
+          z[v][k] = l.z[k][v];
+    }
+    return w;
+}
+
+#endif  /* IIR_HAVE_LANES */
+
+int32_t iir_batch(CSOUND *csound, void **p, int n, const IIR_BATCH *f)
+{
+    int         j, w = 0;
+
+#ifdef IIR_HAVE_LANES
+    if (LIKELY(__builtin_cpu_supports("avx2")))
+      return lanes_batch(csound, p, n, f);
+#endif
+    for (j = 0; j < n; j++)
+      if (LIKELY(f->perf(csound, p[j]) == OK))
+        p[w++] = p[j];
+    return w;
+}
@@ -23,6 +23,7 @@
 
 #include "csoundCore.h"         /*                      UGENS5.C        */
 #include "ugens5.h"
+#include "iir.h"
 #include <math.h>
 #include <inttypes.h>
 
@@ -111,40 +112,79 @@ int32_t ktone(CSOUND *csound, TONE *p)
     return OK;
 }
 
-int32_t tone(CSOUND *csound, TONE *p)
+static void tone_coefs(CSOUND *csound, TONE *p, IIR_COEFS *c)
 {
-    IGN(csound);
-    MYFLT       *ar, *asig;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    double      c1 = p->c1, c2 = p->c2;
-    double      yt1 = p->yt1;
-
     if (*p->khp != (MYFLT)p->prvhp) {
       double b;
       p->prvhp = (double)*p->khp;
       b = 2.0 - cos((double)(p->prvhp * csound->tpidsr));
-      p->c2 = c2 = b - sqrt(b * b - 1.0);
-      p->c1 = c1 = 1.0 - c2;
+      p->c2 = b - sqrt(b * b - 1.0);
+      p->c1 = 1.0 - p->c2;
     }
+    c->b0 = p->c1;
+    c->a1 = -p->c2;
+    c->b1 = c->b2 = c->a2 = 0.0;
+}
+
+int32_t tone(CSOUND *csound, TONE *p)
+{
+    MYFLT       *ar;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nsmps = CS_KSMPS;
+    IIR_COEFS   c;
+
+    tone_coefs(csound, p, &c);
     ar = p->ar;
-    asig = p->asig;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++) {
-      yt1 = c1 * (double)(asig[n]) + c2 * yt1;
-      ar[n] = (MYFLT)yt1;
-    }
-    p->yt1 = yt1;
+    iir_onepole(&c, &p->yt1, p->asig, ar, offset, nsmps);
     return OK;
 }
 
+/* tone for n voices run together (see iir.h) */
+
+static int tone_voice(CSOUND *csound, void *pp, IIR_COEFS *c, double **z,
+                      MYFLT **in, MYFLT **out)
+{
+    TONE        *p = (TONE *) pp;
+
+    tone_coefs(csound, p, c);
+    *z = &p->yt1;
+    *in = p->asig; *out = p->ar;
+    return 1;
+}
+
+static const IIR_BATCH tone_iir = {
+    (SUBR) tone, tone_voice, IIR_ONEPOLE
+};
+
+int32_t tone_batch(CSOUND *csound, void **p, int n)
+{
+    return iir_batch(csound, p, n, &tone_iir);
+}
+
+/* tonex and atonex are 'loop' like first order sections, run by
+   iir_tdf2() with two doubles of state each; tonex.a and atonex.a
+   (Opcodes/afilters.c) keep one each in the first half of the state */
+
+static void tonex_coefs(TONEX *p, double b0, double b1, double a1)
+{
+    IIR_COEFS   *c = p->c;
+    int32_t     j;
+
+    for (j = 0; j < p->loop; j++, c++) {
+      c->b0 = b0; c->b1 = b1; c->a1 = a1;
+      c->b2 = c->a2 = 0.0;
+    }
+}
+
 int32_t tonsetx(CSOUND *csound, TONEX *p)
 {                   /* From Gabriel Maldonado, modified for arbitrary order */
+    uint32_t    size;
     {
       double b;
       p->prvhp = *p->khp;
@@ -153,24 +193,31 @@ int32_t tonsetx(CSOUND *csound, TONEX *p)
       p->c1 = 1.0 - p->c2;
     }
     if (UNLIKELY((p->loop = (int32_t) (*p->ord + FL(0.5))) < 1)) p->loop = 4;
-    if (!*p->istor && (p->aux.auxp == NULL ||
-                    (uint32_t)(p->loop*sizeof(double)) > p->aux.size))
-        csound->AuxAlloc(csound, (int32_t)(p->loop*sizeof(double)), &p->aux);
+    size = p->loop * (2 * sizeof(double) + sizeof(IIR_COEFS));
+    if (!*p->istor && (p->aux.auxp == NULL || size > p->aux.size))
+        csound->AuxAlloc(csound, (int32_t) size, &p->aux);
     p->yt1 = (double*)p->aux.auxp;
+    p->c = (IIR_COEFS*) (p->yt1 + 2 * p->loop);
     if (LIKELY(!(*p->istor))) {
-    memset(p->yt1, 0, p->loop*sizeof(double)); /* Punning zero and 0.0 */
+    memset(p->yt1, 0, 2*p->loop*sizeof(double)); /* Punning zero and 0.0 */
     }
+    tonex_coefs(p, p->c1, 0.0, -p->c2);
+    return OK;
+}
+
+int32_t atonsetx(CSOUND *csound, TONEX *p)
+{
+    tonsetx(csound, p);
+    tonex_coefs(p, p->c2, -p->c2, -p->c2);
     return OK;
 }
 
 int32_t tonex(CSOUND *csound, TONEX *p)      /* From Gabriel Maldonado, modified */
 {
     MYFLT       *ar = p->ar;
-    double      c2 = p->c2, *yt1 = p->yt1,c1 = p->c1;
     uint32_t    offset = p->h.insdshead->ksmps_offset;
     uint32_t    early  = p->h.insdshead->ksmps_no_end;
-    uint32_t    n, nsmps = CS_KSMPS;
-    int32_t     j, lp = p->loop;
+    uint32_t    nsmps = CS_KSMPS;
 
     if (*p->khp != p->prvhp) {
       double b;
@@ -178,22 +225,14 @@ int32_t tonex(CSOUND *csound, TONEX *p)      /* From Gabriel Maldonado, modified
       b = 2.0 - cos(p->prvhp * (double)csound->tpidsr);
       p->c2 = b - sqrt(b * b - 1.0);
       p->c1 = 1.0 - p->c2;
+      tonex_coefs(p, p->c1, 0.0, -p->c2);
     }
-
-    memmove(ar,p->asig,sizeof(MYFLT)*nsmps);
     if (UNLIKELY(offset))  memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (j=0; j< lp; j++) {
-      /* Should *yt1 be reset to something?? */
-      for (n=0; n<nsmps; n++) {
-        double x = c1 * ar[n] + c2 * yt1[j];
-        yt1[j] = x;
-        ar[n] = (MYFLT)x;
-      }
-    }
+    iir_tdf2(p->c, p->loop, p->yt1, p->asig, ar, offset, nsmps);
     return OK;
 }
 
@@ -220,46 +259,67 @@ int32_t katone(CSOUND *csound, TONE *p)
 }
 
 
-int32_t atone(CSOUND *csound, TONE *p)
+static void atone_coefs(CSOUND *csound, TONE *p, IIR_COEFS *c)
 {
-    MYFLT       *ar, *asig;
-    uint32_t    offset = p->h.insdshead->ksmps_offset;
-    uint32_t    early  = p->h.insdshead->ksmps_no_end;
-    uint32_t    n, nsmps = CS_KSMPS;
-    double      c2 = p->c2, yt1 = p->yt1;
-
     if (*p->khp != p->prvhp) {
       double b;
       p->prvhp = *p->khp;
       b = 2.0 - cos((double)(*p->khp * csound->tpidsr));
-      p->c2 = c2 = b - sqrt(b * b - 1.0);
+      p->c2 = b - sqrt(b * b - 1.0);
 /*      p->c1 = c1 = 1.0 - c2; */
     }
+    c->b0 = p->c2;
+    c->b1 = c->a1 = -p->c2;
+    c->b2 = c->a2 = 0.0;
+}
+
+int32_t atone(CSOUND *csound, TONE *p)
+{
+    MYFLT       *ar;
+    uint32_t    offset = p->h.insdshead->ksmps_offset;
+    uint32_t    early  = p->h.insdshead->ksmps_no_end;
+    uint32_t    nsmps = CS_KSMPS;
+    IIR_COEFS   c;
+
+    atone_coefs(csound, p, &c);
     ar = p->ar;
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    asig = p->asig;
-    for (n=offset; n<nsmps; n++) {
-      double sig = (double)asig[n];
-      double x = yt1 = c2 * (yt1 + sig);
-      ar[n] = (MYFLT)x;
-      yt1 -= sig;               /* yt1 contains yt1-xt1 */
-    }
-    p->yt1 = yt1;
+    iir_hp1(&c, &p->yt1, p->asig, ar, offset, nsmps);
     return OK;
 }
 
+/* atone for n voices run together (see iir.h) */
+
+static int atone_voice(CSOUND *csound, void *pp, IIR_COEFS *c, double **z,
+                       MYFLT **in, MYFLT **out)
+{
+    TONE        *p = (TONE *) pp;
+
+    atone_coefs(csound, p, c);
+    *z = &p->yt1;
+    *in = p->asig; *out = p->ar;
+    return 1;
+}
+
+static const IIR_BATCH atone_iir = {
+    (SUBR) atone, atone_voice, IIR_HP1
+};
+
+int32_t atone_batch(CSOUND *csound, void **p, int n)
+{
+    return iir_batch(csound, p, n, &atone_iir);
+}
+
 int32_t atonex(CSOUND *csound, TONEX *p)      /* Gabriel Maldonado, modified */
 {
     MYFLT       *ar = p->ar;
-    double      c2 = p->c2, *yt1 = p->yt1;
     uint32_t    offset = p->h.insdshead->ksmps_offset;
     uint32_t    early  = p->h.insdshead->ksmps_no_end;
-    uint32_t    n, nsmps = CS_KSMPS;
-    int32_t     j, lp = p->loop;
+    uint32_t    nsmps = CS_KSMPS;
 
     if (*p->khp != p->prvhp) {
       double b;
@@ -267,22 +327,18 @@ int32_t atonex(CSOUND *csound, TONEX *p)      /* Gabriel Maldonado, modified */
       b = 2.0 - cos((double)(*p->khp * csound->tpidsr));
       p->c2 = b - sqrt(b * b - 1.0);
       /*p->c1 = 1. - p->c2;*/
+      tonex_coefs(p, p->c2, -p->c2, -p->c2);
     }
-
-    memmove(ar,p->asig,sizeof(MYFLT)*nsmps);
     if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (j=1; j<lp; j++) {
-      for (n=offset; n<nsmps; n++) {
-        double sig = (double)ar[n];
-        double x = c2 * (yt1[j] + sig);
-        yt1[j] = x - sig;            /* yt1 contains yt1-xt1 */
-        ar[n] = (MYFLT)x;
-      }
-    }
+    /* one section fewer than the order, as atonex has always run */
+    if (LIKELY(p->loop > 1))
+      iir_tdf2(p->c, p->loop - 1, p->yt1, p->asig, ar, offset, nsmps);
+    else if (ar != p->asig)
+      memcpy(&ar[offset], &p->asig[offset], (nsmps-offset)*sizeof(MYFLT));
     return OK;
 }
 
@@ -401,13 +457,15 @@ int32_t reson(CSOUND *csound, RESON *p)
 int32_t rsnsetx(CSOUND *csound, RESONX *p)
 {                               /* Gabriel Maldonado, modifies for arb order */
     int32_t scale;
+    uint32_t size;
     p->scale = scale = (int32_t) *p->iscl;
     if ((p->loop = (int32_t) (*p->ord + FL(0.5))) < 1)
       p->loop = 4; /* default value */
-    if (!*p->istor && (p->aux.auxp == NULL ||
-                       (uint32_t)(p->loop*2*sizeof(double)) > p->aux.size))
-      csound->AuxAlloc(csound, (int32_t)(p->loop*2*sizeof(double)), &p->aux);
+    size = p->loop * (2 * sizeof(double) + sizeof(IIR_COEFS));
+    if (!*p->istor && (p->aux.auxp == NULL || size > p->aux.size))
+      csound->AuxAlloc(csound, (int32_t) size, &p->aux);
     p->yt1 = (double*)p->aux.auxp; p->yt2 = (double*)p->aux.auxp + p->loop;
+    p->c = (IIR_COEFS*) (p->yt2 + p->loop);
     if (UNLIKELY(scale && scale != 1 && scale != 2)) {
       return csound->InitError(csound, Str("illegal reson iscl value, %f"),
                                        *p->iscl);
@@ -421,6 +479,47 @@ int32_t rsnsetx(CSOUND *csound, RESONX *p)
     return OK;
 }
 
+/* With kcf and kbw both k-rate the sections all have the same numbers
+   for the whole block, and iir_tdf2() runs them, with the state of
+   section j in yt1[2j], yt1[2j+1] (over into yt2); with either at a-rate
+   the coefficients move sample by sample, and the state is the last two
+   outputs of each section. */
+
+static void resonx_coefs(CSOUND *csound, RESONX *p)
+{
+    double      c3p1, c3t4, omc3, c2sqr;
+    int32_t     j, flag = 0;
+
+    if (*p->kcf != (MYFLT)p->prvcf) {
+      p->prvcf = (double)*p->kcf;
+      p->cosf = cos(p->prvcf * (double)(csound->tpidsr));
+      flag = 1;
+    }
+    if (*p->kbw != (MYFLT)p->prvbw) {
+      p->prvbw = (double)*p->kbw;
+      p->c3 = exp(p->prvbw * (double)(csound->mtpdsr));
+      flag = 1;
+    }
+    if (!flag)
+      return;
+    c3p1 = p->c3 + 1.0;
+    c3t4 = p->c3 * 4.0;
+    omc3 = 1.0 - p->c3;
+    p->c2 = c3t4 * p->cosf / c3p1;              /* -B, so + below */
+    c2sqr = p->c2 * p->c2;
+    if (p->scale == 1)
+      p->c1 = omc3 * sqrt(1.0 - (c2sqr / c3t4));
+    else if (p->scale == 2)
+      p->c1 = sqrt((c3p1*c3p1-c2sqr) * omc3/c3p1);
+    else p->c1 = 1.0;
+    for (j = 0; j < p->loop; j++) {
+      p->c[j].b0 = p->c1;
+      p->c[j].b1 = p->c[j].b2 = 0.0;
+      p->c[j].a1 = -p->c2;
+      p->c[j].a2 = p->c3;
+    }
+}
+
 int32_t resonx(CSOUND *csound, RESONX *p)   /* Gabriel Maldonado, modified  */
 {
     uint32_t    offset = p->h.insdshead->ksmps_offset;
@@ -434,6 +533,16 @@ int32_t resonx(CSOUND *csound, RESONX *p)   /* Gabriel Maldonado, modified  */
     int32_t     asgw = IS_ASIG_ARG(p->kbw);
 
     ar   = p->ar;
+    if (!asgf && !asgw) {
+      resonx_coefs(csound, p);
+      if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
+      if (UNLIKELY(early)) {
+        nsmps -= early;
+        memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
+      }
+      iir_tdf2(p->c, p->loop, p->yt1, p->asig, ar, offset, nsmps);
+      return OK;
+    }
     c1   = p->c1;
     c2   = p->c2;
     c3   = p->c3;
@@ -46,40 +46,68 @@ static int32_t biquadset(CSOUND *csound, BIQUAD *p)
      IGN(csound);
     /* The biquadratic filter is initialised to zero.    */
     if (*p->reinit==FL(0.0)) {      /* Only reset in in non-legato mode */
-      p->xnm1 = p->xnm2 = p->ynm1 = p->ynm2 = 0.0;
+      p->z[0] = p->z[1] = p->z[2] = p->z[3] = 0.0;
     }
+    p->prv_a0 = FL(0.0);            /* no filter: coefficients not set */
     return OK;
 } /* end biquadset(p) */
 
+/* Normalise the coefficients when one of them has changed */
+
+static void biquad_coefs(BIQUAD *p)
+{
+    double a0;
+
+    if (*p->b0 == p->prv_b0 && *p->b1 == p->prv_b1 && *p->b2 == p->prv_b2 &&
+        *p->a0 == p->prv_a0 && *p->a1 == p->prv_a1 && *p->a2 == p->prv_a2)
+      return;
+    p->prv_b0 = *p->b0; p->prv_b1 = *p->b1; p->prv_b2 = *p->b2;
+    p->prv_a0 = *p->a0; p->prv_a1 = *p->a1; p->prv_a2 = *p->a2;
+    a0 = 1.0 / *p->a0;
+    p->c.a1 = a0 * *p->a1; p->c.a2 = a0 * *p->a2;
+    p->c.b0 = a0 * *p->b0; p->c.b1 = a0 * *p->b1; p->c.b2 = a0 * *p->b2;
+}
+
 static int32_t biquad(CSOUND *csound, BIQUAD *p)
 {
      IGN(csound);
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-    double xn, yn;
-    double xnm1 = p->xnm1, xnm2 = p->xnm2, ynm1 = p->ynm1, ynm2 = p->ynm2;
-    double a0 = 1.0 / *p->a0, a1 = a0 * *p->a1, a2 = a0 * *p->a2;
-    double b0 = a0 * *p->b0, b1 = a0 * *p->b1, b2 = a0 * *p->b2;
+    uint32_t nsmps = CS_KSMPS;
 
+    biquad_coefs(p);
     if (UNLIKELY(offset)) memset(p->out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&p->out[nsmps], '\0', early*sizeof(MYFLT));
     }
-    for (n=offset; n<nsmps; n++) {
-      xn = (double)p->in[n];
-      yn = b0*xn + b1*xnm1 + b2*xnm2 - a1*ynm1 - a2*ynm2;
-      xnm2 = xnm1;
-      xnm1 = xn;
-      ynm2 = ynm1;
-      ynm1 = yn;
-      p->out[n] = (MYFLT)yn;
-    }
-    p->xnm1 = xnm1; p->xnm2 = xnm2; p->ynm1 = ynm1; p->ynm2 = ynm2;
+    iir_df1(&p->c, p->z, p->in, p->out, offset, nsmps);
     return OK;
 }
 
+/* biquad for n voices run together (see iir.h) */
+
+static int biquad_voice(CSOUND *csound, void *pp, IIR_COEFS *c, double **z,
+                        MYFLT **in, MYFLT **out)
+{
+    BIQUAD *p = (BIQUAD *) pp;
+    IGN(csound);
+
+    biquad_coefs(p);
+    *c = p->c; *z = p->z;
+    *in = p->in; *out = p->out;
+    return 1;
+}
+
+static const IIR_BATCH biquad_iir = {
+    (SUBR) biquad, biquad_voice, IIR_DF1
+};
+
+static int32_t biquad_batch(CSOUND *csound, void **p, int n)
+{
+    return iir_batch(csound, p, n, &biquad_iir);
+}
+
 /* A-rate version of above -- JPff August 2001 */
 
 static int32_t biquada(CSOUND *csound, BIQUAD *p)
@@ -92,7 +120,7 @@ static int32_t biquada(CSOUND *csound, BIQUAD *p)
     double xn, yn;
     MYFLT *a0 = p->a0, *a1 = p->a1, *a2 = p->a2;
     MYFLT *b0 = p->b0, *b1 = p->b1, *b2 = p->b2;
-    double xnm1 = p->xnm1, xnm2 = p->xnm2, ynm1 = p->ynm1, ynm2 = p->ynm2;
+    double xnm1 = p->z[0], xnm2 = p->z[1], ynm1 = p->z[2], ynm2 = p->z[3];
     in   = p->in;
     out  = p->out;
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
@@ -110,7 +138,7 @@ static int32_t biquada(CSOUND *csound, BIQUAD *p)
       ynm1 = yn;
       out[n] = (MYFLT)yn;
     }
-    p->xnm1 = xnm1; p->xnm2 = xnm2; p->ynm1 = ynm1; p->ynm2 = ynm2;
+    p->z[0] = xnm1; p->z[1] = xnm2; p->z[2] = ynm1; p->z[3] = ynm2;
     return OK;
 }
 
@@ -810,21 +838,15 @@ static int32_t pareqset(CSOUND *csound, PAREQ *p)
      IGN(csound);
     /* The equalizer filter is initialised to zero.    */
     if (*p->iskip == FL(0.0)) {
-      p->xnm1 = p->xnm2 = p->ynm1 = p->ynm2 = 0.0;
+      p->z[0] = p->z[1] = p->z[2] = p->z[3] = 0.0;
       p->prv_fc = p->prv_v = p->prv_q = FL(-1.0);
       p->imode = (int32_t) MYFLT2LONG(*p->mode);
     }
     return OK;
 } /* end pareqset(p) */
 
-static int32_t pareq(CSOUND *csound, PAREQ *p)
+static void pareq_coefs(CSOUND *csound, PAREQ *p)
 {
-     IGN(csound);
-    MYFLT xn, yn;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
-
     if (*p->fc != p->prv_fc || *p->v != p->prv_v || *p->q != p->prv_q) {
       double omega = (double)(csound->tpidsr * *p->fc), k, kk, vkk, vk, vkdq, a0;
       p->prv_fc = *p->fc; p->prv_v = *p->v; p->prv_q = *p->q;
@@ -835,12 +857,12 @@ static int32_t pareq(CSOUND *csound, PAREQ *p)
           k = tan(omega * 0.5);
           kk = k * k;
           vkk = (double)p->prv_v * kk;
-          p->b0 =  1.0 + sq * k + vkk;
-          p->b1 =  2.0 * (vkk - FL(1.0));
-          p->b2 =  1.0 - sq * k + vkk;
+          p->c.b0 =  1.0 + sq * k + vkk;
+          p->c.b1 =  2.0 * (vkk - FL(1.0));
+          p->c.b2 =  1.0 - sq * k + vkk;
           a0    =  1.0 + k / (double)p->prv_q + kk;
-          p->a1 =  2.0 * (kk - 1.0);
-          p->a2 =  1.0 - k / (double)p->prv_q + kk;
+          p->c.a1 =  2.0 * (kk - 1.0);
+          p->c.a2 =  1.0 - k / (double)p->prv_q + kk;
         }
         break;
         /* High Shelf */
@@ -849,12 +871,12 @@ static int32_t pareq(CSOUND *csound, PAREQ *p)
           k = tan((PI - omega) * 0.5);
           kk = k * k;
           vkk = (double)p->prv_v * kk;
-          p->b0 =  1.0 + sq * k + vkk;
-          p->b1 = -2.0 * (vkk - 1.0);
-          p->b2 =  1.0 - sq * k + vkk;
+          p->c.b0 =  1.0 + sq * k + vkk;
+          p->c.b1 = -2.0 * (vkk - 1.0);
+          p->c.b2 =  1.0 - sq * k + vkk;
           a0    =  1.0 + k / (double)p->prv_q + kk;
-          p->a1 = -2.0 * (kk - 1.0);
-          p->a2 =  1.0 - k / (double)p->prv_q + kk;
+          p->c.a1 = -2.0 * (kk - 1.0);
+          p->c.a2 =  1.0 - k / (double)p->prv_q + kk;
         }
         break;
         /* Peaking EQ */
@@ -863,40 +885,58 @@ static int32_t pareq(CSOUND *csound, PAREQ *p)
           kk = k * k;
           vk = (double)p->prv_v * k;
           vkdq = vk / (double)p->prv_q;
-          p->b0 =  1.0 + vkdq + kk;
-          p->b1 =  2.0 * (kk - 1.0);
-          p->b2 =  1.0 - vkdq + kk;
+          p->c.b0 =  1.0 + vkdq + kk;
+          p->c.b1 =  2.0 * (kk - 1.0);
+          p->c.b2 =  1.0 - vkdq + kk;
           a0    =  1.0 + k / (double)p->prv_q + kk;
-          p->a1 =  2.0 * (kk - 1.0);
-          p->a2 =  1.0 - k / (double)p->prv_q + kk;
+          p->c.a1 =  2.0 * (kk - 1.0);
+          p->c.a2 =  1.0 - k / (double)p->prv_q + kk;
         }
       }
       a0 = 1.0 / a0;
-      p->a1 *= a0; p->a2 *= a0; p->b0 *= a0; p->b1 *= a0; p->b2 *= a0;
+      p->c.a1 *= a0; p->c.a2 *= a0;
+      p->c.b0 *= a0; p->c.b1 *= a0; p->c.b2 *= a0;
     }
+}
+
+static int32_t pareq(CSOUND *csound, PAREQ *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nsmps = CS_KSMPS;
+
+    pareq_coefs(csound, p);
     if (UNLIKELY(offset)) memset(p->out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
       nsmps -= early;
       memset(&p->out[nsmps], '\0', early*sizeof(MYFLT));
     }
-    {
-      double a1 = p->a1, a2 = p->a2;
-      double b0 = p->b0, b1 = p->b1, b2 = p->b2;
-      double xnm1 = p->xnm1, xnm2 = p->xnm2, ynm1 = p->ynm1, ynm2 = p->ynm2;
-      for (n=offset; n<nsmps; n++) {
-        xn = (double)p->in[n];
-        yn = b0 * xn + b1 * xnm1 + b2 * xnm2 - a1 * ynm1 - a2 * ynm2;
-        xnm2 = xnm1;
-        xnm1 = xn;
-        ynm2 = ynm1;
-        ynm1 = yn;
-        p->out[n] = (MYFLT)yn;
-      }
-      p->xnm1 = xnm1; p->xnm2 = xnm2; p->ynm1 = ynm1; p->ynm2 = ynm2;
-    }
+    iir_df1(&p->c, p->z, p->in, p->out, offset, nsmps);
     return OK;
 }
 
+/* pareq for n voices run together (see iir.h) */
+
+static int pareq_voice(CSOUND *csound, void *pp, IIR_COEFS *c, double **z,
+                       MYFLT **in, MYFLT **out)
+{
+    PAREQ *p = (PAREQ *) pp;
+
+    pareq_coefs(csound, p);
+    *c = p->c; *z = p->z;
+    *in = p->in; *out = p->out;
+    return 1;
+}
+
+static const IIR_BATCH pareq_iir = {
+    (SUBR) pareq, pareq_voice, IIR_DF1
+};
+
+static int32_t pareq_batch(CSOUND *csound, void **p, int n)
+{
+    return iir_batch(csound, p, n, &pareq_iir);
+}
+
 /* Nested all-pass filters useful for creating reverbs */
 /* Coded by Hans Mikelson January 1999                 */
 /* Derived from Csound's delay opcode                  */
@@ -1504,9 +1544,10 @@ int mvmfilter(CSOUND *csound, MVMFILT *p) {
 #define S(x)    sizeof(x)
 
 static OENTRY biquad_localops[] = {
-    { "biquad", S(BIQUAD),   0, 3, "a", "akkkkkko",
-                                   (SUBR)biquadset,  (SUBR)biquad },
-    { "biquada", S(BIQUAD),  0, 3, "a", "aaaaaaao",
+    { "biquad", S(BIQUAD),  VB, 3, "a", "akkkkkko",
+                                   (SUBR)biquadset,  (SUBR)biquad,
+      NULL, NULL, biquad_batch },
+    { "biquada", S(BIQUAD), VB, 3, "a", "aaaaaaao",
                                      (SUBR)biquadset, (SUBR)biquada },
     { "moogvcf", S(MOOGVCF), 0, 3, "a", "axxpo",
                                    (SUBR)moogvcfset,  (SUBR)moogvcf },
@@ -1518,7 +1559,8 @@ static OENTRY biquad_localops[] = {
     { "vco", S(VCO),      TR, 3, "a", "xxiVppovoo",(SUBR)vcoset,  (SUBR)vco },
     { "tbvcf", S(TBVCF),     0, 3, "a", "axxkkp",
                                      (SUBR)tbvcfset,  (SUBR)tbvcf   },
-    { "pareq", S(PAREQ),     0, 3, "a", "akkkoo",(SUBR)pareqset,  (SUBR)pareq },
+    { "pareq", S(PAREQ),    VB, 3, "a", "akkkoo",(SUBR)pareqset,  (SUBR)pareq,
+      NULL, NULL, pareq_batch },
     { "nestedap", S(NESTEDAP),0, 3,"a", "aiiiiooooo",
                                          (SUBR)nestedapset,  (SUBR)nestedap},
     { "mode",  S(MODE),   0, 3,      "a", "axxo", (SUBR)modeset,  (SUBR)mode   },
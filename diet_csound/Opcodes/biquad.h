@@ -25,12 +25,15 @@
 
                                                         /* biquad.h */
 #include "stdopcod.h"
+#include "iir.h"
 
                                 /* Structure for biquadratic filter */
 typedef struct {
     OPDS    h;
     MYFLT   *out, *in, *b0, *b1, *b2, *a0, *a1, *a2, *reinit;
-    double  xnm1, xnm2, ynm1, ynm2;
+    double  z[4];                       /* xnm1, xnm2, ynm1, ynm2 */
+    MYFLT   prv_b0, prv_b1, prv_b2, prv_a0, prv_a1, prv_a2;
+    IIR_COEFS c;
 } BIQUAD;
 
                                 /* Structure for moogvcf filter */
@@ -76,9 +79,9 @@ typedef struct {
 typedef struct {
     OPDS   h;
     MYFLT  *out, *in, *fc, *v, *q, *mode, *iskip;
-    double xnm1, xnm2, ynm1, ynm2;
+    double z[4];                        /* xnm1, xnm2, ynm1, ynm2 */
     MYFLT  prv_fc, prv_v, prv_q;
-    double b0, b1, b2, a1, a2;
+    IIR_COEFS c;
     int32_t imode;
 } PAREQ;
 
@@ -26,12 +26,14 @@
 /*              Copyright (c) May 1994.  All rights reserved            */
 
 #include "stdopcod.h"
+#include "iir.h"
 
 typedef struct  {
         OPDS    h;
         MYFLT   *sr, *ain, *kfc, *istor;
         MYFLT   lkf;
-        double  a[8];
+        IIR_COEFS c;
+        double  z[2];
 } BFIL;
 
 typedef struct  {
@@ -44,13 +46,14 @@ typedef struct  {
 #include <math.h>
 //#define ROOT2 (1.4142135623730950488)
 
-static void butter_filter(uint32_t, uint32_t, MYFLT *, MYFLT *, double *);
+static void hibut_coefs(CSOUND *, BFIL *);
+static void lobut_coefs(CSOUND *, BFIL *);
 
 int32_t butset(CSOUND *csound, BFIL *p)      /*      Hi/Lo pass set-up   */
 {
      IGN(csound);
     if (*p->istor==FL(0.0)) {
-      p->a[6] = p->a[7] = 0.0;
+      p->z[0] = p->z[1] = 0.0;
       p->lkf = FL(0.0);
     }
     return OK;
@@ -76,23 +79,28 @@ static int32_t hibut(CSOUND *csound, BFIL *p)       /*      Hipass filter
       return OK;
     }
 
-    if (*p->kfc != p->lkf)      {
-      double    *a, c;
-
-      a = p->a;
-      p->lkf = *p->kfc;
-      c = tan((double)(csound->pidsr * p->lkf));
-
-      a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
-      a[2] = -(a[1] + a[1]);
-      a[3] = a[1];
-      a[4] = 2.0 * ( c*c - 1.0) * a[1];
-      a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
-    }
-    butter_filter(nsmps, offset, in, out, p->a);
+    if (*p->kfc != p->lkf)
+      hibut_coefs(csound, p);
+    iir_df2(&p->c, p->z, in, out, offset, nsmps);
     return OK;
 }
 
+static void hibut_coefs(CSOUND *csound, BFIL *p)
+{
+    IIR_COEFS *a;
+    double    c;
+
+    a = &p->c;
+    p->lkf = *p->kfc;
+    c = tan((double)(csound->pidsr * p->lkf));
+
+    a->b0 = 1.0 / ( 1.0 + ROOT2 * c + c * c);
+    a->b1 = -(a->b0 + a->b0);
+    a->b2 = a->b0;
+    a->a1 = 2.0 * ( c*c - 1.0) * a->b0;
+    a->a2 = ( 1.0 - ROOT2 * c + c * c) * a->b0;
+}
+
 static int32_t lobut(CSOUND *csound, BFIL *p)       /*      Lopass filter       */
 {
     MYFLT       *out, *in;
@@ -114,47 +122,84 @@ static int32_t lobut(CSOUND *csound, BFIL *p)       /*      Lopass filter
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
 
-    if (*p->kfc != p->lkf) {
-      double     *a, c;
-      a = p->a;
-      p->lkf = *p->kfc;
-      c = 1.0 / tan((double)(csound->pidsr * p->lkf));
-      a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
-      a[2] = a[1] + a[1];
-      a[3] = a[1];
-      a[4] = 2.0 * ( 1.0 - c*c) * a[1];
-      a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
-    }
+    if (*p->kfc != p->lkf)
+      lobut_coefs(csound, p);
 
-    butter_filter(nsmps, offset, in, out, p->a);
+    iir_df2(&p->c, p->z, in, out, offset, nsmps);
     return OK;
 }
 
-/* Filter loop */
+static void lobut_coefs(CSOUND *csound, BFIL *p)
+{
+    IIR_COEFS  *a;
+    double     c;
+
+    a = &p->c;
+    p->lkf = *p->kfc;
+    c = 1.0 / tan((double)(csound->pidsr * p->lkf));
+    a->b0 = 1.0 / ( 1.0 + ROOT2 * c + c * c);
+    a->b1 = a->b0 + a->b0;
+    a->b2 = a->b0;
+    a->a1 = 2.0 * ( 1.0 - c*c) * a->b0;
+    a->a2 = ( 1.0 - ROOT2 * c + c * c) * a->b0;
+}
+
+/* Voices run together (see iir.h): a cutoff at or below zero goes
+   through the single voice code. */
 
-static void butter_filter(uint32_t n, uint32_t offset,
-                          MYFLT *in, MYFLT *out, double *a)
+static int butter_voice(CSOUND *csound, BFIL *p, IIR_COEFS *c, double **z,
+                        MYFLT **in, MYFLT **out,
+                        void (*coefs)(CSOUND *, BFIL *))
 {
-    double t, y;
-    uint32_t nn;
-
-    for (nn=offset; nn<n; nn++) {
-      t = (double)in[nn] - a[4] * a[6] - a[5] * a[7];
-      t = csoundUndenormalizeDouble(t); /* Not needed on AMD */
-      y = t * a[1] + a[2] * a[6] + a[3] * a[7];
-      a[7] = a[6];
-      a[6] = t;
-      out[nn] = (MYFLT)y;
-    }
+    if (*p->kfc <= FL(0.0))
+      return 0;
+    if (*p->kfc != p->lkf)
+      coefs(csound, p);
+    *c = p->c; *z = p->z;
+    *in = p->ain; *out = p->sr;
+    return 1;
+}
+
+static int hibut_voice(CSOUND *csound, void *p, IIR_COEFS *c, double **z,
+                       MYFLT **in, MYFLT **out)
+{
+    return butter_voice(csound, (BFIL *) p, c, z, in, out, hibut_coefs);
+}
+
+static int lobut_voice(CSOUND *csound, void *p, IIR_COEFS *c, double **z,
+                       MYFLT **in, MYFLT **out)
+{
+    return butter_voice(csound, (BFIL *) p, c, z, in, out, lobut_coefs);
+}
+
+static const IIR_BATCH hibut_iir = {
+    (SUBR) hibut, hibut_voice, IIR_DF2
+};
+static const IIR_BATCH lobut_iir = {
+    (SUBR) lobut, lobut_voice, IIR_DF2
+};
+
+static int32_t hibut_batch(CSOUND *csound, void **p, int n)
+{
+    return iir_batch(csound, p, n, &hibut_iir);
+}
+
+static int32_t lobut_batch(CSOUND *csound, void **p, int n)
+{
+    return iir_batch(csound, p, n, &lobut_iir);
 }
 
 #define S(x)    sizeof(x)
 
 static OENTRY butter_localops[] = {
-    { "butterhp.k", S(BFIL), 0, 3, "a", "ako",  (SUBR)butset,  (SUBR)hibut  },
-    { "butterlp.k", S(BFIL), 0, 3, "a", "ako",  (SUBR)butset,  (SUBR)lobut  },
-    { "buthp.k",    S(BFIL), 0, 3, "a", "ako",  (SUBR)butset,  (SUBR)hibut  },
-    { "butlp.k",    S(BFIL), 0, 3, "a", "ako",  (SUBR)butset,  (SUBR)lobut  },
+    { "butterhp.k", S(BFIL), VB, 3, "a", "ako",  (SUBR)butset,  (SUBR)hibut,
+      NULL, NULL, hibut_batch },
+    { "butterlp.k", S(BFIL), VB, 3, "a", "ako",  (SUBR)butset,  (SUBR)lobut,
+      NULL, NULL, lobut_batch },
+    { "buthp.k",    S(BFIL), VB, 3, "a", "ako",  (SUBR)butset,  (SUBR)hibut,
+      NULL, NULL, hibut_batch },
+    { "butlp.k",    S(BFIL), VB, 3, "a", "ako",  (SUBR)butset,  (SUBR)lobut,
+      NULL, NULL, lobut_batch },
 };
 
 LINKAGE_BUILTIN(butter_localops)
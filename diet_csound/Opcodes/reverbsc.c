@@ -64,18 +64,11 @@ static const double reverbParams[8][4] = {
 static const double outputGain  = 0.35;
 static const double jpScale     = 0.25;
 
-typedef struct {
-    int32_t         writePos;
-    int32_t         bufferSize;
-    int32_t         readPos;
-    int32_t         readPosFrac;
-    int32_t         readPosFrac_inc;
-    int32_t         dummy;
-    int32_t         seedVal;
-    int32_t         randLine_cnt;
-    double      filterState;
-    MYFLT       buf[1];
-} delayLine;
+/* The state of the 8 delay lines is kept one array per field, so that
+   the per sample work of all the lines is a loop over 8 lanes that the
+   compiler can turn into vector code.  Each delay line is stored with
+   one sample before and two after it that mirror the other end, so the
+   four samples of the interpolation can be read without wrapping. */
 
 typedef struct {
     OPDS        h;
@@ -85,7 +78,15 @@ typedef struct {
     double      dampFact;
     MYFLT       prv_LPFreq;
     int32_t         initDone;
-    delayLine   *delayLines[8];
+    double      filterState[8];
+    int32_t         writePos[8];
+    int32_t         bufferSize[8];
+    int32_t         readPos[8];
+    int32_t         readPosFrac[8];
+    int32_t         readPosFrac_inc[8];
+    int32_t         seedVal[8];
+    int32_t         randLine_cnt[8];
+    MYFLT       *buf[8];        /* buf[n][-1] to buf[n][bufferSize[n] + 1] */
     AUXCH       auxData;
 } SC_REVERB;
 
@@ -102,64 +103,60 @@ static int32_t delay_line_bytes_alloc(SC_REVERB *p, int32_t n)
 {
     int32_t nBytes;
 
-    nBytes = (int32_t) sizeof(delayLine) - (int32_t) sizeof(MYFLT);
-    nBytes += (delay_line_max_samples(p, n) * (int32_t) sizeof(MYFLT));
+    nBytes = (delay_line_max_samples(p, n) + 3) * (int32_t) sizeof(MYFLT);
     nBytes = (nBytes + 15) & (~15);
     return nBytes;
 }
 
-static void next_random_lineseg(SC_REVERB *p, delayLine *lp, int32_t n)
+static void next_random_lineseg(SC_REVERB *p, int32_t n)
 {
     double  prvDel, nxtDel, phs_incVal;
 
     /* update random seed */
-    if (lp->seedVal < 0)
-      lp->seedVal += 0x10000;
-    lp->seedVal = (lp->seedVal * 15625 + 1) & 0xFFFF;
-    if (lp->seedVal >= 0x8000)
-      lp->seedVal -= 0x10000;
+    if (p->seedVal[n] < 0)
+      p->seedVal[n] += 0x10000;
+    p->seedVal[n] = (p->seedVal[n] * 15625 + 1) & 0xFFFF;
+    if (p->seedVal[n] >= 0x8000)
+      p->seedVal[n] -= 0x10000;
     /* length of next segment in samples */
-    lp->randLine_cnt = (int32_t) ((p->sampleRate / reverbParams[n][2]) + 0.5);
-    prvDel = (double) lp->writePos;
-    prvDel -= ((double) lp->readPos
-               + ((double) lp->readPosFrac / (double) DELAYPOS_SCALE));
+    p->randLine_cnt[n] =
+      (int32_t) ((p->sampleRate / reverbParams[n][2]) + 0.5);
+    prvDel = (double) p->writePos[n];
+    prvDel -= ((double) p->readPos[n]
+               + ((double) p->readPosFrac[n] / (double) DELAYPOS_SCALE));
     while (prvDel < 0.0)
-      prvDel += (double) lp->bufferSize;
+      prvDel += (double) p->bufferSize[n];
     prvDel = prvDel / p->sampleRate;    /* previous delay time in seconds */
-    nxtDel = (double) lp->seedVal * reverbParams[n][1] / 32768.0;
+    nxtDel = (double) p->seedVal[n] * reverbParams[n][1] / 32768.0;
     /* next delay time in seconds */
     nxtDel = reverbParams[n][0] + (nxtDel * (double) *(p->iPitchMod));
     /* calculate phase increment per sample */
-    phs_incVal = (prvDel - nxtDel) / (double) lp->randLine_cnt;
+    phs_incVal = (prvDel - nxtDel) / (double) p->randLine_cnt[n];
     phs_incVal = phs_incVal * p->sampleRate + 1.0;
-    lp->readPosFrac_inc = (int32_t) (phs_incVal * DELAYPOS_SCALE + 0.5);
+    p->readPosFrac_inc[n] = (int32_t) (phs_incVal * DELAYPOS_SCALE + 0.5);
 }
 
-static void init_delay_line(SC_REVERB *p, delayLine *lp, int32_t n)
+static void init_delay_line(SC_REVERB *p, int32_t n)
 {
     double  readPos;
-    /* int32_t     i; */
 
     /* calculate length of delay line */
-    lp->bufferSize = delay_line_max_samples(p, n);
-    lp->dummy = 0;
-    lp->writePos = 0;
+    p->bufferSize[n] = delay_line_max_samples(p, n);
+    p->writePos[n] = 0;
     /* set random seed */
-    lp->seedVal = (int32_t) (reverbParams[n][3] + 0.5);
+    p->seedVal[n] = (int32_t) (reverbParams[n][3] + 0.5);
     /* set initial delay time */
-    readPos = (double) lp->seedVal * reverbParams[n][1] / 32768;
+    readPos = (double) p->seedVal[n] * reverbParams[n][1] / 32768;
     readPos = reverbParams[n][0] + (readPos * (double) *(p->iPitchMod));
-    readPos = (double) lp->bufferSize - (readPos * p->sampleRate);
-    lp->readPos = (int32_t) readPos;
-    readPos = (readPos - (double) lp->readPos) * (double) DELAYPOS_SCALE;
-    lp->readPosFrac = (int32_t) (readPos + 0.5);
+    readPos = (double) p->bufferSize[n] - (readPos * p->sampleRate);
+    p->readPos[n] = (int32_t) readPos;
+    readPos = (readPos - (double) p->readPos[n]) * (double) DELAYPOS_SCALE;
+    p->readPosFrac[n] = (int32_t) (readPos + 0.5);
     /* initialise first random line segment */
-    next_random_lineseg(p, lp, n);
+    next_random_lineseg(p, n);
     /* clear delay line to zero */
-    lp->filterState = 0.0;
-    memset(lp->buf, 0, sizeof(MYFLT)*lp->bufferSize);
-    /* for (i = 0; i < lp->bufferSize; i++) */
-    /*   lp->buf[i] = FL(0.0); */
+    p->filterState[n] = 0.0;
+    memset(p->buf[n] - 1, 0, sizeof(MYFLT) * (p->bufferSize[n] + 3));
 }
 
 static int32_t sc_reverb_init(CSOUND *csound, SC_REVERB *p)
@@ -192,9 +189,9 @@ static int32_t sc_reverb_init(CSOUND *csound, SC_REVERB *p)
     /* set up delay lines */
     nBytes = 0;
     for (i = 0; i < 8; i++) {
-      p->delayLines[i] = (delayLine*) ((unsigned char*) (p->auxData.auxp)
-                                       + (int32_t) nBytes);
-      init_delay_line(p, p->delayLines[i], i);
+      p->buf[i] = (MYFLT*) ((unsigned char*) (p->auxData.auxp)
+                            + (int32_t) nBytes) + 1;
+      init_delay_line(p, i);
       nBytes += delay_line_bytes_alloc(p, i);
     }
     p->dampFact = 1.0;
@@ -207,13 +204,15 @@ static int32_t sc_reverb_init(CSOUND *csound, SC_REVERB *p)
 static int32_t sc_reverb_perf(CSOUND *csound, SC_REVERB *p)
 {
     double    ainL, ainR, aoutL, aoutR;
-    double    vm1, v0, v1, v2, am1, a0, a1, a2, frac;
-    delayLine *lp;
-    int32_t       readPos;
+    double    filterState[8], vm1[8], v0[8], v1[8], v2[8], frac[8];
+    double    am1, a0, a1, a2, v, feedBack;
+    int32_t       readPos[8], readPosFrac[8], readPosFrac_inc[8];
+    int32_t       writePos[8], bufferSize[8];
+    MYFLT     *bp;
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
     uint32_t i, n, nsmps = CS_KSMPS;
-    int32_t       bufferSize; /* Local copy */
+    int32_t       run, k;
     double    dampFact = p->dampFact;
 
     if (UNLIKELY(p->initDone <= 0)) goto err1;
@@ -223,6 +222,7 @@ static int32_t sc_reverb_perf(CSOUND *csound, SC_REVERB *p)
       dampFact = 2.0 - cos(p->prv_LPFreq * TWOPI / p->sampleRate);
       dampFact = p->dampFact = dampFact - sqrt(dampFact * dampFact - 1.0);
     }
+    feedBack = (double) *(p->kFeedBack);
     if (UNLIKELY(offset)) {
       memset(p->aoutL, '\0', offset*sizeof(MYFLT));
       memset(p->aoutR, '\0', offset*sizeof(MYFLT));
@@ -232,73 +232,88 @@ static int32_t sc_reverb_perf(CSOUND *csound, SC_REVERB *p)
       memset(&p->aoutL[nsmps], '\0', early*sizeof(MYFLT));
       memset(&p->aoutR[nsmps], '\0', early*sizeof(MYFLT));
     }
-    /* update delay lines */
-    for (i = offset; i < nsmps; i++) {
-      /* calculate "resultant junction pressure" and mix to input signals */
-      ainL = aoutL = aoutR = 0.0;
+    /* local copies, which cannot alias the signals */
+    for (n = 0; n < 8; n++) {
+      filterState[n] = p->filterState[n];
+      writePos[n] = p->writePos[n];
+      bufferSize[n] = p->bufferSize[n];
+      readPos[n] = p->readPos[n];
+      readPosFrac[n] = p->readPosFrac[n];
+      readPosFrac_inc[n] = p->readPosFrac_inc[n];
+    }
+    /* update delay lines, in runs that end where the first random line
+       segment does */
+    for (i = offset; i < nsmps; ) {
+      run = (int32_t) (nsmps - i);
       for (n = 0; n < 8; n++)
-        ainL += p->delayLines[n]->filterState;
-      ainL *= jpScale;
-      ainR = ainL + (double) p->ainR[i];
-      ainL = ainL + (double) p->ainL[i];
-      /* loop through all delay lines */
-      for (n = 0; n < 8; n++) {
-        lp = p->delayLines[n];
-        bufferSize = lp->bufferSize;
-        /* send input signal and feedback to delay line */
-        lp->buf[lp->writePos] = (MYFLT) ((n & 1 ? ainR : ainL)
-                                         - lp->filterState);
-        if (UNLIKELY(++lp->writePos >= bufferSize))
-          lp->writePos -= bufferSize;
-        /* read from delay line with cubic interpolation */
-        if (lp->readPosFrac >= DELAYPOS_SCALE) {
-          lp->readPos += (lp->readPosFrac >> DELAYPOS_SHIFT);
-          lp->readPosFrac &= DELAYPOS_MASK;
+        if (p->randLine_cnt[n] < run)
+          run = p->randLine_cnt[n];
+      for (k = 0; k < run; k++, i++) {
+        /* calculate "resultant junction pressure" and mix to input */
+        ainL = aoutL = aoutR = 0.0;
+        for (n = 0; n < 8; n++)
+          ainL += filterState[n];
+        ainL *= jpScale;
+        ainR = ainL + (double) p->ainR[i];
+        ainL = ainL + (double) p->ainL[i];
+        /* send input signal and feedback to the delay lines */
+        for (n = 0; n < 8; n++) {
+          bp = p->buf[n];
+          bp[writePos[n]] = (MYFLT) ((n & 1 ? ainR : ainL) - filterState[n]);
+          if (UNLIKELY(writePos[n] < 2))
+            bp[bufferSize[n] + writePos[n]] = bp[writePos[n]];
+          else if (UNLIKELY(writePos[n] == bufferSize[n] - 1))
+            bp[-1] = bp[writePos[n]];
         }
-        if (UNLIKELY(lp->readPos >= bufferSize))
-          lp->readPos -= bufferSize;
-        readPos = lp->readPos;
-        frac = (double) lp->readPosFrac * (1.0 / (double) DELAYPOS_SCALE);
-        /* calculate interpolation coefficients */
-        a2 = frac * frac; a2 -= 1.0; a2 *= (1.0 / 6.0);
-        a1 = frac; a1 += 1.0; a1 *= 0.5; am1 = a1 - 1.0;
-        a0 = 3.0 * a2; a1 -= a0; am1 -= a2; a0 -= frac;
-        /* read four samples for interpolation */
-        if (LIKELY(readPos > 0 && readPos < (bufferSize - 2))) {
-          vm1 = (double) (lp->buf[readPos - 1]);
-          v0  = (double) (lp->buf[readPos]);
-          v1  = (double) (lp->buf[readPos + 1]);
-          v2  = (double) (lp->buf[readPos + 2]);
+        /* move the write and read positions on */
+        for (n = 0; n < 8; n++) {
+          writePos[n] = (writePos[n] + 1 < bufferSize[n] ?
+                         writePos[n] + 1 : 0);
+          readPos[n] += (readPosFrac[n] >> DELAYPOS_SHIFT);
+          readPos[n] = (readPos[n] >= bufferSize[n] ?
+                        readPos[n] - bufferSize[n] : readPos[n]);
+          readPosFrac[n] &= DELAYPOS_MASK;
+          frac[n] = (double) readPosFrac[n] * (1.0 / (double) DELAYPOS_SCALE);
+          readPosFrac[n] += readPosFrac_inc[n];
         }
-        else {
-          /* at buffer wrap-around, need to check index */
-          if (--readPos < 0) readPos += bufferSize;
-          vm1 = (double) lp->buf[readPos];
-          if (++readPos >= bufferSize) readPos -= bufferSize;
-          v0 = (double) lp->buf[readPos];
-          if (++readPos >= bufferSize) readPos -= bufferSize;
-          v1 = (double) lp->buf[readPos];
-          if (++readPos >= bufferSize) readPos -= bufferSize;
-          v2 = (double) lp->buf[readPos];
+        /* read four samples of each line for interpolation */
+        for (n = 0; n < 8; n++) {
+          bp = p->buf[n] + readPos[n];
+          vm1[n] = (double) bp[-1];
+          v0[n]  = (double) bp[0];
+          v1[n]  = (double) bp[1];
+          v2[n]  = (double) bp[2];
+        }
+        /* cubic interpolation, feedback gain and lowpass filter */
+        for (n = 0; n < 8; n++) {
+          a2 = frac[n] * frac[n]; a2 -= 1.0; a2 *= (1.0 / 6.0);
+          a1 = frac[n]; a1 += 1.0; a1 *= 0.5; am1 = a1 - 1.0;
+          a0 = 3.0 * a2; a1 -= a0; am1 -= a2; a0 -= frac[n];
+          v = (am1 * vm1[n] + a0 * v0[n] + a1 * v1[n] + a2 * v2[n])
+              * frac[n] + v0[n];
+          v *= feedBack;
+          filterState[n] = (filterState[n] - v) * dampFact + v;
         }
-        v0 = (am1 * vm1 + a0 * v0 + a1 * v1 + a2 * v2) * frac + v0;
-        /* update buffer read position */
-        lp->readPosFrac += lp->readPosFrac_inc;
-        /* apply feedback gain and lowpass filter */
-        v0 *= (double) *(p->kFeedBack);
-        v0 = (lp->filterState - v0) * dampFact + v0;
-        lp->filterState = v0;
         /* mix to output */
-        if (n & 1)
-          aoutR += v0;
-        else
-          aoutL += v0;
-        /* start next random line segment if current one has reached endpoint */
-        if (--(lp->randLine_cnt) <= 0)
-          next_random_lineseg(p, lp, n);
+        for (n = 0; n < 8; n += 2) {
+          aoutL += filterState[n];
+          aoutR += filterState[n + 1];
+        }
+        p->aoutL[i] = (MYFLT) (aoutL * outputGain);
+        p->aoutR[i] = (MYFLT) (aoutR * outputGain);
       }
-      p->aoutL[i] = (MYFLT) (aoutL * outputGain);
-      p->aoutR[i] = (MYFLT) (aoutR * outputGain);
+      for (n = 0; n < 8; n++) {
+        p->filterState[n] = filterState[n];
+        p->writePos[n] = writePos[n];
+        p->readPos[n] = readPos[n];
+        p->readPosFrac[n] = readPosFrac[n];
+      }
+      /* start next random line segment where the current one has ended */
+      for (n = 0; n < 8; n++)
+        if ((p->randLine_cnt[n] -= run) <= 0) {
+          next_random_lineseg(p, n);
+          readPosFrac_inc[n] = p->readPosFrac_inc[n];
+        }
     }
 
     return OK;
@@ -902,20 +902,19 @@ static int32_t rbjeqset(CSOUND *csound, RBJEQ *p)
     p->ftype = mode >> 1;
     /* reset filter */
     p->old_kcps = p->old_klvl = p->old_kQ = p->old_kS = FL(-1.12123e35);
-    p->b0 = p->b1 = p->b2 = p->a1 = p->a2 = FL(0.0);
-    p->xnm1 = p->xnm2 = p->ynm1 = p->ynm2 = FL(0.0);
+    p->c.b0 = p->c.b1 = p->c.b2 = p->c.a1 = p->c.a2 = 0.0;
+    p->z[0] = p->z[1] = p->z[2] = p->z[3] = 0.0;
     return OK;
 }
 
-static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
+/* Work out the coefficients again when the arguments the filter type
+   uses have changed.  Types with fewer distinct terms (b0 == b2 and so
+   on) still fill in all five for the df1 section.  Returns NOTOK for
+   a bad filter type. */
+
+static int32_t rbjeq_coefs(CSOUND *csound, RBJEQ *p)
 {
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t n, nsmps = CS_KSMPS;
     int32_t     new_frq;
-    MYFLT   b0, b1, b2, a1, a2, tmp;
-    MYFLT   xnm1, xnm2, ynm1, ynm2;
-    MYFLT   *ar, *asig;
     double  dva0;
 
     if (*(p->kcps) != p->old_kcps) {
@@ -930,14 +929,6 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
     }
     else
       new_frq = 0;
-    /* copy object data to local variables */
-    ar = p->ar; asig = p->asig;
-    xnm1 = p->xnm1; xnm2 = p->xnm2; ynm1 = p->ynm1; ynm2 = p->ynm2;
-    if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
-    if (UNLIKELY(early)) {
-      nsmps -= early;
-      memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
-    }
     switch (p->ftype) {
     case 0:                                     /* lowpass filter */
       if (new_frq || *(p->kQ) != p->old_kQ) {
@@ -950,16 +941,11 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
 #endif
         /* recalculate all coeffs */
         dva0 = 1.0 / (1.0 + alpha);
-        p->b2 = (MYFLT) (0.5 * (dva0 - dva0 * p->cs));
-        p->a1 = (MYFLT) (-2.0 * dva0 * p->cs);
-        p->a2 = (MYFLT) (dva0 - dva0 * alpha);
-      }
-      b2 = p->b2; a1 = p->a1; a2 = p->a2;
-      for (n=offset; n<nsmps; n++) {
-        tmp = asig[n];
-        ar[n] = b2 * (tmp + xnm1 + xnm1 + xnm2) - a1 * ynm1 - a2 * ynm2;
-        xnm2 = xnm1; xnm1 = tmp;
-        ynm2 = ynm1; ynm1 = ar[n];
+        p->c.b2 = (MYFLT) (0.5 * (dva0 - dva0 * p->cs));
+        p->c.a1 = (MYFLT) (-2.0 * dva0 * p->cs);
+        p->c.a2 = (MYFLT) (dva0 - dva0 * alpha);
+        p->c.b0 = p->c.b2;
+        p->c.b1 = p->c.b2 + p->c.b2;
       }
       break;
     case 1:                                     /* highpass filter */
@@ -973,16 +959,11 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
 #endif
         /* recalculate all coeffs */
         dva0 = 1.0 / (1.0 + alpha);
-        p->b2 = (MYFLT) (0.5 * (dva0 + dva0 * p->cs));
-        p->a1 = (MYFLT) (-2.0 * dva0 * p->cs);
-        p->a2 = (MYFLT) (dva0 - dva0 * alpha);
-      }
-      b2 = p->b2; a1 = p->a1; a2 = p->a2;
-      for (n=offset; n<nsmps; n++) {
-        tmp = asig[n];
-        ar[n] = b2 * (tmp - xnm1 - xnm1 + xnm2) - a1 * ynm1 - a2 * ynm2;
-        xnm2 = xnm1; xnm1 = tmp;
-        ynm2 = ynm1; ynm1 = ar[n];
+        p->c.b2 = (MYFLT) (0.5 * (dva0 + dva0 * p->cs));
+        p->c.a1 = (MYFLT) (-2.0 * dva0 * p->cs);
+        p->c.a2 = (MYFLT) (dva0 - dva0 * alpha);
+        p->c.b0 = p->c.b2;
+        p->c.b1 = -(p->c.b2 + p->c.b2);
       }
       break;
     case 2:                                     /* bandpass filter */
@@ -996,16 +977,11 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
 #endif
         /* recalculate all coeffs */
         dva0 = 1.0 / (1.0 + alpha);
-        p->b2 = (MYFLT) (dva0 * alpha);
-        p->a1 = (MYFLT) (-2.0 * dva0 * p->cs);
-        p->a2 = (MYFLT) (dva0 - dva0 * alpha);
-      }
-      b2 = p->b2; a1 = p->a1; a2 = p->a2;
-      for (n=offset; n<nsmps; n++) {
-        tmp = asig[n];
-        ar[n] = b2 * (tmp - xnm2) - a1 * ynm1 - a2 * ynm2;
-        xnm2 = xnm1; xnm1 = tmp;
-        ynm2 = ynm1; ynm1 = ar[n];
+        p->c.b0 = (MYFLT) (dva0 * alpha);
+        p->c.b1 = 0.0;
+        p->c.b2 = -p->c.b0;
+        p->c.a1 = (MYFLT) (-2.0 * dva0 * p->cs);
+        p->c.a2 = (MYFLT) (dva0 - dva0 * alpha);
       }
       break;
     case 3:                                     /* band-reject (notch) filter */
@@ -1019,16 +995,11 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
 #endif
         /* recalculate all coeffs */
         dva0 = 1.0 / (1.0 + alpha);
-        p->b2 = (MYFLT) dva0;
-        p->a1 = (MYFLT) (-2.0 * dva0 * p->cs);
-        p->a2 = (MYFLT) (dva0 - dva0 * alpha);
-      }
-      b2 = p->b2; a1 = p->a1; a2 = p->a2;
-      for (n=offset; n<nsmps; n++) {
-        tmp = asig[n];
-        ar[n] = b2 * (tmp + xnm2) - a1 * (ynm1 - xnm1) - a2 * ynm2;
-        xnm2 = xnm1; xnm1 = tmp;
-        ynm2 = ynm1; ynm1 = ar[n];
+        p->c.b2 = (MYFLT) dva0;
+        p->c.a1 = (MYFLT) (-2.0 * dva0 * p->cs);
+        p->c.a2 = (MYFLT) (dva0 - dva0 * alpha);
+        p->c.b0 = p->c.b2;
+        p->c.b1 = p->c.a1;
       }
       break;
     case 4:                                     /* peaking EQ */
@@ -1046,17 +1017,11 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
         tmp1 = alpha / sq;
         dva0 = 1.0 / (1.0 + tmp1);
         tmp2 = alpha * sq * dva0;
-        p->b0 = (MYFLT) (dva0 + tmp2);
-        p->b2 = (MYFLT) (dva0 - tmp2);
-        p->a1 = (MYFLT) (-2.0 * dva0 * p->cs);
-        p->a2 = (MYFLT) (dva0 - dva0 * tmp1);
-      }
-      b0 = p->b0; b2 = p->b2; a1 = p->a1; a2 = p->a2;
-      for (n=offset; n<nsmps; n++) {
-        tmp = asig[n];
-        ar[n] = b0 * tmp + b2 * xnm2 - a1 * (ynm1 - xnm1) - a2 * ynm2;
-        xnm2 = xnm1; xnm1 = tmp;
-        ynm2 = ynm1; ynm1 = ar[n];
+        p->c.b0 = (MYFLT) (dva0 + tmp2);
+        p->c.b2 = (MYFLT) (dva0 - tmp2);
+        p->c.a1 = (MYFLT) (-2.0 * dva0 * p->cs);
+        p->c.a2 = (MYFLT) (dva0 - dva0 * tmp1);
+        p->c.b1 = p->c.a1;
       }
       break;
     case 5:                                     /* low shelf */
@@ -1072,19 +1037,12 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
         tmp3 = tmp1 * p->cs;
         tmp4 = tmp2 * p->cs;
         dva0 = 1.0 / (tmp1 + tmp4 + beta);
-        p->a1 = (MYFLT) (-2.0 * dva0 * (tmp2 + tmp3));
-        p->a2 = (MYFLT) (dva0 * (tmp1 + tmp4 - beta));
+        p->c.a1 = (MYFLT) (-2.0 * dva0 * (tmp2 + tmp3));
+        p->c.a2 = (MYFLT) (dva0 * (tmp1 + tmp4 - beta));
         dva0 *= sq;
-        p->b0 = (MYFLT) (dva0 * (tmp1 - tmp4 + beta));
-        p->b1 = (MYFLT) ((dva0 + dva0) * (tmp2 - tmp3));
-        p->b2 = (MYFLT) (dva0 * (tmp1 - tmp4 - beta));
-      }
-      b0 = p->b0; b1 = p->b1; b2 = p->b2; a1 = p->a1; a2 = p->a2;
-      for (n=offset; n<nsmps; n++) {
-        tmp = asig[n];
-        ar[n] = b0 * tmp + b1 * xnm1 + b2 * xnm2 - a1 * ynm1 - a2 * ynm2;
-        xnm2 = xnm1; xnm1 = tmp;
-        ynm2 = ynm1; ynm1 = ar[n];
+        p->c.b0 = (MYFLT) (dva0 * (tmp1 - tmp4 + beta));
+        p->c.b1 = (MYFLT) ((dva0 + dva0) * (tmp2 - tmp3));
+        p->c.b2 = (MYFLT) (dva0 * (tmp1 - tmp4 - beta));
       }
       break;
     case 6:                                     /* high shelf */
@@ -1100,31 +1058,63 @@ static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
         tmp3 = tmp1 * p->cs;
         tmp4 = tmp2 * p->cs;
         dva0 = 1.0 / (tmp1 - tmp4 + beta);
-        p->a1 = (MYFLT) ((dva0 + dva0) * (tmp2 - tmp3));
-        p->a2 = (MYFLT) (dva0 * (tmp1 - tmp4 - beta));
+        p->c.a1 = (MYFLT) ((dva0 + dva0) * (tmp2 - tmp3));
+        p->c.a2 = (MYFLT) (dva0 * (tmp1 - tmp4 - beta));
         dva0 *= sq;
-        p->b0 = (MYFLT) (dva0 * (tmp1 + tmp4 + beta));
-        p->b1 = (MYFLT) (-2.0 * dva0 * (tmp2 + tmp3));
-        p->b2 = (MYFLT) (dva0 * (tmp1 + tmp4 - beta));
-      }
-      b0 = p->b0; b1 = p->b1; b2 = p->b2; a1 = p->a1; a2 = p->a2;
-      for (n=offset; n<nsmps; n++) {
-        tmp = asig[n];
-        ar[n] = b0 * tmp + b1 * xnm1 + b2 * xnm2 - a1 * ynm1 - a2 * ynm2;
-        xnm2 = xnm1; xnm1 = tmp;
-        ynm2 = ynm1; ynm1 = ar[n];
+        p->c.b0 = (MYFLT) (dva0 * (tmp1 + tmp4 + beta));
+        p->c.b1 = (MYFLT) (-2.0 * dva0 * (tmp2 + tmp3));
+        p->c.b2 = (MYFLT) (dva0 * (tmp1 + tmp4 - beta));
       }
       break;
     default:
+      return NOTOK;
+    }
+    return OK;
+}
+
+static int32_t rbjeq(CSOUND *csound, RBJEQ *p)
+{
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t nsmps = CS_KSMPS;
+    MYFLT   *ar = p->ar;
+
+    if (UNLIKELY(rbjeq_coefs(csound, p) != OK))
       return csound->PerfError(csound, &(p->h),
                                Str("rbjeq: invalid filter type"));
-      break;
+    if (UNLIKELY(offset)) memset(ar, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&ar[nsmps], '\0', early*sizeof(MYFLT));
     }
-    /* save filter state */
-    p->xnm1 = xnm1; p->xnm2 = xnm2; p->ynm1 = ynm1; p->ynm2 = ynm2;
+    iir_df1(&p->c, p->z, p->asig, ar, offset, nsmps);
     return OK;
 }
 
+/* rbjeq for n voices run together (see iir.h) */
+
+static int rbjeq_voice(CSOUND *csound, void *pp, IIR_COEFS *c, double **z,
+                       MYFLT **in, MYFLT **out)
+{
+    RBJEQ   *p = (RBJEQ *) pp;
+
+    if (UNLIKELY(rbjeq_coefs(csound, p) != OK))
+      return 0;                 /* perf gives the error */
+    *c = p->c; *z = p->z;
+    *in = p->asig; *out = p->ar;
+    return 1;
+}
+
+static const IIR_BATCH rbjeq_iir = {
+    (SUBR) rbjeq, rbjeq_voice, IIR_DF1
+};
+
+static int32_t rbjeq_batch(CSOUND *csound, void **p, int n)
+{
+    return iir_batch(csound, p, n, &rbjeq_iir);
+}
+
+
 /* ------------------------------------------------------------------------- */
 
 static const OENTRY vco2_localops[] = {
@@ -1142,8 +1132,8 @@ static const OENTRY vco2_localops[] = {
             (SUBR) delaykset, (SUBR) delayk, (SUBR) NULL                },
     { "vdel_k",     sizeof(VDELAYK),   0,  3,      "k",    "kkio",
             (SUBR) vdelaykset, (SUBR) vdelayk, (SUBR) NULL              },
-    { "rbjeq",      sizeof(RBJEQ),     0,  3,      "a",    "akkkko",
-            (SUBR) rbjeqset, (SUBR) rbjeq                  }
+    { "rbjeq",      sizeof(RBJEQ),     VB, 3,      "a",    "akkkko",
+            (SUBR) rbjeqset, (SUBR) rbjeq, NULL, NULL, rbjeq_batch     }
 };
 
 LINKAGE_BUILTIN(vco2_localops)
@@ -26,6 +26,7 @@
 
 #include "csoundCore.h"
 #include "stdopcod.h"
+#include "iir.h"
 
 #define OSCBNK_PHSMAX   0x80000000UL    /* max. phase   */
 #define OSCBNK_PHSMSK   0x7FFFFFFFUL    /* phase mask   */
@@ -129,8 +130,8 @@ typedef struct {                /* ar rbjeq asig, kfco, klvl, kQ, kS[, imode] */
         /* internal variables */
         MYFLT   old_kcps, old_klvl, old_kQ, old_kS;
         double  omega, cs, sn;
-        MYFLT   xnm1, xnm2, ynm1, ynm2;
-        MYFLT   b0, b1, b2, a1, a2;
+        double  z[4];           /* xnm1, xnm2, ynm1, ynm2 */
+        IIR_COEFS c;
         int32_t
         ftype;
 } RBJEQ;
@@ -295,6 +295,20 @@ static const char *longUsageList[] = {
   Str_noop("                          velocity number to pfield N as amplitude"),
   Str_noop("--no-default-paths      turn off relative paths from CSD/ORC/SCO"),
   Str_noop("--sample-accurate       use sample-accurate timing of score events"),
+  Str_noop("--parallel-scheduler=S  task dispatch with -j N: scan (default) "
+                                   "or steal"),
+  Str_noop("--barrier-spin=N        spin N times at a thread barrier "
+                                   "before sleeping"),
+  Str_noop("--sfwrite-queue=N       write the output file from a thread "
+                                   "with N buffers"),
+  Str_noop("--sample-cache=MB       share decoded sound files read by "
+                                   "diskin2 and GEN01 (0: off)"),
+  Str_noop("--ftgen-threads=N       generate large ftables on N background "
+                                   "threads"),
+  Str_noop("--ftable-cache=DIR      keep generated ftables in DIR and map "
+                                   "them on later runs"),
+  Str_noop("--voice-batch           run the notes of an instrument together, "
+                                   "opcode by opcode"),
   Str_noop("--realtime              realtime priority mode"),
   Str_noop("--nchnls=N              override number of audio channels"),
   Str_noop("--nchnls_i=N            override number of input audio channels"),
@@ -1066,6 +1080,50 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       O->numThreads = atoi(s);
       return 1;
     }
+    else if (!(strncmp (s, "parallel-scheduler=", 19))) {
+      s += 19;
+      if (!(strcmp(s, "steal")))
+        O->parallelScheduler = PAR_SCHED_STEAL;
+      else if (!(strcmp(s, "scan")))
+        O->parallelScheduler = PAR_SCHED_SCAN;
+      else
+        csound->Warning(csound, Str("unknown parallel scheduler '%s'"), s);
+      return 1;
+    }
+    else if (!(strncmp (s, "barrier-spin=", 13))) {
+      s += 13;
+      O->barrierSpin = atoi(s);
+      if (O->barrierSpin < 0) O->barrierSpin = 0;
+      return 1;
+    }
+    else if (!(strncmp (s, "sfwrite-queue=", 14))) {
+      s += 14;
+      O->sfWriteQueue = atoi(s);
+      if (O->sfWriteQueue < 0) O->sfWriteQueue = 0;
+      return 1;
+    }
+    else if (!(strncmp (s, "sample-cache=", 13))) {
+      s += 13;
+      O->sampleCache = atoi(s);
+      if (O->sampleCache < 0) O->sampleCache = 0;
+      return 1;
+    }
+    else if (!(strncmp (s, "ftable-cache=", 13))) {
+      s += 13;
+      if (UNLIKELY(*s == '\0')) dieu(csound, Str("no ftable cache directory"));
+      O->ftCacheDir = s;
+      return 1;
+    }
+    else if (!(strncmp (s, "ftgen-threads=", 14))) {
+      s += 14;
+      O->ftgenThreads = atoi(s);
+      if (O->ftgenThreads < 0) O->ftgenThreads = 0;
+      return 1;
+    }
+    else if (!(strcmp (s, "voice-batch"))) {
+      O->voiceBatch = 1;
+      return 1;
+    }
     else if (!(strcmp (s, "syntax-check-only"))) {
       O->syntaxCheckOnly = 1;
       return 1;
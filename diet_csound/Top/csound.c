@@ -63,6 +63,8 @@
 #include "namedins.h"
 //#include "cs_par_dispatch.h"
 #include "find_opcode.h"
+#include "interlocks.h"
+#include "vbatch.h"
 
 #if defined(linux)||defined(__HAIKU__)|| defined(__EMSCRIPTEN__)||defined(__CYGWIN__)
 #define PTHREAD_SPINLOCK_INITIALIZER 0
@@ -87,6 +89,9 @@ static int  defaultCsoundYield(CSOUND *);
 static int  csoundDoCallback_(CSOUND *, void *, unsigned int);
 static void reset(CSOUND *);
 static int  csoundPerformKsmpsInternal(CSOUND *csound);
+static int  csoundSetPerformDriver(CSOUND *, int (*)(CSOUND *, void *),
+                                   void *);
+static int  csoundPerformKsmpsDriven(CSOUND *);
 void csoundTableSetInternal(CSOUND *csound, int table, int index,
                                    MYFLT value);
 static INSTRTXT **csoundGetInstrumentList(CSOUND *csound);
@@ -96,6 +101,8 @@ static void set_util_nchnls(CSOUND *csound, int nchnls);
 
 extern void cscoreRESET(CSOUND *);
 extern void memRESET(CSOUND *);
+extern void memINIT(CSOUND *, int);
+extern void memDESTROY(CSOUND *);
 extern MYFLT csoundPow2(CSOUND *csound, MYFLT a);
 extern int csoundInitStaticModules(CSOUND *);
 extern void close_all_files(CSOUND *);
@@ -110,6 +117,7 @@ void csoundDebuggerBreakpointReached(CSOUND *csound);
 void message_dequeue(CSOUND *csound);
 
 extern OENTRY opcodlst_1[];
+extern void aops_dispatch(CSOUND *);
 
 #define STRING_HASH(arg) STRSH(arg)
 #define STRSH(arg) #arg
@@ -192,6 +200,8 @@ static void create_opcode_table(CSOUND *csound)
 
     if (UNLIKELY(err))
       csoundDie(csound, Str("Error allocating opcode list"));
+    /* vector arithmetic for this CPU */
+    aops_dispatch(csound);
 
 }
 
@@ -521,10 +531,12 @@ static const CSOUND cenviron_ = {
     csoundCepsLP,
     csoundLPrms,
     csoundCreateThread2,
+    csoundSetPerformDriver,
+    csoundPerformKsmpsDriven,
+    csoundPrefetchAsync,
     {
       NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-      NULL, NULL
+      NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
     },
     /* ------- private data (not to be used by hosts or externals) ------- */
     /* callback function pointers */
@@ -603,6 +615,7 @@ static const CSOUND cenviron_ = {
     DFLT_NCHNLS,    /*  nchnls              */
     -1,             /*  inchns              */
      0,              /*  spoutactive         */
+    0,              /*  spouthost           */
     0L,             /*  kcounter            */
     0L,             /*  global_kcounter     */
     DFLT_SR,        /*  esr                 */
@@ -635,6 +648,9 @@ static const CSOUND cenviron_ = {
     NULL, NULL,     /*  scorein, scoreout   */
     NULL,           /*  argoffspace         */
     NULL,           /*  frstoff             */
+    NULL,           /*  offheap             */
+    0, 0,           /*  offcnt, offmax      */
+    0,              /*  offseq              */
     NULL,           /*  stdOp_Env           */
     2345678,        /*  holdrand            */
     0,              /*  randSeed1           */
@@ -685,7 +701,7 @@ static const CSOUND cenviron_ = {
     NULL,
     NULL,
     NULL,
-    NULL,
+    0, 0,
     NULL,
     NULL,
     0,
@@ -722,6 +738,7 @@ static const CSOUND cenviron_ = {
     FL(0.0),
     NULL,
     NULL,
+    0,
     {NULL, FL(0.0)},
    {NULL, FL(0.0)},
    {NULL, FL(0.0)},
@@ -731,6 +748,9 @@ static const CSOUND cenviron_ = {
     0, 0,           /*  rngflg, multichan   */
     NULL,           /*  evtFuncChain        */
     NULL,           /*  OrcTrigEvts         */
+    NULL,           /*  OrcTrigHeap         */
+    0, 0,           /*  OrcTrigCnt, OrcTrigMax */
+    0,              /*  OrcTrigSeq          */
     NULL,           /*  freeEvtNodes        */
     1,              /*  csoundIsScorePending_ */
     0,              /*  advanceCnt          */
@@ -743,6 +763,10 @@ static const CSOUND cenviron_ = {
     0,              /*  maxfnum             */
     NULL,           /*  gensub              */
     GENMAX+1,       /*  genmax              */
+    NULL,           /*  ftjobs              */
+    NULL,           /*  ftcache             */
+    NULL,           /*  ftretired           */
+    0,              /*  ftepoch             */
     NULL,           /*  namedGlobals        */
     NULL,           /*  cfgVariableDB       */
     FL(0.0), FL(0.0), FL(0.0),  /*  prvbt, curbt, nxtbt */
@@ -751,6 +775,7 @@ static const CSOUND cenviron_ = {
     { 0, NULL, NULL, '\0', 0, FL(0.0),
       FL(0.0), { FL(0.0) }, {NULL}},   /*  evt */
     NULL,           /*  memalloc_db         */
+    NULL,           /*  memarena            */
     (MGLOBAL*) NULL, /* midiGlobals         */
     NULL,           /*  envVarDB            */
     (MEMFIL*) NULL, /*  memfiles            */
@@ -763,6 +788,7 @@ static const CSOUND cenviron_ = {
     NULL,           /* file_io_thread    */
     0,              /* file_io_start   */
     NULL,           /* file_io_threadlock */
+    NULL,           /* file_io_wake */
     0,              /* realtime_audio_flag */
     NULL,           /* init pass thread */
     0,              /* init pass loop  */
@@ -833,6 +859,7 @@ static const CSOUND cenviron_ = {
       1U,           /*  nframes             */
       NULL, NULL,   /*  pin, pout           */
       0,            /*dither                */
+      NULL          /*  sfwriter            */
     },
     0,              /*  warped              */
     0,              /*  sstrlen             */
@@ -852,8 +879,10 @@ static const CSOUND cenviron_ = {
     NULL, NULL,     /*  omacros, smacros    */
     NULL,           /*  namedgen            */
     NULL,           /*  open_files          */
+    SPINLOCK_INIT,  /*  open_files_lock     */
     NULL,           /*  searchPathCache     */
     NULL,           /*  sndmemfiles         */
+    NULL,           /*  sndcache            */
     NULL,           /*  reset_list          */
     NULL,           /*  pvFileTable         */
     0,              /*  pvNumFiles          */
@@ -883,10 +912,17 @@ static const CSOUND cenviron_ = {
     0,              /*  currentLPCSlot      */
     0,              /*  max_lpc_slot        */
     NULL,           /*  chn_db              */
+    NULL,           /*  chn_numtab          */
+    0,              /*  chn_bus_seq         */
+    NULL,           /*  chn_audio           */
     1,              /*  opcodedirWasOK      */
     0,              /*  disable_csd_options */
     { 0, { 0U } },  /*  randState_          */
     0,              /*  performState        */
+    NULL,           /*  perfDriver          */
+    NULL,           /*  perfDriverData      */
+    0,              /*  perfDriven          */
+    0, 0,           /*  perfDrivenEnd, perfDrivenResult */
     1000,           /*  ugens4_rand_16      */
     1000,           /*  ugens4_rand_15      */
     NULL,           /*  schedule_kicked     */
@@ -929,7 +965,14 @@ static const CSOUND cenviron_ = {
       0,             /*    fft_lib */
       0,             /* echo */
       0.0,           /* limiter */
-      DFLT_SR, DFLT_KR  /* defaults */
+      DFLT_SR, DFLT_KR, /* defaults */
+      PAR_SCHED_SCAN, /* parallelScheduler */
+      1000,          /* barrierSpin */
+      0,             /* sfWriteQueue */
+      128,           /* sampleCache */
+      0,             /* ftgenThreads */
+      NULL,          /* ftCacheDir */
+      0              /* voiceBatch */
     },
     {0, 0, {0}}, /* REMOT_BUF */
     NULL,           /* remoteGlobals        */
@@ -954,8 +997,18 @@ static const CSOUND cenviron_ = {
     NULL,           /* dag_task_status */
     NULL,           /* dag_task_watch */
     NULL,           /* dag_wlmm */
-    NULL,           /* dag_task_dep */
+    NULL,           /* dag_task_ins */
+    NULL,           /* dag_run_first */
+    0,              /* dag_num_runs */
     100,            /* dag_task_max_size */
+    NULL,           /* dag_deques */
+    0,              /* dag_num_deques */
+    0,              /* dag_tasks_left */
+    0,              /* dag_serial */
+    NULL,           /* dag_ins_conflict */
+    NULL,           /* dag_ins_known */
+    NULL,           /* dag_ins_txt */
+    0,              /* dag_ins_max */
     0,              /* tempStatus */
     1,              /* orcLineOffset */
     0,              /* scoLineOffset */
@@ -985,9 +1038,10 @@ static const CSOUND cenviron_ = {
     1,              /* inZero */
     NULL,           /* msg_queue */
     0,              /* msg_queue_wget */
-    0,              /* msg_queue_wput */
     0,              /* msg_queue_rstart */
-    0,              /* msg_queue_items */
+    NULL,           /* msg_spill */
+    NULL,           /* msg_spill_tail */
+    SPINLOCK_INIT,  /* msg_spill_lock */
     127,            /* aftouch */
     NULL,           /* directory for corfiles */
     NULL,           /* alloc_queue */
@@ -1320,6 +1374,11 @@ PUBLIC void csoundSetOpcodedir(const char *s) {
 
 
 PUBLIC CSOUND *csoundCreate(void *hostdata)
+{
+    return csoundCreateWithAllocator(hostdata, CSOUND_ALLOC_SYSTEM);
+}
+
+PUBLIC CSOUND *csoundCreateWithAllocator(void *hostdata, int allocator)
 {
     CSOUND        *csound;
     csInstance_t  *p;
@@ -1344,6 +1403,7 @@ PUBLIC CSOUND *csoundCreate(void *hostdata)
     p->nxt = (csInstance_t*) instance_list;
     instance_list = p;
     csoundUnLock();
+    memINIT(csound, allocator);
     csoundReset(csound);
     csound->API_lock = csoundCreateMutex(1);
     allocate_message_queue(csound);
@@ -1422,6 +1482,7 @@ PUBLIC void csoundDestroy(CSOUND *csound)
       //csoundLockMutex(csound->API_lock);
       csoundDestroyMutex(csound->API_lock);
     }
+    memDESTROY(csound);
     /* clear the pointer */
     // *(csound->self) = NULL;
     free((void*) csound);
@@ -1517,7 +1578,7 @@ inline void advanceINSDSPointer(INSDS ***start, int num)
 }
 
 int dag_get_task(CSOUND *csound, int index, int numThreads, int next_task);
-int dag_end_task(CSOUND *csound, int task);
+int dag_end_task(CSOUND *csound, int index, int task);
 void dag_build(CSOUND *csound, INSDS *chain);
 void dag_reinit(CSOUND *csound);
 
@@ -1533,7 +1594,6 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
 #define INVALID (-1)
 #define WAIT    (-2)
     int next_task = INVALID;
-    IGN(index);
 
     while (1) {
       int done;
@@ -1613,44 +1673,48 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
           played_count++;
         }
         //printf("******** finished task %d\n", which_task);
-        next_task = dag_end_task(csound, which_task);
+        next_task = dag_end_task(csound, index, which_task);
     }
     return played_count;
 }
 #endif //PARCS
 
-inline static void make_interleave(CSOUND *csound, uint32_t lksmps)
+/* spraw is the planar output of a cycle, nchnls blocks of ksmps samples.
+   Instruments with a local ksmps leave it as a sequence of nchnls x lksmps
+   blocks instead, which is reordered here; spout is free to be used as
+   scratch space because it is only filled for a host that reads it. */
+
+inline static void make_planar(CSOUND *csound, uint32_t lksmps)
 {
-    uint32_t nsmps = csound->ksmps, nchan = csound->nchnls,i, j, n, k=0;
-    MYFLT *spout = csound->spout;
+    uint32_t nsmps = csound->ksmps, nchan = csound->nchnls, i, n;
+    MYFLT *spout = csound->spout, *spraw = csound->spraw;
 
-    if (!csound->spoutactive) {
-      memset(spout, '\0', csound->nspout*sizeof(MYFLT));
-    }
-    else if (lksmps == nsmps|| nchan==1 ) {
-      for (j=0; j<nsmps; j++) {
-        for (i=0; i<nchan; i++) {
-          // Will be copy t ad when complette
-          spout[k + i] = csound->spraw[i*nsmps+j];
-        }
-        k += nchan;
-      }
-    }
-    else {
-      int m = 0;
-      for (n=0; n<nsmps/lksmps; n++) {
-        for (j=0; j<lksmps; j++) {
-          for (i=0; i<nchan; i++) {
-            // Will be copy t ad when complette
-            spout[k + i] = csound->spraw[i*lksmps+j+m];
-          }
-          k += nchan;
-        }
-        m += nchan*lksmps;
-      }
+    if (!csound->spoutactive)
+      memset(spraw, 0, csound->nspout*sizeof(MYFLT));
+    else if (lksmps != nsmps && nchan > 1) {
+      memcpy(spout, spraw, csound->nspout*sizeof(MYFLT));
+      for (n=0; n<nsmps/lksmps; n++)
+        for (i=0; i<nchan; i++)
+          memcpy(&spraw[i*nsmps + n*lksmps], &spout[(n*nchan + i)*lksmps],
+                 lksmps*sizeof(MYFLT));
     }
 }
 
+/* fill spout from spraw, once a host has asked for it: spoutsf() and the
+   drivers read spraw, but hosts keep the pointer from csoundGetSpout()
+   and read spout after every cycle */
+
+static void make_interleave(CSOUND *csound)
+{
+    if (!csound->spouthost)
+      return;
+    if (!csound->spoutactive)
+      memset(csound->spout, '\0', csound->nspout*sizeof(MYFLT));
+    else
+      interleave_frames(csound->spout, csound->spraw, csound->nchnls,
+                        csound->ksmps, csound->ksmps, FL(1.0));
+}
+
 #ifdef PARCS
 unsigned long kperfThread(void * cs)
 {
@@ -1661,7 +1725,7 @@ unsigned long kperfThread(void * cs)
     int numThreads;
     _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
 
-    csound->WaitBarrier(csound->barrier2);
+    csp_barrier_wait(csound->barrier2);
 
     threadId = csound->GetCurrentThreadID();
     index = getThreadIndex(csound, threadId);
@@ -1681,7 +1745,7 @@ unsigned long kperfThread(void * cs)
 
     while (1) {
 
-      csound->WaitBarrier(csound->barrier1);
+      csp_barrier_wait(csound->barrier1);
 
       // FIXME:PTHREAD_WORK - need to check if this is necessary and, if so,
       // use some other kind of locking mechanism as it isn't clear why a
@@ -1696,11 +1760,137 @@ unsigned long kperfThread(void * cs)
 
       nodePerf(csound, index, numThreads);
 
-      csound->WaitBarrier(csound->barrier2);
+      csp_barrier_wait(csound->barrier2);
     }
 }
 #endif
 
+/* Voice batching (--voice-batch): the active instances of an instr
+   are contiguous in the active list, and those of an instr made only
+   of VB opcodes can run op by op: each opcode for every voice, then
+   the next.  Labels (and so any jump), user opcodes and writes to
+   global variables rule an instr out, as these would let one voice
+   see another half way through its k-cycle.  Opcodes that read spin
+   or add into spout (IB) are allowed too, but the group stops at the
+   first of them: from there each voice runs the rest of its chain
+   alone, so that spout is summed in the same order as without
+   batching. */
+
+static int vbatch_check(INSTRTXT *tp)
+{
+    OPTXT   *optxt = (OPTXT*) tp;
+    OENTRY  *ep;
+    ARG     *arg;
+
+    while ((optxt = optxt->nxtop) != NULL) {
+      ep = optxt->t.oentry;
+      if (strcmp(ep->opname, "endin") == 0 ||
+          strcmp(ep->opname, "endop") == 0)
+        break;
+      if (strcmp(ep->opname, "$label") == 0 || ep->useropinfo != NULL)
+        return -1;
+      if (!(ep->thread & 02) &&                 /* not run at perf time */
+          ((ep->thread & 03) != 0 || optxt->t.pftype == 'b'))
+        continue;
+      if (!(ep->flags & (VB | IB)))
+        return -1;
+      for (arg = optxt->t.outArgs; arg != NULL; arg = arg->next)
+        if (arg->type == ARG_GLOBAL)
+          return -1;
+    }
+    return 1;
+}
+
+/* Perform ip and the instances of the same instr that follow it op by
+   op, and step *pip past them.  Returns 0, leaving *pip alone, if
+   there is nothing to batch. */
+
+static int vbatch_perf(CSOUND *csound, INSDS **pip, double time_end)
+{
+    INSDS   *ip = *pip, *voice[VBATCH_MAX], *nxt;
+    OPDS    *ops[VBATCH_MAX];
+    INSTRTXT *tp = ip->instr;
+    OENTRY  *ep;
+    OPDS    *op;
+    int     i, j, n, m, alone = 0;
+
+    if (UNLIKELY(tp->vbatch == 0))
+      tp->vbatch = vbatch_check(tp);
+    if (tp->vbatch < 0)
+      return 0;
+    for (n = 0; ip != NULL && ip->instr == tp && n < VBATCH_MAX;
+         ip = ip->nxtact) {
+      if (ATOMIC_GET(ip->init_done) != 1 || ip->ksmps != csound->ksmps ||
+          !ip->actflg)
+        break;
+      voice[n++] = ip;
+    }
+    if (n < 2)
+      return 0;
+    nxt = voice[n-1]->nxtact;
+    for (i = 0; i < n; i++) {
+      ip = voice[i];
+      if (UNLIKELY(csound->oparms->sampleAccurate &&
+                   ip->offtim > 0                 &&
+                   time_end > ip->offtim))
+        ip->ksmps_no_end = ip->no_end;
+      ip->spin = csound->spin;
+      ip->spout = csound->spraw;
+      ip->kcounter = csound->kcounter;
+      ops[i] = (OPDS*) ip;
+    }
+    csound->mode = 2;
+    m = n;
+    while (m > 0 && (ops[0] = ops[0]->nxtp) != NULL) {
+      /* the instances share one opcode chain */
+      for (i = 1; i < m; i++)
+        ops[i] = ops[i]->nxtp;
+      ep = ops[0]->optext->t.oentry;
+      if (ep->flags & IB) {
+        alone = 1;
+        break;
+      }
+      csound->op = ops[0]->optext->t.opcod;
+      /* as in the loop below, an error ends the voice's k-cycle */
+      if (ep->bopadr != NULL) {
+        for (i = 0; i < m; i++)
+          ops[i]->insdshead->pds = ops[i];
+        m = (*ep->bopadr)(csound, (void**) ops, m);
+      }
+      else {
+        for (i = j = 0; i < m; i++) {
+          ops[i]->insdshead->pds = ops[i];
+          if (LIKELY((*ops[i]->opadr)(csound, ops[i]) == 0))
+            ops[j++] = ops[i];
+        }
+        m = j;
+      }
+      /* voices turned off drop out of the group */
+      for (i = j = 0; i < m; i++)
+        if (ops[i]->insdshead->actflg)
+          ops[j++] = ops[i]->insdshead->pds;
+      m = j;
+    }
+    /* the rest of the chain, a voice at a time */
+    for (i = 0; alone && i < m; i++) {
+      ip = ops[i]->insdshead;
+      for (op = ops[i]; op != NULL && ip->actflg; op = op->nxtp) {
+        ip->pds = op;
+        csound->op = op->optext->t.opcod;
+        if ((*op->opadr)(csound, op) != 0)
+          break;
+        op = ip->pds;
+      }
+    }
+    csound->mode = 0;
+    for (i = 0; i < n; i++) {
+      voice[i]->ksmps_offset = 0;         /* reset sample-accuracy offset */
+      voice[i]->ksmps_no_end = 0;
+    }
+    *pip = (nxt != NULL ? nxt : voice[n-1]->nxtact);
+    return 1;
+}
+
 int kperf_nodebug(CSOUND *csound)
 {
     INSDS *ip;
@@ -1712,6 +1902,12 @@ int kperf_nodebug(CSOUND *csound)
 
    /* call message_dequeue to run API calls */
     message_dequeue(csound);
+    /* install ftables made by the background GEN threads */
+    if (UNLIKELY(csound->ftjobs != NULL))
+      ftjobs_publish(csound);
+    /* free replaced ftables no running note can still be using */
+    if (UNLIKELY(csound->ftretired != NULL))
+      ftreclaim(csound, 0);
 
 
     /* if skipping time on request by 'a' score statement: */
@@ -1733,11 +1929,12 @@ int kperf_nodebug(CSOUND *csound)
     if (csound->oparms_.sfread)         /*   if audio_infile open  */
       csound->spinrecv(csound);         /*      fill the spin buf  */
     csound->spoutactive = 0;            /*   make spout inactive   */
-    /* clear spout */
-    memset(csound->spout, 0, csound->nspout*sizeof(MYFLT));
+    /* clear spraw; spout is rebuilt from it on demand */
     memset(csound->spraw, 0, csound->nspout*sizeof(MYFLT));
     ip = csound->actanchor.nxtact;
 
+    /* audio channels set by a host; writes of this cycle (bus.c) */
+    chn_bus_begin(csound);
     if (ip != NULL) {
       /* There are 2 partitions of work: 1st by inso,
          2nd by inso count / thread count. */
@@ -1746,13 +1943,19 @@ int kperf_nodebug(CSOUND *csound)
         if (csound->dag_changed) dag_build(csound, ip);
         else dag_reinit(csound);     /* set to initial state */
 
-        /* process this partition */
-        csound->WaitBarrier(csound->barrier1);
+        if (csound->dag_serial) {
+          /* nothing to share: leave the workers parked */
+          (void) nodePerf(csound, 0, 1);
+        }
+        else {
+          /* process this partition */
+          csp_barrier_wait(csound->barrier1);
 
-        (void) nodePerf(csound, 0, 1);
+          (void) nodePerf(csound, 0, 1);
 
-        /* wait until partition is complete */
-        csound->WaitBarrier(csound->barrier2);
+          /* wait until partition is complete */
+          csp_barrier_wait(csound->barrier2);
+        }
 #endif
         csound->multiThreadedDag = NULL;
       }
@@ -1762,6 +1965,9 @@ int kperf_nodebug(CSOUND *csound)
 
         while (ip != NULL) {                /* for each instr active:  */
           INSDS *nxt = ip->nxtact;
+          if (csound->oparms->voiceBatch &&
+              vbatch_perf(csound, &ip, time_end))
+            continue;
           if (UNLIKELY(csound->oparms->sampleAccurate &&
                        ip->offtim > 0                 &&
                        time_end > ip->offtim)) {
@@ -1851,12 +2057,10 @@ int kperf_nodebug(CSOUND *csound)
         }
       }
     }
+    chn_bus_end(csound);
 
-    if (!csound->spoutactive) { /* results now in spout? */
-      memset(csound->spout, 0, csound->nspout * sizeof(MYFLT));
-      memset(csound->spraw, 0, csound->nspout * sizeof(MYFLT));
-    }
-    make_interleave(csound, lksmps);
+    make_planar(csound, lksmps);
+    make_interleave(csound);
     csound->spoutran(csound); /* send to audio_out */
     //#ifdef ANDROID
     //struct timespec ts;
@@ -1956,6 +2160,12 @@ int kperf_debug(CSOUND *csound)
     int lksmps = csound->ksmps;
     /* call message_dequeue to run API calls */
     message_dequeue(csound);
+    /* install ftables made by the background GEN threads */
+    if (UNLIKELY(csound->ftjobs != NULL))
+      ftjobs_publish(csound);
+    /* free replaced ftables no running note can still be using */
+    if (UNLIKELY(csound->ftretired != NULL))
+      ftreclaim(csound, 0);
 
     if (!data || data->status != CSDEBUG_STATUS_STOPPED) {
       /* update orchestra time */
@@ -1989,8 +2199,7 @@ int kperf_debug(CSOUND *csound)
       if (csound->oparms_.sfread)         /*   if audio_infile open  */
         csound->spinrecv(csound);         /*      fill the spin buf  */
       csound->spoutactive = 0;            /*   make spout inactive   */
-      /* clear spout */
-      memset(csound->spout, 0, csound->nspout*sizeof(MYFLT));
+      /* clear spraw; spout is rebuilt from it on demand */
       memset(csound->spraw, 0, csound->nspout*sizeof(MYFLT));
     }
 
@@ -2018,6 +2227,7 @@ int kperf_debug(CSOUND *csound)
           data->status = CSDEBUG_STATUS_NEXT;
       }
     }
+    chn_bus_begin(csound);
     if (ip != NULL && data != NULL && (data->status != CSDEBUG_STATUS_STOPPED) ) {
       /* There are 2 partitions of work: 1st by inso,
          2nd by inso count / thread count. */
@@ -2026,13 +2236,19 @@ int kperf_debug(CSOUND *csound)
         if (csound->dag_changed) dag_build(csound, ip);
         else dag_reinit(csound);     /* set to initial state */
 
-        /* process this partition */
-        csound->WaitBarrier(csound->barrier1);
+        if (csound->dag_serial) {
+          /* nothing to share: leave the workers parked */
+          (void) nodePerf(csound, 0, 1);
+        }
+        else {
+          /* process this partition */
+          csp_barrier_wait(csound->barrier1);
 
-        (void) nodePerf(csound, 0, 1);
+          (void) nodePerf(csound, 0, 1);
 
-        /* wait until partition is complete */
-        csound->WaitBarrier(csound->barrier2);
+          /* wait until partition is complete */
+          csp_barrier_wait(csound->barrier2);
+        }
 #endif
         csound->multiThreadedDag = NULL;
       }
@@ -2061,6 +2277,7 @@ int kperf_debug(CSOUND *csound)
                     data->debug_opcode_ptr = NULL;
                     data->status = CSDEBUG_STATUS_STOPPED;
                     csoundDebuggerBreakpointReached(csound);
+                    chn_bus_end(csound);
                     return 0;
                 } else {
                     ip = data->debug_instr_ptr;
@@ -2079,6 +2296,7 @@ int kperf_debug(CSOUND *csound)
                   data->status = CSDEBUG_STATUS_STOPPED;
                   csoundDebuggerBreakpointReached(csound);
                   bp_node->count = bp_node->skip;
+                  chn_bus_end(csound);
                   return 0;
                 } else {
                   bp_node->count--;
@@ -2131,21 +2349,19 @@ int kperf_debug(CSOUND *csound)
             if (ip != NULL) { /* must defer break until next kperf */
               data->status = CSDEBUG_STATUS_STOPPED;
               csoundDebuggerBreakpointReached(csound);
+              chn_bus_end(csound);
               return 0;
             }
           }
         }
       }
     }
+    chn_bus_end(csound);
 
     if (!data || data->status != CSDEBUG_STATUS_STOPPED)
     {
-    if (!csound->spoutactive) {             /*   results now in spout? */
-      memset(csound->spout, 0, csound->nspout * sizeof(MYFLT));
-      memset(csound->spraw, 0, csound->nspout * sizeof(MYFLT));
-    }
-    else
-      make_interleave(csound, lksmps);
+    make_planar(csound, lksmps);
+    make_interleave(csound);
     csound->spoutran(csound);               /*      send to audio_out  */
     }
     return 0;
@@ -2291,6 +2507,8 @@ PUBLIC int csoundPerformBuffer(CSOUND *csound)
 
 /* perform an entire score */
 
+enum {PERF_DRIVEN_DONE=1, PERF_DRIVEN_STOP, PERF_DRIVEN_JMP};
+
 PUBLIC int csoundPerform(CSOUND *csound)
 {
     int done;
@@ -2313,18 +2531,41 @@ PUBLIC int csoundPerform(CSOUND *csound)
       return ((returnValue - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
     }
     do {
+      if (csound->perfDriver != NULL) {
+        /* the audio module runs the k-cycles; wait outside kperf */
+        csound->perfDrivenEnd = 0;
+        ATOMIC_SET(csound->perfDriven, 1);
+        csound->perfDriver(csound, csound->perfDriverData);
+        /* let a driven k-cycle in progress finish */
+        for (;;) {
+          long waiting = 1, idle = 0;
+          if (!ATOMIC_CMP_XCH(&csound->perfDriven, idle, waiting))
+            break;
+          csoundSleep(1);
+        }
+        done = csound->perfDrivenResult;
+        if (csound->perfDrivenEnd == PERF_DRIVEN_JMP) {
+#ifndef MACOSX
+          csoundMessage(csound, Str("Early return from csoundPerform().\n"));
+#endif
+          return done;
+        }
+        if (csound->perfDrivenEnd == PERF_DRIVEN_DONE)
+          goto finished;
+        if (csound->perfDrivenEnd == PERF_DRIVEN_STOP)
+          break;
+        /* not the end (the JACK server went away): call it again,
+           unless it has taken itself off */
+        if (csound->perfDriver != NULL)
+          continue;
+      }
         if(!csound->oparms->realtime)
            csoundLockMutex(csound->API_lock);
       do {
         if (UNLIKELY((done = sensevents(csound)))) {
-           csoundMessage(csound, Str("Score finished in csoundPerform().\n"));
           if(!csound->oparms->realtime)
             csoundUnlockMutex(csound->API_lock);
-          if (csound->oparms->numThreads > 1) {
-            csound->multiThreadedComplete = 1;
-            csound->WaitBarrier(csound->barrier1);
-          }
-          return done;
+          goto finished;
         }
       } while (csound->kperf(csound));
       if(!csound->oparms->realtime)
@@ -2333,6 +2574,71 @@ PUBLIC int csoundPerform(CSOUND *csound)
     csoundMessage(csound, Str("csoundPerform(): stopped.\n"));
     csound->performState = 0;
     return 0;
+ finished:
+    csoundMessage(csound, Str("Score finished in csoundPerform().\n"));
+    if (csound->oparms->numThreads > 1) {
+      csound->multiThreadedComplete = 1;
+      csp_barrier_wait(csound->barrier1);
+    }
+    return done;
+}
+
+static int csoundSetPerformDriver(CSOUND *csound,
+                                  int (*driver)(CSOUND *, void *),
+                                  void *userData)
+{
+    csound->perfDriver = driver;
+    csound->perfDriverData = userData;
+    return OK;
+}
+
+/* One k-cycle of csoundPerform() for its driver, on the driver's
+   thread.  The thread in csoundPerform() is not using exitjmp while it
+   waits, so an exit jumps back here and is handed to it to return. */
+
+static int csoundPerformKsmpsDriven(CSOUND *csound)
+{
+    jmp_buf       saved;
+    volatile int  locked = 0;
+    int           done = 0, n;
+    long          waiting = 1, running = 2;
+
+    if (UNLIKELY(ATOMIC_CMP_XCH(&csound->perfDriven, running, waiting)))
+      return CSOUND_ERROR;
+    if (UNLIKELY(csound->perfDrivenEnd)) {
+      ATOMIC_SET(csound->perfDriven, 1);
+      return CSOUND_ERROR;
+    }
+    memcpy((void*) &saved, (void*) &csound->exitjmp, sizeof(jmp_buf));
+    if (UNLIKELY((n = setjmp(csound->exitjmp)) != 0)) {
+      memcpy((void*) &csound->exitjmp, (void*) &saved, sizeof(jmp_buf));
+      if (locked)
+        csoundUnlockMutex(csound->API_lock);
+      csound->perfDrivenResult =
+        ((n - CSOUND_EXITJMP_SUCCESS) | CSOUND_EXITJMP_SUCCESS);
+      csound->perfDrivenEnd = PERF_DRIVEN_JMP;
+      ATOMIC_SET(csound->perfDriven, 1);
+      return 1;
+    }
+    if (!csound->oparms->realtime) {
+      csoundLockMutex(csound->API_lock);
+      locked = 1;
+    }
+    do {
+      if (UNLIKELY((done = sensevents(csound))))
+        break;
+    } while (csound->kperf(csound));
+    if (locked)
+      csoundUnlockMutex(csound->API_lock);
+    memcpy((void*) &csound->exitjmp, (void*) &saved, sizeof(jmp_buf));
+    if (done) {
+      csound->perfDrivenResult = done;
+      csound->perfDrivenEnd = PERF_DRIVEN_DONE;
+    }
+    else if ((unsigned char) csound->performState != (unsigned char) '\0')
+      csound->perfDrivenEnd = PERF_DRIVEN_STOP;
+    ATOMIC_SET(csound->perfDriven, 1);
+    return csound->perfDrivenEnd != 0;
 }
 
 /* stop a csoundPerform() running in another thread */
@@ -2424,13 +2730,22 @@ PUBLIC void csoundAddSpinSample(CSOUND *csound, int frame,
 
 PUBLIC MYFLT *csoundGetSpout(CSOUND *csound)
 {
+    if (!csound->spouthost) {
+      csound->spouthost = 1;
+      make_interleave(csound);
+    }
     return csound->spout;
 }
 
+PUBLIC MYFLT *csoundGetSpoutPlanar(CSOUND *csound)
+{
+    return csound->spraw;
+}
+
 PUBLIC MYFLT csoundGetSpoutSample(CSOUND *csound, int frame, int channel)
 {
-    int index = (frame * csound->nchnls) + channel;
-    return csound->spout[index];
+    int index = (channel * csound->ksmps) + frame;
+    return csound->spraw[index];
 }
 
 PUBLIC const char *csoundGetOutputName(CSOUND *csound)
@@ -3228,6 +3543,8 @@ PUBLIC int csoundAppendOpcode(CSOUND *csound,
     tmpEntry.iopadr     = iopadr;
     tmpEntry.kopadr     = kopadr;
     tmpEntry.aopadr     = aopadr;
+    tmpEntry.useropinfo = NULL;
+    tmpEntry.bopadr     = NULL;
     err = opcode_list_new_oentry(csound, &tmpEntry);
     add_to_symbtab(csound, &tmpEntry);
     if (UNLIKELY(err))
@@ -3311,7 +3628,10 @@ static void reset(CSOUND *csound)
     uintptr_t end, start;
     int n = 0;
 
+    ftjobs_free(csound);
     csoundCleanup(csound);
+    ftreclaim(csound, 1);
+    ftcache_free(csound);
 
     /* call registered reset callbacks */
     while (csound->reset_list != NULL) {
@@ -3340,6 +3660,7 @@ static void reset(CSOUND *csound)
     csound->oparms_.odebug = 0;
     /* RWD 9:2000 not terribly vital, but good to do this somewhere... */
     pvsys_release(csound);
+    sndcache_free(csound);
     close_all_files(csound);
     /* delete temporary files created by this Csound instance */
     remove_tmpfiles(csound);
@@ -3383,6 +3704,7 @@ static void reset(CSOUND *csound)
     csound->enableHostImplementedMIDIIO = saved_env->enableHostImplementedMIDIIO;
     memcpy(&(csound->exitjmp), &(saved_env->exitjmp), sizeof(jmp_buf));
     csound->memalloc_db = saved_env->memalloc_db;
+    csound->memarena = saved_env->memarena;
     csound->message_buffer = saved_env->message_buffer; /*VL 19.06.21 keep msg buffer */
     //csound->self = self;
     free(saved_env);
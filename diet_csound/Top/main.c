@@ -528,6 +528,7 @@ PUBLIC int csoundStart(CSOUND *csound) // DEBUG
 #ifdef PARCS
     if (O->numThreads > 1) {
       void csp_barrier_alloc(CSOUND *, void **, int);
+      int csp_barrier_wait(void *);
       int i;
       THREADINFO *current = NULL;
 
@@ -551,7 +552,7 @@ PUBLIC int csoundStart(CSOUND *csound) // DEBUG
         current = t;
       }
 
-      csound->WaitBarrier(csound->barrier2);
+      csp_barrier_wait(csound->barrier2);
     }
 #endif
     csound->engineStatus |= CS_STATE_COMP;
@@ -49,34 +49,51 @@ int csoundScoreEventAbsoluteInternal(CSOUND *csound, char type,
                                      double time_ofs);
 void set_channel_data_ptr(CSOUND *csound, const char *name,
                           void *ptr, int newSize);
+void read_audio_channel(CSOUND *csound, const char *name, MYFLT *samples);
+void write_audio_channel(CSOUND *csound, const char *name,
+                         const MYFLT *samples);
 
 void named_instr_assign_numbers(CSOUND *csound, ENGINE_STATE *engineState);
 
 enum {INPUT_MESSAGE=1, READ_SCORE, SCORE_EVENT, SCORE_EVENT_ABS,
       TABLE_COPY_OUT, TABLE_COPY_IN, TABLE_SET, MERGE_STATE, KILL_INSTANCE};
 
-/* MAX QUEUE SIZE */
+/* MAX QUEUE SIZE (must be a power of two) */
 #define API_MAX_QUEUE 1024
 /* ARG LIST ALIGNMENT */
 #define ARG_ALIGN 8
-
-/* Message queue structure */
+/* bytes of arguments stored in the queue slot itself */
+#define API_MSG_INLINE 256
+/* spins on a full ring before a message goes to the spill list */
+#define API_QUEUE_SPINS 100
+
+/* Message queue structure: a bounded multi-producer, single-consumer
+   ring.  A writer claims a slot by advancing msg_queue_wget, fills it
+   in and publishes it by setting seq to its position + 1; the reader
+   runs published slots in order and hands them back by setting seq to
+   the position of their next turn.  Arguments live in the slot, so an
+   enqueue does not allocate unless they are larger than API_MSG_INLINE
+   (long orchestra or score strings).
+   A message that finds the ring full is never dropped: it goes to a
+   list under msg_spill_lock, tagged with the ring position claimed
+   next, and the reader runs it once it has run the slots before it.
+*/
 typedef struct _message_queue {
-  int64_t message;  /* message id */
-  char *args;   /* args, arg pointers */
-  int64_t rtn;  /* return value */
+  volatile long seq;  /* slot state, see above */
+  int32_t message;    /* message id */
+  int32_t argsiz;
+  int64_t rtn;        /* return value */
+  char *ext;          /* args that did not fit in the slot */
+  char args[API_MSG_INLINE]; /* args, arg pointers */
 } message_queue_t;
 
+typedef struct _message_spill {
+  struct _message_spill *nxt;
+  long after;         /* run when the reader gets to this position */
+  message_queue_t msg;
+} message_spill_t;
 
-/* atomicGetAndIncrementWithModulus */
-static long atomicGet_Incr_Mod(volatile long* val, long mod) {
-  volatile long oldVal, newVal;
-  do {
-    oldVal = *val;
-    newVal = (oldVal + 1) % mod;
-  } while (ATOMIC_CMP_XCH(val, newVal, oldVal));
-  return oldVal;
-}
+#define MSG_ARGS(msg) ((msg)->ext != NULL ? (msg)->ext : (msg)->args)
 
 /* called by csoundCreate() at the start
    and also by csoundStart() to cover de-allocation
@@ -85,172 +102,250 @@ static long atomicGet_Incr_Mod(volatile long* val, long mod) {
 void allocate_message_queue(CSOUND *csound) {
   if (csound->msg_queue == NULL) {
     int i;
-    csound->msg_queue = (message_queue_t **)
-      csound->Calloc(csound, sizeof(message_queue_t*)*API_MAX_QUEUE);
-    for (i = 0; i < API_MAX_QUEUE; i++) {
-      csound->msg_queue[i] =
-        (message_queue_t*)
-        csound->Calloc(csound, sizeof(message_queue_t));
-    }
+    csound->msg_queue = (message_queue_t *)
+      csound->Calloc(csound, sizeof(message_queue_t)*API_MAX_QUEUE);
+    for (i = 0; i < API_MAX_QUEUE; i++)
+      csound->msg_queue[i].seq = i;
+    csound->msg_queue_wget = 0;
+    csound->msg_queue_rstart = 0;
+    csound->msg_spill = csound->msg_spill_tail = NULL;
+    csoundSpinLockInit(&csound->msg_spill_lock);
   }
 }
 
-
-/* enqueue should be called by the relevant API function */
+static void message_fill(CSOUND *csound, message_queue_t *msg,
+                         int32_t message, char *args, int argsiz) {
+  msg->message = message;
+  msg->argsiz = argsiz;
+  msg->rtn = 0;
+  msg->ext = NULL;
+  if (argsiz > API_MSG_INLINE)
+    msg->ext = (char *) csound->Malloc(csound, argsiz);
+  memcpy(MSG_ARGS(msg), args, argsiz);
+}
+
+/* the ring is full: append the message to the spill list */
+static void *message_spill(CSOUND *csound, int32_t message, char *args,
+                           int argsiz) {
+  message_spill_t *s = (message_spill_t *)
+    csound->Malloc(csound, sizeof(message_spill_t));
+  message_fill(csound, &s->msg, message, args, argsiz);
+  s->nxt = NULL;
+  csoundSpinLock(&csound->msg_spill_lock);
+  /* every slot claimed so far comes first */
+  s->after = ATOMIC_GET(csound->msg_queue_wget);
+  if (csound->msg_spill_tail != NULL)
+    ((message_spill_t *) csound->msg_spill_tail)->nxt = s;
+  else
+    csound->msg_spill = s;
+  csound->msg_spill_tail = s;
+  csoundSpinUnLock(&csound->msg_spill_lock);
+  return (void *) &s->msg.rtn;
+}
+
+/* enqueue should be called by the relevant API function;
+   returns NULL only if there is no queue */
 void *message_enqueue(CSOUND *csound, int32_t message, char *args,
                       int argsiz) {
   if(csound->msg_queue != NULL) {
-    int64_t *rtn;
-    volatile long items;
-
-    /* block if queue is full */
-    do {
-      items = ATOMIC_GET(csound->msg_queue_items);
-    } while(items >= API_MAX_QUEUE);
-
-    message_queue_t* msg =
-      csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wget,
-                                           API_MAX_QUEUE)];
-    msg->message = message;
-    if(msg->args != NULL)
-      csound->Free(csound, msg->args);
-    msg->args = (char *)csound->Calloc(csound, argsiz);
-    memcpy(msg->args, args, argsiz);
-    rtn = &msg->rtn;
-    csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wput,
-                                         API_MAX_QUEUE)] = msg;
-    ATOMIC_INCR(csound->msg_queue_items);
-    return (void *) rtn;
+    message_queue_t *msg;
+    long pos = ATOMIC_GET(csound->msg_queue_wget);
+    int  spins = 0;
+
+    for (;;) {
+      long dif;
+      msg = &csound->msg_queue[pos & (API_MAX_QUEUE-1)];
+      dif = (long) ((unsigned long) ATOMIC_GET(msg->seq) -
+                    (unsigned long) pos);
+      if (dif == 0) {                 /* free: try to claim it */
+        long nxt = pos + 1;
+        if (!ATOMIC_CMP_XCH(&csound->msg_queue_wget, nxt, pos))
+          break;
+        pos = ATOMIC_GET(csound->msg_queue_wget);
+      }
+      else if (dif < 0) {             /* full: wait for the reader */
+        if (++spins >= API_QUEUE_SPINS)
+          return message_spill(csound, message, args, argsiz);
+        pos = ATOMIC_GET(csound->msg_queue_wget);
+      }
+      else                            /* another writer got there first */
+        pos = ATOMIC_GET(csound->msg_queue_wget);
+    }
+    message_fill(csound, msg, message, args, argsiz);
+    ATOMIC_SET(msg->seq, pos + 1);    /* publish */
+    return (void *) &msg->rtn;
   }
   else return NULL;
 }
 
+/* number of messages waiting to be run */
+PUBLIC int csoundGetAPIQueueDepth(CSOUND *csound) {
+  message_spill_t *s;
+  int n;
+  if (csound->msg_queue == NULL) return 0;
+  n = (int) (ATOMIC_GET(csound->msg_queue_wget) -
+             ATOMIC_GET(csound->msg_queue_rstart));
+  csoundSpinLock(&csound->msg_spill_lock);
+  for (s = csound->msg_spill; s != NULL; s = s->nxt)
+    n++;
+  csoundSpinUnLock(&csound->msg_spill_lock);
+  return n;
+}
+
+static void message_run(CSOUND *csound, message_queue_t *msg) {
+  char *args = MSG_ARGS(msg);
+  switch(msg->message) {
+  case INPUT_MESSAGE:
+    {
+      const char *str = args;
+      csoundInputMessageInternal(csound, str);
+    }
+
+    break;
+  case READ_SCORE:
+    {
+      const char *str = args;
+      csoundReadScoreInternal(csound, str);
+    }
+    break;
+  case SCORE_EVENT:
+    {
+      char type;
+      const MYFLT *pfields;
+      long numFields;
+      type = args[0];
+      memcpy(&numFields, args + ARG_ALIGN,
+             sizeof(long));
+      pfields = (const MYFLT *) (args + ARG_ALIGN*2);
+
+      csoundScoreEventInternal(csound, type, pfields, numFields);
+    }
+    break;
+  case SCORE_EVENT_ABS:
+    {
+      char type;
+      const MYFLT *pfields;
+      long numFields;
+      double ofs;
+      type = args[0];
+      memcpy(&numFields, args + ARG_ALIGN,
+             sizeof(long));
+      memcpy(&ofs, args + ARG_ALIGN*2,
+             sizeof(double));
+      pfields = (const MYFLT *) (args + ARG_ALIGN*3);
+
+      csoundScoreEventAbsoluteInternal(csound, type, pfields, numFields,
+                                         ofs);
+    }
+    break;
+  case TABLE_COPY_OUT:
+    {
+      int table;
+      MYFLT *ptable;
+      memcpy(&table, args, sizeof(int));
+      memcpy(&ptable, args + ARG_ALIGN,
+             sizeof(MYFLT *));
+      csoundTableCopyOutInternal(csound, table, ptable);
+    }
+    break;
+  case TABLE_COPY_IN:
+    {
+      int table;
+      MYFLT *ptable;
+      memcpy(&table, args, sizeof(int));
+      memcpy(&ptable, args + ARG_ALIGN,
+             sizeof(MYFLT *));
+      csoundTableCopyInInternal(csound, table, ptable);
+    }
+    break;
+  case TABLE_SET:
+    {
+      int table, index;
+      MYFLT value;
+      memcpy(&table, args, sizeof(int));
+      memcpy(&index, args + ARG_ALIGN,
+             sizeof(int));
+      memcpy(&value, args + 2*ARG_ALIGN,
+             sizeof(MYFLT));
+      csoundTableSetInternal(csound, table, index, value);
+    }
+    break;
+  case MERGE_STATE:
+    {
+      ENGINE_STATE *e;
+      TYPE_TABLE *t;
+      OPDS *ids;
+      memcpy(&e, args, sizeof(ENGINE_STATE *));
+      memcpy(&t, args + ARG_ALIGN,
+             sizeof(TYPE_TABLE *));
+      memcpy(&ids, args + 2*ARG_ALIGN,
+             sizeof(OPDS *));
+      named_instr_assign_numbers(csound, e);
+      merge_state(csound, e, t, ids);
+    }
+    break;
+  case KILL_INSTANCE:
+    {
+      MYFLT instr;
+      int mode, insno, rls;
+      INSDS *ip;
+      memcpy(&instr, args, sizeof(MYFLT));
+      memcpy(&insno, args + ARG_ALIGN,
+             sizeof(int));
+      memcpy(&ip, args + ARG_ALIGN*2,
+             sizeof(INSDS *));
+      memcpy(&mode, args + ARG_ALIGN*3,
+             sizeof(int));
+      memcpy(&rls, args  + ARG_ALIGN*4,
+             sizeof(int));
+      killInstance(csound, instr, insno, ip, mode, rls);
+    }
+    break;
+  }
+  msg->message = 0;
+  if (msg->ext != NULL) {
+    csound->Free(csound, msg->ext);
+    msg->ext = NULL;
+  }
+}
+
+/* run the spilled messages that were sent before slot rp was claimed */
+static void message_unspill(CSOUND *csound, long rp) {
+  message_spill_t *s;
+  for (;;) {
+    csoundSpinLock(&csound->msg_spill_lock);
+    s = csound->msg_spill;
+    if (s == NULL || s->after - rp > 0) {
+      csoundSpinUnLock(&csound->msg_spill_lock);
+      return;
+    }
+    if ((csound->msg_spill = s->nxt) == NULL)
+      csound->msg_spill_tail = NULL;
+    csoundSpinUnLock(&csound->msg_spill_lock);
+    message_run(csound, &s->msg);
+    csound->Free(csound, s);
+  }
+}
+
 /* dequeue should be called by kperf_*()
    NB: these calls are already in place
 */
 void message_dequeue(CSOUND *csound) {
   if(csound->msg_queue != NULL) {
     long rp = csound->msg_queue_rstart;
-    long items = csound->msg_queue_items;
-    long rend = rp + items;
-
-    while(rp < rend) {
-      message_queue_t* msg = csound->msg_queue[rp % API_MAX_QUEUE];
-      switch(msg->message) {
-      case INPUT_MESSAGE:
-        {
-          const char *str = msg->args;
-          csoundInputMessageInternal(csound, str);
-        }
-
-        break;
-      case READ_SCORE:
-        {
-          const char *str = msg->args;
-          csoundReadScoreInternal(csound, str);
-        }
-        break;
-      case SCORE_EVENT:
-        {
-          char type;
-          const MYFLT *pfields;
-          long numFields;
-          type = msg->args[0];
-          memcpy(&pfields, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          memcpy(&numFields, msg->args + ARG_ALIGN*2,
-                 sizeof(long));
-
-          csoundScoreEventInternal(csound, type, pfields, numFields);
-        }
-        break;
-      case SCORE_EVENT_ABS:
-        {
-          char type;
-          const MYFLT *pfields;
-          long numFields;
-          double ofs;
-          type = msg->args[0];
-          memcpy(&pfields, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          memcpy(&numFields, msg->args + ARG_ALIGN*2,
-                 sizeof(long));
-          memcpy(&ofs, msg->args + ARG_ALIGN*3,
-                 sizeof(double));
-
-          csoundScoreEventAbsoluteInternal(csound, type, pfields, numFields,
-                                             ofs);
-        }
-        break;
-      case TABLE_COPY_OUT:
-        {
-          int table;
-          MYFLT *ptable;
-          memcpy(&table, msg->args, sizeof(int));
-          memcpy(&ptable, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          csoundTableCopyOutInternal(csound, table, ptable);
-        }
-        break;
-      case TABLE_COPY_IN:
-        {
-          int table;
-          MYFLT *ptable;
-          memcpy(&table, msg->args, sizeof(int));
-          memcpy(&ptable, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          csoundTableCopyInInternal(csound, table, ptable);
-        }
-        break;
-      case TABLE_SET:
-        {
-          int table, index;
-          MYFLT value;
-          memcpy(&table, msg->args, sizeof(int));
-          memcpy(&index, msg->args + ARG_ALIGN,
-                 sizeof(int));
-          memcpy(&value, msg->args + 2*ARG_ALIGN,
-                 sizeof(MYFLT));
-          csoundTableSetInternal(csound, table, index, value);
-        }
-        break;
-      case MERGE_STATE:
-        {
-          ENGINE_STATE *e;
-          TYPE_TABLE *t;
-          OPDS *ids;
-          memcpy(&e, msg->args, sizeof(ENGINE_STATE *));
-          memcpy(&t, msg->args + ARG_ALIGN,
-                 sizeof(TYPE_TABLE *));
-          memcpy(&ids, msg->args + 2*ARG_ALIGN,
-                 sizeof(OPDS *));
-          named_instr_assign_numbers(csound, e);
-          merge_state(csound, e, t, ids);
-        }
-        break;
-      case KILL_INSTANCE:
-        {
-          MYFLT instr;
-          int mode, insno, rls;
-          INSDS *ip;
-          memcpy(&instr, msg->args, sizeof(MYFLT));
-          memcpy(&insno, msg->args + ARG_ALIGN,
-                 sizeof(int));
-          memcpy(&ip, msg->args + ARG_ALIGN*2,
-                 sizeof(INSDS *));
-          memcpy(&mode, msg->args + ARG_ALIGN*3,
-                 sizeof(int));
-          memcpy(&rls, msg->args  + ARG_ALIGN*4,
-                 sizeof(int));
-          killInstance(csound, instr, insno, ip, mode, rls);
-        }
-        break;
-      }
-      msg->message = 0;
+    long rend = rp + API_MAX_QUEUE;   /* one lap at most */
+
+    for (;;) {
+      message_queue_t* msg = &csound->msg_queue[rp & (API_MAX_QUEUE-1)];
+      if (csound->msg_spill != NULL)
+        message_unspill(csound, rp);
+      if (rp == rend || ATOMIC_GET(msg->seq) != rp + 1)
+        break;                        /* nothing (complete) to run */
+      message_run(csound, msg);
+      ATOMIC_SET(msg->seq, rp + API_MAX_QUEUE); /* back to the writers */
       rp += 1;
+      ATOMIC_SET(csound->msg_queue_rstart, rp);
     }
-    ATOMIC_SUB(csound->msg_queue_items, items);
-    csound->msg_queue_rstart = rp % API_MAX_QUEUE;
   }
 }
 
@@ -294,16 +389,23 @@ static inline void csoundTableSet_enqueue(CSOUND *csound, int table, int index,
 }
 
 
+/* the pfields are copied, so the caller may reuse its array at once */
 static inline int64_t *csoundScoreEvent_enqueue(CSOUND *csound, char type,
                                                 const MYFLT *pfields,
                                                 long numFields)
 {
-  const int argsize = ARG_ALIGN*3;
-  char args[ARG_ALIGN*3];
-  args[0] = type;
-  memcpy(args+ARG_ALIGN, &pfields, sizeof(MYFLT *));
-  memcpy(args+2*ARG_ALIGN, &numFields, sizeof(long));
-  return message_enqueue(csound,SCORE_EVENT, args, argsize);
+  const int argsize = ARG_ALIGN*2 + numFields*sizeof(MYFLT);
+  char args[API_MSG_INLINE], *pargs = args;
+  int64_t *rtn;
+  if (argsize > API_MSG_INLINE)
+    pargs = (char *) csound->Malloc(csound, argsize);
+  pargs[0] = type;
+  memcpy(pargs+ARG_ALIGN, &numFields, sizeof(long));
+  memcpy(pargs+2*ARG_ALIGN, pfields, numFields*sizeof(MYFLT));
+  rtn = message_enqueue(csound,SCORE_EVENT, pargs, argsize);
+  if (pargs != args)
+    csound->Free(csound, pargs);
+  return rtn;
 }
 
 
@@ -312,13 +414,19 @@ static inline int64_t *csoundScoreEventAbsolute_enqueue(CSOUND *csound, char typ
                                                         long numFields,
                                                         double time_ofs)
 {
-  const int argsize = ARG_ALIGN*4;
-  char args[ARG_ALIGN*4];
-  args[0] = type;
-  memcpy(args+ARG_ALIGN, &pfields, sizeof(MYFLT *));
-  memcpy(args+2*ARG_ALIGN, &numFields, sizeof(long));
-  memcpy(args+3*ARG_ALIGN, &time_ofs, sizeof(double));
-  return message_enqueue(csound,SCORE_EVENT_ABS, args, argsize);
+  const int argsize = ARG_ALIGN*3 + numFields*sizeof(MYFLT);
+  char args[API_MSG_INLINE], *pargs = args;
+  int64_t *rtn;
+  if (argsize > API_MSG_INLINE)
+    pargs = (char *) csound->Malloc(csound, argsize);
+  pargs[0] = type;
+  memcpy(pargs+ARG_ALIGN, &numFields, sizeof(long));
+  memcpy(pargs+2*ARG_ALIGN, &time_ofs, sizeof(double));
+  memcpy(pargs+3*ARG_ALIGN, pfields, numFields*sizeof(MYFLT));
+  rtn = message_enqueue(csound,SCORE_EVENT_ABS, pargs, argsize);
+  if (pargs != args)
+    csound->Free(csound, pargs);
+  return rtn;
 }
 
 /* this is to be called from
@@ -329,7 +437,7 @@ void killInstance_enqueue(CSOUND *csound, MYFLT instr, int insno,
                           int allow_release) {
   const int argsize = ARG_ALIGN*5;
   char args[ARG_ALIGN*5];
-  memcpy(args, &instr, sizeof(int));
+  memcpy(args, &instr, sizeof(MYFLT));
   memcpy(args+ARG_ALIGN, &insno, sizeof(int));
   memcpy(args+ARG_ALIGN*2, &ip, sizeof(INSDS *));
   memcpy(args+ARG_ALIGN*3, &mode, sizeof(int));
@@ -568,10 +676,7 @@ void csoundGetAudioChannel(CSOUND *csound, const char *name, MYFLT *samples)
   if (csoundGetChannelPtr(csound, &psamples, name,
                           CSOUND_AUDIO_CHANNEL | CSOUND_OUTPUT_CHANNEL)
       == CSOUND_SUCCESS) {
-    spin_lock_t *lock = (spin_lock_t *)csoundGetChannelLock(csound, (char*) name);
-    csoundSpinLock(lock);
-    memcpy(samples, psamples, csoundGetKsmps(csound)*sizeof(MYFLT));
-    csoundSpinUnLock(lock);
+    read_audio_channel(csound, name, samples);
   }
 }
 
@@ -581,10 +686,7 @@ void csoundSetAudioChannel(CSOUND *csound, const char *name, MYFLT *samples)
   if (csoundGetChannelPtr(csound, &psamples, name,
                           CSOUND_AUDIO_CHANNEL | CSOUND_INPUT_CHANNEL)
       == CSOUND_SUCCESS){
-    spin_lock_t *lock = (spin_lock_t *)csoundGetChannelLock(csound, (char*) name);
-    csoundSpinLock(lock);
-    memcpy(psamples, samples, csoundGetKsmps(csound)*sizeof(MYFLT));
-    csoundSpinUnLock(lock);
+    write_audio_channel(csound, name, samples);
   }
 }
 
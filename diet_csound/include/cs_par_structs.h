@@ -67,4 +67,19 @@ typedef struct _watchList {
                      sizeof(struct _watchList *))) / sizeof(uint8_t)];
 } watchList;
 
+/* Per-thread deque of ready tasks for the work-stealing dispatcher.
+ * The owning thread pushes and pops at the bottom, idle threads steal
+ * from the top.  The deques are emptied at the start of every k-cycle
+ * and each task is queued at most once per cycle, so a buffer of
+ * dag_task_max_size entries never wraps.
+ */
+typedef struct _taskDeque {
+  volatile int top;
+  uint8_t padding1 [(CONCURRENTPADDING - sizeof(int)) / sizeof(uint8_t)];
+  volatile int bottom;
+  uint8_t padding2 [(CONCURRENTPADDING - sizeof(int)) / sizeof(uint8_t)];
+  taskID *tasks;
+  uint8_t padding3 [(CONCURRENTPADDING - sizeof(taskID *)) / sizeof(uint8_t)];
+} taskDeque;
+
 #endif
@@ -358,6 +358,13 @@ extern "C" {
 #define CSOUNDINIT_NO_SIGNAL_HANDLER  1
 #define CSOUNDINIT_NO_ATEXIT          2
 
+  /**
+   * Memory allocators for csoundCreateWithAllocator().
+   */
+
+#define CSOUND_ALLOC_SYSTEM           0
+#define CSOUND_ALLOC_ARENA            1
+
   /**
    * Types for keyboard callbacks set in csoundRegisterKeyboardCallback()
    */
@@ -561,6 +568,20 @@ extern "C" {
     float   sampleRate;
   } csRtAudioParams;
 
+  /**
+   * Allocation counters returned by csoundGetMemoryStats()
+   */
+  typedef struct {
+    /** CSOUND_ALLOC_SYSTEM or CSOUND_ALLOC_ARENA */
+    int     allocator;
+    /** number of blocks allocated and freed since creation */
+    int64_t allocs, frees;
+    /** bytes held by live blocks (arena allocator only) */
+    int64_t bytesInUse;
+    /** bytes reserved in arena chunks (arena allocator only) */
+    int64_t bytesReserved;
+  } CSOUND_MEMSTATS;
+
   typedef struct RTCLOCK_S {
     int_least64_t   starttime_real;
     int_least64_t   starttime_CPU;
@@ -699,6 +720,21 @@ extern "C" {
    */
   PUBLIC CSOUND *csoundCreate(void *hostData);
 
+  /**
+   * Like csoundCreate(), but selects the allocator behind csound->Malloc
+   * and friends for the lifetime of the instance: CSOUND_ALLOC_SYSTEM
+   * (malloc, the default) or CSOUND_ALLOC_ARENA (size-classed arenas
+   * with per-thread free lists, released wholesale on reset).  Falls
+   * back to the system allocator where thread-local storage is missing.
+   */
+  PUBLIC CSOUND *csoundCreateWithAllocator(void *hostData, int allocator);
+
+  /**
+   * Fills in *stats with the allocation counters of the instance.
+   * Returns CSOUND_SUCCESS, or CSOUND_ERROR if none are available.
+   */
+  PUBLIC int csoundGetMemoryStats(CSOUND *, CSOUND_MEMSTATS *stats);
+
   /**
    *  Loads all plugins from a given directory
    */
@@ -1259,10 +1295,21 @@ extern "C" {
   /**
    * Returns the address of the Csound audio output working buffer (spout).
    * Enables external software to read audio from Csound after calling
-   * csoundPerformKsmps.
+   * csoundPerformKsmps.  The engine itself works on the planar buffer
+   * (csoundGetSpoutPlanar()) and only fills this interleaved copy on
+   * every cycle once this function has been called.
    */
   PUBLIC MYFLT *csoundGetSpout(CSOUND *csound);
 
+  /**
+   * Returns the address of the Csound audio output working buffer in
+   * planar layout: nchnls consecutive blocks of ksmps samples each.
+   * This is the buffer the orchestra writes to; csoundGetSpout() holds
+   * an interleaved copy of it.  Only ever makes sense after calling
+   * csoundPerformKsmps().
+   */
+  PUBLIC MYFLT *csoundGetSpoutPlanar(CSOUND *csound);
+
   /**
    * Returns the indicated sample from the Csound audio output
    * working buffer (spout); only ever makes sense after calling
@@ -1779,18 +1826,33 @@ extern "C" {
 
   /**
    * copies the audio channel identified by *name into array
-   * *samples which should contain enough memory for ksmps MYFLTs
+   * *samples which should contain enough memory for ksmps MYFLTs;
+   * this is the channel as it was at the end of the last k-cycle
    */
   PUBLIC void csoundGetAudioChannel(CSOUND *csound,
                                     const char *name, MYFLT *samples);
 
   /**
    * sets the audio channel identified by *name with data from array
-   * *samples which should contain at least ksmps MYFLTs
+   * *samples which should contain at least ksmps MYFLTs; the engine
+   * takes it at the start of the next k-cycle
    */
   PUBLIC void csoundSetAudioChannel(CSOUND *csound,
                                     const char *name, MYFLT *samples);
 
+  /**
+   * Copies 'count' existing control or audio channels named in *names
+   * into the buffers in *values (one MYFLT for a control channel, ksmps
+   * for an audio channel).  Neither this nor csoundGetAudioChannel()
+   * and csoundSetAudioChannel() ever makes the engine wait.
+   * Returns CSOUND_SUCCESS if all values were taken from the same
+   * k-cycle, 1 if the engine stayed busy and each channel was copied
+   * on its own, or CSOUND_ERROR if a name is not a control or audio
+   * channel.
+   */
+  PUBLIC int csoundGetChannelSnapshot(CSOUND *csound, const char **names,
+                                      MYFLT **values, int count);
+
   /**
    * copies the string channel identified by *name into *string
    * which should contain enough memory for the string
@@ -1884,6 +1946,14 @@ extern "C" {
    */
   PUBLIC void csoundInputMessageAsync(CSOUND *, const char *message);
 
+  /**
+   * Returns the number of asynchronous API calls (the ...Async()
+   * functions) waiting to be run by the performance thread.  The
+   * queue holds 1024 calls without allocating; calls made while it is
+   * full are kept on an overflow list and run after it, in order.
+   */
+  PUBLIC int csoundGetAPIQueueDepth(CSOUND *);
+
   /**
    * Kills off one or more running instances of an instrument identified
    * by instr (number) or instrName (name). If instrName is NULL, the
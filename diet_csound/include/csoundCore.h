@@ -221,6 +221,7 @@ extern int ISSTRCOD(MYFLT);
 
 enum {FFT_LIB=0, PFFT_LIB, VDSP_LIB};
 enum {FFT_FWD=0, FFT_INV};
+enum {PAR_SCHED_SCAN=0, PAR_SCHED_STEAL};
 
 /* advance declaration for
   API  message queue struct
@@ -270,6 +271,13 @@ typedef struct CORFIL {
     int     echo;
     MYFLT   limiter;
     float   sr_default, kr_default;
+    int     parallelScheduler; /* PAR_SCHED_SCAN or PAR_SCHED_STEAL */
+    int     barrierSpin;    /* spins before a thread parks at a barrier */
+    int     sfWriteQueue;   /* output buffers queued to a writer thread */
+    int     sampleCache;    /* sample cache budget in MB, 0: off */
+    int     ftgenThreads;   /* threads generating ftables, 0: inline */
+    char    *ftCacheDir;    /* directory of the ftable cache, or NULL */
+    int     voiceBatch;     /* run instances of an instr op by op */
   } OPARMS;
 
   typedef struct arglst {
@@ -299,6 +307,9 @@ typedef struct CORFIL {
         int     (*kopadr)(CSOUND *, void *p);
         int     (*aopadr)(CSOUND *, void *p);
         void    *useropinfo;    /* user opcode parameters */
+        /* perf for n instances at once, with --voice-batch (vbatch.h);
+           returns how many are left in p[], dropping those that failed */
+        int     (*bopadr)(CSOUND *, void **p, int n);
     } OENTRY;
 
   /**
@@ -353,6 +364,12 @@ typedef struct CORFIL {
     int     instcnt;                /* Count number of instances ever */
     int     isNew;                  /* is this a new definition */
     int     nocheckpcnt;            /* Control checks on pcnt */
+    void    *slabs;                 /* Slabs the instances are carved from */
+    void    *slab_free;             /* Chain of unused instance blocks */
+    size_t  slab_blksiz;            /* Size of one instance block */
+    int     slab_hint;              /* Blocks per slab (set by prealloc) */
+    int     vbatch;                 /* Voices can run op by op: 1 yes,
+                                       -1 no, 0 not checked yet */
   } INSTRTXT;
 
   typedef struct namedInstr {
@@ -521,8 +538,10 @@ typedef struct CORFIL {
     struct insds * nxtact;
     /* Previous in list of active instruments */
     struct insds * prvact;
-    /* Next instrument to terminate */
-    struct insds * nxtoff;
+    /* Position in the turnoff heap plus one (0: not scheduled) */
+    int      offidx;
+    /* Scheduling order, breaks offtim ties in the turnoff heap */
+    uint32   offseq;
     /* Chain of files used by opcodes in this instr */
     FDCH    *fdchp;
     /* Extra memory used by opcodes in this instr */
@@ -580,6 +599,8 @@ typedef struct CORFIL {
     MYFLT    retval;
     MYFLT   *lclbas;  /* base for variable memory pool */
     char    *strarg;       /* string argument */
+    /* ftable epoch when initialised (see ftreclaim()) */
+    int64_t  ftepoch;
     /* Copy of required p-field values for quick access */
     CS_VAR_MEM  p0;
     CS_VAR_MEM  p1;
@@ -833,6 +854,7 @@ typedef struct CORFIL {
   typedef struct eventnode {
     struct eventnode  *nxt;
     uint32     start_kcnt;
+    uint32     seqno;           /* insertion order, breaks start_kcnt ties */
     EVTBLK            evt;
   } EVTNODE;
 
@@ -1410,11 +1432,24 @@ typedef struct _message_queue_t_ {
     MYFLT* (*CepsLP)(CSOUND *, MYFLT *, MYFLT *, int, int);
     MYFLT (*LPrms)(CSOUND *, void *);
     void *(*CreateThread2)(uintptr_t (*threadRoutine)(void *), unsigned int, void *userdata);
+    /** Hand the k-loop of csoundPerform() to an audio module that runs
+        it from its own thread: csoundPerform() calls driver() instead,
+        which returns when the performance has ended or it stops driving
+        (it is then called again, unless it has been set to NULL).
+        The module runs each k-cycle with PerformKsmpsDriven(), which
+        returns non-zero once the performance has ended, or
+        CSOUND_ERROR if csoundPerform() is not waiting in driver(). */
+    int (*SetPerformDriver)(CSOUND *, int (*driver)(CSOUND *, void *),
+                            void *userData);
+    int (*PerformKsmpsDriven)(CSOUND *);
+    /** Set how far ahead the IO thread keeps a file opened with
+        FileOpenAsync(), in samples (see csoundPrefetchAsync()). */
+    void (*PrefetchAsync)(CSOUND *, void *, int);
     /**@}*/
     /** @name Placeholders
         To allow the API to grow while maintining backward binary compatibility. */
     /**@{ */
-    SUBR dummyfn_2[22];
+    SUBR dummyfn_2[19];
     /**@}*/
 #ifdef __BUILDING_LIBCSOUND
     /* ------- private data (not to be used by hosts or externals) ------- */
@@ -1490,6 +1525,8 @@ typedef struct _message_queue_t_ {
     uint32_t      nchnls;
     int           inchnls;
     int           spoutactive;
+    /** a host has asked for spout, so it is interleaved every cycle */
+    int           spouthost;
     uint64_t      kcounter, global_kcounter;
     MYFLT         esr;
     MYFLT         ekr;
@@ -1523,7 +1560,10 @@ typedef struct _message_queue_t_ {
     FILE*         scorein;
     FILE*         scoreout;
     int           *argoffspace;
-    INSDS         *frstoff;
+    INSDS         *frstoff;                 /* earliest note in offheap */
+    INSDS         **offheap;                /* turnoff heap on offtim */
+    int           offcnt, offmax;
+    uint32        offseq;
     /** reserved for std opcode library  */
     void          *stdOp_Env;
     int           holdrand;
@@ -1562,7 +1602,10 @@ typedef struct _message_queue_t_ {
     int32         rngcnt[MAXCHNLS];
     int16         rngflg, multichan;
     void          *evtFuncChain;
-    EVTNODE       *OrcTrigEvts;             /* List of events to be started */
+    EVTNODE       *OrcTrigEvts;             /* Next event to be started */
+    EVTNODE       **OrcTrigHeap;            /* Heap of events to be started */
+    int           OrcTrigCnt, OrcTrigMax;
+    uint32        OrcTrigSeq;
     EVTNODE       *freeEvtNodes;
     int           csoundIsScorePending_;
     int64_t       advanceCnt;
@@ -1575,6 +1618,10 @@ typedef struct _message_queue_t_ {
     int           maxfnum;
     GEN           *gensub;
     int           genmax;
+    void          *ftjobs;              /* fgens.c: background GEN queue */
+    void          *ftcache;             /* fgens.c: mapped cache tables */
+    void          *ftretired;           /* fgens.c: replaced ftables */
+    int64_t       ftepoch;              /* count of retired ftables */
     CS_HASH_TABLE *namedGlobals;
     CS_HASH_TABLE *cfgVariableDB;
     double        prvbt, curbt, nxtbt;
@@ -1582,6 +1629,7 @@ typedef struct _message_queue_t_ {
     int64_t       cyclesRemaining;
     EVTBLK        evt;
     void          *memalloc_db;
+    void          *memarena;            /* allocator state and counters */
     MGLOBAL       *midiGlobals;
     CS_HASH_TABLE *envVarDB;
     MEMFIL        *memfiles;
@@ -1598,6 +1646,7 @@ typedef struct _message_queue_t_ {
     void          *file_io_thread;
     int           file_io_start;
     void          *file_io_threadlock;
+    void          *file_io_wake;
     int           realtime_audio_flag;
     void          *event_insert_thread;
     int           event_insert_loop;
@@ -1687,6 +1736,7 @@ typedef struct _message_queue_t_ {
       uint32        nframes               /* = 1UL */;
       FILE          *pin, *pout;
       int           dither;
+      void          *sfwriter;            /* background writer, or NULL   */
     } libsndStatics;
 
     int           warped;               /* rdscor.c */
@@ -1707,8 +1757,10 @@ typedef struct _message_queue_t_ {
     NAMES         *omacros, *smacros;
     void          *namedgen;            /* fgens.c */
     void          *open_files;          /* fileopen.c */
+    spin_lock_t   open_files_lock;
     void          *searchPathCache;
     CS_HASH_TABLE *sndmemfiles;
+    void          *sndcache;            /* memfiles.c */
     void          *reset_list;
     void          *pvFileTable;         /* pvfileio.c */
     int           pvNumFiles;
@@ -1747,10 +1799,18 @@ typedef struct _message_queue_t_ {
     int           currentLPCSlot;
     int           max_lpc_slot;
     CS_HASH_TABLE *chn_db;
+    void          *chn_numtab;          /* bus.c: numbered channels */
+    volatile long chn_bus_seq;          /* odd during the perf pass */
+    void * volatile chn_audio;          /* bus.c: audio channels */
     int           opcodedirWasOK;
     int           disable_csd_options;
     CsoundRandMTState randState_;
     int           performState;
+    int           (*perfDriver)(CSOUND *, void *); /* see SetPerformDriver */
+    void          *perfDriverData;
+    volatile long perfDriven;   /* 1: csoundPerform() waits in perfDriver,
+                                   2: and a driven k-cycle is running */
+    int           perfDrivenEnd, perfDrivenResult;
     int           ugens4_rand_16;
     int           ugens4_rand_15;
     void          *schedule_kicked;
@@ -1783,8 +1843,18 @@ typedef struct _message_queue_t_ {
     volatile stateWithPadding    *dag_task_status;
     watchList     * volatile *dag_task_watch;
     watchList     *dag_wlmm;
-    char          **dag_task_dep;
+    int           *dag_task_ins;   /* insno of each task */
+    int           *dag_run_first;  /* first task of each run of one insno */
+    int           dag_num_runs;
     int           dag_task_max_size;
+    taskDeque     *dag_deques;     /* one per thread, work-stealing mode */
+    int           dag_num_deques;
+    volatile int  dag_tasks_left;  /* tasks not yet DONE this k-cycle */
+    int           dag_serial;      /* DAG is a chain, run on main thread */
+    uint32_t      **dag_ins_conflict; /* per instrument: clashing insnos */
+    uint32_t      **dag_ins_known;    /* per instrument: bits worked out */
+    INSTRTXT      **dag_ins_txt;      /* templates the bits belong to */
+    int           dag_ins_max;
     uint32_t      tempStatus;    /* keeps track of which files are temps */
     int           orcLineOffset; /* 1 less than 1st orch line in the CSD */
     int           scoLineOffset; /* 1 less than 1st score line in the CSD */
@@ -1814,11 +1884,12 @@ typedef struct _message_queue_t_ {
     CS_HASH_TABLE* symbtab;
     int           print_version;
     int           inZero;       /* flag compilation of instr0 */
-    struct _message_queue **msg_queue;
-    volatile long msg_queue_wget; /* Writer - Get index */
-    volatile long msg_queue_wput; /* Writer - Put Index */
-    volatile long msg_queue_rstart; /* Reader - start index */
-    volatile long msg_queue_items;
+    struct _message_queue *msg_queue;
+    volatile long msg_queue_wget; /* Writers - next slot to claim */
+    volatile long msg_queue_rstart; /* Reader - next slot to run */
+    void * volatile msg_spill;  /* Messages the full queue overflowed to */
+    void     *msg_spill_tail;
+    spin_lock_t msg_spill_lock;
     int      aftouch;
     void     *directory;
     ALLOC_DATA *alloc_queue;
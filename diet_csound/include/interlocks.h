@@ -50,6 +50,9 @@
 #define IW (0x0400)
 #define IB (0x0600)
 
+// No state shared between instances: can run voices op by op
+#define VB (0x0800)
+
 //Deprecated
 #define _QQ (0x8000)
 
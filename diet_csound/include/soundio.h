@@ -147,6 +147,9 @@ typedef struct {
         int64_t audrem, framesrem, getframes;   /* samples, frames, frames */
         MYFLT   fscalefac;
         MYFLT   skiptime;
+        int     usecache;           /* read through the sample cache ?      */
+        void    *sc;                /* sample cache entry, or NULL          */
+        int64_t cachepos;           /* next frame to read from the cache    */
         char    sfname[MAXSNDNAME];
         MYFLT   inbuf[SNDINBUFSIZ];
 } SOUNDIN;
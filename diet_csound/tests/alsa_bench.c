@@ -0,0 +1,240 @@
+/*
+    alsa_bench.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* A loopback through InOut/rtalsa.c on an ALSA device that does not
+   wait for a clock ('null' by default): each period is read with
+   rtrecord_() and written back with rtplay_(), for 16-bit, 32-bit and
+   float samples, and the process CPU time per period is printed.  Then
+   the dithered 16-bit converter is timed against the per sample one it
+   replaced, and fails unless the two give the same samples.
+
+       alsa_bench [device [period [channels [periods]]]]             */
+
+#include "rtalsa.c"
+#include "test_util.h"
+
+static CSOUND   cs;
+static void     *playdata, *recdata;
+
+static void **play_userdata(CSOUND *csound)
+{
+    (void) csound;
+    return &playdata;
+}
+
+static void **rec_userdata(CSOUND *csound)
+{
+    (void) csound;
+    return &recdata;
+}
+
+static void message(CSOUND *csound, const char *fmt, ...)
+{
+    va_list args;
+
+    (void) csound;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+static void message_s(CSOUND *csound, int attr, const char *fmt, ...)
+{
+    va_list args;
+
+    (void) csound;
+    (void) attr;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+static int zero(CSOUND *csound)
+{
+    (void) csound;
+    return 0;
+}
+
+static int dither_mode(CSOUND *csound)
+{
+    (void) csound;
+    return 1;                           /* triangular */
+}
+
+static void *no_global(CSOUND *csound, const char *name)
+{
+    (void) csound;
+    (void) name;
+    return NULL;
+}
+
+static int no_create(CSOUND *csound, const char *name, size_t nbytes)
+{
+    (void) csound;
+    (void) name;
+    (void) nbytes;
+    return -1;
+}
+
+static MYFLT system_sr(CSOUND *csound, MYFLT sr)
+{
+    (void) csound;
+    return sr;
+}
+
+/* MYFLT_to_short() as it was, with the noise made sample by sample */
+
+static void old_short(int nSmps, MYFLT *inBuf, int16_t *outBuf, int *seed)
+{
+    MYFLT tmp_f;
+    int   tmp_i;
+    int n;
+    for (n=0; n<nSmps; n++) {
+      int rnd = (((*seed) * 15625) + 1) & 0xFFFF;
+      *seed = (((rnd) * 15625) + 1) & 0xFFFF;
+      rnd += *seed;           /* triangular distribution */
+      tmp_f = (MYFLT) ((rnd>>1) - 0x8000) * (FL(1.0) / (MYFLT) 0x10000);
+      tmp_f += inBuf[n] * (MYFLT) 0x8000;
+#ifndef USE_DOUBLE
+      tmp_i = (int) lrintf(tmp_f);
+#else
+      tmp_i = (int) lrint(tmp_f);
+#endif
+      if (tmp_i < -0x8000) tmp_i = -0x8000;
+      if (tmp_i > 0x7FFF) tmp_i = 0x7FFF;
+      outBuf[n] = (int16_t) tmp_i;
+    }
+}
+
+static double cpu_now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* CPU microseconds per period of the loopback, or -1 if the device
+   cannot be opened with 'format' */
+
+static double loopback(char *device, int format, int period, int nchns,
+                       long periods, MYFLT *buf, int *mmap)
+{
+    csRtAudioParams parm;
+    double  t0;
+    int     nbytes = period * nchns * (int) sizeof(MYFLT);
+    long    k;
+
+    memset(&parm, 0, sizeof(csRtAudioParams));
+    parm.devName = device;
+    parm.devNum = 1024;
+    parm.bufSamp_SW = period;
+    parm.bufSamp_HW = period * 4;
+    parm.nChannels = nchns;
+    parm.sampleFormat = format;
+    parm.sampleRate = 44100.0f;
+    if (recopen_(&cs, &parm) != 0 || playopen_(&cs, &parm) != 0) {
+      rtclose_(&cs);
+      return -1.0;
+    }
+    *mmap = ((DEVPARAMS*) playdata)->mmap;
+    t0 = cpu_now();
+    for (k = 0; k < periods; k++) {
+      rtrecord_(&cs, buf, nbytes);
+      rtplay_(&cs, buf, nbytes);
+    }
+    t0 = cpu_now() - t0;
+    rtclose_(&cs);
+    return t0 / periods * 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct { int format; const char *name; } fmt[] = {
+      { AE_SHORT, "16-bit" }, { AE_LONG, "32-bit" }, { AE_FLOAT, "float" }
+    };
+    char    *device = (argc > 1 ? argv[1] : "null");
+    int     period = (argc > 2 ? atoi(argv[2]) : 256);
+    int     nchns = (argc > 3 ? atoi(argv[3]) : 2);
+    long    periods = (argc > 4 ? atol(argv[4]) : 20000L);
+    long    i, n, bad = 0;
+    MYFLT   *buf;
+    int16_t *out[2];
+    double  t0, t[2], us;
+    int     j, mmap, seed[2];
+
+    if (period < 16 || nchns < 1 || periods < 1) {
+      fprintf(stderr,
+              "usage: alsa_bench [device [period [channels [periods]]]]\n");
+      return 1;
+    }
+    test_libc_memory(&cs);
+    cs.GetRtPlayUserData = play_userdata;
+    cs.GetRtRecordUserData = rec_userdata;
+    cs.Message = message;
+    cs.MessageS = message_s;
+    cs.Warning = message;
+    cs.ErrorMsg = message;
+    cs.GetMessageLevel = zero;
+    cs.GetDebug = zero;
+    cs.GetDitherMode = dither_mode;
+    cs.QueryGlobalVariable = no_global;
+    cs.CreateGlobalVariable = no_create;
+    cs.system_sr = system_sr;
+    n = (long) period * nchns;
+    buf = (MYFLT*) calloc(n, sizeof(MYFLT));
+    printf("'%s', %d frames of %d channels a period; CPU us/period\n",
+           device, period, nchns);
+    for (j = 0; j < (int) (sizeof(fmt) / sizeof(fmt[0])); j++) {
+      us = loopback(device, fmt[j].format, period, nchns, periods, buf, &mmap);
+      if (us < 0.0)
+        printf("%-7s cannot be opened\n", fmt[j].name);
+      else
+        printf("%-7s %9.3f%s\n", fmt[j].name, us, (mmap ? " (mmap)" : ""));
+    }
+    /* the converter alone, on a full scale sweep that clips at the ends */
+    for (i = 0; i < n; i++)
+      buf[i] = FL(-1.25) + FL(2.5) * i / n;
+    out[0] = (int16_t*) malloc(n * sizeof(int16_t));
+    out[1] = (int16_t*) malloc(n * sizeof(int16_t));
+    seed[0] = seed[1] = 1;
+    t0 = now();
+    for (i = 0; i < periods; i++)
+      old_short((int) n, buf, out[0], &seed[0]);
+    t[0] = now() - t0;
+    t0 = now();
+    for (i = 0; i < periods; i++)
+      MYFLT_to_short((int) n, buf, out[1], &seed[1]);
+    t[1] = now() - t0;
+    for (i = 0; i < n; i++)
+      if (out[0][i] != out[1][i])
+        bad++;
+    bad += (seed[0] != seed[1]);
+    printf("dithered 16-bit, ns/sample: before %.3f, now %.3f\n"
+           "%ld samples differ\n", t[0] / (periods * n) * 1e9,
+           t[1] / (periods * n) * 1e9, bad);
+    free(buf);
+    free(out[0]);
+    free(out[1]);
+    return (bad != 0);
+}
@@ -0,0 +1,109 @@
+/*
+    aops_math_bench.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Time per sample of the audio rate sin, cos, exp, log, tanh, ampdb,
+   ampdbfs and powoftwo, scalar (aops.c) and in each vector set of
+   OOps/aops_simd.c this CPU has, on blocks of ksmps samples.
+
+       aops_math_bench [ksmps [blocks]]                              */
+
+#include "aops_simd.c"
+#include "test_util.h"
+
+#define NFUNC   8
+
+#if defined(AOPS_X86) || defined(AOPS_NEON)
+
+int main(int argc, char **argv)
+{
+    static const char *fname[NFUNC] = {
+      "sin", "cos", "exp", "log", "tanh", "ampdb", "ampdbfs", "powoftwo"
+    };
+    static CSOUND cs;
+    const SUBR  *sets[4];
+    const char  *names[4];
+    INSDS       ip;
+    EVAL        p;
+    MYFLT       *a, *r;
+    double      t0, ns[4];
+    int         ksmps = (argc > 1 ? atoi(argv[1]) : 64);
+    long        blocks = (argc > 2 ? atol(argv[2]) : 200000L), k;
+    int         nsets = 0, s, f, i;
+
+    if (ksmps < 1 || blocks < 1) {
+      fprintf(stderr, "usage: aops_math_bench [ksmps [blocks]]\n");
+      return 1;
+    }
+    sets[nsets] = aops_generic, names[nsets++] = "scalar";
+#ifdef AOPS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+      sets[nsets] = aops_sse2, names[nsets++] = "SSE2";
+    if (__builtin_cpu_supports("avx2"))
+      sets[nsets] = aops_avx2, names[nsets++] = "AVX2";
+    if (__builtin_cpu_supports("avx512f"))
+      sets[nsets] = aops_avx512, names[nsets++] = "AVX-512";
+#else
+    sets[nsets] = aops_neon, names[nsets++] = "NEON";
+#endif
+    a = (MYFLT*) malloc(ksmps * sizeof(MYFLT));
+    r = (MYFLT*) malloc(ksmps * sizeof(MYFLT));
+    for (i = 0; i < ksmps; i++)     /* in range for every function */
+      a[i] = (MYFLT) (0.1 + (i % 64) * 0.07);
+    cs.e0dbfs = FL(1.0);
+    memset(&ip, 0, sizeof(INSDS));
+    ip.ksmps = ksmps;
+    memset(&p, 0, sizeof(EVAL));
+    p.h.insdshead = &ip;
+    p.a = a;
+    p.r = r;
+    printf("ns/sample, ksmps %d\n%-9s", ksmps, "");
+    for (s = 0; s < nsets; s++)
+      printf(" %8s", names[s]);
+    printf("\n");
+    for (f = 0; f < NFUNC; f++) {
+      for (s = 0; s < nsets; s++) {
+        t0 = now();
+        for (k = 0; k < blocks; k++)
+          sets[s][16 + f](&cs, &p);
+        ns[s] = (now() - t0) / ((double) blocks * ksmps) * 1e9;
+      }
+      printf("%-9s", fname[f]);
+      for (s = 0; s < nsets; s++)
+        printf(" %8.2f", ns[s]);
+      printf("\n");
+    }
+    free(a);
+    free(r);
+    return 0;
+}
+
+#else
+
+int main(void)
+{
+    printf("no vector sets on this platform\n");
+    return 0;
+}
+
+#endif
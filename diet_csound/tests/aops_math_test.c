@@ -0,0 +1,213 @@
+/*
+    aops_math_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Measures the error of the audio rate sin, cos, exp, log, tanh, ampdb,
+   ampdbfs and powoftwo of OOps/aops_simd.c against the C library in
+   the next wider type, in units in the last place, over random inputs
+   and the special values.  Fails if a vector set is outside the bounds
+   given at the top of aops_simd.c, gets a special value wrong or
+   writes into the zeroed ends of a block. */
+
+#include "aops_simd.c"
+
+#define NSMP    80
+#define NFUNC   8                       /* from sina, the 17th function */
+
+#if defined(AOPS_X86) || defined(AOPS_NEON)
+
+#ifdef USE_DOUBLE
+typedef long double REF;
+#  define REFF(f)       f##l
+#  define MANT          53
+#  define MINEXP        (-1074)
+static const double bound[NFUNC] = { 2, 2, 1, 1, 2, 1, 1, 1 };
+#else
+typedef double REF;
+#  define REFF(f)       f
+#  define MANT          24
+#  define MINEXP        (-149)
+static const double bound[NFUNC] = { 2.5, 2.5, 1.5, 1.5, 2.5, 1.5, 1.5, 1.5 };
+#endif
+
+static const char *fname[NFUNC] = {
+    "sin", "cos", "exp", "log", "tanh", "ampdb", "ampdbfs", "powoftwo"
+};
+
+/* the size of one unit in the last place of a MYFLT near r */
+
+static double ulp(REF r)
+{
+    int e;
+
+    if (r == 0)
+      return ldexp(1.0, MINEXP);
+    frexp((double) r, &e);
+    return ldexp(1.0, (e - MANT) < MINEXP ? MINEXP : e - MANT);
+}
+
+static MYFLT input(int f)
+{
+    double u = rand() / (double) RAND_MAX - 0.5;
+    double v = rand() / (double) RAND_MAX;
+
+    switch (f) {
+    case 0: case 1:             /* up to where the library takes over */
+      return (MYFLT) (u * (v < 0.05 ? 3e9 : v < 0.1 ? 2e4 :
+                           v < 0.5 ? 100 : 8));
+    case 2: case 5: case 6:     /* into overflow and denormals */
+      return (MYFLT) (u * (v < 0.1 ? 1800 : 60));
+    case 3:
+      return (MYFLT) (v < 0.05 ? (u + 0.5) * 1e-300 :
+                      v < 0.1 ? (u + 0.5) * 1e300 :
+                      v < 0.5 ? exp(u * 100) : (u + 0.5) * 4);
+    case 4:
+      return (MYFLT) (u * (v < 0.3 ? 60 : 3));
+    default:
+      return (MYFLT) (u * (v < 0.1 ? 2200 : 40));
+    }
+}
+
+static REF reference(int f, MYFLT x)
+{
+    switch (f) {
+    case 0: return REFF(sin)((REF) x);
+    case 1: return REFF(cos)((REF) x);
+    case 2: return REFF(exp)((REF) x);
+    case 3: return REFF(log)((REF) x);
+    case 4: return REFF(tanh)((REF) x);
+    case 5: case 6:             /* the product rounds as in aops.c */
+      return REFF(exp)((REF) (MYFLT) (x * (MYFLT) LOG10D20));
+    default: return REFF(exp2)((REF) x);
+    }
+}
+
+static const MYFLT special[] = {
+    (MYFLT) NAN, (MYFLT) INFINITY, -(MYFLT) INFINITY, FL(0.0), -FL(0.0),
+    (MYFLT) 1e-310, (MYFLT) 1e-41, -FL(1.0), (MYFLT) 1e10, (MYFLT) 709.7,
+    -FL(745.0), FL(1024.0), -FL(1074.5), (MYFLT) 88.7, (MYFLT) -103.5,
+    (MYFLT) 127.9, (MYFLT) -149.5, FL(0.625), -FL(0.625), FL(8192.5),
+    FL(1.0), FL(2.0), FL(3.0), (MYFLT) 1e-20
+};
+
+int main(void)
+{
+    static CSOUND cs;
+    const SUBR  *sets[3];
+    const char  *names[3];
+    INSDS       ip;
+    EVAL        p;
+    MYFLT       a[NSMP], r[NSMP];
+    double      e, worst[3][NFUNC];
+    REF         want;
+    int         nsets = 0, s, f, k, bad = 0;
+    uint32_t    i, nspecial = sizeof(special) / sizeof(MYFLT);
+
+#ifdef AOPS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+      sets[nsets] = aops_sse2, names[nsets++] = "SSE2";
+    if (__builtin_cpu_supports("avx2"))
+      sets[nsets] = aops_avx2, names[nsets++] = "AVX2";
+    if (__builtin_cpu_supports("avx512f"))
+      sets[nsets] = aops_avx512, names[nsets++] = "AVX-512";
+#else
+    sets[nsets] = aops_neon, names[nsets++] = "NEON";
+#endif
+    cs.e0dbfs = FL(1.0);
+    srand(11);
+    for (s = 0; s < nsets; s++)
+      for (f = 0; f < NFUNC; f++) {
+        worst[s][f] = 0.0;
+        for (k = 0; k < 60000; k++) {
+          memset(&ip, 0, sizeof(INSDS));
+          if (k == 0) {
+            ip.ksmps = nspecial;
+            memcpy(a, special, sizeof(special));
+          }
+          else {
+            ip.ksmps = 1 + rand() % (NSMP - 10);
+            if (rand() % 4 == 0)
+              ip.ksmps_offset = rand() % ip.ksmps;
+            if (rand() % 4 == 0)
+              ip.ksmps_no_end = rand() % (ip.ksmps - ip.ksmps_offset);
+            for (i = 0; i < NSMP; i++)
+              a[i] = input(f);
+          }
+          for (i = 0; i < NSMP; i++)
+            r[i] = FL(7.0);
+          memset(&p, 0, sizeof(EVAL));
+          p.h.insdshead = &ip;
+          p.a = a;
+          p.r = r;
+          sets[s][16 + f](&cs, &p);
+          for (i = 0; i < ip.ksmps; i++) {
+            if (i < ip.ksmps_offset || i >= ip.ksmps - ip.ksmps_no_end) {
+              if (r[i] != FL(0.0))
+                bad++;
+              continue;
+            }
+            want = reference(f, a[i]);
+            if (isnan((double) want) || isinf((double) (MYFLT) want) ||
+                isnan(r[i]) || isinf(r[i])) {
+              if (!(isnan((double) want) ? isnan(r[i])
+                                          : r[i] == (MYFLT) want)) {
+                if (bad < 20)
+                  printf("%s %s(%g) is %g, not %g\n", names[s], fname[f],
+                         (double) a[i], (double) r[i], (double) want);
+                bad++;
+              }
+              continue;
+            }
+            e = fabs((double) (((REF) r[i] - want) / ulp(want)));
+            if (e > worst[s][f])
+              worst[s][f] = e;
+          }
+        }
+        if (worst[s][f] > bound[f]) {
+          printf("%s %s is %.3f ulp out, over %g\n",
+                 names[s], fname[f], worst[s][f], bound[f]);
+          bad++;
+        }
+      }
+    printf("%-9s", "ulp");
+    for (s = 0; s < nsets; s++)
+      printf(" %8s", names[s]);
+    printf("\n");
+    for (f = 0; f < NFUNC; f++) {
+      printf("%-9s", fname[f]);
+      for (s = 0; s < nsets; s++)
+        printf(" %8.3f", worst[s][f]);
+      printf("\n");
+    }
+    return (bad != 0);
+}
+
+#else
+
+int main(void)
+{
+    printf("no vector sets on this platform\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*
+    aops_simd_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Runs every set of OOps/aops_simd.c this CPU has on the same random
+   blocks, with random ksmps, offsets and early ends, and checks that
+   each gives the same bits as the scalar aops.c for the arithmetic,
+   and as the first vector set for the math functions, down to the
+   NaNs, the zeroed ends and whether divz warned. */
+
+#include "aops_simd.c"
+
+#define NSMP    80
+
+#if defined(AOPS_X86) || defined(AOPS_NEON)
+
+typedef union {
+    AOP     aop;
+    DIVZ    dz;
+    EVAL    ev;
+} AOPS_ARGS;
+
+static int nwarn;
+
+static void warning(CSOUND *csound, const char *fmt, ...)
+{
+    IGN(csound); IGN(fmt);
+    nwarn++;
+}
+
+static MYFLT rnd(size_t k)
+{
+    int   c = rand() % 24;
+    MYFLT u = (MYFLT) (rand() / (double) RAND_MAX - 0.5);
+
+    switch (c) {
+    case 0: return FL(0.0);
+    case 1: return -FL(0.0);
+    case 2: return (MYFLT) NAN;
+    case 3: return (MYFLT) INFINITY;
+    case 4: return -(MYFLT) INFINITY;
+    case 5: return u * (MYFLT) 1e-300;      /* denormal, or 0 in float */
+    case 6: return u * (MYFLT) 3e9;         /* beyond the sin reduction */
+    case 7: return u * FL(2000.0);          /* exp over and underflow */
+    }
+    return u * (k < 16 ? FL(1000.0) : FL(60.0));
+}
+
+static void setargs(AOPS_ARGS *p, size_t k, INSDS *ip, MYFLT *a, MYFLT *b,
+                    MYFLT *def, MYFLT *r)
+{
+    memset(p, 0, sizeof(AOPS_ARGS));
+    if (k >= 12 && k <= 14) {               /* divz */
+      p->dz.h.insdshead = ip;
+      p->dz.r = r; p->dz.a = a; p->dz.b = b; p->dz.def = def;
+    }
+    else if (k >= 15) {                     /* abs and the math functions */
+      p->ev.h.insdshead = ip;
+      p->ev.r = r; p->ev.a = a;
+    }
+    else {
+      p->aop.h.insdshead = ip;
+      p->aop.r = r; p->aop.a = a; p->aop.b = b;
+    }
+}
+
+int main(void)
+{
+    static CSOUND cs;
+    const SUBR  *sets[3];
+    const char  *names[3];
+    INSDS       ip;
+    AOPS_ARGS   p;
+    MYFLT       a[NSMP], b[NSMP], def, r0[NSMP], r1[NSMP];
+    const SUBR  *ref;
+    int         nsets = 0, s, t, i, w0, w1, bad = 0;
+    size_t      k;
+
+#ifdef AOPS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+      sets[nsets] = aops_sse2, names[nsets++] = "SSE2";
+    if (__builtin_cpu_supports("avx2"))
+      sets[nsets] = aops_avx2, names[nsets++] = "AVX2";
+    if (__builtin_cpu_supports("avx512f"))
+      sets[nsets] = aops_avx512, names[nsets++] = "AVX-512";
+#else
+    sets[nsets] = aops_neon, names[nsets++] = "NEON";
+#endif
+    cs.Warning = warning;
+    cs.e0dbfs = FL(1.0);
+    srand(3);
+    for (s = 0; s < nsets; s++)
+      for (k = 0; k < AOPS_NFUNCS; k++) {
+        /* the math functions are not the library's, only each other's */
+        ref = (k < 16 ? aops_generic : sets[0]);
+        if (ref == sets[s])
+          continue;
+        for (t = 0; t < 3000; t++) {
+          memset(&ip, 0, sizeof(INSDS));
+          ip.ksmps = 1 + rand() % (NSMP - 10);
+          if (rand() % 4 == 0)
+            ip.ksmps_offset = rand() % ip.ksmps;
+          if (rand() % 4 == 0)
+            ip.ksmps_no_end = rand() % (ip.ksmps - ip.ksmps_offset);
+          for (i = 0; i < NSMP; i++) {
+            a[i] = rnd(k); b[i] = rnd(k);
+            r0[i] = r1[i] = FL(7.0);
+          }
+          def = rnd(k);
+          setargs(&p, k, &ip, a, b, &def, r0);
+          nwarn = 0;
+          ref[k](&cs, &p);
+          w0 = nwarn;
+          setargs(&p, k, &ip, a, b, &def, r1);
+          nwarn = 0;
+          sets[s][k](&cs, &p);
+          w1 = nwarn;
+          if (memcmp(r0, r1, sizeof(r0)) || (w0 != 0) != (w1 != 0)) {
+            if (bad < 10)
+              printf("%s: function %d differs, ksmps %u offset %u "
+                     "early %u\n", names[s], (int) k, ip.ksmps,
+                     ip.ksmps_offset, ip.ksmps_no_end);
+            bad++;
+          }
+        }
+      }
+    for (s = 0; s < nsets; s++)
+      printf("%s ", names[s]);
+    printf(": %d blocks differ\n", bad);
+    return (bad != 0);
+}
+
+#else
+
+int main(void)
+{
+    printf("no vector sets on this platform\n");
+    return 0;
+}
+
+#endif
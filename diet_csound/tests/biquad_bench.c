@@ -0,0 +1,121 @@
+/*
+    biquad_bench.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Runs 256 biquads (each a lowpass at its own frequency, swept every
+   100 cycles) three ways: biquad() as it was before the filter core
+   (biquad_old.c), biquad() once per voice, and biquad_batch() on all
+   the voices, as --voice-batch does, and prints the cost of a sample in
+   each.  biquad_test checks that the three agree.
+
+       biquad_bench [voices [k-cycles]]                             */
+
+#include "biquad.c"
+#include "test_util.h"
+
+extern void biquad_old(const MYFLT *, double *, const MYFLT *, MYFLT *,
+                       uint32_t, uint32_t);
+
+typedef struct {
+    MYFLT   in[KS], out[3][KS];
+    MYFLT   coef[7];                /* b0, b1, b2, a0, a1, a2, reinit */
+    double  z[4];                   /* of biquad_old() */
+} VOICE;
+
+/* RBJ lowpass, left unnormalised */
+
+static void lowpass(VOICE *v, double hz)
+{
+    double w = TWOPI * hz / 44100.0, alpha = sin(w) / 1.8, c = cos(w);
+
+    v->coef[0] = (MYFLT) ((1.0 - c) / 2.0);
+    v->coef[1] = (MYFLT) (1.0 - c);
+    v->coef[2] = v->coef[0];
+    v->coef[3] = (MYFLT) (1.0 + alpha);
+    v->coef[4] = (MYFLT) (-2.0 * c);
+    v->coef[5] = (MYFLT) (1.0 - alpha);
+}
+
+int main(int argc, char **argv)
+{
+    static CSOUND cs;
+    INSDS       ip;
+    int         nv = (argc > 1 ? atoi(argv[1]) : 256);
+    long        cycles = (argc > 2 ? atol(argv[2]) : 20000L), k;
+    VOICE       *v;
+    BIQUAD      *p[2];
+    void        **bp;
+    double      t0, t[3] = { 0.0, 0.0, 0.0 }, n;
+    int         i, j, s;
+
+    if (nv < 1 || cycles < 1) {
+      fprintf(stderr, "usage: biquad_bench [voices [k-cycles]]\n");
+      return 1;
+    }
+    cs.ksmps = KS;
+    memset(&ip, 0, sizeof(INSDS));
+    ip.ksmps = KS;
+    v = (VOICE*) calloc(nv, sizeof(VOICE));
+    p[0] = (BIQUAD*) calloc(nv, sizeof(BIQUAD));
+    p[1] = (BIQUAD*) calloc(nv, sizeof(BIQUAD));
+    bp = (void**) calloc(nv, sizeof(void*));
+    for (j = 0; j < nv; j++) {
+      lowpass(&v[j], 100.0 + 40.0 * j);
+      for (s = 0; s < 2; s++) {
+        BIQUAD *q = &p[s][j];
+        q->h.insdshead = &ip;
+        q->out = v[j].out[s + 1]; q->in = v[j].in;
+        q->b0 = &v[j].coef[0]; q->b1 = &v[j].coef[1];
+        q->b2 = &v[j].coef[2]; q->a0 = &v[j].coef[3];
+        q->a1 = &v[j].coef[4]; q->a2 = &v[j].coef[5];
+        q->reinit = &v[j].coef[6];
+        biquadset(&cs, q);
+      }
+    }
+    for (k = 0; k < cycles; k++) {
+      for (j = 0; j < nv; j++) {
+        for (i = 0; i < KS; i++)
+          v[j].in[i] = (MYFLT) (((j * 31 + (k * KS + i) * 17) % 101)
+                                / 101.0 - 0.5);
+        if (k % 100 == 99)
+          lowpass(&v[j], 100.0 + 40.0 * j + 10.0 * (k % 700) / 100);
+        bp[j] = &p[1][j];
+      }
+      t0 = now();
+      for (j = 0; j < nv; j++)
+        biquad_old(v[j].coef, v[j].z, v[j].in, v[j].out[0], 0, KS);
+      t[0] += now() - t0;
+      t0 = now();
+      for (j = 0; j < nv; j++)
+        biquad(&cs, &p[0][j]);
+      t[1] += now() - t0;
+      t0 = now();
+      biquad_batch(&cs, bp, nv);
+      t[2] += now() - t0;
+    }
+    n = (double) cycles * nv * KS;
+    printf("%d biquads, ns/sample: before %.2f, biquad %.2f, "
+           "biquad_batch %.2f\n", nv,
+           t[0] / n * 1e9, t[1] / n * 1e9, t[2] / n * 1e9);
+    free(v); free(p[0]); free(p[1]); free(bp);
+    return 0;
+}
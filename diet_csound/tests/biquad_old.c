@@ -0,0 +1,50 @@
+/*
+    biquad_old.c:
+
+    Copyright (C) 1998, 1999, 2001 by Hans Mikelson, Matt Gerassimoff,
+                                      Jens Groh, John ffitch, Steven Yi
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+
+/* biquad() of Opcodes/biquad.c as it was before the filter core, for
+   biquad_test.c and biquad_bench.c to check and time the current one
+   by.  'coef' is b0, b1, b2, a0, a1, a2, as the opcode takes them, and
+   'z' the last two inputs and the last two outputs. */
+
+#include "csoundCore.h"
+
+void biquad_old(const MYFLT *coef, double *z, const MYFLT *in, MYFLT *out,
+                uint32_t offset, uint32_t nsmps)
+{
+    uint32_t n;
+    double xn, yn;
+    double xnm1 = z[0], xnm2 = z[1], ynm1 = z[2], ynm2 = z[3];
+    double a0 = 1.0 / coef[3], a1 = a0 * coef[4], a2 = a0 * coef[5];
+    double b0 = a0 * coef[0], b1 = a0 * coef[1], b2 = a0 * coef[2];
+
+    for (n=offset; n<nsmps; n++) {
+      xn = (double)in[n];
+      yn = b0*xn + b1*xnm1 + b2*xnm2 - a1*ynm1 - a2*ynm2;
+      xnm2 = xnm1;
+      xnm1 = xn;
+      ynm2 = ynm1;
+      ynm1 = yn;
+      out[n] = (MYFLT)yn;
+    }
+    z[0] = xnm1; z[1] = xnm2; z[2] = ynm1; z[3] = ynm2;
+}
@@ -0,0 +1,129 @@
+/*
+    biquad_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Runs biquad() one voice at a time and biquad_batch() on the lot, as
+   --voice-batch does, next to biquad() as it was (biquad_old.c), for 1
+   to 37 voices so that the lanes are full, part full and left over,
+   with the coefficients moving and some voices starting late or ending
+   early.  Fails unless every output sample has the same bits (or, built
+   with -ffast-math, is within 1e-12). */
+
+#include "biquad.c"
+#include "test_util.h"
+
+#define CYCLES  300
+
+extern void biquad_old(const MYFLT *, double *, const MYFLT *, MYFLT *,
+                       uint32_t, uint32_t);
+
+typedef struct {
+    INSDS   ip;
+    MYFLT   in[KS], out[3][KS];
+    MYFLT   coef[7];                /* b0, b1, b2, a0, a1, a2, reinit */
+    double  z[4];                   /* of biquad_old() */
+} VOICE;
+
+/* RBJ lowpass, left unnormalised */
+
+static void lowpass(VOICE *v, double hz)
+{
+    double w = TWOPI * hz / 44100.0, alpha = sin(w) / 1.8, c = cos(w);
+
+    v->coef[0] = (MYFLT) ((1.0 - c) / 2.0);
+    v->coef[1] = (MYFLT) (1.0 - c);
+    v->coef[2] = v->coef[0];
+    v->coef[3] = (MYFLT) (1.0 + alpha);
+    v->coef[4] = (MYFLT) (-2.0 * c);
+    v->coef[5] = (MYFLT) (1.0 - alpha);
+}
+
+static long run(int nv)
+{
+    static CSOUND cs;
+    VOICE       *v = (VOICE*) calloc(nv, sizeof(VOICE));
+    BIQUAD      *p[2];
+    void        **bp = (void**) calloc(nv, sizeof(void*));
+    long        k, bad = 0;
+    int         i, j, s, nb;
+    uint32_t    end;
+
+    cs.ksmps = KS;
+    p[0] = (BIQUAD*) calloc(nv, sizeof(BIQUAD));
+    p[1] = (BIQUAD*) calloc(nv, sizeof(BIQUAD));
+    for (j = 0; j < nv; j++) {
+      v[j].ip.ksmps = KS;
+      lowpass(&v[j], 100.0 + 400.0 * j);
+      for (s = 0; s < 2; s++) {
+        BIQUAD *q = &p[s][j];
+        q->h.insdshead = &v[j].ip;
+        q->out = v[j].out[s + 1]; q->in = v[j].in;
+        q->b0 = &v[j].coef[0]; q->b1 = &v[j].coef[1];
+        q->b2 = &v[j].coef[2]; q->a0 = &v[j].coef[3];
+        q->a1 = &v[j].coef[4]; q->a2 = &v[j].coef[5];
+        q->reinit = &v[j].coef[6];
+        biquadset(&cs, q);
+      }
+    }
+    for (k = 0; k < CYCLES; k++) {
+      for (j = 0; j < nv; j++) {
+        for (i = 0; i < KS; i++)
+          v[j].in[i] = (MYFLT) (((j * 31 + (k * KS + i) * 17) % 101)
+                                / 101.0 - 0.5);
+        if (k % 10 == 9)
+          lowpass(&v[j], 100.0 + 400.0 * j + 30.0 * (k % 70));
+        /* every fifth voice starts late or ends early now and then */
+        v[j].ip.ksmps_offset = (j % 5 == 1 && k % 7 == 0 ? 13 : 0);
+        v[j].ip.ksmps_no_end = (j % 5 == 3 && k % 11 == 0 ? 29 : 0);
+        memset(v[j].out, 0, sizeof(v[j].out));
+        end = KS - v[j].ip.ksmps_no_end;
+        biquad_old(v[j].coef, v[j].z, v[j].in, v[j].out[0],
+                   v[j].ip.ksmps_offset, end);
+        biquad(&cs, &p[0][j]);
+        bp[j] = &p[1][j];
+      }
+      if ((nb = biquad_batch(&cs, bp, nv)) != nv)
+        bad += nv - nb;
+      for (j = 0; j < nv; j++)
+        for (i = 0; i < KS; i++)
+          if (!SAME(v[j].out[0][i], v[j].out[1][i]) ||
+              !SAME(v[j].out[0][i], v[j].out[2][i]))
+            bad++;
+    }
+    free(v); free(p[0]); free(p[1]); free(bp);
+    return bad;
+}
+
+int main(void)
+{
+    static const int nv[] = { 1, 3, 7, 8, 9, 16, 37 };
+    long        bad, total = 0;
+    int         i;
+
+    for (i = 0; i < (int) (sizeof(nv) / sizeof(nv[0])); i++) {
+      if ((bad = run(nv[i])) != 0)
+        printf("%d voices: %ld samples differ\n", nv[i], bad);
+      total += bad;
+    }
+    printf("biquad: %ld samples differ\n", total);
+    return (total != 0);
+}
@@ -0,0 +1,160 @@
+/*
+    circularbuffer_bench.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Throughput of InOut/circularbuffer.c and of the version before it
+   (circularbuffer_old.c) on a ring of 'size' MYFLTs, as the async file
+   IO uses them: first writing and reading blocks of 1 to 1024 samples
+   in one thread, then with a writer and a reader thread moving blocks
+   of ksmps.  Fails if, with the two threads, a sample comes out that
+   was not the next one written.
+
+       circularbuffer_bench [size [Msamples]]                        */
+
+#include "circularbuffer.c"
+#include "test_util.h"
+#include <pthread.h>
+#include <sched.h>
+
+extern void *cbuf_old_create(CSOUND *, int, int);
+extern int  cbuf_old_read(CSOUND *, void *, void *, int);
+extern int  cbuf_old_write(CSOUND *, void *, const void *, int);
+extern void cbuf_old_destroy(CSOUND *, void *);
+
+typedef struct {
+    void    *(*create)(CSOUND *, int, int);
+    int     (*read)(CSOUND *, void *, void *, int);
+    int     (*write)(CSOUND *, void *, const void *, int);
+    void    (*destroy)(CSOUND *, void *);
+} CBUF;
+
+static const CBUF impl[2] = {
+    { cbuf_old_create, cbuf_old_read, cbuf_old_write, cbuf_old_destroy },
+    { csoundCreateCircularBuffer, csoundReadCircularBuffer,
+      csoundWriteCircularBuffer, csoundDestroyCircularBuffer }
+};
+
+static CSOUND   cs;
+static long     total, bad;
+
+typedef struct {
+    const CBUF  *f;
+    void        *cb;
+} SIDE;
+
+/* the writer thread: blocks of KS samples counting up from 0 */
+
+static void *writer(void *arg)
+{
+    SIDE    *s = (SIDE*) arg;
+    MYFLT   blk[KS];
+    long    n = 0;
+    int     i, done;
+
+    while (n < total) {
+      for (i = 0; i < KS; i++)
+        blk[i] = (MYFLT) (n + i);
+      if ((done = s->f->write(&cs, s->cb, blk, KS)) == 0)
+        sched_yield();
+      n += done;
+    }
+    return NULL;
+}
+
+static double threaded(const CBUF *f, int size)
+{
+    SIDE        s;
+    pthread_t   th;
+    MYFLT       blk[KS];
+    double      t0;
+    long        n = 0;
+    int         i, got;
+
+    s.f = f;
+    s.cb = f->create(&cs, size, sizeof(MYFLT));
+    t0 = now();
+    pthread_create(&th, NULL, writer, &s);
+    while (n < total) {
+      if ((got = f->read(&cs, s.cb, blk, KS)) == 0) {
+        sched_yield();
+        continue;
+      }
+      for (i = 0; i < got; i++, n++)
+        if (blk[i] != (MYFLT) n)
+          bad++;
+    }
+    pthread_join(th, NULL);
+    t0 = now() - t0;
+    f->destroy(&cs, s.cb);
+    return t0 / total * 1e9;
+}
+
+static double blocks(const CBUF *f, int size, int len)
+{
+    void    *cb = f->create(&cs, size, sizeof(MYFLT));
+    MYFLT   *in = (MYFLT*) malloc(len * sizeof(MYFLT));
+    MYFLT   *out = (MYFLT*) calloc(len, sizeof(MYFLT));
+    double  t0;
+    long    n;
+    int     i;
+
+    for (i = 0; i < len; i++)
+      in[i] = (MYFLT) (i + 1);
+    t0 = now();
+    for (n = 0; n < total; n += len) {
+      f->write(&cs, cb, in, len);
+      f->read(&cs, cb, out, len);
+    }
+    t0 = now() - t0;
+    for (i = 0; i < len; i++)
+      if (out[i] != in[i])
+        bad++;
+    free(in);
+    free(out);
+    f->destroy(&cs, cb);
+    return t0 / n * 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    static const int len[] = { 1, 16, 64, 256, 1024 };
+    int     size = (argc > 1 ? atoi(argv[1]) : 4096);
+    double  msamples = (argc > 2 ? atof(argv[2]) : 50.0);
+    int     i;
+
+    total = (long) (msamples * 1e6);
+    if (size < 2 || total < 1) {
+      fprintf(stderr, "usage: circularbuffer_bench [size [Msamples]]\n");
+      return 1;
+    }
+    test_libc_memory(&cs);
+    printf("ring of %d, ns/sample    before       now\n", size);
+    for (i = 0; i < (int) (sizeof(len) / sizeof(len[0])); i++) {
+      if (len[i] >= size)
+        break;
+      printf("blocks of %-4d %19.3f %9.3f\n", len[i],
+             blocks(&impl[0], size, len[i]), blocks(&impl[1], size, len[i]));
+    }
+    printf("2 threads, %-4d %18.3f %9.3f\n%ld samples out of order\n", KS,
+           threaded(&impl[0], size), threaded(&impl[1], size), bad);
+    return (bad != 0);
+}
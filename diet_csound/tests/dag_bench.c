@@ -0,0 +1,232 @@
+/*
+    dag_bench.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Time of a k-cycle of the parallel DAG in Engine/cs_new_dispatch.c,
+   for 1 to 'threads' performance threads, with the scanning and the
+   work-stealing dispatcher.  There are 'instrs' instruments of 'voices'
+   voices each; every fourth instrument writes a global bus that the
+   next one reads, so those must run in order, and the rest are free.
+   A voice costs about 'work' iterations of a one pole filter over a
+   block of KS samples.  The order the tasks ran in is checked against
+   the dependencies on every cycle.
+
+       dag_bench [threads [instrs [voices [work [k-cycles]]]]]      */
+
+#include "cs_new_dispatch.c"
+#include "cs_par_orc_semantics.h"
+#include "test_util.h"
+#include <pthread.h>
+#include <unistd.h>
+
+static CSOUND           cs;
+static OPARMS           O;
+static pthread_barrier_t start, end;
+static INSDS            *voice;
+static MYFLT            (*buf)[KS];
+static volatile long    stamp;
+static long             *began, *ended;
+static int              nthreads, ntasks, work, running;
+
+static CS_NORETURN void die(CSOUND *csound, const char *msg, ...)
+{
+    (void) csound;
+    fprintf(stderr, "%s\n", msg);
+    exit(1);
+}
+
+/* instruments 4, 8, 12 ... write "ga4", "ga8", "ga12" ..., which
+   instruments 5, 9, 13 ... read; they all read "gkamp" */
+
+static void instruments(int n)
+{
+    INSTR_SEMANTICS *ins;
+    char name[16];
+    int  i;
+
+    for (i = n; i >= 1; i--) {
+      ins = (INSTR_SEMANTICS*) calloc(1, sizeof(INSTR_SEMANTICS));
+      snprintf(name, 16, "%d", i);
+      ins->name = strdup(name);
+      ins->insno = i;
+      ins->read = csp_set_alloc_string(&cs);
+      ins->write = csp_set_alloc_string(&cs);
+      ins->read_write = csp_set_alloc_string(&cs);
+      csp_set_add(&cs, ins->read, "gkamp");
+      snprintf(name, 16, "ga%d", i & ~3);
+      if ((i & 3) == 0)
+        csp_set_add(&cs, ins->write, strdup(name));
+      else if ((i & 3) == 1 && i > 1)
+        csp_set_add(&cs, ins->read, strdup(name));
+      ins->next = cs.instRoot;
+      cs.instRoot = ins;
+    }
+}
+
+/* does task j (of instrument a) wait for task k < j (of instrument b)? */
+
+static int depends(int a, int b)
+{
+    return ((a & 3) == 0 && a == b) ||
+           ((a & 3) == 1 && a > 1 && b == a - 1);
+}
+
+static void perform(int t)
+{
+    MYFLT *x = buf[t], y = x[KS - 1];
+    int   i, k;
+
+    began[t] = __atomic_add_fetch(&stamp, 1, __ATOMIC_SEQ_CST);
+    for (k = 0; k < work; k++)
+      for (i = 0; i < KS; i++)
+        x[i] = y = FL(0.5) * x[i] + FL(0.4999) * y;
+    ended[t] = __atomic_add_fetch(&stamp, 1, __ATOMIC_SEQ_CST);
+}
+
+/* the task loop of nodePerf() in Top/csound.c */
+
+static void run(int index)
+{
+    taskID next = INVALID, t;
+
+    while (1) {
+      t = dag_get_task(&cs, index, nthreads, next);
+      if (t == WAIT) continue;
+      if (t == INVALID) return;
+      perform(t);
+      next = dag_end_task(&cs, index, t);
+    }
+}
+
+static void *worker(void *arg)
+{
+    int index = (int) (intptr_t) arg;
+
+    while (1) {
+      pthread_barrier_wait(&start);
+      if (!running) return NULL;
+      run(index);
+      pthread_barrier_wait(&end);
+    }
+}
+
+static long check(void)
+{
+    long bad = 0;
+    int  j, k;
+
+    for (j = 0; j < ntasks; j++) {
+      if (began[j] == 0)
+        bad++;
+      for (k = 0; k < j; k++)
+        if (depends(voice[j].insno, voice[k].insno) && ended[k] > began[j])
+          bad++;
+    }
+    return bad;
+}
+
+/* microseconds per k-cycle with 'threads' threads and 'sched' */
+
+static double cycle(int threads, int sched, long cycles, long *bad)
+{
+    pthread_t *th = (pthread_t*) calloc(threads, sizeof(pthread_t));
+    double    t0, t = 0.0;
+    long      k;
+    int       i;
+
+    O.numThreads = nthreads = threads;
+    O.parallelScheduler = sched;
+    cs.dag_task_status = NULL;          /* a fresh DAG */
+    cs.dag_deques = NULL;
+    cs.dag_task_max_size = 0;
+    cs.dag_changed = 1;
+    dag_build(&cs, &voice[0]);
+    pthread_barrier_init(&start, NULL, threads);
+    pthread_barrier_init(&end, NULL, threads);
+    running = 1;
+    for (i = 1; i < threads; i++)
+      pthread_create(&th[i], NULL, worker, (void*) (intptr_t) i);
+    for (k = 0; k < cycles; k++) {
+      memset(began, 0, ntasks * sizeof(long));
+      t0 = now();
+      dag_reinit(&cs);
+      pthread_barrier_wait(&start);
+      run(0);
+      pthread_barrier_wait(&end);
+      t += now() - t0;
+      *bad += check();
+    }
+    running = 0;
+    pthread_barrier_wait(&start);
+    for (i = 1; i < threads; i++)
+      pthread_join(th[i], NULL);
+    pthread_barrier_destroy(&start);
+    pthread_barrier_destroy(&end);
+    free(th);
+    return t / cycles * 1e6;
+}
+
+int main(int argc, char **argv)
+{
+    int     maxthreads = (argc > 1 ? atoi(argv[1])
+                                   : (int) sysconf(_SC_NPROCESSORS_ONLN));
+    int     ninstrs = (argc > 2 ? atoi(argv[2]) : 16);
+    int     nvoices = (argc > 3 ? atoi(argv[3]) : 20);
+    long    cycles = (argc > 5 ? atol(argv[5]) : 500L), bad = 0;
+    double  t[2];
+    int     i, n;
+
+    work = (argc > 4 ? atoi(argv[4]) : 20);
+    if (maxthreads < 1 || ninstrs < 1 || nvoices < 1 || work < 0 ||
+        cycles < 1) {
+      fprintf(stderr, "usage: dag_bench [threads [instrs [voices [work "
+                      "[k-cycles]]]]]\n");
+      return 1;
+    }
+    test_libc_memory(&cs);
+    cs.Die = die;
+    cs.oparms = &O;
+    cs.engineState.maxinsno = ninstrs;
+    cs.engineState.instrtxtp =
+      (INSTRTXT**) calloc(ninstrs + 1, sizeof(INSTRTXT*));
+    instruments(ninstrs);
+    /* the active list is sorted by instrument number */
+    ntasks = ninstrs * nvoices;
+    voice = (INSDS*) calloc(ntasks, sizeof(INSDS));
+    for (i = 0; i < ntasks; i++) {
+      voice[i].insno = 1 + i / nvoices;
+      voice[i].nxtact = (i + 1 < ntasks ? &voice[i + 1] : NULL);
+    }
+    buf = calloc(ntasks, sizeof(*buf));
+    began = (long*) calloc(ntasks, sizeof(long));
+    ended = (long*) calloc(ntasks, sizeof(long));
+    printf("%d tasks, %d iterations of work each; us/k-cycle\n"
+           "threads      scan     steal\n", ntasks, work);
+    for (n = 1; n <= maxthreads; n++) {
+      t[0] = cycle(n, PAR_SCHED_SCAN, cycles, &bad);
+      t[1] = cycle(n, PAR_SCHED_STEAL, cycles, &bad);
+      printf("%7d %9.2f %9.2f\n", n, t[0], t[1]);
+    }
+    if (bad != 0)
+      printf("%ld tasks ran out of order\n", bad);
+    return (bad != 0);
+}
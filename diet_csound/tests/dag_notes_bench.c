@@ -0,0 +1,211 @@
+/*
+    dag_notes_bench.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Keeps the DAG of Engine/cs_new_dispatch.c up to date under a stream
+   of short notes, 'rate' a second of 'dur' seconds each, spread over
+   'instrs' instruments (44100 Hz, ksmps 64), and times dag_build() and
+   dag_reinit() against the instance by instance rebuild dag_build()
+   did before.  Odd instruments mix into "gaverb", which the last one,
+   always on, reads.  Fails if the two ever disagree on a dependency.
+
+       dag_notes_bench [rate [dur [instrs [seconds]]]]              */
+
+#include "cs_new_dispatch.c"
+#include "cs_par_orc_semantics.h"
+#include "test_util.h"
+
+#define KR      (44100.0 / KS)
+
+static CSOUND   cs;
+static OPARMS   O;
+static char     **dep;                  /* of dag_build_ref() */
+static int      ndep;                   /* rows of dep */
+
+static CS_NORETURN void die(CSOUND *csound, const char *msg, ...)
+{
+    (void) csound;
+    fprintf(stderr, "%s\n", msg);
+    exit(1);
+}
+
+static void instruments(int n)
+{
+    INSTR_SEMANTICS *ins;
+    char name[16];
+    int  i;
+
+    for (i = n; i >= 1; i--) {
+      ins = (INSTR_SEMANTICS*) calloc(1, sizeof(INSTR_SEMANTICS));
+      snprintf(name, 16, "%d", i);
+      ins->name = strdup(name);
+      ins->insno = i;
+      ins->read = csp_set_alloc_string(&cs);
+      ins->write = csp_set_alloc_string(&cs);
+      ins->read_write = csp_set_alloc_string(&cs);
+      csp_set_add(&cs, ins->read, "gkvol");
+      if (i == n)
+        csp_set_add(&cs, ins->read, "gaverb");
+      else if (i & 1)
+        csp_set_add(&cs, ins->read_write, "gaverb");
+      ins->next = cs.instRoot;
+      cs.instRoot = ins;
+    }
+}
+
+/* the dependencies as dag_build() worked them out before: every pair
+   of instances, by intersecting their instruments' sets */
+
+static void dag_build_ref(CSOUND *csound, INSDS *chain)
+{
+    INSDS *next;
+    INSTR_SEMANTICS *current_instr, *later_instr;
+    int   i, j, cnt;
+
+    for (i = 0; i < ndep; i++) {
+      free(dep[i]);
+      dep[i] = NULL;
+    }
+    for (i = 0; chain != NULL; i++, chain = chain->nxtact) {
+      current_instr = dag_get_info(csound, chain->insno);
+      for (j = i + 1, next = chain->nxtact; next != NULL;
+           j++, next = next->nxtact) {
+        later_instr = dag_get_info(csound, next->insno);
+        cnt = 0;
+        if (dag_intersect(csound, current_instr->write,
+                          later_instr->read, cnt++)       ||
+            dag_intersect(csound, current_instr->read_write,
+                          later_instr->read, cnt++)       ||
+            dag_intersect(csound, current_instr->read,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->write,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->read_write,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->read,
+                          later_instr->read_write, cnt++) ||
+            dag_intersect(csound, current_instr->write,
+                          later_instr->read_write, cnt++)) {
+          if (dep[j] == NULL)
+            dep[j] = (char*) calloc(j + 1, 1);
+          dep[j][i] = 1;
+        }
+      }
+    }
+}
+
+/* put 'ip' after the last active instance of its instrument */
+
+static void activate(INSDS **act, INSDS *ip)
+{
+    while (*act != NULL && (*act)->insno <= ip->insno)
+      act = &((*act)->nxtact);
+    ip->nxtact = *act;
+    *act = ip;
+}
+
+int main(int argc, char **argv)
+{
+    double  rate = (argc > 1 ? atof(argv[1]) : 1000.0);
+    double  dur = (argc > 2 ? atof(argv[2]) : 0.05);
+    int     ninstrs = (argc > 3 ? atoi(argv[3]) : 8);
+    double  seconds = (argc > 4 ? atof(argv[4]) : 20.0);
+    INSDS   *pool, *act = NULL, **pp, *ip;
+    long    k, kcycles = (long) (seconds * KR), nbuilds = 0, nactive = 0;
+    long    bad = 0, notes = 0;
+    double  due = 0.0, t0, t[3] = { 0.0, 0.0, 0.0 };
+    int     npool, n, i, j;
+
+    if (rate <= 0.0 || dur <= 0.0 || ninstrs < 2 || kcycles < 1) {
+      fprintf(stderr,
+              "usage: dag_notes_bench [rate [dur [instrs [seconds]]]]\n");
+      return 1;
+    }
+    test_libc_memory(&cs);
+    cs.Die = die;
+    cs.oparms = &O;
+    O.numThreads = 4;
+    cs.dag_task_max_size = 100;
+    cs.engineState.maxinsno = ninstrs;
+    cs.engineState.instrtxtp =
+      (INSTRTXT**) calloc(ninstrs + 1, sizeof(INSTRTXT*));
+    instruments(ninstrs);
+    npool = (int) (rate * (dur + 1.0 / KR)) + 2;
+    pool = (INSDS*) calloc(npool, sizeof(INSDS));
+    ndep = npool + 1;
+    dep = (char**) calloc(ndep, sizeof(char*));
+    pool[0].insno = ninstrs;            /* the reverb, always on */
+    pool[0].offtim = -1.0;
+    activate(&act, &pool[0]);
+    cs.dag_changed = 1;
+    for (k = 0; k < kcycles; k++) {
+      /* notes that end, then notes that start */
+      for (pp = &act; *pp != NULL; ) {
+        if ((*pp)->offtim >= 0.0 && (*pp)->offtim <= k / KR) {
+          (*pp)->actflg = 0;
+          *pp = (*pp)->nxtact;
+          cs.dag_changed++;
+        }
+        else pp = &((*pp)->nxtact);
+      }
+      for (due += rate / KR; due >= 1.0; due -= 1.0, notes++) {
+        for (i = 1; i < npool && pool[i].actflg; i++)
+          ;
+        if (i == npool) break;
+        ip = &pool[i];
+        ip->insno = 1 + notes % (ninstrs - 1);
+        ip->offtim = k / KR + dur;
+        ip->actflg = 1;
+        activate(&act, ip);
+        cs.dag_changed++;
+      }
+      for (ip = act, n = 0; ip != NULL; ip = ip->nxtact)
+        n++;
+      nactive += n;
+      if (!cs.dag_changed) {
+        t0 = now();
+        dag_reinit(&cs);
+        t[2] += now() - t0;
+        continue;
+      }
+      t0 = now();
+      dag_build(&cs, act);
+      t[0] += now() - t0;
+      t0 = now();
+      dag_build_ref(&cs, act);
+      t[1] += now() - t0;
+      nbuilds++;
+      if (cs.dag_num_active != n)
+        bad++;
+      for (j = 1; j < n; j++)
+        for (i = 0; i < j; i++)
+          if (dag_depends(&cs, j, i) != (dep[j] != NULL && dep[j][i]))
+            bad++;
+    }
+    printf("%.0f notes/s of %.3f s, %d instruments, %.1f active on "
+           "average, %ld rebuilds\nms per second: dag_build %.3f, "
+           "before %.3f, dag_reinit %.3f; %ld dependencies differ\n",
+           rate, dur, ninstrs, (double) nactive / kcycles, nbuilds,
+           t[0] / seconds * 1e3, t[1] / seconds * 1e3,
+           t[2] / seconds * 1e3, bad);
+    return (bad != 0);
+}
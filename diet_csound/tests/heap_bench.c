@@ -0,0 +1,140 @@
+/*
+    heap_bench.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Schedules 'events' realtime notes at random times in the next 'span'
+   seconds through insert_score_event_at_sample() in Engine/musmon.c,
+   as the schedule and event opcodes do, then takes them off the queue
+   as sensevents() does.  Prints the cost of each, and of the sorted
+   list insert it replaced on the first 'before' of the same events.
+   Fails unless every event comes off, in start time order, and in the
+   order they were scheduled when they start in the same k-period.
+
+       heap_bench [events [span [before]]]                           */
+
+#include "musmon.c"
+#include "test_util.h"
+
+static CSOUND   cs;
+static OPARMS   O;
+static INSTRTXT instr;
+static INSTRTXT *instrtxtp[2] = { NULL, &instr };
+
+/* the sorted list insert of insert_score_event_at_sample() as it was */
+
+static void list_insert(EVTNODE **list, EVTNODE *e)
+{
+    EVTNODE *prv = *list;
+
+    if (prv == NULL || e->start_kcnt < prv->start_kcnt) {
+      e->nxt = prv;
+      *list = e;
+    }
+    else {
+      while (prv->nxt != NULL && e->start_kcnt >= prv->nxt->start_kcnt)
+        prv = prv->nxt;
+      e->nxt = prv->nxt;
+      prv->nxt = e;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long    n = (argc > 1 ? atol(argv[1]) : 100000L);
+    double  span = (argc > 2 ? atof(argv[2]) : 60.0);
+    long    nref = (argc > 3 ? atol(argv[3]) : 20000L);
+    EVTBLK  evt;
+    EVTNODE *e, *ref, *list = NULL;
+    double  *when, t0, t[3];
+    uint64_t kcnt;
+    long    i, last, got, bad = 0;
+    int     pass;
+
+    if (n < 1 || span <= 0.0 || nref < 0) {
+      fprintf(stderr, "usage: heap_bench [events [span [before]]]\n");
+      return 1;
+    }
+    if (nref > n)
+      nref = n;
+    test_libc_memory(&cs);
+    cs.oparms = &O;
+    cs.esr = 44100.0;
+    cs.ekr = 44100.0 / KS;
+    cs.ksmps = KS;
+    cs.ibeatTime = 1.0;
+    cs.engineState.maxinsno = 1;
+    cs.engineState.instrtxtp = instrtxtp;
+    when = (double*) malloc(n * sizeof(double));
+    srand(1);
+    for (i = 0; i < n; i++)
+      when[i] = span * rand() / ((double) RAND_MAX + 1.0);
+    memset(&evt, 0, sizeof(EVTBLK));
+    evt.opcod = 'i';
+    evt.pcnt = 4;
+    evt.p[1] = FL(1.0);
+    evt.p[3] = FL(0.1);
+    /* the second time round the event nodes come from the free list,
+       as they do in a running performance */
+    for (pass = 0; pass < 2; pass++) {
+      t0 = now();
+      for (i = 0; i < n; i++) {
+        evt.p[2] = (MYFLT) when[i];
+        evt.p[4] = (MYFLT) i;           /* to check the order */
+        if (insert_score_event_at_sample(&cs, &evt, 0) != 0) {
+          fprintf(stderr, "insert_score_event_at_sample() failed\n");
+          return 1;
+        }
+      }
+      t[0] = now() - t0;
+      t0 = now();
+      kcnt = 0;
+      last = -1;
+      got = 0;
+      while (cs.OrcTrigEvts != NULL) {
+        e = evtheap_pop(&cs);
+        if (e->start_kcnt < kcnt ||
+            (e->start_kcnt == kcnt && (long) e->evt.p[4] < last))
+          bad++;
+        kcnt = e->start_kcnt;
+        last = (long) e->evt.p[4];
+        got++;
+        e->nxt = cs.freeEvtNodes;
+        cs.freeEvtNodes = e;
+      }
+      t[1] = now() - t0;
+      bad += labs(n - got);
+    }
+    ref = (EVTNODE*) calloc(nref + 1, sizeof(EVTNODE));
+    t0 = now();
+    for (i = 0; i < nref; i++) {
+      ref[i].start_kcnt = time2kcnt(&cs, when[i]);
+      list_insert(&list, &ref[i]);
+    }
+    t[2] = now() - t0;
+    printf("%ld events over %.0f s, us/event: schedule %.3f, take off "
+           "%.3f; sorted list (first %ld) %.3f\n%ld out of order\n",
+           n, span, t[0] / n * 1e6, t[1] / n * 1e6, nref,
+           (nref > 0 ? t[2] / nref * 1e6 : 0.0), bad);
+    free(when);
+    free(ref);
+    return (bad != 0);
+}
@@ -0,0 +1,302 @@
+/*
+    memalloc_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Checks the arena allocator of Engine/memalloc.c: the counters of
+   csoundGetMemoryStats() against what was asked for, zeroing, realloc
+   and reuse of a freed block, blocks freed on another thread than the
+   one that took them going back to the shared lists (so that the arena
+   does not grow when they are taken again), threads handing blocks to
+   each other at random without one block being given out twice, and
+   memRESET().  The system allocator's counters are checked as well. */
+
+#include "memalloc.c"
+#include <pthread.h>
+
+#define NTHREADS    4
+#define NCROSS      20000
+#define NPOOL       256
+#define NSWAP       200000
+
+static CSOUND   cs;
+static long     bad;
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+      printf("%s\n", what);
+      bad++;
+    }
+}
+
+/* what the arena takes for a request of n bytes */
+
+static int64_t class_bytes(size_t n)
+{
+    size_t  c = CLASS_BYTES(0);
+
+    if (n > ARENA_MAX_SIZE)
+      return (int64_t) n;
+    while (c < n)
+      c <<= 1;
+    return (int64_t) c;
+}
+
+static CSOUND_MEMSTATS stats(void)
+{
+    CSOUND_MEMSTATS s;
+
+    check(csoundGetMemoryStats(&cs, &s) == CSOUND_SUCCESS, "no stats");
+    return s;
+}
+
+static void sizes(void)
+{
+    static const size_t size[] = {
+      1, 16, 17, 100, 1000, 4096, 4097, 32768, 32769, 100000
+    };
+    enum { N = sizeof(size) / sizeof(size[0]) };
+    CSOUND_MEMSTATS s0 = stats(), s;
+    unsigned char   *p[N];
+    int64_t         bytes = 0;
+    int             i;
+    size_t          j;
+
+    for (i = 0; i < N; i++) {
+      p[i] = (unsigned char*) mcalloc(&cs, size[i]);
+      for (j = 0; j < size[i]; j++)
+        if (p[i][j] != 0) {
+          check(0, "mcalloc() block not zeroed");
+          break;
+        }
+      memset(p[i], i + 1, size[i]);
+      bytes += class_bytes(size[i]);
+    }
+    s = stats();
+    check(s.allocator == CSOUND_ALLOC_ARENA, "not the arena allocator");
+    check(s.allocs - s0.allocs == N, "allocs miscounted");
+    check(s.bytesInUse - s0.bytesInUse == bytes, "bytes in use miscounted");
+    check(s.bytesReserved > 0 && s.bytesReserved % ARENA_CHUNK_SIZE == 0,
+          "bytes reserved not whole chunks");
+    for (i = 0; i < N; i++)
+      for (j = 0; j < size[i]; j++)
+        if (p[i][j] != (unsigned char) (i + 1)) {
+          check(0, "blocks overlap");
+          break;
+        }
+    /* within its class realloc keeps the block, beyond it the data */
+    check(mrealloc(&cs, p[2], 32) == p[2], "realloc moved within class");
+    p[2] = (unsigned char*) mrealloc(&cs, p[2], 5000);
+    for (j = 0; j < size[2]; j++)
+      if (p[2][j] != 3) {
+        check(0, "realloc lost the data");
+        break;
+      }
+    for (i = 0; i < N; i++)
+      mfree(&cs, p[i]);
+    s = stats();
+    check(s.allocs - s.frees == s0.allocs - s0.frees, "frees miscounted");
+    check(s.bytesInUse == s0.bytesInUse, "bytes in use left after free");
+    /* the thread cache hands the block just freed straight back */
+    p[0] = (unsigned char*) mmalloc(&cs, 200);
+    mfree(&cs, p[0]);
+    check(mmalloc(&cs, 200) == p[0], "freed block not reused");
+    mfree(&cs, p[0]);
+}
+
+/* blocks taken on one thread and freed on another, twice over; both
+   threads live throughout, so each has its own cache */
+
+static void             *cross[NCROSS];
+static long             corrupt;
+static pthread_barrier_t turn;
+static CSOUND_MEMSTATS  after[4];
+
+static void *taker(void *arg)
+{
+    int     i, pass;
+
+    (void) arg;
+    for (pass = 0; pass < 2; pass++) {
+      for (i = 0; i < NCROSS; i++) {
+        cross[i] = mmalloc(&cs, 256);
+        memset(cross[i], i & 0xFF, 256);
+      }
+      after[2 * pass] = stats();
+      pthread_barrier_wait(&turn);      /* the freer's turn */
+      pthread_barrier_wait(&turn);
+    }
+    return NULL;
+}
+
+static void *freer(void *arg)
+{
+    int     i, pass;
+
+    (void) arg;
+    for (pass = 0; pass < 2; pass++) {
+      pthread_barrier_wait(&turn);
+      for (i = 0; i < NCROSS; i++) {
+        if (((unsigned char*) cross[i])[255] != (i & 0xFF))
+          corrupt++;
+        mfree(&cs, cross[i]);
+      }
+      after[2 * pass + 1] = stats();
+      pthread_barrier_wait(&turn);
+    }
+    return NULL;
+}
+
+static void cross_thread(void)
+{
+    CSOUND_MEMSTATS s0 = stats();
+    pthread_t       th[2];
+
+    pthread_barrier_init(&turn, NULL, 2);
+    pthread_create(&th[0], NULL, taker, NULL);
+    pthread_create(&th[1], NULL, freer, NULL);
+    pthread_join(th[0], NULL);
+    pthread_join(th[1], NULL);
+    pthread_barrier_destroy(&turn);
+    check(corrupt == 0, "blocks corrupted between threads");
+    check(after[1].allocs - s0.allocs == NCROSS &&
+          after[1].frees - s0.frees == NCROSS,
+          "cross thread frees miscounted");
+    check(after[1].bytesInUse == s0.bytesInUse &&
+          after[3].bytesInUse == s0.bytesInUse,
+          "bytes in use left after cross thread free");
+    /* what the freeing thread gave back is taken again */
+    check(after[2].bytesReserved <=
+          after[0].bytesReserved + (int64_t) ARENA_CHUNK_SIZE,
+          "blocks freed on another thread not reused");
+}
+
+/* NTHREADS threads swap blocks of all sizes through a pool: each takes
+   one, stamps it and puts it in the pool in place of one that any of
+   them may have taken, which it checks and frees.  A block given out
+   while still in the pool would lose its stamp. */
+
+typedef struct {
+    long    *p, id, k;
+} POOLED;
+
+static pthread_mutex_t  pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static POOLED           pool[NPOOL];
+static long             restamped;
+
+static void release(POOLED *q)
+{
+    if (q->p == NULL)
+      return;
+    if (q->p[0] != q->id || q->p[1] != q->k)
+      __atomic_add_fetch(&restamped, 1, __ATOMIC_SEQ_CST);
+    mfree(&cs, q->p);
+}
+
+static void *swap(void *arg)
+{
+    POOLED  mine, q;
+    unsigned int seed = (unsigned int) (intptr_t) arg;
+    int     j;
+
+    mine.id = (long) (intptr_t) arg;
+    for (mine.k = 0; mine.k < NSWAP; mine.k++) {
+      mine.p = (long*) mmalloc(&cs, 2 * sizeof(long) +
+                                    (size_t) (rand_r(&seed) % 40000));
+      mine.p[0] = mine.id;
+      mine.p[1] = mine.k;
+      j = rand_r(&seed) % NPOOL;
+      pthread_mutex_lock(&pool_lock);
+      q = pool[j];
+      pool[j] = mine;
+      pthread_mutex_unlock(&pool_lock);
+      release(&q);
+    }
+    return NULL;
+}
+
+static void swap_threads(void)
+{
+    CSOUND_MEMSTATS s0 = stats(), s;
+    pthread_t       th[NTHREADS];
+    int             i;
+
+    for (i = 0; i < NTHREADS; i++)
+      pthread_create(&th[i], NULL, swap, (void*) (intptr_t) i);
+    for (i = 0; i < NTHREADS; i++)
+      pthread_join(th[i], NULL);
+    for (i = 0; i < NPOOL; i++)
+      release(&pool[i]);
+    check(restamped == 0, "a block was given out twice");
+    s = stats();
+    check(s.allocs - s0.allocs == (int64_t) NTHREADS * NSWAP &&
+          s.frees - s0.frees == (int64_t) NTHREADS * NSWAP,
+          "swapped blocks miscounted");
+    check(s.bytesInUse == s0.bytesInUse, "bytes in use left after swaps");
+}
+
+/* the system allocator keeps the counts, not the bytes */
+
+static void system_allocator(void)
+{
+    CSOUND          sys;
+    CSOUND_MEMSTATS s;
+    void            *p;
+
+    memset(&sys, 0, sizeof(CSOUND));
+    csoundSpinLockInit(&sys.memlock);
+    memINIT(&sys, CSOUND_ALLOC_SYSTEM);
+    p = mmalloc(&sys, 100);
+    p = mrealloc(&sys, p, 100000);
+    mfree(&sys, mcalloc(&sys, 10));
+    check(csoundGetMemoryStats(&sys, &s) == CSOUND_SUCCESS, "no stats");
+    check(s.allocator == CSOUND_ALLOC_SYSTEM && s.allocs == 2 &&
+          s.frees == 1 && s.bytesInUse == 0 && s.bytesReserved == 0,
+          "system allocator miscounted");
+    mfree(&sys, p);
+    memRESET(&sys);
+    memDESTROY(&sys);
+}
+
+int main(void)
+{
+    CSOUND_MEMSTATS s;
+
+    csoundSpinLockInit(&cs.memlock);
+    memINIT(&cs, CSOUND_ALLOC_ARENA);
+    sizes();
+    cross_thread();
+    swap_threads();
+    memRESET(&cs);
+    s = stats();
+    check(s.bytesReserved == 0 && s.bytesInUse == 0, "memRESET kept chunks");
+    check(s.allocs == s.frees, "memRESET lost the counts");
+    mfree(&cs, mmalloc(&cs, 10));       /* a fresh cache after the reset */
+    s = stats();
+    check(s.bytesReserved == (int64_t) ARENA_CHUNK_SIZE,
+          "no chunk after the reset");
+    memRESET(&cs);
+    memDESTROY(&cs);
+    system_allocator();
+    printf("arena: %ld checks failed\n", bad);
+    return (bad != 0);
+}
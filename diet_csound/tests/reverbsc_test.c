@@ -0,0 +1,133 @@
+/*
+    reverbsc_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Runs Opcodes/reverbsc.c and the version before it (reverbsc_old.c)
+   side by side on the same noise, with the cutoff moving, several
+   sample rates and pitch modulations, and offsets and early ends, and
+   fails unless every output sample has the same bits (or, built with
+   -ffast-math, which lets the compiler add up the lines in another
+   order in each, is within 1e-12).  Also prints what a sample costs in
+   each.
+
+       reverbsc_test [k-cycles per case]                            */
+
+#include "reverbsc.c"
+#include "test_util.h"
+
+extern SUBR     reverbsc_old_init, reverbsc_old_perf;
+extern size_t   reverbsc_old_size;
+
+/* the delay lines of both versions, freed after each case */
+
+static void *allocs[4];
+static int  nallocs;
+
+static void auxalloc(CSOUND *csound, size_t nbytes, AUXCH *auxchp)
+{
+    IGN(csound);
+    auxchp->auxp = allocs[nallocs++] = calloc(1, nbytes);
+    auxchp->size = nbytes;
+    auxchp->endp = (char*) auxchp->auxp + nbytes;
+}
+
+static int error(CSOUND *csound, const char *msg, ...)
+{
+    IGN(csound);
+    printf("%s\n", msg);
+    return NOTOK;
+}
+
+int main(int argc, char **argv)
+{
+    static const double srates[] = { 44100.0, 48000.0, 96000.0 };
+    static const MYFLT  pitchmods[] = { FL(0.0), FL(1.0), FL(5.0) };
+    static CSOUND cs;
+    INSDS       ip;
+    SC_REVERB   *p[2];              /* 0: the old version, 1: the new */
+    MYFLT       outL[2][KS], outR[2][KS], inL[KS], inR[KS];
+    MYFLT       fb, lp, sr = FL(0.0), pm, skip = FL(0.0);
+    long        cycles = (argc > 1 ? atol(argv[1]) : 20000L), k;
+    long        nsmps = 0, ndiff = 0;
+    double      t0, t[2] = { 0.0, 0.0 };
+    int         c, v, i;
+
+    cs.AuxAlloc = auxalloc;
+    cs.InitError = error;
+    memset(&ip, 0, sizeof(INSDS));
+    ip.ksmps = KS;
+    srand(1);
+    for (c = 0; c < 9; c++) {
+      cs.esr = srates[c % 3];
+      pm = pitchmods[c / 3];
+      fb = (MYFLT) (c & 1 ? 0.85 : 0.97);
+      lp = FL(12000.0);
+      p[0] = (SC_REVERB*) calloc(1, reverbsc_old_size);
+      p[1] = (SC_REVERB*) calloc(1, sizeof(SC_REVERB));
+      for (v = 0; v < 2; v++) {
+        /* the arguments come first in both structures */
+        p[v]->h.insdshead = &ip;
+        p[v]->aoutL = outL[v]; p[v]->aoutR = outR[v];
+        p[v]->ainL = inL; p[v]->ainR = inR;
+        p[v]->kFeedBack = &fb; p[v]->kLPFreq = &lp;
+        p[v]->iSampleRate = &sr; p[v]->iPitchMod = &pm;
+        p[v]->iSkipInit = &skip;
+      }
+      if (reverbsc_old_init(&cs, p[0]) != OK ||
+          sc_reverb_init(&cs, p[1]) != OK)
+        return 1;
+      for (k = 0; k < cycles; k++) {
+        for (i = 0; i < KS; i++) {
+          inL[i] = (MYFLT) (rand() / (double) RAND_MAX - 0.5);
+          inR[i] = (MYFLT) ((rand() / (double) RAND_MAX - 0.5) * 0.1);
+        }
+        if (k % 1000 == 0)
+          lp = (MYFLT) (2000 + rand() % 15000);
+        ip.ksmps_offset = (k % 97 == 0 ? 13 : 0);
+        ip.ksmps_no_end = (k % 89 == 0 ? 7 : 0);
+        t0 = now();
+        reverbsc_old_perf(&cs, p[0]);
+        t[0] += now() - t0;
+        t0 = now();
+        sc_reverb_perf(&cs, p[1]);
+        t[1] += now() - t0;
+        for (i = 0; i < KS; i++, nsmps++)
+          if (!SAME(outL[0][i], outL[1][i]) ||
+              !SAME(outR[0][i], outR[1][i])) {
+            if (ndiff < 5)
+              printf("sr %g pitchmod %g cycle %ld sample %d: "
+                     "%.17g %.17g, not %.17g %.17g\n", cs.esr, (double) pm,
+                     k, i, (double) outL[1][i], (double) outR[1][i],
+                     (double) outL[0][i], (double) outR[0][i]);
+            ndiff++;
+          }
+      }
+      while (nallocs > 0)
+        free(allocs[--nallocs]);
+      free(p[0]);
+      free(p[1]);
+    }
+    printf("reverbsc: %ld of %ld samples differ, old %.1f ns/sample, "
+           "new %.1f ns/sample (x%.2f)\n", ndiff, nsmps,
+           t[0] / nsmps * 1e9, t[1] / nsmps * 1e9, t[0] / t[1]);
+    return (ndiff != 0);
+}
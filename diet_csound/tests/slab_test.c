@@ -0,0 +1,171 @@
+/*
+    slab_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Checks the per-template instance slabs of Engine/insert.c: blocks
+   are zeroed, aligned and apart, a released block is the next one
+   handed out, a template sized by prealloc takes one malloc, a smaller
+   request reuses the template's blocks and a larger one dies, and
+   free_instance_slabs() gives back every malloc. */
+
+#include "insert.c"
+#include "test_util.h"
+#include <setjmp.h>
+
+#define NBLK    40
+#define SIZE    100
+
+static CSOUND   cs;
+static jmp_buf  jb;
+static int      nmallocs, nfrees, died;
+static long     bad;
+
+static void *count_malloc(CSOUND *csound, size_t nbytes)
+{
+    (void) csound;
+    nmallocs++;
+    return malloc(nbytes);
+}
+
+static void count_free(CSOUND *csound, void *ptr)
+{
+    (void) csound;
+    if (ptr != NULL)
+      nfrees++;
+    free(ptr);
+}
+
+static void quiet(CSOUND *csound, const char *hdr, const char *fmt,
+                  va_list args)
+{
+    (void) csound; (void) hdr; (void) fmt; (void) args;
+}
+
+static CS_NORETURN void long_jmp(CSOUND *csound, int retval)
+{
+    (void) csound; (void) retval;
+    longjmp(jb, 1);
+}
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+      printf("%s\n", what);
+      bad++;
+    }
+}
+
+static int zeroed(const char *p, size_t n)
+{
+    while (n--)
+      if (*p++ != 0)
+        return 0;
+    return 1;
+}
+
+/* a note-on, as instance() takes a block */
+
+static char *take(INSTRTXT *tp, size_t size)
+{
+    char    *p = (char*) slab_alloc(&cs, tp, size);
+
+    tp->instcnt++;
+    return p;
+}
+
+int main(void)
+{
+    INSTRTXT    tp;
+    char        *blk[NBLK], *p;
+    size_t      bs;
+    int         i, j, m;
+
+    test_libc_memory(&cs);
+    cs.Malloc = count_malloc;
+    cs.Free = count_free;
+    cs.ErrMsgV = quiet;
+    cs.LongJmp = long_jmp;
+
+    /* grows with the number of instances */
+    memset(&tp, 0, sizeof(INSTRTXT));
+    for (i = 0; i < NBLK; i++) {
+      blk[i] = take(&tp, SIZE);
+      check(((uintptr_t) blk[i] & (sizeof(MYFLT) - 1)) == 0, "misaligned");
+      check(zeroed(blk[i], tp.slab_blksiz), "block not zeroed");
+      memset(blk[i], i + 1, tp.slab_blksiz);
+    }
+    bs = tp.slab_blksiz;
+    check(bs >= SIZE && bs < SIZE + sizeof(MYFLT), "wrong block size");
+    for (i = 0; i < NBLK; i++)
+      for (j = 0; j < (int) bs; j++)
+        if (blk[i][j] != (char) (i + 1)) {
+          check(0, "blocks overlap");
+          i = NBLK;
+          break;
+        }
+    check(nmallocs > 1 && nmallocs <= NBLK / SLAB_MINBLKS,
+          "slabs did not grow with the instances");
+
+    /* the free list: last released, first reused, no malloc */
+    m = nmallocs;
+    slab_release(&tp, (INSDS*) blk[3]);
+    slab_release(&tp, (INSDS*) blk[17]);
+    slab_release(&tp, (INSDS*) blk[29]);
+    check(take(&tp, SIZE) == blk[29] && take(&tp, SIZE) == blk[17],
+          "released blocks not reused last in, first out");
+    slab_release(&tp, (INSDS*) blk[29]);
+    p = take(&tp, SIZE / 2);            /* a smaller request fits */
+    check(p == blk[29] && zeroed(p, bs), "smaller request not reused");
+    check(take(&tp, SIZE) == blk[3] && zeroed(blk[3], bs),
+          "reused block not zeroed");
+    check(nmallocs == m, "malloc with blocks on the free list");
+
+    /* a larger request than the template's blocks */
+    slab_release(&tp, (INSDS*) blk[3]);
+    if (setjmp(jb) == 0) {
+      take(&tp, bs + 1);
+      check(0, "larger request did not die");
+    }
+    else died = 1;
+    check(died && cs.perferrcnt == 1, "larger request did not die");
+    check(take(&tp, SIZE) == blk[3], "free list lost by a failed request");
+
+    free_instance_slabs(&cs, &tp);
+    check(nfrees == nmallocs, "slabs not freed");
+    check(tp.slabs == NULL && tp.slab_free == NULL && tp.slab_blksiz == 0,
+          "template not reset");
+
+    /* sized by prealloc: one malloc for all of them */
+    memset(&tp, 0, sizeof(INSTRTXT));
+    tp.slab_hint = NBLK;
+    nmallocs = nfrees = 0;
+    for (i = 0; i < NBLK; i++)
+      take(&tp, SIZE);
+    check(nmallocs == 1, "prealloc'ed template took more than one malloc");
+    take(&tp, SIZE);
+    check(nmallocs == 2, "no new slab when the hint ran out");
+    free_instance_slabs(&cs, &tp);
+    check(nfrees == nmallocs, "slabs not freed");
+
+    printf("slab: %ld checks failed\n", bad);
+    return (bad != 0);
+}
@@ -0,0 +1,223 @@
+/*
+    spout_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Checks spoutsf() in InOut/libsnd.c against the per-sample loop it
+   replaced.  Without the limiter the output buffers, peaks, peak
+   positions and out of range counts must be bit-identical; with it the
+   peaks and counts still must, and the limited samples must be within
+   the error of the tanh approximant. */
+
+#include "libsnd.c"
+
+#define NOUT    (1 << 16)
+
+static CSOUND   cs[2];                  /* 0: reference, 1: spoutsf()   */
+static MYFLT    outbuf[2][NOUT], flushed[2][NOUT], spout[MAXCHNLS * 256];
+static int      nflushed[2];
+
+static void capture(CSOUND *csound, const MYFLT *buf, int nbytes)
+{
+    int k = (csound == &cs[1]), n = nbytes / (int) sizeof(MYFLT);
+
+    if (nflushed[k] + n <= NOUT)
+      memcpy(&flushed[k][nflushed[k]], buf, n * sizeof(MYFLT));
+    nflushed[k] += n;
+}
+
+/* spoutsf() as it was, reading interleaved samples from csound->spout */
+
+static void spoutsf_ref(CSOUND *csound)
+{
+    OPARMS  *O = csound->oparms;
+    uint32_t   chn = 0;
+    int     n;
+    int spoutrem = csound->nspout;
+    MYFLT   *sp = csound->spout;
+    MYFLT   absamp = FL(0.0);
+    uint32  nframes = csound->libsndStatics.nframes;
+    MYFLT lim = O->limiter*csound->e0dbfs;
+    MYFLT rlim = lim==0 ? 0 : FL(1.0)/lim;
+    MYFLT k1 = FL(1.0)/TANH(FL(1.0)); /*  1.31304 */
+ nchk:
+    /* if nspout remaining > buf rem, prepare to send in parts */
+    if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem) {
+      n = (int) csound->libsndStatics.outbufrem;
+    }
+    spoutrem -= n;
+    csound->libsndStatics.outbufrem -= n;
+    do {
+      if (O->limiter) {
+        MYFLT x = *sp;
+        absamp = x;
+        if (UNLIKELY(x>=lim))
+          x = lim;
+        else if (UNLIKELY(x<= -lim))
+          x = -lim;
+        else
+          x = lim*k1*TANH(x*rlim);
+        *sp++ = x;
+        if (csound->libsndStatics.osfopen) {
+          *csound->libsndStatics.outbufp++ = (x * csound->dbfs_to_float);
+        }
+      }
+      else {
+        absamp = *sp++;
+        if (csound->libsndStatics.osfopen) {
+          *csound->libsndStatics.outbufp++ =
+            (absamp * csound->dbfs_to_float);
+        }
+      }
+      if (absamp < FL(0.0)) {
+        absamp = -absamp;
+      }
+      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
+        csound->maxamp[chn] = absamp;
+        csound->maxpos[chn] = nframes;
+      }
+      if (absamp > csound->e0dbfs) {        /* out of range?     */
+        csound->rngcnt[chn]++;              /*  report it        */
+        csound->rngflg = 1;
+      }
+      if (csound->multichan) {
+        if (++chn >= csound->nchnls) {
+            chn = 0;
+            nframes++;
+        }
+      } else {
+        nframes++;
+      }
+    } while (--n);
+    if (!csound->libsndStatics.outbufrem) {
+      if (csound->libsndStatics.osfopen) {
+        csound->nrecs++;
+        csound->audtran(csound, csound->libsndStatics.outbuf,
+                        csound->libsndStatics.outbufsiz); /* Flush buffer */
+        csound->libsndStatics.outbufp = (MYFLT*) csound->libsndStatics.outbuf;
+      }
+      csound->libsndStatics.outbufrem = csound->oparms_.outbufsamps;
+      if (spoutrem) {
+        goto nchk;
+      }
+    }
+    csound->libsndStatics.nframes = nframes;
+}
+
+static MYFLT rnd(void)
+{
+    return (MYFLT) ((rand() / (double) RAND_MAX - 0.5) * 2.4);
+}
+
+static int compare(uint32_t nch, int limited)
+{
+    CSOUND  *a = &cs[0], *b = &cs[1];
+    int     i, n = nflushed[0], bad = 0;
+    /* the [7/6] Pade approximant against the library tanh */
+    MYFLT   tol = limited ? (MYFLT) (sizeof(MYFLT) == 4 ? 1e-5 : 1e-10) : 0;
+    MYFLT   d;
+
+    if (n != nflushed[1] || a->nrecs != b->nrecs ||
+        a->libsndStatics.nframes != b->libsndStatics.nframes ||
+        a->libsndStatics.outbufrem != b->libsndStatics.outbufrem ||
+        a->rngflg != b->rngflg)
+      return 1;
+    if (n > NOUT)
+      n = NOUT;
+    for (i = 0; i < n; i++) {
+      d = flushed[0][i] - flushed[1][i];
+      if (!(FABS(d) <= tol))
+        bad++;
+    }
+    n = (int) (a->libsndStatics.outbufp - a->libsndStatics.outbuf);
+    for (i = 0; i < n; i++) {
+      d = outbuf[0][i] - outbuf[1][i];
+      if (!(FABS(d) <= tol))
+        bad++;
+    }
+    if (memcmp(a->maxamp, b->maxamp, nch * sizeof(MYFLT)) ||
+        memcmp(a->maxpos, b->maxpos, nch * sizeof(uint32)) ||
+        memcmp(a->rngcnt, b->rngcnt, nch * sizeof(int32)))
+      bad++;
+    return bad;
+}
+
+int main(void)
+{
+    static const uint32_t nchs[] = { 1, 2, 3, 4, 5, 6, 8, 9, 32 };
+    uint32_t  t, nch, ksmps, obs, c, f;
+    int       rep, k, ncycles, limited, bad, fails = 0;
+
+    srand(7);
+    for (t = 0; t < sizeof(nchs) / sizeof(nchs[0]); t++)
+      for (rep = 0; rep < 40; rep++) {
+        nch = nchs[t];
+        ksmps = 1 + rand() % 130;
+        ncycles = 1 + rand() % 8;
+        limited = (rep % 4 == 3);
+        /* whole frames, sometimes fewer than a cycle holds */
+        obs = nch * (1 + rand() % (2 * ksmps));
+        for (k = 0; k < 2; k++) {
+          CSOUND *csound = &cs[k];
+          memset(csound, 0, sizeof(CSOUND));
+          csound->oparms = &csound->oparms_;
+          csound->oparms_.limiter = limited ? FL(0.9) : FL(0.0);
+          csound->oparms_.outbufsamps = obs;
+          csound->e0dbfs = FL(1.0);
+          csound->dbfs_to_float = FL(0.7);
+          csound->nchnls = nch;
+          csound->ksmps = ksmps;
+          csound->multichan = (nch > 1);
+          csound->nspout = (int) (nch * ksmps);
+          csound->audtran = capture;
+          csound->libsndStatics.outbuf = outbuf[k];
+          csound->libsndStatics.outbufp = outbuf[k];
+          csound->libsndStatics.outbufsiz = obs * sizeof(MYFLT);
+          csound->libsndStatics.outbufrem = obs;
+          csound->libsndStatics.osfopen = (rep % 7 != 6);
+          csound->libsndStatics.nframes = 1;
+          nflushed[k] = 0;
+        }
+        cs[1].spraw = (MYFLT*) calloc(nch * ksmps, sizeof(MYFLT));
+        cs[0].spout = spout;
+        for (k = 0; k < ncycles; k++) {
+          for (c = 0; c < nch; c++)
+            for (f = 0; f < ksmps; f++)
+              cs[1].spraw[c * ksmps + f] =
+                (rep % 5 == 0 ? (MYFLT) ((f % 17) / 16.0) : rnd());
+          for (f = 0; f < ksmps; f++)
+            for (c = 0; c < nch; c++)
+              spout[f * nch + c] = cs[1].spraw[c * ksmps + f];
+          spoutsf_ref(&cs[0]);
+          spoutsf(&cs[1]);
+        }
+        bad = compare(nch, limited);
+        if (bad) {
+          printf("nchnls %u ksmps %u outbufsamps %u limiter %d: "
+                 "%d mismatches\n", nch, ksmps, obs, limited, bad);
+          fails++;
+        }
+        free(cs[1].spraw);
+      }
+    printf("spoutsf: %d of %d cases differ\n", fails,
+           (int) (sizeof(nchs) / sizeof(nchs[0])) * 40);
+    return (fails != 0);
+}
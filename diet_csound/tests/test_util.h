@@ -0,0 +1,86 @@
+/*
+    test_util.h:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* What the programs in tests/ share.  Include it after the source
+   file under test, which brings in csoundCore.h. */
+
+#ifndef CSOUND_TEST_UTIL_H
+#define CSOUND_TEST_UTIL_H
+
+#include <time.h>
+
+#define KS      64                      /* ksmps, unless a test says */
+
+/* the same bits, or within 1e-12 when built with -ffast-math, where
+   the compiler may reassociate either side */
+#ifdef __FAST_MATH__
+#  define SAME(x, y)    (fabs((double) (x) - (double) (y)) <= 1.0e-12)
+#else
+#  define SAME(x, y)    (memcmp(&(x), &(y), sizeof(x)) == 0)
+#endif
+
+/* wall clock, in seconds */
+
+static inline double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* memory for a CSOUND that has not been through csoundCreate() */
+
+static void *test_malloc(CSOUND *csound, size_t nbytes)
+{
+    (void) csound;
+    return malloc(nbytes);
+}
+
+static void *test_calloc(CSOUND *csound, size_t nbytes)
+{
+    (void) csound;
+    return calloc(1, nbytes);
+}
+
+static void *test_realloc(CSOUND *csound, void *oldp, size_t nbytes)
+{
+    (void) csound;
+    return realloc(oldp, nbytes);
+}
+
+static void test_free(CSOUND *csound, void *ptr)
+{
+    (void) csound;
+    free(ptr);
+}
+
+static inline void test_libc_memory(CSOUND *csound)
+{
+    csound->Malloc = test_malloc;
+    csound->Calloc = test_calloc;
+    csound->ReAlloc = test_realloc;
+    csound->Free = test_free;
+}
+
+#endif
@@ -0,0 +1,206 @@
+/*
+    threadsafe_test.c:
+
+    Copyright (C) 2026
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Checks the async API queue of Top/threadsafe.c.  One producer fills
+   the ring and goes on into the spill list with nobody reading, then
+   several producers send table writes and long score messages (whose
+   arguments do not fit in a slot) against a reader that sleeps between
+   k-cycles, so that the ring keeps going from full to spill and back.
+   Every message must arrive once, each producer's in the order it sent
+   them, and every allocation must be freed. */
+
+/* the messages end up here instead of in the engine */
+#define csoundTableSetInternal      test_table_set
+#define csoundInputMessageInternal  test_input_message
+
+#include "threadsafe.c"
+#include "test_util.h"
+#include <pthread.h>
+#include <unistd.h>
+
+#define NPROD   4
+#define NMSG    20000
+#define LONGMSG (API_MSG_INLINE + 100)
+
+static CSOUND   cs;
+static long     next[NPROD + 1], bad, got;
+static long     nalloc, nfree, nspill;
+
+static void *count_malloc(CSOUND *csound, size_t nbytes)
+{
+    (void) csound;
+    __atomic_add_fetch(&nalloc, 1, __ATOMIC_SEQ_CST);
+    if (nbytes == sizeof(message_spill_t))
+      __atomic_add_fetch(&nspill, 1, __ATOMIC_SEQ_CST);
+    return malloc(nbytes);
+}
+
+static void *count_calloc(CSOUND *csound, size_t nbytes)
+{
+    (void) csound;
+    __atomic_add_fetch(&nalloc, 1, __ATOMIC_SEQ_CST);
+    return calloc(1, nbytes);
+}
+
+static void count_free(CSOUND *csound, void *ptr)
+{
+    (void) csound;
+    if (ptr != NULL)
+      __atomic_add_fetch(&nfree, 1, __ATOMIC_SEQ_CST);
+    free(ptr);
+}
+
+/* message 'seq' of producer 'id' has arrived */
+
+static void arrived(int id, long seq)
+{
+    if (id < 0 || id > NPROD || seq != next[id])
+      bad++;
+    else next[id]++;
+    got++;
+}
+
+void test_table_set(CSOUND *csound, int table, int index, MYFLT value)
+{
+    (void) csound;
+    arrived(table, index);
+    if (value != (MYFLT) index)
+      bad++;
+}
+
+void test_input_message(CSOUND *csound, const char *message)
+{
+    int     id;
+    long    seq;
+
+    (void) csound;
+    if (strlen(message) != LONGMSG - 1 ||
+        sscanf(message, "i %d %ld", &id, &seq) != 2)
+      bad++;
+    else arrived(id, seq);
+}
+
+static void send(int id, long seq)
+{
+    char    msg[LONGMSG];
+
+    if (seq % 7 == 3) {                 /* too long for a slot */
+      memset(msg, ' ', LONGMSG - 1);
+      msg[LONGMSG - 1] = '\0';
+      msg[snprintf(msg, LONGMSG, "i %d %ld", id, seq)] = ' ';
+      csoundInputMessageAsync(&cs, msg);
+    }
+    else csoundTableSetAsync(&cs, id, (int) seq, (MYFLT) seq);
+}
+
+static long spilled(void)
+{
+    message_spill_t *s;
+    long            n = 0;
+
+    for (s = (message_spill_t*) cs.msg_spill; s != NULL; s = s->nxt)
+      n++;
+    return n;
+}
+
+static void *producer(void *arg)
+{
+    int     id = (int) (intptr_t) arg;
+    long    seq;
+
+    for (seq = 0; seq < NMSG; seq++)
+      send(id, seq);
+    return NULL;
+}
+
+static volatile int producing;
+
+/* gives up if messages are left that it cannot run */
+
+static void *reader(void *arg)
+{
+    long    last = -1;
+    int     stuck = 0;
+
+    (void) arg;
+    while (producing || (csoundGetAPIQueueDepth(&cs) > 0 && stuck < 1000)) {
+      message_dequeue(&cs);
+      stuck = (got == last ? stuck + 1 : 0);
+      last = got;
+      usleep(200);                      /* a k-cycle */
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t   prod[NPROD], rd;
+    long        i, n = API_MAX_QUEUE + 300;
+    int         j;
+
+    test_libc_memory(&cs);
+    cs.Malloc = count_malloc;
+    cs.Calloc = count_calloc;
+    cs.Free = count_free;
+    allocate_message_queue(&cs);
+
+    /* no reader: the ring fills, the rest is spilled, then all run in
+       order, and the ring takes over again after the spill */
+    for (i = 0; i < n; i++)
+      send(NPROD, i);
+    if (csoundGetAPIQueueDepth(&cs) != n || spilled() != n - API_MAX_QUEUE) {
+      printf("%d queued, %ld spilled, not %ld and %ld\n",
+             csoundGetAPIQueueDepth(&cs), spilled(), n,
+             n - API_MAX_QUEUE);
+      bad++;
+    }
+    for (i = n; i < n + 10; i++) {
+      message_dequeue(&cs);
+      send(NPROD, i);
+    }
+    message_dequeue(&cs);
+    if (next[NPROD] != n + 10 || csoundGetAPIQueueDepth(&cs) != 0)
+      bad++;
+
+    /* several producers against a slow reader */
+    nspill = 0;
+    producing = 1;
+    pthread_create(&rd, NULL, reader, NULL);
+    for (j = 0; j < NPROD; j++)
+      pthread_create(&prod[j], NULL, producer, (void*) (intptr_t) j);
+    for (j = 0; j < NPROD; j++)
+      pthread_join(prod[j], NULL);
+    producing = 0;
+    pthread_join(rd, NULL);
+    for (j = 0; j < NPROD; j++)
+      if (next[j] != NMSG)
+        bad++;
+    if (nspill == 0) {
+      printf("the ring never filled\n");
+      bad++;
+    }
+    cs.Free(&cs, cs.msg_queue);
+    printf("%ld messages, %ld spilled, %ld out of order or lost, "
+           "%ld allocations not freed\n", got, nspill, bad, nalloc - nfree);
+    return (bad != 0 || nalloc != nfree);
+}